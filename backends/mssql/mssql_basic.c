@@ -40,6 +40,7 @@ struct odbx_basic_ops mssql_odbx_basic_ops = {
 	.column_type = mssql_odbx_column_type,
 	.field_length = mssql_odbx_field_length,
 	.field_value = mssql_odbx_field_value,
+	.cancel = mssql_odbx_cancel,
 };
 
 
@@ -89,6 +90,7 @@ static int mssql_odbx_init( odbx_t* handle, const char* host, const char* port )
 	tc->msg = 0;
 	tc->errtype = 0;
 	tc->firstresult = 0;
+	tc->cancel = 0;
 
 	len = strlen( host ) + 1;
 
@@ -291,6 +293,8 @@ static int mssql_odbx_query( odbx_t* handle, const char* query, unsigned long le
 
 	if( aux == NULL ) { return -ODBX_ERR_HANDLE; }
 
+	__atomic_store_n( &aux->cancel, 0, __ATOMIC_RELAXED );
+
 	if( dbcmd( dbproc, (char*) query ) == FAIL )
 	{
 		return -ODBX_ERR_BACKEND;
@@ -314,18 +318,47 @@ static int mssql_odbx_result( odbx_t* handle, odbx_result_t** result, struct tim
 	struct tdsconn* caux = (struct tdsconn*) handle->aux;
 
 
+	/*
+	 *  DB-Library doesn't allow other threads to use the connection, so
+	 *  waiting for the first result is interrupted regularly to look for
+	 *  cancel requests
+	 */
 	if( caux->firstresult )
 	{
-		long ms = -1;
+		long ms = -1, wait;
 		int reason = DBRESULT;
 		DBPROCESS* cdbproc;
 
 		if( timeout != NULL ) { ms = timeout->tv_sec * 1000 + timeout->tv_usec / 1000; }
-		if( dbpoll( dbproc, ms, &cdbproc, &reason ) == FAIL ) { return -ODBX_ERR_BACKEND; }
-		if( reason != DBRESULT ) { return ODBX_RES_TIMEOUT; }   // timeout
+
+		do
+		{
+			wait = ms < 0 || ms > MSSQL_CANCELPOLL ? MSSQL_CANCELPOLL : ms;
+
+			if( dbpoll( dbproc, wait, &cdbproc, &reason ) == FAIL ) { return -ODBX_ERR_BACKEND; }
+			if( __atomic_load_n( &caux->cancel, __ATOMIC_ACQUIRE ) ) { break; }
+			if( ms > 0 ) { ms -= wait; }
+		}
+		while( reason != DBRESULT && ms != 0 );
+
+		if( reason != DBRESULT && !__atomic_load_n( &caux->cancel, __ATOMIC_ACQUIRE ) )
+		{
+			return ODBX_RES_TIMEOUT;   // timeout
+		}
 
 		caux->firstresult = 0;
-		if( dbsqlok( dbproc ) == FAIL ) { return -ODBX_ERR_BACKEND; }
+
+		if( !__atomic_load_n( &caux->cancel, __ATOMIC_ACQUIRE ) && dbsqlok( dbproc ) == FAIL )
+		{
+			return -ODBX_ERR_BACKEND;
+		}
+	}
+
+	if( __atomic_exchange_n( &caux->cancel, 0, __ATOMIC_ACQUIRE ) )
+	{
+		if( dbcancel( dbproc ) == FAIL ) { return -ODBX_ERR_BACKEND; }
+
+		return -ODBX_ERR_CANCELED;   // no results are left afterwards
 	}
 
 	switch( dbresults( dbproc ) )
@@ -396,6 +429,19 @@ static int mssql_odbx_result( odbx_t* handle, odbx_result_t** result, struct tim
 
 
 
+static int mssql_odbx_cancel( odbx_t* handle )
+{
+	struct tdsconn* aux = (struct tdsconn*) handle->aux;
+
+	if( aux == NULL ) { return -ODBX_ERR_PARAM; }
+
+	__atomic_store_n( &aux->cancel, 1, __ATOMIC_RELEASE );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int mssql_odbx_result_finish( odbx_result_t* result )
 {
 	DBINT i, cols = 0;
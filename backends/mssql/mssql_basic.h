@@ -43,6 +43,8 @@ static int mssql_odbx_query( odbx_t* handle, const char* query, unsigned long le
 
 static int mssql_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk );
 
+static int mssql_odbx_cancel( odbx_t* handle );
+
 static int mssql_odbx_result_finish( odbx_result_t* result );
 
 static int mssql_odbx_row_fetch( odbx_result_t* result );
@@ -23,6 +23,7 @@ extern struct odbx_basic_ops mssql_odbx_basic_ops;
 struct odbx_ops mssql_odbx_ops = {
 	.basic = &mssql_odbx_basic_ops,
 	.lo = NULL,
+	.stmt = NULL,
 };
 
 
@@ -34,6 +34,7 @@
 
 
 #define MSSQL_MSGLEN 512
+#define MSSQL_CANCELPOLL 100   // milliseconds between checks for cancel requests
 
 
 
@@ -47,6 +48,7 @@ struct tdsconn
 	int msg;
 	int errtype;
 	int firstresult;
+	char cancel;   // set by other threads, dbcancel() is called by the thread using the connection
 	char* host;
 	LOGINREC* login;
 };
@@ -40,6 +40,7 @@ struct odbx_basic_ops mysql_odbx_basic_ops = {
 	.column_type = mysql_odbx_column_type,
 	.field_length = mysql_odbx_field_length,
 	.field_value = mysql_odbx_field_value,
+	.cancel = mysql_odbx_cancel,
 };
 
 
@@ -88,6 +89,9 @@ static int mysql_odbx_init( odbx_t* handle, const char* host, const char* port )
 	aux->mode = NULL;
 	aux->flags = 0;
 	aux->tls = 0;
+	aux->who = NULL;
+	aux->cred = NULL;
+	aux->thread = 0;
 
 	aux->flags |= CLIENT_REMEMBER_OPTIONS;   // remember options between mysql_real_connect() calls
 	aux->flags |= CLIENT_FOUND_ROWS;   // return the number of found rows, not the number of changed rows
@@ -182,12 +186,16 @@ static int mysql_odbx_bind( odbx_t* handle, const char* database, const char* wh
 
 SUCCESS:
 
-	if( ( err = mysql_priv_setmode( handle, param->mode ) ) != ODBX_ERR_SUCCESS )
+	if( ( err = mysql_priv_setmode( handle, param->mode ) ) != ODBX_ERR_SUCCESS ||
+		( err = mysql_priv_account( param, who, cred ) ) != ODBX_ERR_SUCCESS )
 	{
 		mysql_close( (MYSQL*) handle->generic );
+		return err;
 	}
 
-	return err;
+	param->thread = mysql_thread_id( (MYSQL*) handle->generic );
+
+	return ODBX_ERR_SUCCESS;
 }
 
 
@@ -196,6 +204,12 @@ static int mysql_odbx_unbind( odbx_t* handle )
 {
 	if( handle->generic != NULL )
 	{
+		if( handle->aux != NULL )
+		{
+			mysql_priv_account( (struct myconn*) handle->aux, NULL, NULL );
+			((struct myconn*) handle->aux)->thread = 0;
+		}
+
 		mysql_close( (MYSQL*) handle->generic );
 		return ODBX_ERR_SUCCESS;
 	}
@@ -217,6 +231,8 @@ static int mysql_odbx_finish( odbx_t* handle )
 			aux->host = NULL;
 		}
 
+		mysql_priv_account( aux, NULL, NULL );
+
 		free( handle->aux );
 		handle->aux = NULL;
 	}
@@ -500,6 +516,52 @@ static int mysql_odbx_result( odbx_t* handle, odbx_result_t** result, struct tim
 
 
 
+/*
+ *  The client library doesn't allow another thread to use the connection
+ *  while it's waiting for the result, so the statement is killed using a
+ *  second connection to the server
+ */
+
+static int mysql_odbx_cancel( odbx_t* handle )
+{
+	MYSQL side;
+	char stmt[40];
+	int err = ODBX_ERR_SUCCESS;
+	char *host = NULL, *socket = NULL;
+	struct myconn* param = (struct myconn*) handle->aux;
+
+
+	if( param == NULL || param->thread == 0 )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( param->host != NULL && param->host[0] != '/' ) { host = param->host; }
+	else { socket = param->host; }
+
+	snprintf( stmt, sizeof( stmt ), "KILL QUERY %lu", param->thread );
+
+	mysql_thread_init();   // the thread may not have used the client library before
+
+	if( mysql_init( &side ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	if( mysql_options( &side, MYSQL_READ_DEFAULT_GROUP, "client" ) != 0 ||
+		mysql_real_connect( &side, host, param->who, param->cred, NULL, param->port, socket, param->flags ) == NULL ||
+		mysql_query( &side, stmt ) != 0 )
+	{
+		err = -ODBX_ERR_BACKEND;
+	}
+
+	mysql_close( &side );
+
+	return err;
+}
+
+
+
 static int mysql_odbx_result_finish( odbx_result_t* result )
 {
 	if( result->generic != NULL )
@@ -719,3 +781,52 @@ static int mysql_priv_setmode( odbx_t* handle, const char* mode )
 
 	return ODBX_ERR_SUCCESS;
 }
+
+
+
+/*
+ *  odbx_cancel() opens a second connection with the same account to kill
+ *  the running statement, so the password is kept in clear text until the
+ *  connection is unbound. It's overwritten before the memory is released.
+ */
+
+static int mysql_priv_account( struct myconn* param, const char* who, const char* cred )
+{
+	mysql_priv_wipe( param->cred );
+
+	free( param->who );
+	free( param->cred );
+
+	param->who = NULL;
+	param->cred = NULL;
+
+	if( who != NULL )
+	{
+		if( ( param->who = (char*) malloc( strlen( who ) + 1 ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+		memcpy( param->who, who, strlen( who ) + 1 );
+	}
+
+	if( cred != NULL )
+	{
+		if( ( param->cred = (char*) malloc( strlen( cred ) + 1 ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+		memcpy( param->cred, cred, strlen( cred ) + 1 );
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Writes through a volatile pointer, so the compiler can't drop the
+ *  stores to memory which is freed afterwards
+ */
+
+static void mysql_priv_wipe( char* str )
+{
+	volatile char* ptr = str;
+
+	if( ptr == NULL ) { return; }
+
+	while( *ptr != 0 ) { *ptr++ = 0; }
+}
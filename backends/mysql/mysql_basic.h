@@ -43,6 +43,8 @@ static int mysql_odbx_query( odbx_t* handle, const char* query, unsigned long le
 
 static int mysql_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk );
 
+static int mysql_odbx_cancel( odbx_t* handle );
+
 static int mysql_odbx_result_finish( odbx_result_t* result );
 
 static int mysql_odbx_row_fetch( odbx_result_t* result );
@@ -67,6 +69,10 @@ static const char* mysql_odbx_field_value( odbx_result_t* result, unsigned long
 
 static int mysql_priv_setmode( odbx_t* handle, const char* mode );
 
+static int mysql_priv_account( struct myconn* param, const char* who, const char* cred );
+
+static void mysql_priv_wipe( char* str );
+
 
 
 #endif
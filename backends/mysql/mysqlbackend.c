@@ -23,6 +23,7 @@ extern struct odbx_basic_ops mysql_odbx_basic_ops;
 struct odbx_ops mysql_odbx_ops = {
 	.basic = &mysql_odbx_basic_ops,
 	.lo = NULL,
+	.stmt = NULL,
 };
 
 
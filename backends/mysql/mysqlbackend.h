@@ -52,6 +52,9 @@ struct myconn
 	char* mode;
 	int tls;
 	int first;
+	char* who;   // account used by the connection killing running statements
+	char* cred;   // password in clear text while bound, wiped before it's freed
+	unsigned long thread;   // connection ID on the server
 };
 
 struct myres
@@ -0,0 +1,635 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "null_basic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+
+/*
+ *  Declaration of null backend capabilities
+ */
+
+struct odbx_basic_ops null_odbx_basic_ops = {
+	.init = null_odbx_init,
+	.bind = null_odbx_bind,
+	.unbind = null_odbx_unbind,
+	.finish = null_odbx_finish,
+	.get_option = null_odbx_get_option,
+	.set_option = null_odbx_set_option,
+	.error = null_odbx_error,
+	.error_type = null_odbx_error_type,
+	.escape = null_odbx_escape,
+	.query = null_odbx_query,
+	.result = null_odbx_result,
+	.result_finish = null_odbx_result_finish,
+	.rows_affected = null_odbx_rows_affected,
+	.row_fetch = null_odbx_row_fetch,
+	.column_count = null_odbx_column_count,
+	.column_name = null_odbx_column_name,
+	.column_type = null_odbx_column_type,
+	.field_length = null_odbx_field_length,
+	.field_value = null_odbx_field_value,
+};
+
+
+
+/*
+ *  Private null backend error messages
+ */
+
+static const char* null_odbx_errmsg[] = {
+	gettext_noop("Unknown error"),
+	gettext_noop("Invalid parameter"),
+	gettext_noop("Invalid value of a result set parameter"),
+	gettext_noop("Not bound to a database"),
+};
+
+
+
+/*
+ *  Default parameters of the synthetic result sets
+ */
+
+static const struct nparam null_odbx_defaults = {
+	.rows = 100,
+	.cols = 4,
+	.size = 8,
+	.nulls = 0,
+	.results = 1,
+	.timeouts = 0,
+	.lob = 4096,
+	.type = NULL_TYPE_TEXT,
+};
+
+
+
+/*
+ *  ODBX basic operations
+ *  Null backend style
+ */
+
+
+/*
+ *  The null backend doesn't connect to anything. All result sets are
+ *  generated in memory from the parameters set by odbx_bind() and the
+ *  statement, so it measures the overhead of the library and the
+ *  applications using it without any I/O. Host and port are unused.
+ */
+
+static int null_odbx_init( odbx_t* handle, const char* host, const char* port )
+{
+	struct nconn* aux;
+
+
+	if( ( aux = (struct nconn*) malloc( sizeof( struct nconn ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	aux->bind = null_odbx_defaults;
+	aux->stmt = null_odbx_defaults;
+	aux->results = 0;
+	aux->timeouts = 0;
+	aux->norows = 0;
+	aux->err = 0;
+
+	handle->aux = (void*) aux;
+	handle->generic = NULL;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  The database name contains the "key=value" pairs of the parameters while
+ *  username and password are ignored.
+ */
+
+static int null_odbx_bind( odbx_t* handle, const char* database, const char* who, const char* cred, int method )
+{
+	struct nconn* aux = (struct nconn*) handle->aux;
+
+
+	if( aux == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( method != ODBX_BIND_SIMPLE ) { return -ODBX_ERR_NOTSUP; }
+
+	aux->bind = null_odbx_defaults;
+
+	if( database != NULL && null_odbx_param( &(aux->bind), database, strlen( database ) ) < 0 )
+	{
+		aux->err = 2;
+		return -ODBX_ERR_BACKEND;
+	}
+
+	aux->err = 0;
+	handle->generic = (void*) aux;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int null_odbx_unbind( odbx_t* handle )
+{
+	struct nconn* aux = (struct nconn*) handle->aux;
+
+	if( aux == NULL ) { return -ODBX_ERR_PARAM; }
+
+	aux->results = 0;
+	aux->timeouts = 0;
+	handle->generic = NULL;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int null_odbx_finish( odbx_t* handle )
+{
+	if( handle->aux != NULL )
+	{
+		free( handle->aux );
+		handle->aux = NULL;
+
+		return ODBX_ERR_SUCCESS;
+	}
+
+	return -ODBX_ERR_PARAM;
+}
+
+
+
+static int null_odbx_get_option( odbx_t* handle, unsigned int option, void* value )
+{
+	switch( option )
+	{
+		case ODBX_OPT_API_VERSION:
+			*(int*) value = APINUMBER;
+			break;
+		case ODBX_OPT_MULTI_STATEMENTS:
+		case ODBX_OPT_THREAD_SAFE:
+			*(int*) value = ODBX_ENABLE;
+			break;
+		case ODBX_OPT_TLS:
+		case ODBX_OPT_PAGED_RESULTS:
+		case ODBX_OPT_COMPRESS:
+		case ODBX_OPT_CONNECT_TIMEOUT:
+			*(int*) value = ODBX_DISABLE;
+			break;
+		default:
+			return -ODBX_ERR_OPTION;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int null_odbx_set_option( odbx_t* handle, unsigned int option, void* value )
+{
+	switch( option )
+	{
+		case ODBX_OPT_API_VERSION:
+		case ODBX_OPT_THREAD_SAFE:
+			return -ODBX_ERR_OPTRO;
+		case ODBX_OPT_MULTI_STATEMENTS:
+
+			if( *((int*) value) == ODBX_ENABLE ) { return ODBX_ERR_SUCCESS; }
+			break;
+
+		case ODBX_OPT_PAGED_RESULTS:
+		case ODBX_OPT_COMPRESS:
+		case ODBX_OPT_TLS:
+			break;
+		default:
+			return -ODBX_ERR_OPTION;
+	}
+
+	return -ODBX_ERR_OPTWR;
+}
+
+
+
+static const char* null_odbx_error( odbx_t* handle )
+{
+	struct nconn* aux = (struct nconn*) handle->aux;
+
+	if( aux == NULL )
+	{
+		return dgettext( "opendbx", null_odbx_errmsg[1] );
+	}
+
+	return dgettext( "opendbx", null_odbx_errmsg[aux->err] );
+}
+
+
+
+static int null_odbx_error_type( odbx_t* handle )
+{
+	struct nconn* aux = (struct nconn*) handle->aux;
+
+	if( aux == NULL ) { return -1; }
+
+	switch( aux->err )
+	{
+		case 0:
+			return 0;
+		case 2:
+			if( handle->generic != NULL ) { return 1; }
+	}
+
+	return -1;
+}
+
+
+
+static int null_odbx_escape( odbx_t* handle, const char* from, unsigned long fromlen, char* to, unsigned long* tolen )
+{
+	unsigned long i, len = 0;
+
+	for( i = 0; i < fromlen; i++ )
+	{
+		if( len + 2 >= *tolen ) { return -ODBX_ERR_SIZE; }
+
+		switch( from[i] )
+		{
+			case '\\': to[len++] = '\\'; break;
+			case '\'': to[len++] = '\''; break;
+		}
+
+		to[len++] = from[i];
+	}
+
+	to[len] = '\0';
+	*tolen = len;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Parameters within the statement overwrite the ones given to odbx_bind()
+ *  for all result sets of this statement.
+ */
+
+static int null_odbx_query( odbx_t* handle, const char* query, unsigned long length )
+{
+	struct nconn* aux = (struct nconn*) handle->aux;
+
+	if( query == NULL || aux == NULL )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( handle->generic == NULL )
+	{
+		aux->err = 3;
+		return -ODBX_ERR_BACKEND;
+	}
+
+	aux->stmt = aux->bind;
+
+	if( null_odbx_param( &(aux->stmt), query, length ) < 0 )
+	{
+		aux->err = 2;
+		return -ODBX_ERR_BACKEND;
+	}
+
+	aux->norows = null_odbx_norows( query, length );
+	aux->results = aux->stmt.results;
+	aux->timeouts = aux->stmt.timeouts;
+	aux->err = 0;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Timeouts are only emulated if the caller doesn't want to wait forever.
+ *  The whole result set is available at once, so chunk is ignored.
+ */
+
+static int null_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk )
+{
+	char* ptr;
+	size_t len;
+	unsigned long i, cols;
+	struct nres* nres;
+	struct nconn* aux = (struct nconn*) handle->aux;
+
+
+	if( aux == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( aux->results == 0 ) { return ODBX_RES_DONE; }
+
+	if( aux->timeouts > 0 && timeout != NULL )
+	{
+		aux->timeouts--;
+		return ODBX_RES_TIMEOUT;
+	}
+
+	aux->timeouts = aux->stmt.timeouts;
+	aux->results--;
+
+	cols = aux->norows ? 0 : aux->stmt.cols;
+	len = sizeof( struct odbx_result_t ) + sizeof( struct nres ) + cols * ( NULL_NAMELEN + 1 ) + NULL_NUMLEN + aux->stmt.size + 1;
+
+	if( ( *result = (odbx_result_t*) malloc( len ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	nres = (struct nres*) ( *result + 1 );
+	nres->param = aux->stmt;
+	nres->param.cols = cols;
+	nres->row = 0;
+	nres->numlen = 0;
+	nres->seed = 0x9e3779b9 * ( (uint32_t) aux->results + 1 );
+
+	ptr = (char*) ( nres + 1 );
+	nres->names = ptr;
+	ptr += cols * NULL_NAMELEN;
+	nres->null = (unsigned char*) ptr;
+	ptr += cols;
+	nres->number = ptr;
+	ptr += NULL_NUMLEN;
+	nres->value = ptr;
+
+	for( i = 0; i < cols; i++ )
+	{
+		snprintf( nres->names + i * NULL_NAMELEN, NULL_NAMELEN, "c%lu", i );
+	}
+
+	memset( nres->null, 0, cols );
+	nres->number[0] = '\0';
+
+	for( i = 0; i < nres->param.size; i++ )
+	{
+		nres->value[i] = (char) ( 'a' + i % 26 );
+	}
+	nres->value[i] = '\0';
+
+	(*result)->handle = handle;
+	(*result)->generic = (void*) nres;
+	(*result)->aux = NULL;
+
+	if( cols == 0 ) { return ODBX_RES_NOROWS; }
+
+	return ODBX_RES_ROWS;
+}
+
+
+
+static int null_odbx_result_finish( odbx_result_t* result )
+{
+	free( result );
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int null_odbx_row_fetch( odbx_result_t* result )
+{
+	unsigned long i;
+	struct nres* nres = (struct nres*) result->generic;
+
+
+	if( nres->param.cols == 0 || nres->row >= nres->param.rows )
+	{
+		return ODBX_ROW_DONE;
+	}
+
+	nres->row++;
+
+	if( nres->param.type == NULL_TYPE_INT || nres->param.type == NULL_TYPE_MIXED )
+	{
+		nres->numlen = (unsigned long) snprintf( nres->number, NULL_NUMLEN, "%lu", nres->row );
+	}
+
+	if( nres->param.nulls > 0 )
+	{
+		for( i = 0; i < nres->param.cols; i++ )
+		{
+			nres->seed ^= nres->seed << 13;
+			nres->seed ^= nres->seed >> 17;
+			nres->seed ^= nres->seed << 5;
+			nres->null[i] = nres->seed % 100 < nres->param.nulls;
+		}
+	}
+
+	return ODBX_ROW_NEXT;
+}
+
+
+
+/*
+ *  Statements not returning rows affect the number of rows set by the
+ *  "rows" parameter.
+ */
+
+static uint64_t null_odbx_rows_affected( odbx_result_t* result )
+{
+	struct nres* nres = (struct nres*) result->generic;
+
+	if( nres->param.cols == 0 ) { return (uint64_t) nres->param.rows; }
+
+	return 0;
+}
+
+
+
+static unsigned long null_odbx_column_count( odbx_result_t* result )
+{
+	return ((struct nres*) result->generic)->param.cols;
+}
+
+
+
+static const char* null_odbx_column_name( odbx_result_t* result, unsigned long pos )
+{
+	struct nres* nres = (struct nres*) result->generic;
+
+	if( pos < nres->param.cols )
+	{
+		return nres->names + pos * NULL_NAMELEN;
+	}
+
+	return NULL;
+}
+
+
+
+static int null_odbx_column_type( odbx_result_t* result, unsigned long pos )
+{
+	struct nres* nres = (struct nres*) result->generic;
+
+	if( pos >= nres->param.cols ) { return -ODBX_ERR_PARAM; }
+
+	switch( nres->param.type )
+	{
+		case NULL_TYPE_INT:
+			return ODBX_TYPE_BIGINT;
+		case NULL_TYPE_MIXED:
+			if( pos % 2 == 0 ) { return ODBX_TYPE_BIGINT; }
+			break;
+		case NULL_TYPE_LOB:
+			return ODBX_TYPE_BLOB;
+	}
+
+	return ODBX_TYPE_VARCHAR;
+}
+
+
+
+static unsigned long null_odbx_field_length( odbx_result_t* result, unsigned long pos )
+{
+	struct nres* nres = (struct nres*) result->generic;
+
+	if( pos >= nres->param.cols || nres->null[pos] ) { return 0; }
+
+	if( null_odbx_column_type( result, pos ) == ODBX_TYPE_BIGINT )
+	{
+		return nres->numlen;
+	}
+
+	return nres->param.size;
+}
+
+
+
+static const char* null_odbx_field_value( odbx_result_t* result, unsigned long pos )
+{
+	struct nres* nres = (struct nres*) result->generic;
+
+	if( pos >= nres->param.cols || nres->null[pos] ) { return NULL; }
+
+	if( null_odbx_column_type( result, pos ) == ODBX_TYPE_BIGINT )
+	{
+		return nres->number;
+	}
+
+	return nres->value;
+}
+
+
+
+
+
+/*
+ *  Internal functions
+ */
+
+
+/*
+ *  Parses all "key=value" pairs in str and overwrites the corresponding
+ *  values in param. Unknown keys are ignored so parameters can be mixed
+ *  with arbitrary SQL text.
+ */
+
+static int null_odbx_param( struct nparam* param, const char* str, unsigned long length )
+{
+	static const char* types[] = { "text", "int", "mixed", "lob" };
+
+	unsigned long i = 0, k, klen, v, vlen, value, num = 0;
+	unsigned long* dest;
+
+
+	while( i < length )
+	{
+		while( i < length && !isalpha( (unsigned char) str[i] ) && str[i] != '_' ) { i++; }
+
+		k = i;
+		while( i < length && ( isalnum( (unsigned char) str[i] ) || str[i] == '_' ) ) { i++; }
+		klen = i - k;
+
+		if( i >= length || str[i] != '=' ) { continue; }
+
+		v = ++i;
+		while( i < length && isalnum( (unsigned char) str[i] ) ) { i++; }
+		vlen = i - v;
+
+		if( klen == 4 && strncmp( str + k, "type", 4 ) == 0 )
+		{
+			for( value = 0; value < sizeof( types ) / sizeof( types[0] ); value++ )
+			{
+				if( strlen( types[value] ) == vlen && strncmp( str + v, types[value], vlen ) == 0 ) { break; }
+			}
+
+			if( value == sizeof( types ) / sizeof( types[0] ) ) { return -ODBX_ERR_PARAM; }
+
+			param->type = value;
+			num++;
+			continue;
+		}
+
+		if( klen == 4 && strncmp( str + k, "rows", 4 ) == 0 ) { dest = &(param->rows); }
+		else if( klen == 4 && strncmp( str + k, "cols", 4 ) == 0 ) { dest = &(param->cols); }
+		else if( klen == 4 && strncmp( str + k, "size", 4 ) == 0 ) { dest = &(param->size); }
+		else if( klen == 5 && strncmp( str + k, "nulls", 5 ) == 0 ) { dest = &(param->nulls); }
+		else if( klen == 7 && strncmp( str + k, "results", 7 ) == 0 ) { dest = &(param->results); }
+		else if( klen == 7 && strncmp( str + k, "timeout", 7 ) == 0 ) { dest = &(param->timeouts); }
+		else if( klen == 3 && strncmp( str + k, "lob", 3 ) == 0 ) { dest = &(param->lob); }
+		else { continue; }
+
+		if( vlen == 0 ) { return -ODBX_ERR_PARAM; }
+
+		for( value = 0; v < i; v++ )
+		{
+			if( !isdigit( (unsigned char) str[v] ) ) { return -ODBX_ERR_PARAM; }
+			value = value * 10 + (unsigned long) ( str[v] - '0' );
+		}
+
+		if( dest == &(param->nulls) && value > 100 ) { return -ODBX_ERR_PARAM; }
+
+		*dest = value;
+		num++;
+	}
+
+	return (int) num;
+}
+
+
+
+/*
+ *  Statements return rows if they start with a keyword reading data or with
+ *  a parameter. All other statements like INSERT or CREATE don't.
+ */
+
+static int null_odbx_norows( const char* query, unsigned long length )
+{
+	static const char* keywords[] = { "select", "with", "show", "values", "explain", "describe" };
+
+	unsigned long i = 0, k, len, n;
+
+
+	while( i < length && isspace( (unsigned char) query[i] ) ) { i++; }
+
+	k = i;
+	while( i < length && ( isalnum( (unsigned char) query[i] ) || query[i] == '_' ) ) { i++; }
+	len = i - k;
+
+	if( len == 0 || ( i < length && query[i] == '=' ) ) { return 0; }
+
+	for( n = 0; n < sizeof( keywords ) / sizeof( keywords[0] ); n++ )
+	{
+		if( strlen( keywords[n] ) == len && strncasecmp( query + k, keywords[n], len ) == 0 ) { return 0; }
+	}
+
+	return 1;
+}
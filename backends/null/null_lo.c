@@ -0,0 +1,94 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "null_lo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*
+ *  Declaration of null backend capabilities
+ */
+
+struct odbx_lo_ops null_odbx_lo_ops = {
+	.open = null_odbx_lo_open,
+	.close = null_odbx_lo_close,
+	.read = null_odbx_lo_read,
+	.write = null_odbx_lo_write,
+};
+
+
+
+/*
+ *  ODBX large object operations
+ *  Null backend style
+ *
+ *  Each large object contains "lob" bytes and data written to it is
+ *  discarded but extends its size.
+ */
+
+static int null_odbx_lo_open( odbx_result_t* result, odbx_lo_t** lo, const char* value )
+{
+	struct nlo* nlo;
+
+
+	if( ( *lo = (odbx_lo_t*) malloc( sizeof( struct odbx_lo_t ) + sizeof( struct nlo ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	nlo = (struct nlo*) ( *lo + 1 );
+	nlo->pos = 0;
+	nlo->size = ((struct nres*) result->generic)->param.lob;
+
+	(*lo)->result = result;
+	(*lo)->generic = (void*) nlo;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int null_odbx_lo_close( odbx_lo_t* lo )
+{
+	free( lo );
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static ssize_t null_odbx_lo_read( odbx_lo_t* lo, void* buffer, size_t buflen )
+{
+	struct nlo* nlo = (struct nlo*) lo->generic;
+	size_t len = nlo->size - nlo->pos;
+
+
+	if( len > buflen ) { len = buflen; }
+
+	memset( buffer, 'l', len );
+	nlo->pos += len;
+
+	return (ssize_t) len;
+}
+
+
+
+static ssize_t null_odbx_lo_write( odbx_lo_t* lo, void* buffer, size_t buflen )
+{
+	struct nlo* nlo = (struct nlo*) lo->generic;
+
+
+	nlo->pos += buflen;
+	if( nlo->pos > nlo->size ) { nlo->size = nlo->pos; }
+
+	return (ssize_t) buflen;
+}
@@ -0,0 +1,34 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "nullbackend.h"
+
+
+
+#ifndef NULL_LO_H
+#define NULL_LO_H
+
+
+
+/*
+ *  Large object operations
+ */
+
+static int null_odbx_lo_open( odbx_result_t* result, odbx_lo_t** lo, const char* value );
+
+static int null_odbx_lo_close( odbx_lo_t* lo );
+
+static ssize_t null_odbx_lo_read( odbx_lo_t* lo, void* buffer, size_t buflen );
+
+static ssize_t null_odbx_lo_write( odbx_lo_t* lo, void* buffer, size_t buflen );
+
+
+
+#endif
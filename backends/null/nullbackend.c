@@ -0,0 +1,39 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "nullbackend.h"
+
+
+
+/*
+ *  Declaration of null backend capabilities
+ */
+
+extern struct odbx_basic_ops null_odbx_basic_ops;
+extern struct odbx_lo_ops null_odbx_lo_ops;
+
+
+
+struct odbx_ops null_odbx_ops = {
+	.basic = &null_odbx_basic_ops,
+	.lo = &null_odbx_lo_ops,
+	.stmt = NULL,
+};
+
+
+
+#ifndef ODBX_SINGLELIB
+
+void odbxdrv_register( struct odbx_ops** ops )
+{
+	*ops = &null_odbx_ops;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+
+
+
+#ifndef NULLBACKEND_H
+#define NULLBACKEND_H
+
+
+
+/*
+ *  Parameters of the synthetic result sets
+ *
+ *  They are set by the database name given to odbx_bind() as list of
+ *  "key=value" pairs, e.g. "rows=1000 cols=8 size=32 nulls=10", and can
+ *  be overwritten for a single statement by pairs within the statement.
+ */
+
+struct nparam
+{
+	unsigned long rows;   // rows per result set
+	unsigned long cols;   // columns per row
+	unsigned long size;   // length of text values in bytes
+	unsigned long nulls;   // percentage of NULL values
+	unsigned long results;   // result sets per statement
+	unsigned long timeouts;   // ODBX_RES_TIMEOUT returned before each result set
+	unsigned long lob;   // size of large objects in bytes
+	unsigned long type;   // NULL_TYPE_*
+};
+
+#define NULL_TYPE_TEXT   0
+#define NULL_TYPE_INT   1
+#define NULL_TYPE_MIXED   2
+#define NULL_TYPE_LOB   3
+
+
+
+/*
+ *  Auxillary data structures attached to odbx_t, odbx_result_t and odbx_lo_t
+ */
+
+struct nconn
+{
+	struct nparam bind;   // parameters given to odbx_bind()
+	struct nparam stmt;   // parameters of the current statement
+	unsigned long results;   // result sets left
+	unsigned long timeouts;   // timeouts left before the next result set
+	int norows;   // statement doesn't return rows
+	int err;
+};
+
+struct nres
+{
+	struct nparam param;
+	unsigned long row;   // number of rows fetched
+	unsigned long numlen;   // length of the integer value of the current row
+	uint32_t seed;   // xorshift state for NULL values
+	char* value;   // text value of all fields
+	char* number;   // integer value of the current row
+	char* names;   // column names
+	unsigned char* null;   // NULL flags of the fields in the current row
+};
+
+struct nlo
+{
+	unsigned long pos;
+	unsigned long size;
+};
+
+#define NULL_NAMELEN   24
+#define NULL_NUMLEN   24
+
+
+
+#endif
@@ -40,6 +40,7 @@ struct odbx_basic_ops odbc_odbx_basic_ops = {
 	.column_type = odbc_odbx_column_type,
 	.field_length = odbc_odbx_field_length,
 	.field_value = odbc_odbx_field_value,
+	.cancel = odbc_odbx_cancel,
 };
 
 
@@ -62,6 +63,7 @@ static int odbc_odbx_init( odbx_t* handle, const char* host, const char* port )
 	gen->env = NULL;
 	gen->conn = NULL;
 	gen->stmt = NULL;
+	gen->lock = 0;
 
 	gen->err = SQLAllocHandle( SQL_HANDLE_ENV, SQL_NULL_HANDLE, &(gen->env) );
 	if( SQL_SUCCEEDED( gen->err ) )
@@ -368,14 +370,12 @@ static int odbc_odbx_query( odbx_t* handle, const char* query, unsigned long len
 
 	if( gen->stmt != NULL )
 	{
-		gen->err = SQLFreeHandle( SQL_HANDLE_STMT, gen->stmt );
+		gen->err = odbc_priv_freestmt( gen );
 		if( !SQL_SUCCEEDED( gen->err ) )
 		{
-			gen->stmt = NULL;
 			return -ODBX_ERR_BACKEND;
 		}
 	}
-	gen->stmt = NULL;
 
 	if( strncasecmp( "BEGIN TRAN", query, 10 ) == 0 )
 	{
@@ -403,13 +403,18 @@ static int odbc_odbx_query( odbx_t* handle, const char* query, unsigned long len
 	}
 	else
 	{
-		gen->err = SQLAllocHandle( SQL_HANDLE_STMT, gen->conn, &(gen->stmt) );
+		SQLHSTMT stmt;
+
+		gen->err = SQLAllocHandle( SQL_HANDLE_STMT, gen->conn, &stmt );
 		if( !SQL_SUCCEEDED( gen->err ) )
 		{
-			gen->stmt = NULL;
 			return -ODBX_ERR_BACKEND;
 		}
 
+		while( __atomic_test_and_set( &gen->lock, __ATOMIC_ACQUIRE ) );
+		gen->stmt = stmt;
+		__atomic_clear( &gen->lock, __ATOMIC_RELEASE );
+
 		gen->err = SQLExecDirect( gen->stmt, (SQLCHAR*) query, (SQLINTEGER) length );
 		if( !SQL_SUCCEEDED( gen->err ) && gen->err != SQL_NO_DATA )
 		{
@@ -440,14 +445,12 @@ static int odbc_odbx_result( odbx_t* handle, odbx_result_t** result, struct time
 				break;
 			case SQL_NO_DATA:
 
-				gen->err = SQLFreeHandle( SQL_HANDLE_STMT, gen->stmt );
+				gen->err = odbc_priv_freestmt( gen );
 				if( !SQL_SUCCEEDED( gen->err ) )
 				{
-					gen->stmt = NULL;
 					return -ODBX_ERR_BACKEND;
 				}
 
-				gen->stmt = NULL;
 				return ODBX_RES_DONE;
 
 			case SQL_STILL_EXECUTING:   // TODO: How to handle this?
@@ -549,6 +552,36 @@ static int odbc_odbx_result( odbx_t* handle, odbx_result_t** result, struct time
 
 
 
+/*
+ *  SQLCancel() is meant to be called by another thread while the statement
+ *  is executed. The result of the call isn't stored in gen->err, because
+ *  it belongs to the thread using the connection.
+ */
+
+static int odbc_odbx_cancel( odbx_t* handle )
+{
+	SQLRETURN err = SQL_SUCCESS;
+	struct odbcgen* gen = (struct odbcgen*) handle->generic;
+
+
+	if( gen == NULL ) { return -ODBX_ERR_PARAM; }
+
+	while( __atomic_test_and_set( &gen->lock, __ATOMIC_ACQUIRE ) );
+
+	if( gen->stmt != NULL ) { err = SQLCancel( gen->stmt ); }
+
+	__atomic_clear( &gen->lock, __ATOMIC_RELEASE );
+
+	if( !SQL_SUCCEEDED( err ) )
+	{
+		return -ODBX_ERR_BACKEND;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int odbc_odbx_result_finish( odbx_result_t* result )
 {
 	struct odbcraux* raux = (struct odbcraux*) result->aux;
@@ -826,3 +859,18 @@ static int odbc_priv_setautocommit( struct odbcgen* gen, SQLUINTEGER mode )
 	return ODBX_ERR_SUCCESS;
 }
 
+
+
+static SQLRETURN odbc_priv_freestmt( struct odbcgen* gen )
+{
+	SQLRETURN err;
+
+	while( __atomic_test_and_set( &gen->lock, __ATOMIC_ACQUIRE ) );
+
+	err = SQLFreeHandle( SQL_HANDLE_STMT, gen->stmt );
+	gen->stmt = NULL;
+
+	__atomic_clear( &gen->lock, __ATOMIC_RELEASE );
+
+	return err;
+}
@@ -41,6 +41,8 @@ static int odbc_odbx_query( odbx_t* handle, const char* query, unsigned long len
 
 static int odbc_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk );
 
+static int odbc_odbx_cancel( odbx_t* handle );
+
 static int odbc_odbx_result_finish( odbx_result_t* result );
 
 static int odbc_odbx_row_fetch( odbx_result_t* result );
@@ -69,5 +71,7 @@ static void odbc_priv_cleanup( odbx_result_t* result, SQLSMALLINT cols );
 
 static int odbc_priv_setautocommit( struct odbcgen* gen, SQLUINTEGER mode );
 
+static SQLRETURN odbc_priv_freestmt( struct odbcgen* gen );
+
 
 #endif
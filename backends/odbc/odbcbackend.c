@@ -24,6 +24,7 @@ extern struct odbx_lo_ops odbc_odbx_lo_ops;
 struct odbx_ops odbc_odbx_ops = {
 	.basic = &odbc_odbx_basic_ops,
  	.lo = NULL,
+ 	.stmt = NULL,
 };
 
 
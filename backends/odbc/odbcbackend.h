@@ -53,6 +53,7 @@ struct odbcgen
 	char* server;
 	char* errmsg[SQL_MAX_MESSAGE_LENGTH];
 	int resnum;
+	char lock;   // stmt isn't allocated or freed while another thread cancels it
 };
 
 
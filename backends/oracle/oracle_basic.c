@@ -48,6 +48,7 @@ struct odbx_basic_ops oracle_odbx_basic_ops = {
 	.column_type = oracle_odbx_column_type,
 	.field_length = oracle_odbx_field_length,
 	.field_value = oracle_odbx_field_value,
+	.cancel = oracle_odbx_cancel,
 };
 
 
@@ -78,6 +79,7 @@ static int oracle_odbx_init( odbx_t* handle, const char* host, const char* port
 
 	handle->generic = NULL;
 	conn->err = NULL;
+	conn->brk = NULL;
 	conn->srv = NULL;
 	conn->ctx = NULL;
 	conn->sess = NULL;
@@ -105,6 +107,14 @@ static int oracle_odbx_init( odbx_t* handle, const char* host, const char* port
 
 	conn->err = hdl;
 
+	if( ( conn->errcode = OCIHandleAlloc( env, &hdl, OCI_HTYPE_ERROR, 0, NULL ) ) != OCI_SUCCESS )
+	{
+		oracle_priv_handle_cleanup( handle );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	conn->brk = hdl;
+
 	if( ( conn->errcode = OCIHandleAlloc( env, &hdl, OCI_HTYPE_SERVER, 0, NULL ) ) != OCI_SUCCESS )
 	{
 		oracle_priv_handle_cleanup( handle );
@@ -582,6 +592,31 @@ static int oracle_odbx_result( odbx_t* handle, odbx_result_t** result, struct ti
 
 
 
+/*
+ *  The environment is created in threaded mode, so OCIBreak() can be called
+ *  while another thread waits for the server. It uses its own error handle
+ *  and the interrupted call fails with ORA-01013.
+ */
+
+static int oracle_odbx_cancel( odbx_t* handle )
+{
+	struct oraconn* conn = (struct oraconn*) handle->aux;
+
+	if( conn == NULL || conn->ctx == NULL || conn->brk == NULL )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( OCIBreak( conn->ctx, conn->brk ) != OCI_SUCCESS )
+	{
+		return -ODBX_ERR_BACKEND;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int oracle_odbx_result_finish( odbx_result_t* result )
 {
 	struct orargen* rgen = (struct orargen*) result->generic;
@@ -838,6 +873,12 @@ static int oracle_priv_handle_cleanup( odbx_t* handle )
 		aux->err = NULL;
 	}
 
+	if( aux->brk != NULL )
+	{
+		if( OCIHandleFree( aux->brk, OCI_HTYPE_ERROR ) != OCI_SUCCESS ) { err = -ODBX_ERR_PARAM; }
+		aux->brk = NULL;
+	}
+
 	if( aux->host != NULL )
 	{
 		free( aux->host );
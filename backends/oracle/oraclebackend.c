@@ -27,6 +27,7 @@ struct odbx_ops oracle_odbx_ops = {
 #else
 	.lo = NULL,
 #endif
+	.stmt = NULL,
 };
 
 
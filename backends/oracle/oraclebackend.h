@@ -42,6 +42,7 @@
 struct oraconn
 {
 	OCIError* err;
+	OCIError* brk;   // used by other threads canceling the statement
 	OCIServer* srv;
 	OCISvcCtx* ctx;
 	OCISession* sess;
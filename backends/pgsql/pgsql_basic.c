@@ -14,8 +14,13 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
+#include <time.h>
 #include <errno.h>
 
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
 #if defined( HAVE_SYS_SELECT_H )
 #include <sys/select.h>
 #elif defined( HAVE_WINSOCK2_H )
@@ -48,6 +53,7 @@ struct odbx_basic_ops pgsql_odbx_basic_ops = {
 	.column_type = pgsql_odbx_column_type,
 	.field_length = pgsql_odbx_field_length,
 	.field_value = pgsql_odbx_field_value,
+	.cancel = pgsql_odbx_cancel,
 };
 
 
@@ -76,6 +82,10 @@ static int pgsql_odbx_init( odbx_t* handle, const char* host, const char* port )
 	conn->infolen = len;
 	conn->timeout = 0;
 	conn->ssl = 0;
+	conn->stmts = 0;
+	conn->dealloc = NULL;
+	conn->dealloclen = 0;
+	conn->cancel = NULL;
 
 	return ODBX_ERR_SUCCESS;
 }
@@ -125,6 +135,13 @@ static int pgsql_odbx_bind( odbx_t* handle, const char* database, const char* wh
 		return -ODBX_ERR_BACKEND;
 	}
 
+	if( ( conn->cancel = PQgetCancel( (PGconn*) handle->generic ) ) == NULL )
+	{
+		PQfinish( (PGconn*) handle->generic );
+		handle->generic = NULL;
+		return -ODBX_ERR_NOMEM;
+	}
+
 	return ODBX_ERR_SUCCESS;
 }
 
@@ -132,9 +149,24 @@ static int pgsql_odbx_bind( odbx_t* handle, const char* database, const char* wh
 
 static int pgsql_odbx_unbind( odbx_t* handle )
 {
+	struct pgconn* conn = (struct pgconn*) handle->aux;
+
 	PQfinish( handle->generic );
 	handle->generic = NULL;
 
+	if( conn != NULL )   // prepared statements are gone too
+	{
+		free( conn->dealloc );
+		conn->dealloc = NULL;
+		conn->dealloclen = 0;
+
+		if( conn->cancel != NULL )
+		{
+			PQfreeCancel( conn->cancel );
+			conn->cancel = NULL;
+		}
+	}
+
 	return ODBX_ERR_SUCCESS;
 }
 
@@ -154,6 +186,12 @@ static int pgsql_odbx_finish( odbx_t* handle )
 		handle->generic = NULL;
 	}
 
+	if( ((struct pgconn*) handle->aux)->cancel != NULL )
+	{
+		PQfreeCancel( ((struct pgconn*) handle->aux)->cancel );
+	}
+
+	free( ((struct pgconn*) handle->aux)->dealloc );
 	free(  handle->aux );
 	handle->aux = NULL;
 
@@ -185,6 +223,14 @@ static int pgsql_odbx_get_option( odbx_t* handle, unsigned int option, void* val
 		case ODBX_OPT_COMPRESS:
 			*(int*) value = ODBX_DISABLE;
 			break;
+#ifdef HAVE_SELECT
+		case ODBX_OPT_SOCKET:
+			if( handle->generic == NULL || ( *(int*) value = PQsocket( (PGconn*) handle->generic ) ) == -1 )
+			{
+				return -ODBX_ERR_PARAM;
+			}
+			break;
+#endif
 		default:
 			return -ODBX_ERR_OPTION;
 	}
@@ -205,6 +251,7 @@ static int pgsql_odbx_set_option( odbx_t* handle, unsigned int option, void* val
 	{
 		case ODBX_OPT_API_VERSION:
 		case ODBX_OPT_THREAD_SAFE:
+		case ODBX_OPT_SOCKET:
 
 			return -ODBX_ERR_OPTRO;
 
@@ -291,6 +338,8 @@ static int pgsql_odbx_query( odbx_t* handle, const char* query, unsigned long le
 {
 	struct pgconn* aux = (struct pgconn*) handle->aux;
 
+	if( aux->dealloc != NULL ) { pgsql_odbx_stmt_cleanup( handle ); }
+
 	if( PQsendQuery( (PGconn*) handle->generic, query ) == 0 )
 	{
 		aux->errtype = 1;
@@ -308,6 +357,27 @@ static int pgsql_odbx_query( odbx_t* handle, const char* query, unsigned long le
 
 
 
+/*
+ *  Monotonic time in microseconds for calculating the remaining timeout
+ */
+
+static uint64_t pgsql_odbx_time( void )
+{
+#if defined( HAVE_CLOCK_GETTIME ) && defined( CLOCK_MONOTONIC )
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+#else
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+	return (uint64_t) tv.tv_sec * 1000000 + (uint64_t) tv.tv_usec;
+#endif
+}
+
+
+
 static int pgsql_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk )
 {
 	struct pgconn* conn = (struct pgconn* ) handle->aux;
@@ -318,28 +388,48 @@ static int pgsql_odbx_result( odbx_t* handle, odbx_result_t** result, struct tim
 	}
 
 #ifdef HAVE_SELECT
-	if( timeout != NULL && PQisBusy( (PGconn*) handle->generic ) == 1 )
+	/*
+	 *  Available data is read without blocking until the complete result is
+	 *  buffered, so PQgetResult() doesn't wait for the rest of it. A zero
+	 *  timeout only checks for a result. Not all systems reduce tv by the
+	 *  time spent in select(), so the remaining time until the deadline is
+	 *  calculated before waiting for each packet.
+	 */
+	if( timeout != NULL )
 	{
 		int fd, err;
 		fd_set fds;
+		struct timeval tv;
+		uint64_t now, end;
+		PGconn* pgconn = (PGconn*) handle->generic;
 
-		if( ( fd = PQsocket( (PGconn*) handle->generic ) ) == -1 )
+		if( ( fd = PQsocket( pgconn ) ) == -1 )
 		{
 			conn->errtype = -1;
 			return -ODBX_ERR_BACKEND;
 		}
 
-		FD_ZERO( &fds );
-		FD_SET( fd, &fds );
-
-		while( ( err = select( fd + 1, &fds, NULL, NULL, timeout ) ) < 0 && errno == EINTR );
+		end = pgsql_odbx_time() + (uint64_t) timeout->tv_sec * 1000000 + (uint64_t) timeout->tv_usec;
 
-		switch( err )
+		while( PQconsumeInput( pgconn ) == 1 && PQisBusy( pgconn ) == 1 )
 		{
-			case -1:
-				return -ODBX_ERR_RESULT;
-			case 0:
-				return ODBX_RES_TIMEOUT;   /* timeout while waiting for a result */
+			now = pgsql_odbx_time();
+
+			tv.tv_sec = now < end ? (long) ( ( end - now ) / 1000000 ) : 0;
+			tv.tv_usec = now < end ? (long) ( ( end - now ) % 1000000 ) : 0;
+
+			FD_ZERO( &fds );
+			FD_SET( fd, &fds );
+
+			if( ( err = select( fd + 1, &fds, NULL, NULL, &tv ) ) < 0 && errno == EINTR ) { continue; }
+
+			switch( err )
+			{
+				case -1:
+					return -ODBX_ERR_RESULT;
+				case 0:
+					return ODBX_RES_TIMEOUT;   /* timeout while waiting for a result */
+			}
 		}
 	}
 #endif
@@ -404,6 +494,32 @@ static int pgsql_odbx_result( odbx_t* handle, odbx_result_t** result, struct tim
 
 
 
+/*
+ *  PQcancel() only uses the copy of the connection parameters made by
+ *  PQgetCancel(), so another thread can send the request while the
+ *  connection is waiting for the result
+ */
+
+static int pgsql_odbx_cancel( odbx_t* handle )
+{
+	char errbuf[256];
+	struct pgconn* conn = (struct pgconn*) handle->aux;
+
+	if( conn == NULL || conn->cancel == NULL )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( PQcancel( conn->cancel, errbuf, sizeof( errbuf ) ) == 0 )
+	{
+		return -ODBX_ERR_BACKEND;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int pgsql_odbx_result_finish( odbx_result_t* result )
 {
 	if( result->generic != NULL )
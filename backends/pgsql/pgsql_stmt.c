@@ -0,0 +1,284 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "pgsql_stmt.h"
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*
+ *  Declaration of PostgreSQL capabilities
+ */
+
+struct odbx_stmt_ops pgsql_odbx_stmt_ops = {
+	.prepare = pgsql_odbx_stmt_prepare,
+	.bind = pgsql_odbx_stmt_bind,
+	.execute = pgsql_odbx_stmt_execute,
+	.finish = pgsql_odbx_stmt_finish,
+};
+
+
+
+/*
+ *  Statements can't be deallocated while the results of another statement
+ *  are pending, so this is done before the next statement is sent
+ */
+
+void pgsql_odbx_stmt_cleanup( odbx_t* handle )
+{
+	struct pgconn* conn = (struct pgconn*) handle->aux;
+
+	if( handle->generic != NULL && conn->dealloc != NULL )
+	{
+		PQclear( PQexec( (PGconn*) handle->generic, conn->dealloc ) );
+	}
+
+	free( conn->dealloc );
+	conn->dealloc = NULL;
+	conn->dealloclen = 0;
+}
+
+
+
+static void pgsql_odbx_stmt_error( odbx_t* handle )
+{
+	struct pgconn* conn = (struct pgconn*) handle->aux;
+
+	conn->errtype = 1;
+
+	if( PQstatus( (PGconn*) handle->generic ) != CONNECTION_OK )
+	{
+		conn->errtype = -1;
+	}
+}
+
+
+
+/*
+ *  ODBX prepared statement operations
+ *  PostgreSQL style
+ *
+ *  Question marks outside of quoted strings and identifiers are replaced
+ *  by $1, $2, etc. The statement is prepared synchronously and the values
+ *  are sent in text format except for binary data.
+ */
+
+static int pgsql_odbx_stmt_prepare( odbx_stmt_t* stmt, const char* query, unsigned long length )
+{
+	char* sql;
+	char quote = 0;
+	unsigned long i, len = 0, count = 0;
+	struct pgstmt* aux;
+	struct pgconn* conn = (struct pgconn*) stmt->handle->aux;
+	PGresult* res;
+
+
+	if( conn == NULL || stmt->handle->generic == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( conn->dealloc != NULL ) { pgsql_odbx_stmt_cleanup( stmt->handle ); }
+
+	for( i = 0; i < length; i++ ) {
+		if( query[i] == '?' ) { count++; }
+	}
+
+	if( ( sql = (char*) malloc( length + count * 10 + 1 ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	count = 0;
+
+	for( i = 0; i < length; i++ )
+	{
+		switch( query[i] )
+		{
+			case '\'':
+			case '"':
+				if( quote == 0 ) { quote = query[i]; }
+				else if( quote == query[i] ) { quote = 0; }
+				break;
+			case '?':
+				if( quote == 0 )
+				{
+					len += sprintf( sql + len, "$%lu", ++count );
+					continue;
+				}
+		}
+
+		sql[len++] = query[i];
+	}
+
+	sql[len] = '\0';
+
+	if( ( aux = (struct pgstmt*) calloc( 1, sizeof( struct pgstmt ) ) ) == NULL ||
+		( count > 0 && ( ( aux->values = (char**) calloc( count, sizeof( char* ) ) ) == NULL ||
+		( aux->lengths = (int*) calloc( count, sizeof( int ) ) ) == NULL ||
+		( aux->formats = (int*) calloc( count, sizeof( int ) ) ) == NULL ) ) )
+	{
+		if( aux != NULL )
+		{
+			free( aux->values );
+			free( aux->lengths );
+			free( aux );
+		}
+
+		free( sql );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	snprintf( aux->name, sizeof( aux->name ), "odbx_stmt_%lu", ++conn->stmts );
+
+	res = PQprepare( (PGconn*) stmt->handle->generic, aux->name, sql, 0, NULL );
+	free( sql );
+
+	if( res == NULL || PQresultStatus( res ) != PGRES_COMMAND_OK )
+	{
+		PQclear( res );
+		pgsql_odbx_stmt_error( stmt->handle );
+
+		free( aux->values );
+		free( aux->lengths );
+		free( aux->formats );
+		free( aux );
+
+		return -ODBX_ERR_BACKEND;
+	}
+
+	PQclear( res );
+
+	stmt->aux = (void*) aux;
+	stmt->count = count;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int pgsql_odbx_stmt_bind( odbx_stmt_t* stmt, unsigned long pos, int type, const void* value, unsigned long length )
+{
+	char buffer[32];
+	const char* dp;
+	unsigned long i;
+	int64_t num;
+	double real;
+	struct pgstmt* aux = (struct pgstmt*) stmt->aux;
+
+	if( aux == NULL ) { return -ODBX_ERR_PARAM; }
+
+	free( aux->values[pos] );
+	aux->values[pos] = NULL;
+	aux->lengths[pos] = 0;
+	aux->formats[pos] = 0;
+
+	switch( type )
+	{
+		case ODBX_PARAM_NULL:
+			return ODBX_ERR_SUCCESS;
+		case ODBX_PARAM_INT64:
+			memcpy( &num, value, sizeof( int64_t ) );
+			length = snprintf( buffer, sizeof( buffer ), "%lld", (long long) num );
+			value = buffer;
+			break;
+		case ODBX_PARAM_DOUBLE:
+			memcpy( &real, value, sizeof( double ) );
+			length = snprintf( buffer, sizeof( buffer ), "%.17g", real );
+			if( ( dp = localeconv()->decimal_point ) != NULL && dp[0] != '.' && dp[0] != '\0' && dp[1] == '\0' )
+			{
+				for( i = 0; i < length; i++ )   // snprintf() uses the decimal point of the current locale
+				{
+					if( buffer[i] == dp[0] ) { buffer[i] = '.'; }
+				}
+			}
+			value = buffer;
+			break;
+		case ODBX_PARAM_TEXT:
+			break;
+		case ODBX_PARAM_BLOB:
+			aux->formats[pos] = 1;
+			break;
+		default:
+			return -ODBX_ERR_PARAM;
+	}
+
+	if( ( aux->values[pos] = (char*) malloc( length + 1 ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	memcpy( aux->values[pos], value, length );
+	aux->values[pos][length] = '\0';
+	aux->lengths[pos] = (int) length;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int pgsql_odbx_stmt_execute( odbx_stmt_t* stmt )
+{
+	struct pgstmt* aux = (struct pgstmt*) stmt->aux;
+	struct pgconn* conn = (struct pgconn*) stmt->handle->aux;
+
+	if( aux == NULL || conn == NULL || stmt->handle->generic == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( conn->dealloc != NULL ) { pgsql_odbx_stmt_cleanup( stmt->handle ); }
+
+	if( PQsendQueryPrepared( (PGconn*) stmt->handle->generic, aux->name, (int) stmt->count,
+		(const char* const*) aux->values, aux->lengths, aux->formats, 0 ) == 0 )
+	{
+		pgsql_odbx_stmt_error( stmt->handle );
+		return -ODBX_ERR_BACKEND;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int pgsql_odbx_stmt_finish( odbx_stmt_t* stmt )
+{
+	char* tmp;
+	size_t len;
+	unsigned long i;
+	struct pgstmt* aux = (struct pgstmt*) stmt->aux;
+	struct pgconn* conn = (struct pgconn*) stmt->handle->aux;
+	PGconn* pgconn = (PGconn*) stmt->handle->generic;
+
+
+	if( aux == NULL ) { return ODBX_ERR_SUCCESS; }
+
+	if( pgconn != NULL && conn != NULL )
+	{
+		len = strlen( aux->name ) + 13;   // "DEALLOCATE " name ";"
+
+		if( ( tmp = (char*) realloc( conn->dealloc, conn->dealloclen + len + 1 ) ) != NULL )
+		{
+			conn->dealloc = tmp;
+			conn->dealloclen += snprintf( conn->dealloc + conn->dealloclen, len + 1, "DEALLOCATE %s;", aux->name );
+		}
+
+		if( PQtransactionStatus( pgconn ) != PQTRANS_ACTIVE ) { pgsql_odbx_stmt_cleanup( stmt->handle ); }
+	}
+
+	for( i = 0; i < stmt->count; i++ ) { free( aux->values[i] ); }
+
+	free( aux->values );
+	free( aux->lengths );
+	free( aux->formats );
+	free( aux );
+
+	stmt->aux = NULL;
+
+	return ODBX_ERR_SUCCESS;
+}
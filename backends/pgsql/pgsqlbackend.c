@@ -17,12 +17,14 @@
  */
 
 extern struct odbx_basic_ops pgsql_odbx_basic_ops;
+extern struct odbx_stmt_ops pgsql_odbx_stmt_ops;
 
 
 
 struct odbx_ops pgsql_odbx_ops = {
 	.basic = &pgsql_odbx_basic_ops,
 	.lo = NULL,
+	.stmt = &pgsql_odbx_stmt_ops,
 };
 
 
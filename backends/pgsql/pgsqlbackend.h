@@ -72,6 +72,10 @@ struct pgconn
 	int errtype;
 	int ssl;
 	unsigned int timeout;
+	unsigned long stmts;   // counter for the names of prepared statements
+	char* dealloc;   // statements deallocated when the connection is idle
+	size_t dealloclen;
+	PGcancel* cancel;   // created by bind(), used by other threads
 };
 
 struct pgres
@@ -80,6 +84,22 @@ struct pgres
 	int total;
 };
 
+struct pgstmt
+{
+	char name[32];
+	char** values;   // parameters in text or binary format
+	int* lengths;
+	int* formats;
+};
+
+
+
+/*
+ *  Shared by the basic and the prepared statement operations
+ */
+
+void pgsql_odbx_stmt_cleanup( odbx_t* handle );
+
 
 
 #endif
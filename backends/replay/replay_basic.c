@@ -0,0 +1,732 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "replay_basic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+
+
+/*
+ *  Declaration of replay backend capabilities
+ */
+
+struct odbx_basic_ops replay_odbx_basic_ops = {
+	.init = replay_odbx_init,
+	.bind = replay_odbx_bind,
+	.unbind = replay_odbx_unbind,
+	.finish = replay_odbx_finish,
+	.get_option = replay_odbx_get_option,
+	.set_option = replay_odbx_set_option,
+	.error = replay_odbx_error,
+	.error_type = replay_odbx_error_type,
+	.escape = NULL,
+	.query = replay_odbx_query,
+	.result = replay_odbx_result,
+	.result_finish = replay_odbx_result_finish,
+	.rows_affected = replay_odbx_rows_affected,
+	.row_fetch = replay_odbx_row_fetch,
+	.column_count = replay_odbx_column_count,
+	.column_name = replay_odbx_column_name,
+	.column_type = replay_odbx_column_type,
+	.field_length = replay_odbx_field_length,
+	.field_value = replay_odbx_field_value,
+};
+
+
+
+/*
+ *  Private replay backend error messages
+ */
+
+static const char* replay_odbx_errmsg[] = {
+	gettext_noop("Unknown error"),
+	gettext_noop("Invalid parameter"),
+	gettext_noop("Opening recording failed"),
+	gettext_noop("Invalid recording"),
+	gettext_noop("Statement not found in recording"),
+};
+
+#define REPLAY_ERR_RECORDED 5
+
+
+
+/*
+ *  ODBX basic operations
+ *  Replay style
+ */
+
+
+/*
+ *  The replay backend serves the statements and result sets recorded by
+ *  odbx_record() from a file. Like SQLite, host is the directory of the
+ *  file. Port is the replay speed: Empty or "0" returns everything as fast
+ *  as possible, "1" waits as long as the recorded backend did and e.g.
+ *  "2" is twice as fast.
+ */
+
+static int replay_odbx_init( odbx_t* handle, const char* host, const char* port )
+{
+	struct rconn* aux;
+
+
+	if( ( aux = (struct rconn*) malloc( sizeof( struct rconn ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	memset( aux, 0, sizeof( struct rconn ) );
+
+	if( port != NULL && *port != '\0' )
+	{
+		if( ( aux->speed = strtod( port, NULL ) ) < 0 )
+		{
+			free( aux );
+			return -ODBX_ERR_PARAM;
+		}
+	}
+
+	if( host != NULL )
+	{
+		aux->pathlen = strlen( host );   /* host == directory */
+
+		if( ( aux->path = malloc( aux->pathlen + 1 ) ) == NULL )
+		{
+			free( aux );
+			return -ODBX_ERR_NOMEM;
+		}
+
+		snprintf( aux->path, aux->pathlen + 1, "%s", host );
+	}
+
+	handle->aux = (void*) aux;
+	handle->generic = NULL;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  The database is the name of the recording. Username and password are
+ *  ignored.
+ */
+
+static int replay_odbx_bind( odbx_t* handle, const char* database, const char* who, const char* cred, int method )
+{
+	int err;
+	char* file;
+	size_t flen;
+	struct rconn* aux = (struct rconn*) handle->aux;
+
+
+	if( aux == NULL || database == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( method != ODBX_BIND_SIMPLE ) { return -ODBX_ERR_NOTSUP; }
+
+	flen = strlen( database );
+
+	if( ( file = malloc( aux->pathlen + flen + 1 ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	memcpy( file, aux->path, aux->pathlen );
+	memcpy( file + aux->pathlen, database, flen + 1 );
+
+	err = replay_odbx_load( aux, file );
+	free( file );
+
+	if( err < 0 )
+	{
+		aux->err = 2;
+		return -ODBX_ERR_BACKEND;
+	}
+
+	if( replay_odbx_check( aux ) < 0 )
+	{
+		replay_odbx_unbind( handle );
+		aux->err = 3;
+		return -ODBX_ERR_BACKEND;
+	}
+
+	aux->err = 0;
+	handle->generic = (void*) aux->data;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int replay_odbx_unbind( odbx_t* handle )
+{
+	struct rconn* aux = (struct rconn*) handle->aux;
+
+	if( aux == NULL ) { return -ODBX_ERR_PARAM; }
+
+#ifdef HAVE_SYS_MMAN_H
+	if( aux->mapped ) { munmap( (void*) aux->data, aux->size ); }
+	else
+#endif
+	free( (void*) aux->data );
+
+	aux->data = NULL;
+	aux->size = 0;
+	aux->mapped = 0;
+	aux->first = aux->pos = 0;
+	aux->msg = NULL;
+
+	handle->generic = NULL;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int replay_odbx_finish( odbx_t* handle )
+{
+	if( handle->aux != NULL )
+	{
+		free( ((struct rconn*) handle->aux)->path );
+		free( handle->aux );
+		handle->aux = NULL;
+
+		return ODBX_ERR_SUCCESS;
+	}
+
+	return -ODBX_ERR_PARAM;
+}
+
+
+
+static int replay_odbx_get_option( odbx_t* handle, unsigned int option, void* value )
+{
+	switch( option )
+	{
+		case ODBX_OPT_API_VERSION:
+			*(int*) value = APINUMBER;
+			break;
+		case ODBX_OPT_MULTI_STATEMENTS:
+		case ODBX_OPT_THREAD_SAFE:
+			*(int*) value = ODBX_ENABLE;
+			break;
+		case ODBX_OPT_TLS:
+		case ODBX_OPT_PAGED_RESULTS:
+		case ODBX_OPT_COMPRESS:
+		case ODBX_OPT_CONNECT_TIMEOUT:
+			*(int*) value = ODBX_DISABLE;
+			break;
+		default:
+			return -ODBX_ERR_OPTION;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int replay_odbx_set_option( odbx_t* handle, unsigned int option, void* value )
+{
+	switch( option )
+	{
+		case ODBX_OPT_API_VERSION:
+		case ODBX_OPT_THREAD_SAFE:
+			return -ODBX_ERR_OPTRO;
+		case ODBX_OPT_MULTI_STATEMENTS:
+
+			if( *((int*) value) == ODBX_ENABLE ) { return ODBX_ERR_SUCCESS; }
+			break;
+
+		case ODBX_OPT_PAGED_RESULTS:
+		case ODBX_OPT_COMPRESS:
+		case ODBX_OPT_TLS:
+			break;
+		default:
+			return -ODBX_ERR_OPTION;
+	}
+
+	return -ODBX_ERR_OPTWR;
+}
+
+
+
+static const char* replay_odbx_error( odbx_t* handle )
+{
+	struct rconn* aux = (struct rconn*) handle->aux;
+
+	if( aux == NULL )
+	{
+		return dgettext( "opendbx", replay_odbx_errmsg[1] );
+	}
+
+	if( aux->err == REPLAY_ERR_RECORDED && aux->msg != NULL )
+	{
+		return aux->msg;
+	}
+
+	if( aux->err < REPLAY_ERR_RECORDED )
+	{
+		return dgettext( "opendbx", replay_odbx_errmsg[aux->err] );
+	}
+
+	return dgettext( "opendbx", replay_odbx_errmsg[0] );
+}
+
+
+
+static int replay_odbx_error_type( odbx_t* handle )
+{
+	struct rconn* aux = (struct rconn*) handle->aux;
+
+	if( aux == NULL ) { return -1; }
+
+	switch( aux->err )
+	{
+		case 0:
+			return 0;
+		case 4:
+		case REPLAY_ERR_RECORDED:
+			return 1;
+	}
+
+	return -1;
+}
+
+
+
+/*
+ *  Statements are searched from the current position to the end of the
+ *  recording and from its beginning afterwards, so replaying the same
+ *  sequence of statements needs only one comparison per statement.
+ */
+
+static int replay_odbx_query( odbx_t* handle, const char* query, unsigned long length )
+{
+	int wrapped = 0;
+	const struct odbx_rec* rec;
+	struct rconn* aux = (struct rconn*) handle->aux;
+	size_t pos, end;
+
+
+	if( query == NULL || aux == NULL )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( aux->data == NULL )
+	{
+		aux->err = 1;
+		return -ODBX_ERR_BACKEND;
+	}
+
+	pos = aux->pos;
+	end = aux->size;
+
+	while( 1 )
+	{
+		if( pos >= end )
+		{
+			if( wrapped || aux->pos == aux->first ) { break; }
+
+			pos = aux->first;
+			end = aux->pos;
+			wrapped = 1;
+			continue;
+		}
+
+		rec = (const struct odbx_rec*) ( aux->data + pos );
+		pos += rec->size;
+
+		if( rec->type != ODBX_REC_QUERY || strlen( (const char*) ( rec + 1 ) ) != length ) { continue; }
+		if( memcmp( (const char*) ( rec + 1 ), query, length ) != 0 ) { continue; }
+
+		aux->pos = pos;
+		aux->last = replay_odbx_time();
+		aux->msg = NULL;
+		aux->err = 0;
+
+		rec = (const struct odbx_rec*) ( aux->data + pos );
+
+		if( pos < aux->size && rec->type == ODBX_REC_FAILED )
+		{
+			aux->pos += rec->size;
+			aux->msg = (const char*) ( rec + 1 );
+			aux->err = REPLAY_ERR_RECORDED;
+
+			return rec->status < 0 ? rec->status : -ODBX_ERR_BACKEND;
+		}
+
+		return ODBX_ERR_SUCCESS;
+	}
+
+	aux->err = 4;
+	return -ODBX_ERR_BACKEND;
+}
+
+
+
+/*
+ *  The result sets are returned as recorded. A timeout is only reported
+ *  if the recorded pacing is replayed and the backend was slower.
+ */
+
+static int replay_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk )
+{
+	struct rres* rres;
+	const struct odbx_rec* rec;
+	struct rconn* aux = (struct rconn*) handle->aux;
+
+
+	if( aux == NULL || aux->data == NULL ) { return -ODBX_ERR_PARAM; }
+
+	rec = (const struct odbx_rec*) ( aux->data + aux->pos );
+
+	if( aux->pos >= aux->size || rec->type == ODBX_REC_QUERY ) { return ODBX_RES_DONE; }
+
+	if( aux->speed > 0 && replay_odbx_pace( aux, aux->last, rec->time, timeout ) != 0 )
+	{
+		return ODBX_RES_TIMEOUT;
+	}
+
+	aux->pos += rec->size;
+	aux->last = replay_odbx_time();
+
+	switch( rec->type )
+	{
+		case ODBX_REC_RESULT:
+			break;
+		case ODBX_REC_ERROR:
+		case ODBX_REC_FAILED:
+			aux->msg = (const char*) ( rec + 1 );
+			aux->err = REPLAY_ERR_RECORDED;
+			return rec->status < 0 ? rec->status : -ODBX_ERR_BACKEND;
+		default:
+			return ODBX_RES_DONE;
+	}
+
+	if( ( *result = (odbx_result_t*) malloc( sizeof( struct odbx_result_t ) + sizeof( struct rres ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	rres = (struct rres*) ( *result + 1 );
+	rres->rec = rec;
+	rres->mat = (const struct odbx_mat*) ( rec + 1 );
+	rres->row = 0;
+	rres->cell = 0;
+	rres->start = aux->last;
+
+	(*result)->handle = handle;
+	(*result)->generic = (void*) rres;
+	(*result)->aux = NULL;
+
+	return rres->mat->status;
+}
+
+
+
+static int replay_odbx_result_finish( odbx_result_t* result )
+{
+	struct rres* rres = (struct rres*) result->generic;
+	struct rconn* aux = (struct rconn*) result->handle->aux;
+
+
+	if( aux->speed > 0 )
+	{
+		replay_odbx_pace( aux, rres->start, rres->rec->fetch, NULL );
+	}
+
+	aux->last = replay_odbx_time();
+	free( result );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  The recorded time for fetching all rows is distributed evenly
+ */
+
+static int replay_odbx_row_fetch( odbx_result_t* result )
+{
+	struct rres* rres = (struct rres*) result->generic;
+	struct rconn* aux = (struct rconn*) result->handle->aux;
+
+
+	if( rres->row >= rres->mat->rows ) { return ODBX_ROW_DONE; }
+
+	rres->cell = rres->row * rres->mat->cols;
+	rres->row++;
+
+	if( aux->speed > 0 )
+	{
+		replay_odbx_pace( aux, rres->start, (uint64_t) ( (double) rres->rec->fetch * rres->row / rres->mat->rows ), NULL );
+	}
+
+	return ODBX_ROW_NEXT;
+}
+
+
+
+static uint64_t replay_odbx_rows_affected( odbx_result_t* result )
+{
+	return ((struct rres*) result->generic)->mat->affected;
+}
+
+
+
+static unsigned long replay_odbx_column_count( odbx_result_t* result )
+{
+	return (unsigned long) ((struct rres*) result->generic)->mat->cols;
+}
+
+
+
+static const char* replay_odbx_column_name( odbx_result_t* result, unsigned long pos )
+{
+	const struct odbx_mat* mat = ((struct rres*) result->generic)->mat;
+
+	if( pos < mat->cols )
+	{
+		return (const char*) mat + _odbx_mat_column( mat, pos )->name;
+	}
+
+	return NULL;
+}
+
+
+
+static int replay_odbx_column_type( odbx_result_t* result, unsigned long pos )
+{
+	const struct odbx_mat* mat = ((struct rres*) result->generic)->mat;
+
+	if( pos < mat->cols )
+	{
+		return _odbx_mat_column( mat, pos )->type;
+	}
+
+	return -ODBX_ERR_PARAM;
+}
+
+
+
+static unsigned long replay_odbx_field_length( odbx_result_t* result, unsigned long pos )
+{
+	struct rres* rres = (struct rres*) result->generic;
+
+	if( rres->row > 0 && pos < rres->mat->cols )
+	{
+		return _odbx_mat_length( rres->mat, rres->cell + pos );
+	}
+
+	return 0;
+}
+
+
+
+static const char* replay_odbx_field_value( odbx_result_t* result, unsigned long pos )
+{
+	struct rres* rres = (struct rres*) result->generic;
+
+	if( rres->row > 0 && pos < rres->mat->cols && !_odbx_mat_isnull( rres->mat, rres->cell + pos ) )
+	{
+		return _odbx_mat_value( rres->mat, rres->cell + pos );
+	}
+
+	return NULL;
+}
+
+
+
+
+
+/*
+ *  Internal functions
+ */
+
+
+/*
+ *  Maps the recording into memory or reads it if this isn't possible
+ */
+
+static int replay_odbx_load( struct rconn* aux, const char* file )
+{
+	int fd;
+	char* data;
+	ssize_t len;
+	size_t pos = 0;
+	struct stat st;
+
+
+	if( ( fd = open( file, O_RDONLY ) ) < 0 ) { return -1; }
+
+	if( fstat( fd, &st ) != 0 || st.st_size == 0 )
+	{
+		close( fd );
+		return -1;
+	}
+
+	aux->size = (size_t) st.st_size;
+
+#ifdef HAVE_SYS_MMAN_H
+	if( ( data = (char*) mmap( NULL, aux->size, PROT_READ, MAP_PRIVATE, fd, 0 ) ) != (char*) MAP_FAILED )
+	{
+		close( fd );
+
+		aux->data = data;
+		aux->mapped = 1;
+
+		return 0;
+	}
+#endif
+
+	if( ( data = (char*) malloc( aux->size ) ) == NULL )
+	{
+		close( fd );
+		return -1;
+	}
+
+	while( pos < aux->size && ( len = read( fd, data + pos, aux->size - pos ) ) > 0 )
+	{
+		pos += (size_t) len;
+	}
+
+	close( fd );
+
+	if( pos != aux->size )
+	{
+		free( data );
+		return -1;
+	}
+
+	aux->data = data;
+	aux->mapped = 0;
+
+	return 0;
+}
+
+
+
+/*
+ *  Checks all records once so they can be used without further tests. An
+ *  incomplete last record of an interrupted recording is ignored.
+ */
+
+static int replay_odbx_check( struct rconn* aux )
+{
+	size_t len, pos = ODBX_MAT_ALIGN( sizeof( struct odbx_rec_file ) );
+	const struct odbx_rec_file* header = (const struct odbx_rec_file*) aux->data;
+	const struct odbx_rec* rec;
+
+
+	if( aux->size < pos || header->magic != ODBX_REC_MAGIC || header->version != ODBX_REC_VERSION ) { return -1; }
+
+	aux->first = aux->pos = pos;
+
+	while( aux->size - pos >= sizeof( struct odbx_rec ) )
+	{
+		rec = (const struct odbx_rec*) ( aux->data + pos );
+
+		if( rec->size < sizeof( struct odbx_rec ) || ( rec->size & 7 ) != 0 ) { return -1; }
+		if( rec->size > aux->size - pos ) { break; }
+
+		len = (size_t) rec->size - sizeof( struct odbx_rec );
+
+		switch( rec->type )
+		{
+			case ODBX_REC_QUERY:
+			case ODBX_REC_ERROR:
+			case ODBX_REC_FAILED:
+				if( memchr( (const void*) ( rec + 1 ), 0, len ) == NULL ) { return -1; }
+				break;
+			case ODBX_REC_RESULT:
+				if( _odbx_mat_check( (const struct odbx_mat*) ( rec + 1 ), len ) < 0 ) { return -1; }
+				break;
+			case ODBX_REC_DONE:
+				break;
+			default:
+				return -1;
+		}
+
+		pos += (size_t) rec->size;
+	}
+
+	aux->size = pos;
+
+	return 0;
+}
+
+
+
+static uint64_t replay_odbx_time( void )
+{
+#ifdef HAVE_CLOCK_GETTIME
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#else
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+	return (uint64_t) tv.tv_sec * 1000000000 + (uint64_t) tv.tv_usec * 1000;
+#endif
+}
+
+
+
+/*
+ *  Waits until the recorded time scaled by the replay speed has passed
+ *  since start. Returns 1 if the timeout is shorter.
+ */
+
+static int replay_odbx_pace( struct rconn* aux, uint64_t start, uint64_t nsec, struct timeval* timeout )
+{
+	int expired = 0;
+	struct timespec ts;
+	uint64_t now, wait, target = start + (uint64_t) ( (double) nsec / aux->speed );
+
+
+	if( ( now = replay_odbx_time() ) >= target ) { return 0; }
+
+	wait = target - now;
+
+	if( timeout != NULL && (uint64_t) timeout->tv_sec * 1000000000 + (uint64_t) timeout->tv_usec * 1000 < wait )
+	{
+		wait = (uint64_t) timeout->tv_sec * 1000000000 + (uint64_t) timeout->tv_usec * 1000;
+		expired = 1;
+	}
+
+	ts.tv_sec = (time_t) ( wait / 1000000000 );
+	ts.tv_nsec = (long) ( wait % 1000000000 );
+
+	while( nanosleep( &ts, &ts ) != 0 && errno == EINTR );
+
+	return expired;
+}
@@ -0,0 +1,76 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "replaybackend.h"
+
+
+
+#ifndef REPLAY_BASIC_H
+#define REPLAY_BASIC_H
+
+
+
+/*
+ *  Basic operations
+ */
+
+static int replay_odbx_init( odbx_t* handle, const char* host, const char* port );
+
+static int replay_odbx_bind( odbx_t* handle, const char* database, const char* who, const char* cred, int method );
+
+static int replay_odbx_unbind( odbx_t* handle );
+
+static int replay_odbx_finish( odbx_t* handle );
+
+static int replay_odbx_get_option( odbx_t* handle, unsigned int option, void* value );
+
+static int replay_odbx_set_option( odbx_t* handle, unsigned int option, void* value );
+
+static const char* replay_odbx_error( odbx_t* handle );
+
+static int replay_odbx_error_type( odbx_t* handle );
+
+static int replay_odbx_query( odbx_t* handle, const char* query, unsigned long length );
+
+static int replay_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk );
+
+static int replay_odbx_result_finish( odbx_result_t* result );
+
+static int replay_odbx_row_fetch( odbx_result_t* result );
+
+static uint64_t replay_odbx_rows_affected( odbx_result_t* result );
+
+static unsigned long replay_odbx_column_count( odbx_result_t* result );
+
+static const char* replay_odbx_column_name( odbx_result_t* result, unsigned long pos );
+
+static int replay_odbx_column_type( odbx_result_t* result, unsigned long pos );
+
+static unsigned long replay_odbx_field_length( odbx_result_t* result, unsigned long pos );
+
+static const char* replay_odbx_field_value( odbx_result_t* result, unsigned long pos );
+
+
+
+/*
+ *  Internal functions
+ */
+
+static int replay_odbx_load( struct rconn* aux, const char* file );
+
+static int replay_odbx_check( struct rconn* aux );
+
+static uint64_t replay_odbx_time( void );
+
+static int replay_odbx_pace( struct rconn* aux, uint64_t start, uint64_t nsec, struct timeval* timeout );
+
+
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "replaybackend.h"
+
+
+
+/*
+ *  Declaration of replay backend capabilities
+ */
+
+extern struct odbx_basic_ops replay_odbx_basic_ops;
+
+
+
+struct odbx_ops replay_odbx_ops = {
+	.basic = &replay_odbx_basic_ops,
+	.lo = NULL,
+	.stmt = NULL,
+};
+
+
+
+#ifndef ODBX_SINGLELIB
+
+void odbxdrv_register( struct odbx_ops** ops )
+{
+	*ops = &replay_odbx_ops;
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+#include "odbxrec.h"
+
+
+
+#ifndef REPLAYBACKEND_H
+#define REPLAYBACKEND_H
+
+
+
+/*
+ *  Auxillary data structures attached to odbx_t and odbx_result_t
+ */
+
+struct rconn
+{
+	char* path;   // directory given as host
+	size_t pathlen;
+	double speed;   // 0 for full speed, 1 for recorded pacing
+	const char* data;   // content of the recording
+	size_t size;
+	int mapped;
+	size_t first;   // offset of the first record
+	size_t pos;   // offset of the next record
+	uint64_t last;   // statement sent or previous result set finished
+	const char* msg;   // recorded error message
+	int err;
+};
+
+struct rres
+{
+	const struct odbx_rec* rec;
+	const struct odbx_mat* mat;
+	uint64_t row;   // number of fetched rows
+	uint64_t cell;   // first cell of the current row
+	uint64_t start;   // time the result set was returned
+};
+
+
+
+#endif
@@ -41,6 +41,7 @@ struct odbx_basic_ops sqlite_odbx_basic_ops = {
 	.column_type = sqlite_odbx_column_type,
 	.field_length = sqlite_odbx_field_length,
 	.field_value = sqlite_odbx_field_value,
+	.cancel = sqlite_odbx_cancel,
 };
 
 
@@ -369,6 +370,17 @@ static int sqlite_odbx_result( odbx_t* handle, odbx_result_t** result, struct ti
 
 
 
+static int sqlite_odbx_cancel( odbx_t* handle )
+{
+	if( handle->generic == NULL ) { return -ODBX_ERR_PARAM; }
+
+	sqlite_interrupt( (sqlite*) handle->generic );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int sqlite_odbx_result_finish( odbx_result_t* result )
 {
 	if( result->handle != NULL && result->handle->aux != NULL )
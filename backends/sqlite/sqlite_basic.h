@@ -41,6 +41,8 @@ static int sqlite_odbx_query( odbx_t* handle, const char* query, unsigned long l
 
 static int sqlite_odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk );
 
+static int sqlite_odbx_cancel( odbx_t* handle );
+
 static int sqlite_odbx_result_finish( odbx_result_t* result );
 
 static int sqlite_odbx_row_fetch( odbx_result_t* result );
@@ -23,6 +23,7 @@ extern struct odbx_basic_ops sqlite_odbx_basic_ops;
 struct odbx_ops sqlite_odbx_ops = {
 	.basic = &sqlite_odbx_basic_ops,
 	.lo = NULL,
+	.stmt = NULL,
 };
 
 
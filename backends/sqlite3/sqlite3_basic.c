@@ -40,6 +40,7 @@ struct odbx_basic_ops sqlite3_odbx_basic_ops = {
 	.column_type = sqlite3_odbx_column_type,
 	.field_length = sqlite3_odbx_field_length,
 	.field_value = sqlite3_odbx_field_value,
+	.cancel = sqlite3_odbx_cancel,
 };
 
 
@@ -78,6 +79,7 @@ static int sqlite3_odbx_init( odbx_t* handle, const char* host, const char* port
 	struct sconn* aux = handle->aux;
 
 	aux->res = NULL;
+	aux->prep = NULL;
 	aux->path = NULL;
 	aux->pathlen = 0;
 	aux->stmt = NULL;
@@ -153,7 +155,7 @@ static int sqlite3_odbx_unbind( odbx_t* handle )
 
 	if( aux->res != NULL )
 	{
-		sqlite3_finalize( aux->res );
+		sqlite3_odbx_release( aux, aux->res );
 		aux->res = NULL;
 	}
 
@@ -378,15 +380,20 @@ static int sqlite3_odbx_result( odbx_t* handle, odbx_result_t** result, struct t
 		case SQLITE_DONE:
 		case SQLITE_OK:
 			break;
+		case SQLITE_INTERRUPT:   // remaining statements of canceled queries aren't executed
+			aux->length = 0;
+			free( aux->stmt );
+			aux->stmt = NULL;
+			/* fall through */
 		default:
-			sqlite3_finalize( aux->res );
+			sqlite3_odbx_release( aux, aux->res );
 			aux->res = NULL;
-			return ODBX_ERR_BACKEND;
+			return -ODBX_ERR_BACKEND;
 	}
 
 	if( ( *result = (odbx_result_t*) malloc( sizeof( struct odbx_result_t ) ) ) == NULL )
 	{
-		sqlite3_finalize( aux->res );
+		sqlite3_odbx_release( aux, aux->res );
 		aux->res = NULL;
 		return -ODBX_ERR_NOMEM;
 	}
@@ -404,6 +411,22 @@ static int sqlite3_odbx_result( odbx_t* handle, odbx_result_t** result, struct t
 
 
 
+/*
+ *  sqlite3_interrupt() is safe to call by another thread as long as the
+ *  database isn't closed
+ */
+
+static int sqlite3_odbx_cancel( odbx_t* handle )
+{
+	if( handle->generic == NULL ) { return -ODBX_ERR_PARAM; }
+
+	sqlite3_interrupt( (sqlite3*) handle->generic );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int sqlite3_odbx_result_finish( odbx_result_t* result )
 {
 	struct sconn* aux = (struct sconn*) result->handle->aux;
@@ -412,7 +435,7 @@ static int sqlite3_odbx_result_finish( odbx_result_t* result )
 
 	if( result->generic != NULL )
 	{
-		sqlite3_finalize( (sqlite3_stmt*) result->generic );
+		sqlite3_odbx_release( aux, (sqlite3_stmt*) result->generic );
 		result->generic = NULL;
 	}
 
@@ -441,9 +464,13 @@ static int sqlite3_odbx_row_fetch( odbx_result_t* result )
 		case SQLITE_DONE:
 		case SQLITE_OK:
 		case SQLITE_MISUSE:   // Return DONE if function called more often afterwards
-			sqlite3_finalize( (sqlite3_stmt*) result->generic );
+			sqlite3_odbx_release( aux, (sqlite3_stmt*) result->generic );
 			result->generic = NULL;
 			return ODBX_ROW_DONE;
+		case SQLITE_INTERRUPT:
+			aux->length = 0;
+			free( aux->stmt );
+			aux->stmt = NULL;
 	}
 
 	return -ODBX_ERR_BACKEND;
@@ -496,11 +523,16 @@ static int sqlite3_odbx_column_type( odbx_result_t* result, unsigned long pos )
 			return ODBX_TYPE_CLOB;
 		default:
 #ifdef HAVE_SQLITE3_TABLE_COLUMN_METADATA
+			if( sqlite3_column_table_name( (sqlite3_stmt*) result->generic, pos ) == NULL )
+			{
+				return ODBX_TYPE_UNKNOWN;   // expression without origin
+			}
+
 			if( sqlite3_table_column_metadata( (sqlite3*) result->handle->generic,
 				sqlite3_column_database_name( (sqlite3_stmt*) result->generic, pos ),
 				sqlite3_column_table_name( (sqlite3_stmt*) result->generic, pos ),
 				sqlite3_column_origin_name( (sqlite3_stmt*) result->generic, pos ),
-				&type, &collation, &notnull, &primarykey, &autoinc ) != SQLITE_OK )
+				&type, &collation, &notnull, &primarykey, &autoinc ) != SQLITE_OK || type == NULL )
 			{
 				return ODBX_TYPE_UNKNOWN;
 			}
@@ -537,3 +569,24 @@ static const char* sqlite3_odbx_field_value( odbx_result_t* result, unsigned lon
 {
 	return (const char*) sqlite3_column_blob( (sqlite3_stmt*) result->generic, pos );
 }
+
+
+
+
+
+/*
+ *  Result sets of prepared statements are only reset, so the statement
+ *  can be executed again
+ */
+
+void sqlite3_odbx_release( struct sconn* aux, sqlite3_stmt* res )
+{
+	if( res != NULL && res == aux->prep )
+	{
+		sqlite3_reset( res );
+		aux->prep = NULL;
+		return;
+	}
+
+	sqlite3_finalize( res );
+}
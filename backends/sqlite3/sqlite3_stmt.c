@@ -0,0 +1,186 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2005-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "sqlite3_stmt.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+
+/*
+ *  Declaration of SQLite3 capabilities
+ */
+
+struct odbx_stmt_ops sqlite3_odbx_stmt_ops = {
+	.prepare = sqlite3_odbx_stmt_prepare,
+	.bind = sqlite3_odbx_stmt_bind,
+	.execute = sqlite3_odbx_stmt_execute,
+	.finish = sqlite3_odbx_stmt_finish,
+};
+
+
+
+static char sqlite3_odbx_empty[] = "";
+
+
+
+/*
+ *  ODBX prepared statement operations
+ *  SQLite3 style
+ *
+ *  The statement is compiled once and reset after its result set is
+ *  finished. Bound values are kept until they are replaced.
+ */
+
+static int sqlite3_odbx_stmt_prepare( odbx_stmt_t* stmt, const char* query, unsigned long length )
+{
+	const char* tail;
+	sqlite3_stmt* res = NULL;
+	struct sconn* aux = (struct sconn*) stmt->handle->aux;
+
+	if( aux == NULL || stmt->handle->generic == NULL ) { return -ODBX_ERR_PARAM; }
+
+#ifdef HAVE_SQLITE3_PREPARE_V2
+	if( ( aux->err = sqlite3_prepare_v2( (sqlite3*) stmt->handle->generic, query, (int) length, &res, &tail ) ) != SQLITE_OK )
+#else
+	if( ( aux->err = sqlite3_prepare( (sqlite3*) stmt->handle->generic, query, (int) length, &res, &tail ) ) != SQLITE_OK )
+#endif
+	{
+		return -ODBX_ERR_BACKEND;
+	}
+
+	if( res == NULL ) { return -ODBX_ERR_PARAM; }   // no statement
+
+	while( tail < query + length && ( isspace( (unsigned char) *tail ) || *tail == ';' ) ) { tail++; }
+
+	if( tail < query + length )   // only one statement can be prepared
+	{
+		sqlite3_finalize( res );
+		return -ODBX_ERR_NOTSUP;
+	}
+
+	stmt->generic = (void*) res;
+	stmt->count = (unsigned long) sqlite3_bind_parameter_count( res );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int sqlite3_odbx_stmt_bind( odbx_stmt_t* stmt, unsigned long pos, int type, const void* value, unsigned long length )
+{
+	int64_t num;
+	double real;
+	sqlite3_stmt* res = (sqlite3_stmt*) stmt->generic;
+	struct sconn* aux = (struct sconn*) stmt->handle->aux;
+
+	if( aux == NULL || res == NULL ) { return -ODBX_ERR_PARAM; }
+
+	switch( type )
+	{
+		case ODBX_PARAM_NULL:
+			aux->err = sqlite3_bind_null( res, (int) pos + 1 );
+			break;
+		case ODBX_PARAM_INT64:
+			memcpy( &num, value, sizeof( int64_t ) );
+			aux->err = sqlite3_bind_int64( res, (int) pos + 1, (sqlite3_int64) num );
+			break;
+		case ODBX_PARAM_DOUBLE:
+			memcpy( &real, value, sizeof( double ) );
+			aux->err = sqlite3_bind_double( res, (int) pos + 1, real );
+			break;
+		case ODBX_PARAM_TEXT:
+			aux->err = sqlite3_bind_text( res, (int) pos + 1, (const char*) value, (int) length, SQLITE_TRANSIENT );
+			break;
+		case ODBX_PARAM_BLOB:
+			aux->err = sqlite3_bind_blob( res, (int) pos + 1, value, (int) length, SQLITE_TRANSIENT );
+			break;
+		default:
+			return -ODBX_ERR_PARAM;
+	}
+
+	if( aux->err != SQLITE_OK ) { return -ODBX_ERR_BACKEND; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  The compiled statement is passed to sqlite3_odbx_result() which steps
+ *  through it instead of compiling the next statement
+ */
+
+static int sqlite3_odbx_stmt_execute( odbx_stmt_t* stmt )
+{
+	struct sconn* aux = (struct sconn*) stmt->handle->aux;
+
+	if( aux == NULL || stmt->generic == NULL ) { return -ODBX_ERR_PARAM; }
+
+	/*
+	 *  Only one prepared statement can be tracked at a time. If the result
+	 *  set of the last execution is still in use, executing this or another
+	 *  statement would let the result set reset or finalize the wrong one
+	 */
+
+	if( aux->prep != NULL && aux->res != aux->prep )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( aux->res != NULL )   // previous statement wasn't finished
+	{
+		sqlite3_odbx_release( aux, aux->res );
+		aux->res = NULL;
+	}
+
+	if( aux->stmt != NULL )
+	{
+		free( aux->stmt );
+		aux->stmt = NULL;
+	}
+
+	sqlite3_reset( (sqlite3_stmt*) stmt->generic );
+
+	aux->prep = (sqlite3_stmt*) stmt->generic;
+	aux->res = aux->prep;
+	aux->tail = sqlite3_odbx_empty;
+	aux->length = stmt->length;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int sqlite3_odbx_stmt_finish( odbx_stmt_t* stmt )
+{
+	struct sconn* aux = (struct sconn*) stmt->handle->aux;
+
+	if( stmt->generic == NULL ) { return ODBX_ERR_SUCCESS; }
+
+	/*
+	 *  If the statement was executed and its result set is still pending or
+	 *  used, it's finalized when the result set is finished
+	 */
+
+	if( aux != NULL && aux->prep == (sqlite3_stmt*) stmt->generic )
+	{
+		aux->prep = NULL;
+		stmt->generic = NULL;
+		return ODBX_ERR_SUCCESS;
+	}
+
+	sqlite3_finalize( (sqlite3_stmt*) stmt->generic );
+	stmt->generic = NULL;
+
+	return ODBX_ERR_SUCCESS;
+}
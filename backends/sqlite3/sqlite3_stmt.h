@@ -0,0 +1,34 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2005-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "sqlite3backend.h"
+
+
+
+#ifndef SQLITE3_STMT_H
+#define SQLITE3_STMT_H
+
+
+
+/*
+ *  Prepared statement operations
+ */
+
+static int sqlite3_odbx_stmt_prepare( odbx_stmt_t* stmt, const char* query, unsigned long length );
+
+static int sqlite3_odbx_stmt_bind( odbx_stmt_t* stmt, unsigned long pos, int type, const void* value, unsigned long length );
+
+static int sqlite3_odbx_stmt_execute( odbx_stmt_t* stmt );
+
+static int sqlite3_odbx_stmt_finish( odbx_stmt_t* stmt );
+
+
+
+#endif
@@ -17,12 +17,14 @@
  */
 
 extern struct odbx_basic_ops sqlite3_odbx_basic_ops;
+extern struct odbx_stmt_ops sqlite3_odbx_stmt_ops;
 
 
 
 struct odbx_ops sqlite3_odbx_ops = {
 	.basic = &sqlite3_odbx_basic_ops,
 	.lo = NULL,
+	.stmt = &sqlite3_odbx_stmt_ops,
 };
 
 
@@ -38,6 +38,7 @@
 struct sconn
 {
 	sqlite3_stmt* res;   // Necessary to restart after timeout
+	sqlite3_stmt* prep;   // prepared statement which is executed
 	char* path;
 	int pathlen;
 	char* stmt;
@@ -48,4 +49,12 @@ struct sconn
 
 
 
+/*
+ *  Shared by the basic and the prepared statement operations
+ */
+
+void sqlite3_odbx_release( struct sconn* aux, sqlite3_stmt* res );
+
+
+
 #endif
@@ -39,6 +39,7 @@ struct odbx_basic_ops sybase_odbx_basic_ops = {
 	.column_type = sybase_odbx_column_type,
 	.field_length = sybase_odbx_field_length,
 	.field_value = sybase_odbx_field_value,
+	.cancel = sybase_odbx_cancel,
 };
 
 
@@ -485,6 +486,31 @@ static int sybase_odbx_result( odbx_t* handle, odbx_result_t** result, struct ti
 
 
 
+/*
+ *  CS_CANCEL_ATTN only sends an attention to the server and is allowed while
+ *  another thread is waiting for results of the connection. The remaining
+ *  results are discarded by the next call to ct_results().
+ */
+
+static int sybase_odbx_cancel( odbx_t* handle )
+{
+	struct sybconn* aux = (struct sybconn*) handle->aux;
+
+	if( aux == NULL || aux->conn == NULL )
+	{
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( ct_cancel( aux->conn, NULL, CS_CANCEL_ATTN ) != CS_SUCCEED )
+	{
+		return -ODBX_ERR_BACKEND;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
 static int sybase_odbx_result_finish( odbx_result_t* result )
 {
 	unsigned long i;
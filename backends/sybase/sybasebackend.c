@@ -23,6 +23,7 @@ extern struct odbx_basic_ops sybase_odbx_basic_ops;
 struct odbx_ops sybase_odbx_ops = {
 	.basic = &sybase_odbx_basic_ops,
 	.lo = NULL,
+	.stmt = NULL,
 };
 
 
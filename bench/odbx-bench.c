@@ -0,0 +1,415 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <odbx.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include "odbx-bench.h"
+
+
+
+/*
+ *  Layouts of the tables used for the insert and scan benchmarks
+ */
+
+struct layout
+{
+	int cols;
+	int width;
+};
+
+static struct layout layouts[] = {
+	{ 1, 8 },
+	{ 4, 64 },
+	{ 16, 64 },
+	{ 4, 1024 },
+};
+
+#define LAYOUTMAX 4
+#define LAYOUTPOINT 1
+
+
+
+void help( char* name )
+{
+	fprintf( stdout, "Usage: %s <options>\n", name );
+	fprintf( stdout, "   -b <backend>    Database backend (mysql, pgsql, sqlite, sqlite3, firebird, freetds, sybase)\n" );
+	fprintf( stdout, "   -h <server>     Server name, IP address or directory\n" );
+	fprintf( stdout, "   -p <port>       Server port\n" );
+	fprintf( stdout, "   -d <database>   Database or file name\n" );
+	fprintf( stdout, "   -u <user>       User name for authentication\n" );
+	fprintf( stdout, "   -w <password>   Password for authentication\n" );
+	fprintf( stdout, "   -n <rows>       Number of rows per table (default 10000)\n" );
+	fprintf( stdout, "   -q <queries>    Number of point queries (default 1000)\n" );
+	fprintf( stdout, "   -r <runs>       Number of scans, the fastest one is reported (default 3)\n" );
+	fprintf( stdout, "   -s <name>       Name of the backend in the output\n" );
+}
+
+
+
+static int compare( const void* a, const void* b )
+{
+	uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+
+	return x < y ? -1 : x > y;
+}
+
+
+
+/*
+ *  Inserts rows into a new table, one statement per row
+ */
+
+static int bench_insert( struct bench* b, const char* table, struct layout* l )
+{
+	int err;
+	uint64_t start;
+
+
+	if( ( err = bench_table( b, table, l->cols, l->width ) ) < 0 ) { return err; }
+
+	start = bench_time();
+	if( ( err = bench_fill( b, table, l->cols, l->width ) ) < 0 ) { return err; }
+
+	bench_report( b, "insert", l->cols, l->width, "rows/s", b->rows / bench_seconds( start ) );
+
+	return 0;
+}
+
+
+
+/*
+ *  Fetches all rows of a table and retrieves each value
+ */
+
+static int bench_scan( struct bench* b, const char* table, struct layout* l )
+{
+	int err, run;
+	char sql[128];
+	unsigned long c, cols;
+	uint64_t start, best = 0, bytes = 0, rows = 0;
+	odbx_result_t* result;
+
+
+	sprintf( sql, "SELECT * FROM %s", table );
+
+	for( run = 0; run < b->runs; run++ )
+	{
+		start = bench_time();
+		bytes = rows = 0;
+
+		if( ( err = odbx_query( b->handle, sql, 0 ) ) < 0 ) { return bench_error( b, "odbx_query", err ); }
+
+		while( ( err = odbx_result( b->handle, &result, NULL, 0 ) ) != ODBX_RES_DONE )
+		{
+			if( err < 0 ) { return bench_error( b, "odbx_result", err ); }
+
+			cols = odbx_column_count( result );
+
+			while( ( err = odbx_row_fetch( result ) ) == ODBX_ROW_NEXT )
+			{
+				for( c = 0; c < cols; c++ )
+				{
+					if( odbx_field_value( result, c ) != NULL ) { bytes += odbx_field_length( result, c ); }
+				}
+				rows++;
+			}
+
+			odbx_result_finish( result );
+			if( err < 0 ) { return bench_error( b, "odbx_row_fetch", err ); }
+		}
+
+		start = bench_time() - start;
+		if( run == 0 || start < best ) { best = start; }
+	}
+
+	if( best == 0 ) { best = 1; }
+
+	bench_report( b, "scan", l->cols, l->width, "rows/s", (double) rows * 1e9 / best );
+	bench_report( b, "scan", l->cols, l->width, "MB/s", (double) bytes * 1e3 / best );
+
+	return 0;
+}
+
+
+
+/*
+ *  Selects single rows by their primary key
+ */
+
+static int bench_point( struct bench* b, const char* table, struct layout* l )
+{
+	int err;
+	char sql[128];
+	unsigned long i;
+	uint64_t start, total = 0;
+	uint64_t* latency;
+	odbx_result_t* result;
+
+
+	if( b->queries == 0 ) { return 0; }
+
+	if( ( latency = (uint64_t*) malloc( sizeof( uint64_t ) * b->queries ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	for( i = 0; i < b->queries; i++ )
+	{
+		sprintf( sql, "SELECT * FROM %s WHERE id = %lu", table, (unsigned long) rand() % b->rows );
+		start = bench_time();
+
+		if( ( err = odbx_query( b->handle, sql, 0 ) ) < 0 )
+		{
+			free( latency );
+			return bench_error( b, "odbx_query", err );
+		}
+
+		while( ( err = odbx_result( b->handle, &result, NULL, 0 ) ) != ODBX_RES_DONE )
+		{
+			if( err < 0 )
+			{
+				free( latency );
+				return bench_error( b, "odbx_result", err );
+			}
+
+			while( odbx_row_fetch( result ) == ODBX_ROW_NEXT ) { odbx_field_value( result, 1 ); }
+			odbx_result_finish( result );
+		}
+
+		latency[i] = bench_time() - start;
+		total += latency[i];
+	}
+
+	qsort( latency, b->queries, sizeof( uint64_t ), compare );
+
+	bench_report( b, "point-mean", l->cols, l->width, "us", (double) total / b->queries / 1e3 );
+	bench_report( b, "point-p50", l->cols, l->width, "us", (double) latency[b->queries / 2] / 1e3 );
+	bench_report( b, "point-p99", l->cols, l->width, "us", (double) latency[b->queries * 99 / 100] / 1e3 );
+
+	free( latency );
+	return 0;
+}
+
+
+
+/*
+ *  Escapes a buffer containing characters which must be quoted
+ */
+
+static int bench_escape( struct bench* b )
+{
+	int err, i, loops = 100;
+	char *from, *to;
+	unsigned long j, len, size = 65536;
+	uint64_t start;
+
+
+	from = (char*) malloc( size );
+	to = (char*) malloc( size * 2 + 1 );
+
+	if( from == NULL || to == NULL )
+	{
+		free( from ); free( to );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	for( j = 0; j < size; j++ ) { from[j] = ( j % 61 == 0 ) ? '\'' : 'a' + j % 26; }
+
+	start = bench_time();
+
+	for( i = 0; i < loops; i++ )
+	{
+		len = size * 2 + 1;
+
+		if( ( err = odbx_escape( b->handle, from, size, to, &len ) ) < 0 )
+		{
+			free( from ); free( to );
+			return bench_error( b, "odbx_escape", err );
+		}
+	}
+
+	bench_report( b, "escape", 0, (int) size, "MB/s", (double) size * loops / 1e6 / bench_seconds( start ) );
+
+	free( from ); free( to );
+	return 0;
+}
+
+
+
+/*
+ *  Writes and reads large objects if the backend supports them
+ */
+
+static int bench_lo( struct bench* b )
+{
+	int err;
+	char* sql;
+	size_t len;
+	char buffer[65536];
+	odbx_lo_t* lo;
+	odbx_result_t* result;
+	ssize_t bytes;
+	uint64_t start, rtotal = 0, wtotal = 0, rtime = 0, wtime = 0;
+
+
+	if( odbx_capabilities( b->handle, ODBX_CAP_LO ) != ODBX_ENABLE ) { return 0; }
+
+	bench_exec( b, "DROP TABLE odbxbench_lo", 1 );
+	if( ( err = bench_exec( b, "CREATE TABLE odbxbench_lo ( id INTEGER NOT NULL PRIMARY KEY, data BLOB )", 0 ) ) < 0 ) { return err; }
+
+	if( ( sql = (char*) malloc( 4096 ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+
+	len = sprintf( sql, "INSERT INTO odbxbench_lo VALUES (1, '" );
+	memset( sql + len, 'a', 2048 );   // valid as text and as hex digits
+	strcpy( sql + len + 2048, "')" );
+
+	bench_exec( b, "BEGIN", 1 );
+	err = bench_exec( b, sql, 0 );
+	free( sql );
+
+	if( err < 0 ) { return err; }
+
+	if( ( err = odbx_query( b->handle, "SELECT data FROM odbxbench_lo WHERE id = 1 FOR UPDATE", 0 ) ) < 0 )
+	{
+		return bench_error( b, "odbx_query", err );
+	}
+
+	memset( buffer, 'a', sizeof( buffer ) );
+
+	while( ( err = odbx_result( b->handle, &result, NULL, 0 ) ) != ODBX_RES_DONE )
+	{
+		if( err < 0 ) { return bench_error( b, "odbx_result", err ); }
+
+		while( odbx_row_fetch( result ) == ODBX_ROW_NEXT )
+		{
+			if( odbx_lo_open( result, &lo, odbx_field_value( result, 0 ) ) < 0 ) { continue; }
+
+			start = bench_time();
+			while( wtotal < 16 * 1048576 && ( bytes = odbx_lo_write( lo, buffer, sizeof( buffer ) ) ) > 0 ) { wtotal += bytes; }
+			wtime += bench_time() - start;
+
+			odbx_lo_close( lo );
+
+			if( odbx_lo_open( result, &lo, odbx_field_value( result, 0 ) ) < 0 ) { continue; }
+
+			start = bench_time();
+			while( ( bytes = odbx_lo_read( lo, buffer, sizeof( buffer ) ) ) > 0 ) { rtotal += bytes; }
+			rtime += bench_time() - start;
+
+			odbx_lo_close( lo );
+		}
+
+		odbx_result_finish( result );
+	}
+
+	bench_exec( b, "COMMIT", 1 );
+	bench_exec( b, "DROP TABLE odbxbench_lo", 1 );
+
+	if( wtotal > 0 ) { bench_report( b, "lo-write", 0, sizeof( buffer ), "MB/s", (double) wtotal * 1e3 / wtime ); }
+	if( rtotal > 0 ) { bench_report( b, "lo-read", 0, sizeof( buffer ), "MB/s", (double) rtotal * 1e3 / rtime ); }
+
+	return 0;
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	int i, param, err = 0;
+	char table[32];
+	struct bench b;
+	char *backend, *host, *port, *db, *user, *pass;
+
+
+	memset( &b, 0, sizeof( struct bench ) );
+	backend = host = port = db = user = pass = NULL;
+	b.rows = 10000;
+	b.queries = 1000;
+	b.runs = 3;
+
+	while( ( param = getopt( argc, argv, "b:h:p:d:u:w:n:q:r:s:" ) ) != -1 )
+	{
+		switch( param )
+		{
+			case 'b':
+				backend = optarg;
+				break;
+			case 'h':
+				host = optarg;
+				break;
+			case 'p':
+				port = optarg;
+				break;
+			case 'd':
+				db = optarg;
+				break;
+			case 'u':
+				user = optarg;
+				break;
+			case 'w':
+				pass = optarg;
+				break;
+			case 'n':
+				b.rows = strtoul( optarg, NULL, 10 );
+				break;
+			case 'q':
+				b.queries = strtoul( optarg, NULL, 10 );
+				break;
+			case 'r':
+				b.runs = (int) strtol( optarg, NULL, 10 );
+				break;
+			case 's':
+				b.name = optarg;
+				break;
+			default:
+				fprintf( stderr, "Unknown option '%c' with arg '%s'\n", (char) param, optarg );
+				return 1;
+		}
+	}
+
+	if( backend == NULL || db == NULL ) { help( argv[0] ); return 1; }
+
+	if( b.name == NULL ) { b.name = backend; }
+	if( b.rows == 0 ) { b.rows = 1; }
+	if( b.runs < 1 ) { b.runs = 1; }
+
+	if( bench_open( &b, backend, host, port, db, user, pass ) < 0 ) { return 1; }
+
+	for( i = 0; i < LAYOUTMAX && err >= 0; i++ )
+	{
+		sprintf( table, "odbxbench_%d", i );
+
+		if( ( err = bench_insert( &b, table, layouts + i ) ) < 0 ) { break; }
+		if( ( err = bench_scan( &b, table, layouts + i ) ) < 0 ) { break; }
+		if( i == LAYOUTPOINT ) { err = bench_point( &b, table, layouts + i ); }
+
+		sprintf( table, "DROP TABLE odbxbench_%d", i );
+		bench_exec( &b, table, 1 );
+	}
+
+	if( err >= 0 ) { err = bench_escape( &b ); }
+	if( err >= 0 ) { err = bench_lo( &b ); }
+
+	bench_close( &b );
+
+	return err < 0 ? 1 : 0;
+}
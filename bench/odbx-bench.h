@@ -0,0 +1,68 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ *  version 2 or (at your option) any later version.
+ */
+
+
+
+#include <odbx.h>
+
+
+
+#ifndef ODBX_BENCH_H
+#define ODBX_BENCH_H
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+struct bench
+{
+	odbx_t* handle;
+	const char* name;   // backend name in the output
+	unsigned long rows;   // rows per table
+	unsigned long queries;   // number of point queries
+	int runs;   // best of runs is reported
+};
+
+
+
+int bench_open( struct bench* b, const char* backend, const char* host, const char* port, const char* db, const char* user, const char* pass );
+
+void bench_close( struct bench* b );
+
+int bench_error( struct bench* b, const char* function, int err );
+
+/* Executes a statement and discards its results */
+int bench_exec( struct bench* b, const char* sql, int quiet );
+
+/* Creates a table with an integer primary key "id" and cols columns c0, c1, ... of the given width */
+int bench_table( struct bench* b, const char* table, int cols, int width );
+
+/* Inserts the configured number of rows in a single transaction */
+int bench_fill( struct bench* b, const char* table, int cols, int width );
+
+/* Monotonic time in nanoseconds */
+uint64_t bench_time( void );
+
+double bench_seconds( uint64_t start );
+
+/* Writes one tab separated line: version, backend, test, cols, width, value, unit */
+void bench_report( struct bench* b, const char* test, int cols, int width, const char* unit, double value );
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxlib.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "odbx-bench.h"
+
+
+
+int bench_open( struct bench* b, const char* backend, const char* host, const char* port, const char* db, const char* user, const char* pass )
+{
+	int err;
+
+
+	if( ( err = odbx_init( &b->handle, backend, host, port ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_init(): %s\n", odbx_error( NULL, err ) );
+		return err;
+	}
+
+	if( ( err = odbx_bind( b->handle, db, user, pass, ODBX_BIND_SIMPLE ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_bind(): %s\n", odbx_error( b->handle, err ) );
+		odbx_finish( b->handle );
+		return err;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+void bench_close( struct bench* b )
+{
+	odbx_unbind( b->handle );
+	odbx_finish( b->handle );
+}
+
+
+
+int bench_error( struct bench* b, const char* function, int err )
+{
+	fprintf( stderr, "Error in %s(): %s\n", function, odbx_error( b->handle, err ) );
+	return err;
+}
+
+
+
+int bench_exec( struct bench* b, const char* sql, int quiet )
+{
+	int err;
+	odbx_result_t* result;
+
+
+	if( ( err = odbx_query( b->handle, sql, 0 ) ) < 0 )
+	{
+		return quiet ? err : bench_error( b, "odbx_query", err );
+	}
+
+	while( ( err = odbx_result( b->handle, &result, NULL, 0 ) ) != ODBX_RES_DONE )
+	{
+		if( err < 0 ) { return quiet ? err : bench_error( b, "odbx_result", err ); }
+
+		odbx_result_finish( result );
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int bench_table( struct bench* b, const char* table, int cols, int width )
+{
+	int c, err;
+	size_t len;
+	char* sql;
+
+
+	if( ( sql = (char*) malloc( cols * 32 + 128 ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+
+	sprintf( sql, "DROP TABLE %s", table );
+	bench_exec( b, sql, 1 );
+
+	len = sprintf( sql, "CREATE TABLE %s ( id INTEGER NOT NULL PRIMARY KEY", table );
+	for( c = 0; c < cols; c++ ) { len += sprintf( sql + len, ", c%d VARCHAR(%d)", c, width ); }
+	strcpy( sql + len, " )" );
+
+	err = bench_exec( b, sql, 0 );
+
+	free( sql );
+	return err;
+}
+
+
+
+int bench_fill( struct bench* b, const char* table, int cols, int width )
+{
+	int c, err = ODBX_ERR_SUCCESS;
+	char* sql;
+	size_t len;
+	unsigned long i;
+
+
+	if( ( sql = (char*) malloc( cols * ( width + 3 ) + 128 ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+
+	bench_exec( b, "BEGIN", 1 );   // not available for all databases
+
+	for( i = 0; i < b->rows; i++ )
+	{
+		len = sprintf( sql, "INSERT INTO %s VALUES (%lu", table, i );
+
+		for( c = 0; c < cols; c++ )
+		{
+			sql[len++] = ',';
+			sql[len++] = '\'';
+			memset( sql + len, 'a' + ( i + c ) % 26, width );
+			len += width;
+			sql[len++] = '\'';
+		}
+
+		sql[len++] = ')';
+		sql[len] = 0;
+
+		if( ( err = bench_exec( b, sql, 0 ) ) < 0 ) { break; }
+	}
+
+	bench_exec( b, "COMMIT", 1 );
+
+	free( sql );
+	return err;
+}
+
+
+
+uint64_t bench_time( void )
+{
+	return _odbx_lib_time();
+}
+
+
+
+double bench_seconds( uint64_t start )
+{
+	uint64_t diff = _odbx_lib_time() - start;
+
+	return diff > 0 ? (double) diff / 1e9 : 1e-9;
+}
+
+
+
+void bench_report( struct bench* b, const char* test, int cols, int width, const char* unit, double value )
+{
+	fprintf( stdout, "%s\t%s\t%s\t%d\t%d\t%.3f\t%s\n", PACKAGE_VERSION, b->name, test, cols, width, value, unit );
+	fflush( stdout );
+}
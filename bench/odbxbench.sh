@@ -0,0 +1,98 @@
+#!/bin/sh
+
+#
+# Automated benchmarks
+#
+# Runs the benchmarks against SQLite3, the null backend and the other
+# backends listed in the odbxtest.site file of the regression tests. The
+# null backend doesn't do any I/O and shows the overhead of the library
+# and the C++ wrapper only. The results are
+# written as tab separated values to bench.out:
+#
+# version  backend  benchmark  columns  width  value  unit
+#
+
+SRCDIR=${1:-.}
+ODBXAPP="./odbxbench ./odbxplusbench"
+
+# Defaults for running without configuration
+ODBXBENCH_ROWS=${ODBXBENCH_ROWS:-10000}
+ODBXBENCH_QUERIES=${ODBXBENCH_QUERIES:-1000}
+ODBXTEST_BACKENDS=""
+
+SQLITE3_HOST="./"
+SQLITE3_PORT=""
+SQLITE3_DATABASE="odbxbench.sq3"
+SQLITE3_USERNAME=""
+SQLITE3_PASSWORD=""
+
+# Import database parameter
+for site in ../test/odbxtest.site $SRCDIR/../test/odbxtest.site
+do
+	if test -f $site
+	then
+		. $site
+		break
+	fi
+done
+
+# SQLite3 always uses its own database file
+SQLITE3_HOST="./"
+SQLITE3_DATABASE="odbxbench.sq3"
+
+# Synthetic result sets of the null backend
+NULL_HOST=""
+NULL_PORT=""
+NULL_DATABASE="rows=$ODBXBENCH_ROWS cols=4 size=64"
+NULL_USERNAME=""
+NULL_PASSWORD=""
+
+
+echo "# `date`" > bench.out
+echo "# version	backend	benchmark	columns	width	value	unit" >> bench.out
+
+for backend in sqlite3 null `echo $ODBXTEST_BACKENDS | sed -e 's/sqlite3//' -e 's/null//'`
+do
+	library="../backends/$backend/.libs/lib${backend}backend.so"
+
+	if ! test -f $library
+	then
+		echo "  $backend SKIPPED (not built)"
+		continue
+	fi
+
+	prefix=`echo $backend | tr 'a-z' 'A-Z'`
+	eval host=\"\$${prefix}_HOST\"
+	eval port=\"\$${prefix}_PORT\"
+	eval database=\"\$${prefix}_DATABASE\"
+	eval username=\"\$${prefix}_USERNAME\"
+	eval password=\"\$${prefix}_PASSWORD\"
+
+	for app in $ODBXAPP
+	do
+		echo "  $backend $app"
+
+		$app \
+			-b "$library" \
+			-h "$host" \
+			-p "$port" \
+			-d "$database" \
+			-u "$username" \
+			-w "$password" \
+			-n "$ODBXBENCH_ROWS" \
+			-q "$ODBXBENCH_QUERIES" \
+			-s "$backend" \
+			>> bench.out
+
+		if test $? -ne 0
+		then
+			echo "  $backend $app FAILED"
+		fi
+	done
+done
+
+rm -f odbxbench.sq3
+
+cat bench.out
+
+exit 0
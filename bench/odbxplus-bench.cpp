@@ -0,0 +1,271 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include <opendbx/api>
+#include <unistd.h>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include "odbx-bench.h"
+
+
+
+using namespace OpenDBX;
+
+
+
+#define COLS 4
+#define WIDTH 64
+
+
+
+void help( char* name )
+{
+	std::cout << "Usage: " << name << " <options>" << std::endl;
+	std::cout << "   -b <backend>    Database backend (mysql, pgsql, sqlite, sqlite3, firebird, freetds, sybase)" << std::endl;
+	std::cout << "   -h <server>     Server name, IP address or directory" << std::endl;
+	std::cout << "   -p <port>       Server port" << std::endl;
+	std::cout << "   -d <database>   Database or file name" << std::endl;
+	std::cout << "   -u <user>       User name for authentication" << std::endl;
+	std::cout << "   -w <password>   Password for authentication" << std::endl;
+	std::cout << "   -n <rows>       Number of rows of the table (default 10000)" << std::endl;
+	std::cout << "   -q <queries>    Number of point queries (default 1000)" << std::endl;
+	std::cout << "   -r <runs>       Number of scans, the fastest one is reported (default 3)" << std::endl;
+	std::cout << "   -s <name>       Name of the backend in the output" << std::endl;
+}
+
+
+
+/*
+ *  Full scans and point queries using the C API
+ */
+
+static uint64_t scan_c( struct bench* b, const char* sql )
+{
+	unsigned long c, cols;
+	uint64_t start = bench_time();
+	odbx_result_t* result;
+
+
+	if( odbx_query( b->handle, sql, 0 ) < 0 ) { return 0; }
+
+	while( odbx_result( b->handle, &result, NULL, 0 ) > 0 )
+	{
+		cols = odbx_column_count( result );
+
+		while( odbx_row_fetch( result ) == ODBX_ROW_NEXT )
+		{
+			for( c = 0; c < cols; c++ )
+			{
+				odbx_field_value( result, c );
+				odbx_field_length( result, c );
+			}
+		}
+
+		odbx_result_finish( result );
+	}
+
+	return bench_time() - start;
+}
+
+
+
+static uint64_t point_c( struct bench* b )
+{
+	char sql[128];
+	unsigned long i;
+	uint64_t start = bench_time();
+
+
+	for( i = 0; i < b->queries; i++ )
+	{
+		sprintf( sql, "SELECT * FROM odbxbench_plus WHERE id = %lu", i % b->rows );
+		scan_c( b, sql );
+	}
+
+	return bench_time() - start;
+}
+
+
+
+/*
+ *  Full scans and point queries using the C++ API
+ */
+
+static uint64_t scan_cxx( Conn& conn, const string& sql )
+{
+	unsigned long c, cols;
+	uint64_t start = bench_time();
+
+
+	Result result = conn.create( sql ).execute();
+
+	while( result.getResult() != ODBX_RES_DONE )
+	{
+		cols = result.columnCount();
+
+		while( result.getRow() != ODBX_ROW_DONE )
+		{
+			for( c = 0; c < cols; c++ )
+			{
+				result.fieldValue( c );
+				result.fieldLength( c );
+			}
+		}
+	}
+
+	return bench_time() - start;
+}
+
+
+
+static uint64_t point_cxx( struct bench* b, Conn& conn )
+{
+	char sql[128];
+	unsigned long i;
+	uint64_t start = bench_time();
+
+
+	for( i = 0; i < b->queries; i++ )
+	{
+		sprintf( sql, "SELECT * FROM odbxbench_plus WHERE id = %lu", i % b->rows );
+		scan_cxx( conn, string( sql ) );
+	}
+
+	return bench_time() - start;
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	int run, param;
+	struct bench b;
+	uint64_t t, ct = 0, cxxt = 0;
+	const char* sql = "SELECT * FROM odbxbench_plus";
+	char *backend, *host, *port, *db, *user, *pass;
+
+
+	memset( &b, 0, sizeof( struct bench ) );
+	backend = host = port = db = user = pass = NULL;
+	b.rows = 10000;
+	b.queries = 1000;
+	b.runs = 3;
+
+	while( ( param = getopt( argc, argv, "b:h:p:d:u:w:n:q:r:s:" ) ) != -1 )
+	{
+		switch( param )
+		{
+			case 'b':
+				backend = optarg;
+				break;
+			case 'h':
+				host = optarg;
+				break;
+			case 'p':
+				port = optarg;
+				break;
+			case 'd':
+				db = optarg;
+				break;
+			case 'u':
+				user = optarg;
+				break;
+			case 'w':
+				pass = optarg;
+				break;
+			case 'n':
+				b.rows = strtoul( optarg, NULL, 10 );
+				break;
+			case 'q':
+				b.queries = strtoul( optarg, NULL, 10 );
+				break;
+			case 'r':
+				b.runs = (int) strtol( optarg, NULL, 10 );
+				break;
+			case 's':
+				b.name = optarg;
+				break;
+			default:
+				std::cerr << "Unknown option '" << (char) param << "' with arg '" << optarg << "'" << std::endl;
+				return 1;
+		}
+	}
+
+	if( backend == NULL || db == NULL ) { help( argv[0] ); return 1; }
+
+	if( host == NULL ) { host = (char*) ""; }
+	if( port == NULL ) { port = (char*) ""; }
+	if( user == NULL ) { user = (char*) ""; }
+	if( pass == NULL ) { pass = (char*) ""; }
+
+	if( b.name == NULL ) { b.name = backend; }
+	if( b.rows == 0 ) { b.rows = 1; }
+	if( b.runs < 1 ) { b.runs = 1; }
+
+	if( bench_open( &b, backend, host, port, db, user, pass ) < 0 ) { return 1; }
+
+	if( bench_table( &b, "odbxbench_plus", COLS, WIDTH ) < 0 || bench_fill( &b, "odbxbench_plus", COLS, WIDTH ) < 0 )
+	{
+		bench_close( &b );
+		return 1;
+	}
+
+	try
+	{
+		Conn conn( backend, host, port );
+		conn.bind( db, user, pass );
+
+		for( run = 0; run < b.runs; run++ )
+		{
+			if( ( t = scan_c( &b, sql ) ) != 0 && ( ct == 0 || t < ct ) ) { ct = t; }
+			if( ( t = scan_cxx( conn, string( sql ) ) ) != 0 && ( cxxt == 0 || t < cxxt ) ) { cxxt = t; }
+		}
+
+		if( ct == 0 || cxxt == 0 ) { throw std::runtime_error( "Scanning the table failed" ); }
+
+		bench_report( &b, "scan-c", COLS, WIDTH, "rows/s", (double) b.rows * 1e9 / ct );
+		bench_report( &b, "scan-cxx", COLS, WIDTH, "rows/s", (double) b.rows * 1e9 / cxxt );
+		bench_report( &b, "scan-cxx-overhead", COLS, WIDTH, "%", ( (double) cxxt / ct - 1.0 ) * 100.0 );
+
+		if( b.queries > 0 )
+		{
+			ct = point_c( &b );
+			cxxt = point_cxx( &b, conn );
+
+			bench_report( &b, "point-c", COLS, WIDTH, "us", (double) ct / b.queries / 1e3 );
+			bench_report( &b, "point-cxx", COLS, WIDTH, "us", (double) cxxt / b.queries / 1e3 );
+			bench_report( &b, "point-cxx-overhead", COLS, WIDTH, "%", ( (double) cxxt / ct - 1.0 ) * 100.0 );
+		}
+
+		conn.finish();
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		bench_close( &b );
+		return 1;
+	}
+
+	bench_exec( &b, "DROP TABLE odbxbench_plus", 1 );
+	bench_close( &b );
+
+	return 0;
+}
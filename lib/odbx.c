@@ -11,6 +11,13 @@
 #include "opendbx/api.h"
 #include "odbxdrv.h"
 #include "odbxlib.h"
+#include "odbxcache.h"
+#include "odbxstats.h"
+#include "odbxtrace.h"
+#include "odbxrec.h"
+#include "odbxtimer.h"
+#include "odbxprobe.h"
+#include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -32,6 +39,7 @@ static const char* odbx_errmsg[] = {
 	gettext_noop("Waiting for result failed"),
 	gettext_noop("Not supported"),
 	gettext_noop("Invalid handle"),
+	gettext_noop("Operation canceled"),
 };
 
 
@@ -67,9 +75,23 @@ int odbx_init( odbx_t** handle, const char* backend, const char* host, const cha
 	(*handle)->backend = NULL;
 	(*handle)->generic = NULL;
 	(*handle)->aux = NULL;
+	(*handle)->database = NULL;
+	(*handle)->cache = NULL;
+	(*handle)->trace = NULL;
+	(*handle)->rec = NULL;
+
+	memset( &(*handle)->stats, 0, sizeof( struct odbx_hstats ) );
+	memset( &(*handle)->timer, 0, sizeof( struct odbx_htimer ) );
+
+	if( ( (*handle)->name = _odbx_lib_strdup( backend ) ) == NULL )
+	{
+		free( *handle );
+		return -ODBX_ERR_NOMEM;
+	}
 
 	if( ( err = _odbx_lib_open( *handle, backend ) ) < 0 )
 	{
+		free( (*handle)->name );
 		free( *handle );
 		return err;
 	}
@@ -80,15 +102,18 @@ int odbx_init( odbx_t** handle, const char* backend, const char* host, const cha
 		{
 			_odbx_lib_close( *handle );
 
+			free( (*handle)->name );
 			free( *handle );
 			*handle = NULL;
 		}
 
+		ODBX_PROBE3( init, *handle, backend, err );
 		return err;
 	}
 
 	_odbx_lib_close( *handle );
 
+	free( (*handle)->name );
 	free( *handle );
 	*handle = NULL;
 
@@ -103,7 +128,23 @@ int odbx_bind( odbx_t* handle, const char* database, const char* who, const char
 
 	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL && handle->ops->basic->bind != NULL )
 	{
-		return handle->ops->basic->bind( handle, database, who, cred, method );
+		int err;
+
+		if( ( err = handle->ops->basic->bind( handle, database, who, cred, method ) ) == ODBX_ERR_SUCCESS )
+		{
+			if( handle->stats.bound ) { handle->stats.total.reconnects++; }
+			handle->stats.bound = 1;
+
+			free( handle->database );
+
+			if( ( handle->database = _odbx_lib_strdup( database ) ) == NULL )
+			{
+				return -ODBX_ERR_NOMEM;
+			}
+		}
+
+		ODBX_PROBE4( bind, handle, handle->name, database, err );
+		return err;
 	}
 
 	return -ODBX_ERR_HANDLE;
@@ -124,6 +165,8 @@ int odbx_unbind( odbx_t* handle )
 {
 	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL && handle->ops->basic->unbind != NULL )
 	{
+		if( handle->timer.armed ) { _odbx_timer_disarm( handle ); }
+
 		return handle->ops->basic->unbind( handle );
 	}
 
@@ -138,6 +181,8 @@ int odbx_finish( odbx_t* handle )
 	{
 		int err;
 
+		if( handle->timer.armed ) { _odbx_timer_disarm( handle ); }
+
 		if( ( err = handle->ops->basic->finish( handle ) ) < 0 )
 		{
 			return err;
@@ -148,7 +193,16 @@ int odbx_finish( odbx_t* handle )
 			return err;
 		}
 
+		if( handle->cache != NULL ) { _odbx_cache_detach( handle ); }
+		if( handle->rec != NULL ) { _odbx_rec_close( handle ); }
+
+		_odbx_stats_flush( &handle->stats );
+
+		free( handle->trace );
+		handle->trace = NULL;
 		handle->ops = NULL;
+		free( handle->database );
+		free( handle->name );
 		free( handle );
 
 		return ODBX_ERR_SUCCESS;
@@ -171,6 +225,9 @@ int odbx_capabilities( odbx_t* handle, unsigned int cap )
 			case ODBX_CAP_LO:
 				if( handle->ops->lo != NULL ) { return ODBX_ENABLE; }
 				break;
+			case ODBX_CAP_STMT:
+				if( handle->ops->stmt != NULL ) { return ODBX_ENABLE; }
+				break;
 		}
 		return ODBX_DISABLE;
 	}
@@ -192,6 +249,12 @@ int odbx_get_option( odbx_t* handle, unsigned int option, void* value )
 
 	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL && handle->ops->basic->get_option != NULL )
 	{
+		if( option == ODBX_OPT_QUERY_TIMEOUT )
+		{
+			*(int*) value = handle->ops->basic->cancel != NULL ? ODBX_ENABLE : ODBX_DISABLE;
+			return ODBX_ERR_SUCCESS;
+		}
+
 		return handle->ops->basic->get_option( handle, option, value );
 	}
 
@@ -221,6 +284,15 @@ int odbx_set_option( odbx_t* handle, unsigned int option, void* value )
 
 	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL && handle->ops->basic->set_option != NULL )
 	{
+		if( option == ODBX_OPT_QUERY_TIMEOUT )   // milliseconds, enforced by the library
+		{
+			if( handle->ops->basic->cancel == NULL ) { return -ODBX_ERR_OPTWR; }
+			if( *(unsigned int*) value != 0 && _odbx_timer_init() < 0 ) { return -ODBX_ERR_OPTWR; }
+
+			handle->timer.timeout = (uint64_t) *(unsigned int*) value * 1000000;
+			return ODBX_ERR_SUCCESS;
+		}
+
 		return handle->ops->basic->set_option( handle, option, value );
 	}
 
@@ -321,12 +393,46 @@ int odbx_escape( odbx_t* handle, const char* from, unsigned long fromlen, char*
 
 int odbx_query( odbx_t* handle, const char* query, unsigned long length )
 {
+	int err;
+
 	if( query == NULL ) { return ODBX_ERR_PARAM; }
 	if( length == 0 ) { length = (unsigned long) strlen( query ); }
 
 	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL && handle->ops->basic->query != NULL )
 	{
-		return handle->ops->basic->query( handle, query, length );
+		handle->stats.total.queries++;
+		handle->stats.query = _odbx_lib_time();
+		handle->stats.first = 1;
+
+		ODBX_PROBE4( query, handle, handle->name, query, length );
+
+		if( handle->trace != NULL ) { _odbx_trace_query( handle, query, length ); }
+		if( handle->rec != NULL ) { _odbx_rec_query( handle, query, length ); }
+		if( handle->timer.armed ) { _odbx_timer_disarm( handle ); }
+
+		__atomic_store_n( &handle->timer.canceled, 0, __ATOMIC_RELEASE );
+
+		if( handle->cache != NULL )
+		{
+			if( ( err = _odbx_cache_query( handle, query, length ) ) != 0 )
+			{
+				return err < 0 ? err : ODBX_ERR_SUCCESS;   // result sets are replayed from cache
+			}
+		}
+
+		if( handle->timer.timeout != 0 ) { _odbx_timer_arm( handle ); }
+
+		if( ( err = handle->ops->basic->query( handle, query, length ) ) < 0 )
+		{
+			if( handle->timer.armed ) { _odbx_timer_disarm( handle ); }
+
+			err = _odbx_timer_error( handle, err );
+
+			if( handle->trace != NULL ) { _odbx_trace_error( handle, err ); }
+			if( handle->rec != NULL ) { _odbx_rec_error( handle, ODBX_REC_FAILED, err ); }
+		}
+
+		return err;
 	}
 
 	return -ODBX_ERR_HANDLE;
@@ -339,17 +445,54 @@ int odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout
 	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL && handle->ops->basic->result != NULL )
 	{
 		int err;
+		uint64_t now, start = _odbx_lib_time();
 		*result = NULL;
 
-		if( ( err = handle->ops->basic->result( handle, result, timeout, chunk ) ) > ODBX_RES_TIMEOUT )   // for ODBX_RES_NOROWS and ODBX_RES_ROWS
+		ODBX_PROBE2( result__entry, handle, handle->name );
+
+		if( handle->cache != NULL && handle->cache->replay != NULL )
 		{
-			if( *result ) { (*result)->handle = handle; }
+			err = _odbx_cache_result( handle, result );
 		}
 		else
 		{
-			*result = NULL;
+			if( ( err = handle->ops->basic->result( handle, result, timeout, chunk ) ) > ODBX_RES_TIMEOUT )   // for ODBX_RES_NOROWS and ODBX_RES_ROWS
+			{
+				if( *result ) { (*result)->handle = handle; }
+			}
+			else
+			{
+				*result = NULL;
+
+				if( handle->timer.armed && err != ODBX_RES_TIMEOUT ) { _odbx_timer_disarm( handle ); }
+
+				err = _odbx_timer_error( handle, err );
+			}
+
+			if( handle->cache != NULL && handle->cache->record ) { _odbx_cache_record( handle, *result, err ); }
+		}
+
+		now = _odbx_lib_time();
+		handle->stats.total.result_wait += now - start;
+
+		ODBX_PROBE4( result__return, handle, handle->name, err, now - start );
+
+		if( err > ODBX_RES_TIMEOUT )
+		{
+			handle->stats.total.results++;
+			handle->stats.result = now;
+			handle->stats.rows = handle->stats.total.rows;
+
+			if( handle->stats.first )
+			{
+				_odbx_stats_latency( handle->stats.total.first_result, now - handle->stats.query );
+				handle->stats.first = 0;
+			}
 		}
 
+		if( handle->trace != NULL ) { _odbx_trace_result( handle, *result, err ); }
+		if( handle->rec != NULL ) { _odbx_rec_result( handle, *result, err ); }
+
 		return err;
 	}
 
@@ -358,13 +501,60 @@ int odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout
 
 
 
+/*
+ *  Backends must be able to cancel the running statement while another
+ *  thread is using the handle, but it must not be unbound or finished
+ *  concurrently
+ */
+
+int odbx_cancel( odbx_t* handle )
+{
+	if( handle != NULL && handle->ops != NULL && handle->ops->basic != NULL )
+	{
+		if( handle->ops->basic->cancel == NULL ) { return -ODBX_ERR_NOTSUP; }
+
+		__atomic_store_n( &handle->timer.canceled, 1, __ATOMIC_RELEASE );
+
+		return handle->ops->basic->cancel( handle );
+	}
+
+	return -ODBX_ERR_HANDLE;
+}
+
+
+
 int odbx_result_finish( odbx_result_t* result )
 {
 	if( result != NULL && result->handle != NULL && result->handle->ops != NULL && result->handle->ops->basic != NULL &&
 		result->handle->ops->basic->result_finish != NULL && result->handle->ops->basic->row_fetch != NULL )
 	{
-		while( result->handle->ops->basic->row_fetch( result ) == ODBX_ROW_NEXT );
-		return result->handle->ops->basic->result_finish( result );
+		int err;
+		odbx_t* handle = result->handle;
+
+		if( handle->rec != NULL ) { _odbx_rec_result_finish( result ); }   // before the cache, see there
+		if( handle->cache != NULL ) { _odbx_cache_result_finish( result ); }
+
+		while( handle->ops->basic->row_fetch( result ) == ODBX_ROW_NEXT );
+
+		if( _odbx_mat_get( result ) == NULL )   // not for materialized result sets
+		{
+			uint64_t drain = _odbx_lib_time() - handle->stats.result;
+
+			ODBX_PROBE4( result__finish, handle, handle->name, handle->stats.total.rows - handle->stats.rows, drain );
+
+			_odbx_stats_latency( handle->stats.total.drain, drain );
+			_odbx_stats_flush( &handle->stats );
+		}
+
+		if( handle->trace == NULL )   // pseudo handles of materialized result sets are freed too
+		{
+			return handle->ops->basic->result_finish( result );
+		}
+
+		err = handle->ops->basic->result_finish( result );
+		_odbx_trace_finish( handle, err );
+
+		return err;
 	}
 
 	return -ODBX_ERR_HANDLE;
@@ -386,7 +576,17 @@ int odbx_row_fetch( odbx_result_t* result )
 	if( result != NULL && result->handle != NULL && result->handle->ops != NULL &&
 		result->handle->ops->basic != NULL && result->handle->ops->basic->row_fetch != NULL )
 	{
-		return result->handle->ops->basic->row_fetch( result );
+		uint64_t start = result->handle->rec != NULL ? _odbx_lib_time() : 0;
+		int err = _odbx_timer_error( result->handle, result->handle->ops->basic->row_fetch( result ) );
+
+		if( err == ODBX_ROW_NEXT ) { result->handle->stats.total.rows++; }
+		if( result->handle->cache != NULL ) { _odbx_cache_row( result, err ); }
+		if( result->handle->trace != NULL ) { _odbx_trace_row( result, err ); }
+		if( result->handle->rec != NULL ) { _odbx_rec_row( result, err, start ); }
+
+		ODBX_PROBE_ROWS( result->handle, result, err );
+
+		return err;
 	}
 
 	return -ODBX_ERR_HANDLE;
@@ -451,7 +651,10 @@ unsigned long odbx_field_length( odbx_result_t* result, unsigned long pos )
 	if( result != NULL && result->handle != NULL && result->handle->ops != NULL &&
 		result->handle->ops->basic != NULL && result->handle->ops->basic->field_length != NULL )
 	{
-		return result->handle->ops->basic->field_length( result, pos );
+		unsigned long len = result->handle->ops->basic->field_length( result, pos );
+
+		result->handle->stats.total.bytes += len;
+		return len;
 	}
 
 	return 0;
@@ -474,6 +677,166 @@ const char* odbx_field_value( odbx_result_t* result, unsigned long pos )
 
 
 
+/*
+ *   ODBX prepared statement operations
+ */
+
+int odbx_stmt_prepare( odbx_t* handle, odbx_stmt_t** stmt, const char* query, unsigned long length )
+{
+	int err;
+
+	if( stmt == NULL || query == NULL ) { return -ODBX_ERR_PARAM; }
+	if( length == 0 ) { length = (unsigned long) strlen( query ); }
+
+	if( handle == NULL || handle->ops == NULL ) { return -ODBX_ERR_HANDLE; }
+	if( handle->ops->stmt == NULL || handle->ops->stmt->prepare == NULL ) { return -ODBX_ERR_NOCAP; }
+
+	if( ( *stmt = (odbx_stmt_t*) calloc( 1, sizeof( struct odbx_stmt_t ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	if( ( (*stmt)->query = (char*) malloc( length + 1 ) ) == NULL )
+	{
+		free( *stmt );
+		*stmt = NULL;
+		return -ODBX_ERR_NOMEM;
+	}
+
+	memcpy( (*stmt)->query, query, length );
+	(*stmt)->query[length] = '\0';
+	(*stmt)->length = length;
+	(*stmt)->handle = handle;
+
+	if( ( err = handle->ops->stmt->prepare( *stmt, query, length ) ) < 0 )
+	{
+		free( (*stmt)->query );
+		free( *stmt );
+		*stmt = NULL;
+	}
+
+	return err;
+}
+
+
+
+unsigned long odbx_stmt_count( odbx_stmt_t* stmt )
+{
+	if( stmt != NULL ) { return stmt->count; }
+
+	return 0;
+}
+
+
+
+/*
+ *  Values are copied by the backends, so they can be freed or changed
+ *  after binding them
+ */
+
+int odbx_stmt_bind( odbx_stmt_t* stmt, unsigned long pos, int type, const void* value, unsigned long length )
+{
+	double real;
+
+	if( stmt == NULL || stmt->handle == NULL || stmt->handle->ops == NULL || stmt->handle->ops->stmt == NULL ||
+		stmt->handle->ops->stmt->bind == NULL )
+	{
+		return -ODBX_ERR_HANDLE;
+	}
+
+	if( pos >= stmt->count || ( type != ODBX_PARAM_NULL && value == NULL ) ) { return -ODBX_ERR_PARAM; }
+
+	switch( type )
+	{
+		case ODBX_PARAM_DOUBLE:
+			memcpy( &real, value, sizeof( double ) );
+			if( !isfinite( real ) ) { return -ODBX_ERR_PARAM; }   // no portable SQL representation
+			/* fall through */
+		case ODBX_PARAM_NULL:
+		case ODBX_PARAM_INT64:
+		case ODBX_PARAM_TEXT:
+		case ODBX_PARAM_BLOB:
+			return stmt->handle->ops->stmt->bind( stmt, pos, type, value, length );
+	}
+
+	return -ODBX_ERR_PARAM;
+}
+
+
+
+/*
+ *  Result sets of prepared statements depend on the bound values and aren't
+ *  cached but executing a statement may invalidate cached result sets
+ */
+
+int odbx_stmt_execute( odbx_stmt_t* stmt )
+{
+	int err;
+	odbx_t* handle;
+
+	if( stmt == NULL || stmt->handle == NULL || stmt->handle->ops == NULL || stmt->handle->ops->stmt == NULL ||
+		stmt->handle->ops->stmt->execute == NULL )
+	{
+		return -ODBX_ERR_HANDLE;
+	}
+
+	handle = stmt->handle;
+	handle->stats.total.queries++;
+	handle->stats.query = _odbx_lib_time();
+	handle->stats.first = 1;
+
+	ODBX_PROBE4( query, handle, handle->name, stmt->query, stmt->length );
+
+	if( handle->trace != NULL ) { _odbx_trace_query( handle, stmt->query, stmt->length ); }
+	if( handle->rec != NULL ) { _odbx_rec_query( handle, stmt->query, stmt->length ); }
+
+	if( handle->timer.armed ) { _odbx_timer_disarm( handle ); }
+
+	__atomic_store_n( &handle->timer.canceled, 0, __ATOMIC_RELEASE );
+
+	if( handle->cache != NULL && ( err = _odbx_cache_bypass( handle, stmt->query, stmt->length ) ) < 0 )
+	{
+		return err;
+	}
+
+	if( handle->timer.timeout != 0 ) { _odbx_timer_arm( handle ); }
+
+	if( ( err = handle->ops->stmt->execute( stmt ) ) < 0 )
+	{
+		if( handle->timer.armed ) { _odbx_timer_disarm( handle ); }
+
+		err = _odbx_timer_error( handle, err );
+
+		if( handle->trace != NULL ) { _odbx_trace_error( handle, err ); }
+		if( handle->rec != NULL ) { _odbx_rec_error( handle, ODBX_REC_FAILED, err ); }
+	}
+
+	return err;
+}
+
+
+
+int odbx_stmt_finish( odbx_stmt_t* stmt )
+{
+	int err = -ODBX_ERR_HANDLE;
+
+	if( stmt == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	if( stmt->handle != NULL && stmt->handle->ops != NULL && stmt->handle->ops->stmt != NULL && stmt->handle->ops->stmt->finish != NULL )
+	{
+		err = stmt->handle->ops->stmt->finish( stmt );
+	}
+
+	free( stmt->query );
+	free( stmt );
+
+	return err;
+}
+
+
+
+
+
 /*
  *   ODBX large object operations
  */
@@ -510,7 +873,12 @@ ssize_t odbx_lo_read( odbx_lo_t* lo, void* buffer, size_t buflen )
 
 	if( lo != NULL && lo->result != NULL && lo->result->handle != NULL && lo->result->handle->ops != NULL && lo->result->handle->ops->lo != NULL && lo->result->handle->ops->lo->read != NULL )
 	{
-		return lo->result->handle->ops->lo->read( lo, buffer, buflen );
+		ssize_t len = lo->result->handle->ops->lo->read( lo, buffer, buflen );
+
+		if( len > 0 ) { lo->result->handle->stats.total.lo_read += len; }
+
+		ODBX_PROBE3( lo__read, lo->result->handle, lo, len );
+		return len;
 	}
 
 	return -ODBX_ERR_HANDLE;
@@ -524,7 +892,12 @@ ssize_t odbx_lo_write( odbx_lo_t* lo, void* buffer, size_t buflen )
 
 	if( lo != NULL && lo->result != NULL && lo->result->handle != NULL && lo->result->handle->ops != NULL && lo->result->handle->ops->lo != NULL && lo->result->handle->ops->lo->write != NULL )
 	{
-		return lo->result->handle->ops->lo->write( lo, buffer, buflen );
+		ssize_t len = lo->result->handle->ops->lo->write( lo, buffer, buflen );
+
+		if( len > 0 ) { lo->result->handle->stats.total.lo_written += len; }
+
+		ODBX_PROBE3( lo__write, lo->result->handle, lo, len );
+		return len;
 	}
 
 	return -ODBX_ERR_HANDLE;
@@ -26,7 +26,7 @@ namespace OpenDBX
 	 *  OpenDBX exception implementation
 	 */
 
-	Exception::Exception( const string& msg, int error, int type ) throw() : std::runtime_error( msg )
+	Exception::Exception( const string& msg, int error, int type ) noexcept : std::runtime_error( msg )
 	{
 		m_error = error;
 		m_type = type;
@@ -34,14 +34,14 @@ namespace OpenDBX
 
 
 
-	int Exception::getCode() const throw()
+	int Exception::getCode() const noexcept
 	{
 		return m_error;
 	}
 
 
 
-	int Exception::getType() const throw()
+	int Exception::getType() const noexcept
 	{
 		return m_type;
 	}
@@ -54,81 +54,79 @@ namespace OpenDBX
 	*  OpenDBX large object interface
 	*/
 
-	Lob::Lob( Lob_Iface* impl ) throw( std::exception )
+	Lob::Lob( Lob_Iface* impl ) noexcept
 	{
 		m_impl = impl;
-		m_ref = new int;
-
-		*m_ref = 1;
 	}
 
 
 
-	Lob::Lob( const Lob& ref ) throw()
+	Lob::Lob( const Lob& ref ) noexcept
 	{
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
-		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+		if( m_impl != NULL ) { m_impl->acquire(); }
+	}
 
-		++(*m_ref);
+
+
+	Lob::Lob( Lob&& ref ) noexcept
+	{
+		m_impl = ref.m_impl;
+		ref.m_impl = NULL;
 	}
 
 
-	Lob::~Lob() throw()
+
+	Lob::~Lob() noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-				delete m_impl;
-				delete m_ref;
-		}
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 	}
 
 
 
-	Lob& Lob::operator=( const Lob& ref ) throw()
+	Lob& Lob::operator=( const Lob& ref ) noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( ref.m_impl != NULL ) { ref.m_impl->acquire(); }
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
+		return *this;
+	}
+
+
+
+	Lob& Lob::operator=( Lob&& ref ) noexcept
+	{
+		if( this != &ref )
 		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+			if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
-		++(*m_ref);
+			m_impl = ref.m_impl;
+			ref.m_impl = NULL;
+		}
 
 		return *this;
 	}
 
 
 
-	void Lob::close() throw( std::exception )
+	void Lob::close()
 	{
 		return m_impl->close();
 	}
 
 
 
-	ssize_t Lob::read( void* buffer, size_t buflen ) throw( std::exception )
+	ssize_t Lob::read( void* buffer, size_t buflen )
 	{
 		return m_impl->read( buffer, buflen );
 	}
 
 
 
-	ssize_t Lob::write( void* buffer, size_t buflen ) throw( std::exception )
+	ssize_t Lob::write( void* buffer, size_t buflen )
 	{
 		return m_impl->write( buffer, buflen );
 	}
@@ -143,143 +141,225 @@ namespace OpenDBX
 
 
 
-	Result::Result( Result_Iface* impl ) throw( std::exception )
+	Result::Result( Result_Iface* impl ) noexcept
 	{
 		m_impl = impl;
-		m_ref = new int;
-
-		*m_ref = 1;
 	}
 
 
 
-	Result::Result( const Result& ref ) throw()
+	Result::Result( const Result& ref ) noexcept
 	{
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
-		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+		if( m_impl != NULL ) { m_impl->acquire(); }
+	}
+
 
-		++(*m_ref);
+
+	Result::Result( Result&& ref ) noexcept
+	{
+		m_impl = ref.m_impl;
+		ref.m_impl = NULL;
 	}
 
 
 
-	Result::~Result() throw()
+	Result::~Result() noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 	}
 
 
 
-	Result& Result::operator=( const Result& ref ) throw()
+	Result& Result::operator=( const Result& ref ) noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( ref.m_impl != NULL ) { ref.m_impl->acquire(); }
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
+		return *this;
+	}
+
+
+
+	Result& Result::operator=( Result&& ref ) noexcept
+	{
+		if( this != &ref )
 		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+			if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
-		++(*m_ref);
+			m_impl = ref.m_impl;
+			ref.m_impl = NULL;
+		}
 
 		return *this;
 	}
 
 
 
-	void Result::finish() throw( std::exception )
+	void Result::finish()
 	{
 		return m_impl->finish();
 	}
 
 
 
-	odbxres Result::getResult( struct timeval* timeout, unsigned long chunk ) throw( std::exception )
+	odbxres Result::getResult( struct timeval* timeout, unsigned long chunk )
 	{
 		return m_impl->getResult( timeout, chunk );
 	}
 
 
 
-	odbxrow Result::getRow() throw( std::exception )
+	odbxrow Result::getRow()
 	{
 		return m_impl->getRow();
 	}
 
 
 
-	uint64_t Result::rowsAffected() throw( std::exception )
+	unsigned long Result::getRows( unsigned long rows, vector<const char*>& values, vector<unsigned long>& lengths )
+	{
+		return m_impl->getRows( rows, values, lengths );
+	}
+
+
+
+	uint64_t Result::rowsAffected()
 	{
 		return m_impl->rowsAffected();
 	}
 
 
 
-	unsigned long Result::columnCount() throw( std::exception )
+	unsigned long Result::columnCount()
 	{
 		return m_impl->columnCount();
 	}
 
 
 
-	unsigned long Result::columnPos( const string& name ) throw( std::exception )
+	unsigned long Result::columnPos( const string& name )
 	{
 		return m_impl->columnPos( name );
 	}
 
 
 
-	const string Result::columnName( unsigned long pos ) throw( std::exception )
+	const string& Result::columnName( unsigned long pos )
 	{
 		return m_impl->columnName( pos );
 	}
 
 
 
-	odbxtype Result::columnType( unsigned long pos ) throw( std::exception )
+	odbxtype Result::columnType( unsigned long pos )
 	{
 		return m_impl->columnType( pos );
 	}
 
 
 
-	unsigned long Result::fieldLength( unsigned long pos ) throw( std::exception )
+	unsigned long Result::fieldLength( unsigned long pos )
 	{
 		return m_impl->fieldLength( pos );
 	}
 
 
 
-	const char* Result::fieldValue( unsigned long pos ) throw( std::exception )
+	const char* Result::fieldValue( unsigned long pos )
 	{
 		return m_impl->fieldValue( pos );
 	}
 
 
-	Lob Result::getLob( const char* value ) throw( std::exception )
+
+	const char* Result::fieldValue( unsigned long pos, unsigned long& length )
+	{
+		return m_impl->fieldValue( pos, length );
+	}
+
+
+	Lob Result::getLob( const char* value )
 	{
 		return m_impl->getLob( value );
 	}
 
 
 
+	ResultSets Result::sets( unsigned long batch, unsigned long chunk )
+	{
+		return ResultSets( *this, batch, chunk );
+	}
+
+
+
+	MaterializedResult Result::materialize()
+	{
+		odbxres stat;
+		vector<MaterializedResult::Set>* sets = new vector<MaterializedResult::Set>();
+		MaterializedResult result;
+
+		result.m_sets.reset( sets );
+
+		while( ( stat = m_impl->getResult( NULL, 0 ) ) != ODBX_RES_DONE )
+		{
+			if( stat == ODBX_RES_TIMEOUT ) { continue; }
+
+			sets->push_back( MaterializedResult::Set( m_impl->detach() ) );
+		}
+
+		return result;
+	}
+
+
+
+	/*
+	*  OpenDBX materialized result interface
+	*/
+
+	static void _release( odbx_result_t* result )
+	{
+		odbx_result_finish( result );
+	}
+
+
+
+	MaterializedResult::Set::Set( odbx_result_t* detached ) : m_block( detached, _release )
+	{
+		unsigned long i;
+		const char* name;
+
+		m_affected = odbx_rows_affected( detached );
+		m_cols = odbx_column_count( detached );
+		m_status = m_cols > 0 ? ODBX_RES_ROWS : ODBX_RES_NOROWS;
+		m_rows = 0;
+
+		m_names.reserve( m_cols );
+		m_types.reserve( m_cols );
+
+		for( i = 0; i < m_cols; i++ )
+		{
+			name = odbx_column_name( detached, i );
+			m_names.push_back( name != NULL ? string( name ) : string() );
+			m_types.push_back( (odbxtype) odbx_column_type( detached, i ) );
+		}
+
+		while( odbx_row_fetch( detached ) == ODBX_ROW_NEXT )
+		{
+			for( i = 0; i < m_cols; i++ )
+			{
+				m_values.push_back( odbx_field_value( detached, i ) );
+				m_lengths.push_back( odbx_field_length( detached, i ) );
+			}
+			m_rows++;
+		}
+	}
+
+
+
 
 
 	/*
@@ -288,82 +368,131 @@ namespace OpenDBX
 
 
 
-	Stmt::Stmt( Stmt_Iface* impl ) throw( std::exception )
+	Stmt::Stmt( Stmt_Iface* impl ) noexcept
 	{
 		m_impl = impl;
-		m_ref = new int;
-
-		*m_ref = 1;
 	}
 
 
 
-	Stmt::Stmt( const Stmt& ref ) throw()
+	Stmt::Stmt( const Stmt& ref ) noexcept
 	{
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
-		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+		if( m_impl != NULL ) { m_impl->acquire(); }
+	}
+
 
-		++(*m_ref);
+
+	Stmt::Stmt( Stmt&& ref ) noexcept
+	{
+		m_impl = ref.m_impl;
+		ref.m_impl = NULL;
 	}
 
 
 
-	Stmt::~Stmt() throw()
+	Stmt::~Stmt() noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 	}
 
 
 
-	Stmt& Stmt::operator=( const Stmt& ref ) throw()
+	Stmt& Stmt::operator=( const Stmt& ref ) noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( ref.m_impl != NULL ) { ref.m_impl->acquire(); }
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
+		return *this;
+	}
+
+
+
+	Stmt& Stmt::operator=( Stmt&& ref ) noexcept
+	{
+		if( this != &ref )
 		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+			if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
-		++(*m_ref);
+			m_impl = ref.m_impl;
+			ref.m_impl = NULL;
+		}
 
 		return *this;
 	}
 
 
 
-// 	void Stmt::bind( const void* data, unsigned long size, size_t pos, int flags )
-// 	{
-// 		m_impl->bind( data, size, pos, flags );
-// 	}
+	void Stmt::bind( const void* data, unsigned long size, size_t pos, int flags )
+	{
+		m_impl->bind( data, size, pos, flags );
+	}
 
 
 
-// 	size_t Stmt::count()
-// 	{
-// 		return m_impl->count();
-// 	}
+	void Stmt::bind( size_t pos, int64_t value )
+	{
+		m_impl->bindParam( pos, ODBX_PARAM_INT64, &value, sizeof( int64_t ) );
+	}
 
 
 
-	Result Stmt::execute() throw( std::exception )
+	void Stmt::bind( size_t pos, int value )
+	{
+		int64_t num = value;
+
+		m_impl->bindParam( pos, ODBX_PARAM_INT64, &num, sizeof( int64_t ) );
+	}
+
+
+
+	void Stmt::bind( size_t pos, double value )
+	{
+		m_impl->bindParam( pos, ODBX_PARAM_DOUBLE, &value, sizeof( double ) );
+	}
+
+
+
+	void Stmt::bind( size_t pos, const string& value )
+	{
+		m_impl->bindParam( pos, ODBX_PARAM_TEXT, value.data(), value.size() );
+	}
+
+
+
+	void Stmt::bind( size_t pos, const char* value )
+	{
+		if( value == NULL ) { m_impl->bindParam( pos, ODBX_PARAM_NULL, NULL, 0 ); }
+		else { m_impl->bindParam( pos, ODBX_PARAM_TEXT, value, std::strlen( value ) ); }
+	}
+
+
+
+	void Stmt::bindBlob( size_t pos, const void* data, unsigned long size )
+	{
+		m_impl->bindParam( pos, ODBX_PARAM_BLOB, data, size );
+	}
+
+
+
+	void Stmt::bindNull( size_t pos )
+	{
+		m_impl->bindParam( pos, ODBX_PARAM_NULL, NULL, 0 );
+	}
+
+
+
+	size_t Stmt::count()
+	{
+		return m_impl->count();
+	}
+
+
+
+	Result Stmt::execute()
 	{
 		return Result( m_impl->execute() );
 	}
@@ -377,84 +506,79 @@ namespace OpenDBX
 	*/
 
 
-	Conn::Conn() throw()
+	Conn::Conn() noexcept
 	{
 		m_impl = NULL;
-		m_ref = NULL;
 	}
 
 
-	Conn::Conn( const char* backend, const char* host, const char* port ) throw( std::exception )
+
+	Conn::Conn( const char* backend, const char* host, const char* port )
 	{
 		m_impl = new Conn_Impl( backend, host, port );
-		m_ref = new int;
-
-		*m_ref = 1;
 	}
 
 
-	Conn::Conn( const string& backend, const string& host, const string& port ) throw( std::exception )
+
+	Conn::Conn( const string& backend, const string& host, const string& port )
 	{
 		m_impl = new Conn_Impl( backend.c_str(), host.c_str(), port.c_str() );
-		m_ref = new int;
-
-		*m_ref = 1;
 	}
 
 
 
-	Conn::Conn( const Conn& ref ) throw()
+	Conn::Conn( const Conn& ref ) noexcept
 	{
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
-		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+		if( m_impl != NULL ) { m_impl->acquire(); }
+	}
+
+
 
-		++(*m_ref);
+	Conn::Conn( Conn&& ref ) noexcept
+	{
+		m_impl = ref.m_impl;
+		ref.m_impl = NULL;
 	}
 
 
 
-	Conn::~Conn() throw()
+	Conn::~Conn() noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 	}
 
 
 
-	Conn& Conn::operator=( const Conn& ref ) throw()
+	Conn& Conn::operator=( const Conn& ref ) noexcept
 	{
-		if( m_ref != NULL && --(*m_ref) == 0 )
-		{
-			delete m_impl;
-			delete m_ref;
-		}
+		if( ref.m_impl != NULL ) { ref.m_impl->acquire(); }
+		if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
 		m_impl = ref.m_impl;
-		m_ref = ref.m_ref;
 
-		if( m_ref == NULL )
+		return *this;
+	}
+
+
+
+	Conn& Conn::operator=( Conn&& ref ) noexcept
+	{
+		if( this != &ref )
 		{
-			m_ref = new int;
-			*m_ref = 0;
-		}
+			if( m_impl != NULL && m_impl->release() ) { delete m_impl; }
 
-		++(*m_ref);
+			m_impl = ref.m_impl;
+			ref.m_impl = NULL;
+		}
 
 		return *this;
 	}
 
 
 
-	void Conn::bind( const char* database, const char* who, const char* cred, odbxbind method ) throw( std::exception )
+	void Conn::bind( const char* database, const char* who, const char* cred, odbxbind method )
 	{
 		if( m_impl == NULL )
 		{
@@ -466,7 +590,7 @@ namespace OpenDBX
 
 
 
-	void Conn::bind( const string& database, const string& who, const string& cred, odbxbind method ) throw( std::exception )
+	void Conn::bind( const string& database, const string& who, const string& cred, odbxbind method )
 	{
 		if( m_impl == NULL )
 		{
@@ -478,7 +602,7 @@ namespace OpenDBX
 
 
 
-	void Conn::unbind() throw( std::exception )
+	void Conn::unbind()
 	{
 		if( m_impl == NULL )
 		{
@@ -490,7 +614,19 @@ namespace OpenDBX
 
 
 
-	void Conn::finish() throw( std::exception )
+	void Conn::cancel()
+	{
+		if( m_impl == NULL )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_HANDLE ) ), -ODBX_ERR_HANDLE, odbx_error_type( NULL, -ODBX_ERR_HANDLE ) );
+		}
+
+		m_impl->cancel();
+	}
+
+
+
+	void Conn::finish()
 	{
 		if( m_impl == NULL )
 		{
@@ -502,7 +638,7 @@ namespace OpenDBX
 
 
 
-	bool Conn::getCapability( odbxcap cap ) throw( std::exception )
+	bool Conn::getCapability( odbxcap cap )
 	{
 		if( m_impl == NULL )
 		{
@@ -514,7 +650,7 @@ namespace OpenDBX
 
 
 
-	void Conn::getOption( odbxopt option, void* value ) throw( std::exception )
+	void Conn::getOption( odbxopt option, void* value )
 	{
 		if( m_impl == NULL )
 		{
@@ -526,7 +662,7 @@ namespace OpenDBX
 
 
 
-	void Conn::setOption( odbxopt option, void* value ) throw( std::exception )
+	void Conn::setOption( odbxopt option, void* value )
 	{
 		if( m_impl == NULL )
 		{
@@ -538,7 +674,7 @@ namespace OpenDBX
 
 
 
-	string& Conn::escape( const string& from, string& to ) throw( std::exception )
+	string& Conn::escape( const string& from, string& to )
 	{
 		if( m_impl == NULL )
 		{
@@ -550,7 +686,7 @@ namespace OpenDBX
 
 
 
-	string& Conn::escape( const char* from, unsigned long fromlen, string& to ) throw( std::exception )
+	string& Conn::escape( const char* from, unsigned long fromlen, string& to )
 	{
 		if( m_impl == NULL )
 		{
@@ -562,7 +698,7 @@ namespace OpenDBX
 
 
 
-	Stmt Conn::create( const char* sql, unsigned long length, Stmt::Type type ) throw( std::exception )
+	Stmt Conn::create( const char* sql, unsigned long length, Stmt::Type type )
 	{
 		if( length == 0 ) { length = (unsigned long) strlen( sql ); }
 
@@ -571,7 +707,14 @@ namespace OpenDBX
 
 
 
-	Stmt Conn::create( const string& sql, Stmt::Type type ) throw( std::exception )
+	Stmt Conn::create( const char* sql, Stmt::Type type )
+	{
+		return this->create( string( sql ), type );
+	}
+
+
+
+	Stmt Conn::create( const string& sql, Stmt::Type type )
 	{
 		if( m_impl == NULL )
 		{
@@ -583,4 +726,74 @@ namespace OpenDBX
 
 
 
+
+
+	/*
+	*  OpenDBX trace interface
+	*/
+
+
+	static void _trace_query( odbx_t* handle, const struct odbx_trace* trace, void* arg )
+	{
+		static_cast<Conn::Trace*>( arg )->query( *trace );
+	}
+
+
+	static void _trace_result( odbx_t* handle, const struct odbx_trace* trace, void* arg )
+	{
+		static_cast<Conn::Trace*>( arg )->result( *trace );
+	}
+
+
+	static void _trace_rows( odbx_t* handle, const struct odbx_trace* trace, void* arg )
+	{
+		static_cast<Conn::Trace*>( arg )->rows( *trace );
+	}
+
+
+	static void _trace_finish( odbx_t* handle, const struct odbx_trace* trace, void* arg )
+	{
+		static_cast<Conn::Trace*>( arg )->finish( *trace );
+	}
+
+
+	static void _trace_error( odbx_t* handle, const struct odbx_trace* trace, void* arg )
+	{
+		static_cast<Conn::Trace*>( arg )->error( *trace );
+	}
+
+
+
+	Conn::Trace::Trace( Conn& conn, unsigned long batch ) : m_conn( conn )
+	{
+		struct odbx_trace_hooks hooks;
+
+		if( m_conn.m_impl == NULL )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_HANDLE ) ), -ODBX_ERR_HANDLE, odbx_error_type( NULL, -ODBX_ERR_HANDLE ) );
+		}
+
+		hooks.query = _trace_query;
+		hooks.result = _trace_result;
+		hooks.rows = _trace_rows;
+		hooks.finish = _trace_finish;
+		hooks.error = _trace_error;
+		hooks.batch = batch;
+
+		m_conn.m_impl->setTraceHooks( &hooks, this );
+	}
+
+
+
+	Conn::Trace::~Trace() noexcept
+	{
+		try
+		{
+			m_conn.m_impl->unsetTraceHooks( this );
+		}
+		catch( std::exception& e ) {}   // connection was already finished
+	}
+
+
+
 }   // namespace OpenDBX
@@ -0,0 +1,612 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbx_async.hpp"
+#include "opendbx/async"
+#include <algorithm>
+#include <stdint.h>
+
+
+
+
+/*
+ *  Asynchronous execution of statements by a pool of connections
+ */
+
+namespace OpenDBX
+{
+
+	/*
+	 *  Results are returned via the callback or the promise of the job,
+	 *  which is deleted after the last reference is released
+	 */
+
+	static std::exception_ptr _canceled()
+	{
+		return std::make_exception_ptr( Exception( string( odbx_error( NULL, -ODBX_ERR_CANCELED ) ),
+			-ODBX_ERR_CANCELED, odbx_error_type( NULL, -ODBX_ERR_CANCELED ) ) );
+	}
+
+
+
+	static void _deliver( AsyncJob* job, MaterializedResult& result, std::exception_ptr error )
+	{
+		if( job->callback )
+		{
+			try {
+				job->callback( result, error );
+			} catch( ... ) {}   // there's nobody to report it to
+		}
+		else if( error )
+		{
+			job->promise.set_exception( error );
+		}
+		else
+		{
+			job->promise.set_value( result );
+		}
+	}
+
+
+
+	static void _release( AsyncJob* job )
+	{
+		if( job->refs.fetch_sub( 1 ) == 1 ) { delete job; }
+	}
+
+
+
+
+
+	/*
+	*  OpenDBX asynchronous executor interface
+	*/
+
+	const unsigned long AsyncExecutor::NoAffinity;
+
+
+
+	AsyncExecutor::AsyncExecutor( Factory factory, unsigned long connections, unsigned long depth )
+	{
+		m_impl = new AsyncExecutor_Impl( factory, connections, depth );
+	}
+
+
+
+	AsyncExecutor::~AsyncExecutor() noexcept
+	{
+		delete m_impl;
+	}
+
+
+
+	std::future<MaterializedResult> AsyncExecutor::submit( const string& sql, unsigned long affinity, Token token )
+	{
+		AsyncJob* job = new AsyncJob();
+		std::future<MaterializedResult> future = job->promise.get_future();
+
+		job->sql = sql;
+		job->token = token;
+
+		m_impl->submit( job, affinity );
+
+		return future;
+	}
+
+
+
+	void AsyncExecutor::submit( const string& sql, Callback callback, unsigned long affinity, Token token )
+	{
+		AsyncJob* job = new AsyncJob();
+
+		job->sql = sql;
+		job->token = token;
+		job->callback = callback;
+
+		m_impl->submit( job, affinity );
+	}
+
+
+
+	unsigned long AsyncExecutor::pending() const noexcept
+	{
+		return m_impl->pending();
+	}
+
+
+
+	/*
+	 *  Connections can't be replaced by the workers while the token holds
+	 *  its mutex, so they are still valid when cancel() is called. Waiting
+	 *  jobs are answered outside the lock because callbacks may submit new
+	 *  statements. The workers only discard them afterwards.
+	 */
+
+	void AsyncExecutor::Token::cancel() noexcept
+	{
+		std::vector<AsyncJob*> waiting;
+
+		{
+			std::lock_guard<std::mutex> lock( m_state->mutex );
+
+			m_state->canceled.store( true );
+			waiting.swap( m_state->waiting );
+
+			for( size_t i = 0; i < waiting.size(); i++ ) { waiting[i]->refs++; }
+
+			for( size_t i = 0; i < m_state->running.size(); i++ )
+			{
+				try {
+					m_state->running[i]->cancel();
+				} catch( ... ) {}   // the statement isn't interrupted but finishes normally
+			}
+		}
+
+		for( size_t i = 0; i < waiting.size(); i++ )
+		{
+			MaterializedResult result;
+
+			_deliver( waiting[i], result, _canceled() );
+			_release( waiting[i] );
+		}
+	}
+
+
+
+
+
+	/*
+	 *  OpenDBX lock-free queue implementation
+	 */
+
+	static size_t _cells( size_t depth )
+	{
+		size_t size = 2;
+
+		while( size < depth ) { size <<= 1; }
+
+		return size;
+	}
+
+
+
+	AsyncQueue::AsyncQueue( size_t depth ) : m_cells( _cells( depth ) ), m_head( 0 ), m_tail( 0 )
+	{
+		m_mask = m_cells.size() - 1;
+
+		for( size_t i = 0; i < m_cells.size(); i++ )
+		{
+			m_cells[i].seq.store( i, std::memory_order_relaxed );
+			m_cells[i].job = NULL;
+		}
+	}
+
+
+
+	bool AsyncQueue::push( AsyncJob* job )
+	{
+		Cell* cell;
+		intptr_t diff;
+		size_t pos = m_tail.load( std::memory_order_relaxed );
+
+		while( true )
+		{
+			cell = &m_cells[pos & m_mask];
+			diff = (intptr_t) cell->seq.load( std::memory_order_acquire ) - (intptr_t) pos;
+
+			if( diff == 0 )
+			{
+				if( m_tail.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) { break; }
+			}
+			else if( diff < 0 )
+			{
+				return false;   // full
+			}
+			else
+			{
+				pos = m_tail.load( std::memory_order_relaxed );
+			}
+		}
+
+		cell->job = job;
+		cell->seq.store( pos + 1, std::memory_order_release );
+
+		return true;
+	}
+
+
+
+	AsyncJob* AsyncQueue::pop()
+	{
+		Cell* cell;
+		intptr_t diff;
+		AsyncJob* job;
+		size_t pos = m_head.load( std::memory_order_relaxed );
+
+		while( true )
+		{
+			cell = &m_cells[pos & m_mask];
+			diff = (intptr_t) cell->seq.load( std::memory_order_acquire ) - (intptr_t) ( pos + 1 );
+
+			if( diff == 0 )
+			{
+				if( m_head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) { break; }
+			}
+			else if( diff < 0 )
+			{
+				return NULL;   // empty
+			}
+			else
+			{
+				pos = m_head.load( std::memory_order_relaxed );
+			}
+		}
+
+		job = cell->job;
+		cell->seq.store( pos + m_mask + 1, std::memory_order_release );
+
+		return job;
+	}
+
+
+
+	size_t AsyncQueue::size() const
+	{
+		size_t head = m_head.load( std::memory_order_relaxed );
+		size_t tail = m_tail.load( std::memory_order_relaxed );
+
+		return tail > head ? tail - head : 0;
+	}
+
+
+
+
+
+	/*
+	 *  OpenDBX asynchronous executor implementation
+	 *
+	 *  Workers and producers only take the mutex before they go to sleep.
+	 *  They register themselves in m_idle or m_full first and try the queue
+	 *  again while holding the mutex, so a job or free cell can't get lost
+	 *  between the last try and waiting for the condition.
+	 */
+
+	AsyncExecutor_Impl::AsyncExecutor_Impl( AsyncExecutor::Factory factory, unsigned long connections, unsigned long depth ) :
+		m_factory( factory ), m_queue( depth ), m_idle( 0 ), m_full( 0 ), m_stop( false )
+	{
+		AsyncWorker* worker;
+
+		if( connections == 0 || !factory )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		}
+
+		try
+		{
+			for( unsigned long i = 0; i < connections; i++ )
+			{
+				m_workers.push_back( worker = new AsyncWorker( depth ) );
+
+				worker->conn = m_factory();
+				worker->bound = true;
+			}
+
+			for( unsigned long i = 0; i < connections; i++ )
+			{
+				m_workers[i]->thread = std::thread( &AsyncExecutor_Impl::_run, this, m_workers[i] );
+			}
+		}
+		catch( ... )
+		{
+			this->_stop();
+			throw;
+		}
+	}
+
+
+
+	AsyncExecutor_Impl::~AsyncExecutor_Impl() noexcept
+	{
+		this->_stop();
+	}
+
+
+
+	void AsyncExecutor_Impl::submit( AsyncJob* job, unsigned long affinity )
+	{
+		AsyncQueue& queue = affinity == AsyncExecutor::NoAffinity ? m_queue : m_workers[affinity % m_workers.size()]->queue;
+		bool queued;
+
+		try {
+			queued = this->_enqueue( job );
+		} catch( ... ) {
+			delete job;
+			throw;
+		}
+
+		if( !queued )
+		{
+			MaterializedResult result;
+
+			_deliver( job, result, _canceled() );
+			_release( job );
+			return;
+		}
+
+		if( !queue.push( job ) )
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+
+			m_full++;
+
+			while( !m_stop && !queue.push( job ) ) { m_space.wait( lock ); }
+
+			m_full--;
+
+			if( m_stop )
+			{
+				lock.unlock();
+				this->_discard( job );
+				return;
+			}
+		}
+
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+
+		if( m_idle.load() > 0 )
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_work.notify_all();
+		}
+	}
+
+
+
+	unsigned long AsyncExecutor_Impl::pending() const
+	{
+		unsigned long count = m_queue.size();
+
+		for( size_t i = 0; i < m_workers.size(); i++ )
+		{
+			count += m_workers[i]->queue.size();
+		}
+
+		return count;
+	}
+
+
+
+	/*
+	 *  Jobs bound to the connection of the worker are preferred
+	 */
+
+	AsyncJob* AsyncExecutor_Impl::_take( AsyncWorker* worker )
+	{
+		AsyncJob* job;
+
+		if( ( job = worker->queue.pop() ) == NULL ) { job = m_queue.pop(); }
+
+		return job;
+	}
+
+
+
+	AsyncJob* AsyncExecutor_Impl::_wait( AsyncWorker* worker )
+	{
+		AsyncJob* job;
+
+		if( m_stop ) { return NULL; }
+
+		if( ( job = this->_take( worker ) ) == NULL )
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+
+			m_idle++;
+
+			while( !m_stop && ( job = this->_take( worker ) ) == NULL ) { m_work.wait( lock ); }
+
+			m_idle--;
+		}
+
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+
+		if( job != NULL && m_full.load() > 0 )
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_space.notify_all();
+		}
+
+		return job;
+	}
+
+
+
+	void AsyncExecutor_Impl::_run( AsyncWorker* worker )
+	{
+		AsyncJob* job;
+
+		while( ( job = this->_wait( worker ) ) != NULL )
+		{
+			this->_execute( worker, job );
+		}
+	}
+
+
+
+	/*
+	 *  Lost connections are replaced by a new one from the factory before
+	 *  the next job is executed. The connection is registered in the token
+	 *  while the statement is running, so canceling it interrupts the
+	 *  statement too.
+	 */
+
+	void AsyncExecutor_Impl::_execute( AsyncWorker* worker, AsyncJob* job )
+	{
+		MaterializedResult result;
+		std::exception_ptr error;
+
+		if( !this->_dequeue( job ) )   // already answered by Token::cancel()
+		{
+			_release( job );
+			return;
+		}
+
+		if( job->token.isCanceled() )
+		{
+			error = _canceled();
+		}
+		else
+		{
+			try
+			{
+				if( !worker->bound )
+				{
+					worker->conn = m_factory();
+					worker->bound = true;
+				}
+
+				if( !this->_attach( job->token, &worker->conn ) )
+				{
+					throw Exception( string( odbx_error( NULL, -ODBX_ERR_CANCELED ) ), -ODBX_ERR_CANCELED, odbx_error_type( NULL, -ODBX_ERR_CANCELED ) );
+				}
+
+				try
+				{
+					result = worker->conn.create( job->sql ).execute().materialize();
+				}
+				catch( ... )
+				{
+					this->_detach( job->token, &worker->conn );
+					throw;
+				}
+
+				this->_detach( job->token, &worker->conn );
+			}
+			catch( Exception& oe )
+			{
+				error = std::current_exception();
+
+				if( oe.getType() < 0 )
+				{
+					worker->conn = Conn();
+					worker->bound = false;
+				}
+			}
+			catch( ... )
+			{
+				error = std::current_exception();
+			}
+		}
+
+		_deliver( job, result, error );
+		_release( job );
+	}
+
+
+
+	/*
+	 *  Jobs are registered in their token while they are queued, so
+	 *  Token::cancel() can answer them without waiting for a worker. Jobs
+	 *  of canceled tokens aren't queued at all.
+	 */
+
+	bool AsyncExecutor_Impl::_enqueue( AsyncJob* job )
+	{
+		std::lock_guard<std::mutex> lock( job->token.m_state->mutex );
+
+		if( job->token.m_state->canceled.load() ) { return false; }
+
+		job->token.m_state->waiting.push_back( job );
+		return true;
+	}
+
+
+
+	bool AsyncExecutor_Impl::_dequeue( AsyncJob* job )
+	{
+		std::lock_guard<std::mutex> lock( job->token.m_state->mutex );
+		std::vector<AsyncJob*>& waiting = job->token.m_state->waiting;
+		std::vector<AsyncJob*>::iterator it = std::find( waiting.begin(), waiting.end(), job );
+
+		if( it == waiting.end() ) { return false; }
+
+		waiting.erase( it );
+		return true;
+	}
+
+
+
+	void AsyncExecutor_Impl::_discard( AsyncJob* job )
+	{
+		MaterializedResult result;
+
+		if( this->_dequeue( job ) ) { _deliver( job, result, _canceled() ); }
+
+		_release( job );
+	}
+
+
+
+	bool AsyncExecutor_Impl::_attach( AsyncExecutor::Token& token, Conn* conn )
+	{
+		std::lock_guard<std::mutex> lock( token.m_state->mutex );
+
+		if( token.m_state->canceled.load() ) { return false; }
+
+		token.m_state->running.push_back( conn );
+		return true;
+	}
+
+
+
+	void AsyncExecutor_Impl::_detach( AsyncExecutor::Token& token, Conn* conn )
+	{
+		std::lock_guard<std::mutex> lock( token.m_state->mutex );
+		std::vector<Conn*>& running = token.m_state->running;
+
+		running.erase( std::find( running.begin(), running.end(), conn ) );
+	}
+
+
+
+	/*
+	 *  Running jobs are finished by the workers while the waiting ones are
+	 *  canceled afterwards
+	 */
+
+	void AsyncExecutor_Impl::_stop()
+	{
+		AsyncJob* job;
+
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+
+			m_stop = true;
+			m_work.notify_all();
+			m_space.notify_all();
+		}
+
+		for( size_t i = 0; i < m_workers.size(); i++ )
+		{
+			if( m_workers[i]->thread.joinable() ) { m_workers[i]->thread.join(); }
+		}
+
+		for( size_t i = 0; i < m_workers.size(); i++ )
+		{
+			while( ( job = m_workers[i]->queue.pop() ) != NULL ) { this->_discard( job ); }
+			delete m_workers[i];
+		}
+
+		while( ( job = m_queue.pop() ) != NULL ) { this->_discard( job ); }
+
+		m_workers.clear();
+	}
+
+}   // namespace OpenDBX
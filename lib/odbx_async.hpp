@@ -0,0 +1,138 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "lib/opendbx/api"
+#include "lib/opendbx/async"
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+
+
+
+#ifndef ODBX_ASYNC_IMPL_HPP
+#define ODBX_ASYNC_IMPL_HPP
+
+
+
+namespace OpenDBX
+{
+	using std::string;
+	using std::vector;
+
+
+
+	/*
+	 *  Statement waiting for execution. Either the promise or the callback
+	 *  is used to return the result. The job is referenced by its queue and
+	 *  temporarily by Token::cancel() if it answers the job while it's still
+	 *  queued.
+	 */
+
+	struct AsyncJob
+	{
+		string sql;
+		AsyncExecutor::Token token;
+		AsyncExecutor::Callback callback;
+		std::promise<MaterializedResult> promise;
+		std::atomic<int> refs;
+
+		AsyncJob() : refs( 1 ) {}
+	};
+
+
+
+	/*
+	 *  Bounded multi-producer/multi-consumer queue. Each cell has a sequence
+	 *  number telling producers and consumers if it's their turn, so neither
+	 *  of them needs a lock.
+	 */
+
+	class AsyncQueue
+	{
+		struct Cell
+		{
+			std::atomic<size_t> seq;
+			AsyncJob* job;
+		};
+
+		vector<Cell> m_cells;
+		size_t m_mask;
+		std::atomic<size_t> m_head;   // next cell to take a job from
+		std::atomic<size_t> m_tail;   // next cell to put a job into
+
+	public:
+
+		AsyncQueue( size_t depth );
+
+		bool push( AsyncJob* job );
+		AsyncJob* pop();
+
+		size_t size() const;
+	};
+
+
+
+	class AsyncWorker
+	{
+	public:
+
+		AsyncQueue queue;   // jobs bound to this connection
+		std::thread thread;
+		Conn conn;
+		bool bound;   // conn was created by the factory
+
+		AsyncWorker( size_t depth ) : queue( depth ), bound( false ) {}
+	};
+
+
+
+	class AsyncExecutor_Impl
+	{
+		AsyncExecutor::Factory m_factory;
+		AsyncQueue m_queue;   // jobs for any connection
+		vector<AsyncWorker*> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_work;   // signaled after a job was queued
+		std::condition_variable m_space;   // signaled after a job was taken
+		std::atomic<unsigned long> m_idle;   // workers waiting for jobs
+		std::atomic<unsigned long> m_full;   // producers waiting for space
+		std::atomic<bool> m_stop;
+
+	protected:
+
+		AsyncJob* _take( AsyncWorker* worker );
+		AsyncJob* _wait( AsyncWorker* worker );
+		void _run( AsyncWorker* worker );
+		void _execute( AsyncWorker* worker, AsyncJob* job );
+		bool _enqueue( AsyncJob* job );
+		bool _dequeue( AsyncJob* job );
+		void _discard( AsyncJob* job );
+		bool _attach( AsyncExecutor::Token& token, Conn* conn );
+		void _detach( AsyncExecutor::Token& token, Conn* conn );
+		void _stop();
+
+	public:
+
+		AsyncExecutor_Impl( AsyncExecutor::Factory factory, unsigned long connections, unsigned long depth );
+		~AsyncExecutor_Impl() noexcept;
+
+		void submit( AsyncJob* job, unsigned long affinity );
+		unsigned long pending() const;
+	};
+
+}   // namespace OpenDBX
+
+
+
+#endif
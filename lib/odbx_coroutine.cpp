@@ -0,0 +1,365 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbx_coroutine.hpp"
+#include "odbxdrv.h"
+#include <system_error>
+#include <cerrno>
+#include <stdint.h>
+
+#if defined( HAVE_SYS_EPOLL_H ) && defined( HAVE_SYS_EVENTFD_H )
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define ODBX_EPOLL 1
+#endif
+
+
+
+
+/*
+ *  Event loop for coroutines awaiting the database
+ */
+
+namespace OpenDBX
+{
+
+	/*
+	*  OpenDBX epoll reactor interface
+	*/
+
+	EpollReactor::EpollReactor( unsigned long threads )
+	{
+		m_impl = new EpollReactor_Impl( threads );
+	}
+
+
+
+	EpollReactor::~EpollReactor() noexcept
+	{
+		delete m_impl;
+	}
+
+
+
+	void EpollReactor::run()
+	{
+		m_impl->run();
+	}
+
+
+
+	void EpollReactor::stop() noexcept
+	{
+		m_impl->stop();
+	}
+
+
+
+	void EpollReactor::watch( int fd, Task ready )
+	{
+		m_impl->watch( fd, ready );
+	}
+
+
+
+	void EpollReactor::post( Task task )
+	{
+		m_impl->post( task );
+	}
+
+
+
+	void EpollReactor::offload( Task work, Task done )
+	{
+		m_impl->offload( work, done );
+	}
+
+
+
+
+
+	/*
+	 *  OpenDBX epoll reactor implementation
+	 */
+
+	EpollReactor_Impl::EpollReactor_Impl( unsigned long threads ) :
+		m_epoll( -1 ), m_wake( -1 ), m_busy( 0 ), m_stop( false ), m_exit( false )
+	{
+		if( threads == 0 )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		}
+
+#ifdef ODBX_EPOLL
+		struct epoll_event event;
+
+		if( ( m_epoll = epoll_create1( EPOLL_CLOEXEC ) ) == -1 ||
+			( m_wake = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK ) ) == -1 )
+		{
+			int err = errno;
+
+			this->_close();
+			throw std::system_error( err, std::generic_category() );
+		}
+
+		event.events = EPOLLIN;
+		event.data.u64 = 0;
+		event.data.fd = m_wake;
+
+		if( epoll_ctl( m_epoll, EPOLL_CTL_ADD, m_wake, &event ) == -1 )
+		{
+			int err = errno;
+
+			this->_close();
+			throw std::system_error( err, std::generic_category() );
+		}
+
+		try
+		{
+			for( unsigned long i = 0; i < threads; i++ )
+			{
+				m_threads.push_back( std::thread( &EpollReactor_Impl::_run, this ) );
+			}
+		}
+		catch( ... )
+		{
+			this->_close();
+			throw;
+		}
+#else
+		throw Exception( string( odbx_error( NULL, -ODBX_ERR_NOTSUP ) ), -ODBX_ERR_NOTSUP, odbx_error_type( NULL, -ODBX_ERR_NOTSUP ) );
+#endif
+	}
+
+
+
+	EpollReactor_Impl::~EpollReactor_Impl() noexcept
+	{
+		this->_close();
+	}
+
+
+
+	/*
+	 *  Posted and ready tasks are preferred to waiting for new events
+	 */
+
+	void EpollReactor_Impl::run()
+	{
+#ifdef ODBX_EPOLL
+		int i, fd, count;
+		uint64_t value;
+		Reactor::Task task;
+		struct epoll_event events[64];
+		std::map<int, Reactor::Task>::iterator it;
+
+		while( true )
+		{
+			{
+				std::lock_guard<std::mutex> lock( m_mutex );
+
+				if( m_stop )
+				{
+					m_stop = false;
+					return;
+				}
+
+				if( m_tasks.empty() && m_watches.empty() && m_busy == 0 ) { return; }
+
+				if( !m_tasks.empty() )
+				{
+					task = std::move( m_tasks.front() );
+					m_tasks.pop_front();
+				}
+			}
+
+			if( task )
+			{
+				Reactor::Task current( std::move( task ) );
+
+				task = nullptr;
+				current();
+				continue;
+			}
+
+			while( ( count = epoll_wait( m_epoll, events, 64, -1 ) ) == -1 && errno == EINTR );
+
+			if( count == -1 ) { throw std::system_error( errno, std::generic_category() ); }
+
+			std::lock_guard<std::mutex> lock( m_mutex );
+
+			for( i = 0; i < count; i++ )
+			{
+				if( ( fd = events[i].data.fd ) == m_wake )
+				{
+					while( read( m_wake, &value, sizeof( value ) ) == -1 && errno == EINTR );
+					continue;
+				}
+
+				epoll_ctl( m_epoll, EPOLL_CTL_DEL, fd, NULL );
+
+				if( ( it = m_watches.find( fd ) ) != m_watches.end() )
+				{
+					m_tasks.push_back( std::move( it->second ) );
+					m_watches.erase( it );
+				}
+			}
+		}
+#endif
+	}
+
+
+
+	void EpollReactor_Impl::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_stop = true;
+		}
+
+		this->_wake();
+	}
+
+
+
+	void EpollReactor_Impl::watch( int fd, Reactor::Task ready )
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		if( fd < 0 || m_watches.find( fd ) != m_watches.end() )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		}
+
+#ifdef ODBX_EPOLL
+		struct epoll_event event;
+
+		event.events = EPOLLIN | EPOLLONESHOT;
+		event.data.u64 = 0;
+		event.data.fd = fd;
+
+		if( epoll_ctl( m_epoll, EPOLL_CTL_ADD, fd, &event ) == -1 )
+		{
+			throw std::system_error( errno, std::generic_category() );
+		}
+#endif
+
+		m_watches[fd] = std::move( ready );
+	}
+
+
+
+	void EpollReactor_Impl::post( Reactor::Task task )
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_tasks.push_back( std::move( task ) );
+		}
+
+		this->_wake();
+	}
+
+
+
+	void EpollReactor_Impl::offload( Reactor::Task work, Reactor::Task done )
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+
+			m_jobs.push_back( std::make_pair( std::move( work ), std::move( done ) ) );
+			m_busy++;
+		}
+
+		m_work.notify_one();
+	}
+
+
+
+	/*
+	 *  The job is only finished after its second task was queued, so run()
+	 *  can't return in between
+	 */
+
+	void EpollReactor_Impl::_run()
+	{
+		std::pair<Reactor::Task, Reactor::Task> job;
+
+		while( true )
+		{
+			{
+				std::unique_lock<std::mutex> lock( m_mutex );
+
+				while( !m_exit && m_jobs.empty() ) { m_work.wait( lock ); }
+
+				if( m_jobs.empty() ) { return; }
+
+				job = std::move( m_jobs.front() );
+				m_jobs.pop_front();
+			}
+
+			try {
+				job.first();
+			} catch( ... ) {}   // the awaitables keep their own exceptions
+
+			{
+				std::lock_guard<std::mutex> lock( m_mutex );
+
+				m_tasks.push_back( std::move( job.second ) );
+				m_busy--;
+			}
+
+			this->_wake();
+		}
+	}
+
+
+
+	void EpollReactor_Impl::_wake()
+	{
+#ifdef ODBX_EPOLL
+		uint64_t value = 1;
+
+		while( write( m_wake, &value, sizeof( value ) ) == -1 && errno == EINTR );
+#endif
+	}
+
+
+
+	/*
+	 *  Offloaded jobs are finished by the threads before they terminate
+	 */
+
+	void EpollReactor_Impl::_close()
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_exit = true;
+		}
+
+		m_work.notify_all();
+
+		for( size_t i = 0; i < m_threads.size(); i++ )
+		{
+			if( m_threads[i].joinable() ) { m_threads[i].join(); }
+		}
+
+		m_threads.clear();
+
+#ifdef ODBX_EPOLL
+		if( m_wake != -1 ) { close( m_wake ); }
+		if( m_epoll != -1 ) { close( m_epoll ); }
+#endif
+
+		m_wake = -1;
+		m_epoll = -1;
+	}
+
+}   // namespace OpenDBX
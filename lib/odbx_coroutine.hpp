@@ -0,0 +1,77 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "lib/opendbx/api"
+#include "lib/opendbx/coroutine"
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <deque>
+#include <map>
+
+
+
+#ifndef ODBX_COROUTINE_IMPL_HPP
+#define ODBX_COROUTINE_IMPL_HPP
+
+
+
+namespace OpenDBX
+{
+	using std::vector;
+
+
+
+	/*
+	 *  Ready tasks are queued and invoked one after another by run(), so
+	 *  an exception thrown by one of them doesn't lose the others
+	 */
+
+	class EpollReactor_Impl
+	{
+		int m_epoll;
+		int m_wake;   // eventfd signaled after a task was queued
+
+		std::mutex m_mutex;
+		std::condition_variable m_work;   // signaled after a job was offloaded
+		std::map<int, Reactor::Task> m_watches;
+		std::deque<Reactor::Task> m_tasks;
+		std::deque<std::pair<Reactor::Task, Reactor::Task> > m_jobs;
+		vector<std::thread> m_threads;
+		unsigned long m_busy;   // offloaded jobs which aren't finished
+		bool m_stop;   // run() returns
+		bool m_exit;   // threads terminate
+
+	protected:
+
+		void _run();
+		void _wake();
+		void _close();
+
+	public:
+
+		EpollReactor_Impl( unsigned long threads );
+		~EpollReactor_Impl() noexcept;
+
+		void run();
+		void stop();
+
+		void watch( int fd, Reactor::Task ready );
+		void post( Reactor::Task task );
+		void offload( Reactor::Task work, Reactor::Task done );
+	};
+
+}   // namespace OpenDBX
+
+
+
+#endif
@@ -11,6 +11,7 @@
 #include "lib/opendbx/api"
 #include <string>
 #include <vector>
+#include <atomic>
 
 
 
@@ -22,75 +23,103 @@
 namespace OpenDBX
 {
 
-	class Lob_Iface
+	/*
+	 *  Reference counter shared by all copies of a public object. New
+	 *  objects start with one reference owned by their creator.
+	 */
+
+	class Ref_Iface
 	{
+		std::atomic<unsigned long> m_refs;
+
 	public:
 
-		virtual ~Lob_Iface() throw() {}
-		virtual void close() throw( std::exception ) = 0;
+		Ref_Iface() noexcept : m_refs( 1 ) {}
+		virtual ~Ref_Iface() noexcept {}
 
-		virtual ssize_t read( void* buffer, size_t buflen ) throw( std::exception ) = 0;
-		virtual ssize_t write( void* buffer, size_t buflen ) throw( std::exception ) = 0;
+		void acquire() noexcept { m_refs.fetch_add( 1, std::memory_order_relaxed ); }
+		bool release() noexcept { return m_refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1; }
 	};
 
 
 
-	class Result_Iface
+	class Lob_Iface : public Ref_Iface
 	{
 	public:
 
-		virtual ~Result_Iface() throw() {}
-		virtual void finish() throw( std::exception ) = 0;
+		virtual ~Lob_Iface() noexcept {}
+		virtual void close() = 0;
+
+		virtual ssize_t read( void* buffer, size_t buflen ) = 0;
+		virtual ssize_t write( void* buffer, size_t buflen ) = 0;
+	};
 
-		virtual odbxres getResult( struct timeval* timeout, unsigned long chunk ) throw( std::exception ) = 0;
 
-		virtual odbxrow getRow() throw( std::exception ) = 0;
-		virtual uint64_t rowsAffected() throw( std::exception ) = 0;
 
-		virtual unsigned long columnCount() throw( std::exception ) = 0;
-		virtual unsigned long columnPos( const string& name ) throw( std::exception ) = 0;
-		virtual const string columnName( unsigned long pos ) throw( std::exception ) = 0;
-		virtual odbxtype columnType( unsigned long pos ) throw( std::exception ) = 0;
+	class Result_Iface : public Ref_Iface
+	{
+	public:
 
-		virtual unsigned long fieldLength( unsigned long pos ) throw( std::exception ) = 0;
-		virtual const char* fieldValue( unsigned long pos ) throw( std::exception ) = 0;
+		virtual ~Result_Iface() noexcept {}
+		virtual void finish() = 0;
 
-		virtual Lob_Iface* getLob( const char* value ) throw( std::exception ) = 0;
+		virtual odbxres getResult( struct timeval* timeout, unsigned long chunk ) = 0;
+
+		virtual odbxrow getRow() = 0;
+		virtual unsigned long getRows( unsigned long rows, vector<const char*>& values, vector<unsigned long>& lengths ) = 0;
+		virtual odbx_result_t* detach() = 0;
+		virtual uint64_t rowsAffected() = 0;
+
+		virtual unsigned long columnCount() = 0;
+		virtual unsigned long columnPos( const string& name ) = 0;
+		virtual const string& columnName( unsigned long pos ) = 0;
+		virtual odbxtype columnType( unsigned long pos ) = 0;
+
+		virtual unsigned long fieldLength( unsigned long pos ) = 0;
+		virtual const char* fieldValue( unsigned long pos ) = 0;
+		virtual const char* fieldValue( unsigned long pos, unsigned long& length ) = 0;
+
+		virtual Lob_Iface* getLob( const char* value ) = 0;
 	};
 
 
 
-	class Stmt_Iface
+	class Stmt_Iface : public Ref_Iface
 	{
 	public:
 
-		virtual ~Stmt_Iface() throw() {};
-		virtual Result_Iface* execute() throw( std::exception ) = 0;
+		virtual ~Stmt_Iface() noexcept {}
+		virtual Result_Iface* execute() = 0;
 
-// 		virtual void bind( const void* data, unsigned long size, size_t pos, int flags ) = 0;
-// 		virtual size_t count() = 0;
+		virtual void bind( const void* data, unsigned long size, size_t pos, int flags ) = 0;
+		virtual void bindParam( size_t pos, int type, const void* data, unsigned long size ) = 0;
+		virtual size_t count() = 0;
 	};
 
 
 
-	class Conn_Iface
+	class Conn_Iface : public Ref_Iface
 	{
 	public:
 
-		virtual ~Conn_Iface() throw() {};
-		virtual void finish() throw( std::exception ) = 0;
+		virtual ~Conn_Iface() noexcept {}
+		virtual void finish() = 0;
+
+		virtual void bind( const char* database, const char* who, const char* cred, odbxbind method = ODBX_BIND_SIMPLE ) = 0;
+		virtual void unbind() = 0;
+		virtual void cancel() = 0;
 
-		virtual void bind( const char* database, const char* who, const char* cred, odbxbind method = ODBX_BIND_SIMPLE ) throw( std::exception ) = 0;
-		virtual void unbind() throw( std::exception ) = 0;
+		virtual bool getCapability( odbxcap cap ) = 0;
 
-		virtual bool getCapability( odbxcap cap ) throw( std::exception ) = 0;
+		virtual void getOption( odbxopt option, void* value ) = 0;
+		virtual void setOption( odbxopt option, void* value ) = 0;
 
-		virtual void getOption( odbxopt option, void* value ) throw( std::exception ) = 0;
-		virtual void setOption( odbxopt option, void* value ) throw( std::exception ) = 0;
+		virtual string& escape( const char* from, unsigned long fromlen, string& to ) = 0;
 
-		virtual string& escape( const char* from, unsigned long fromlen, string& to ) throw( std::exception ) = 0;
+		virtual Stmt_Iface* create( const string& sql, Stmt::Type type ) = 0;
 
-		virtual Stmt_Iface* create( const string& sql, Stmt::Type type ) throw( std::exception ) = 0;
+		virtual void setTraceHooks( const struct odbx_trace_hooks* hooks, void* arg ) = 0;
+		virtual void unsetTraceHooks( void* arg ) = 0;
 	};
 
 }   // namespace
@@ -13,7 +13,10 @@
 #include "odbxdrv.h"
 #include <iostream>
 #include <cstdlib>
+#include <cmath>
+#include <clocale>
 #include <cstring>
+#include <cstdio>
 
 
 
@@ -29,7 +32,7 @@ namespace OpenDBX
 	*  OpenDBX large object implementation
 	*/
 
-	Lob_Impl::Lob_Impl( odbx_result_t* result, const char* value ) throw( std::exception )
+	Lob_Impl::Lob_Impl( odbx_result_t* result, const char* value )
 	{
 		int err;
 
@@ -45,14 +48,14 @@ namespace OpenDBX
 
 
 
-	Lob_Impl::~Lob_Impl() throw()
+	Lob_Impl::~Lob_Impl() noexcept
 	{
 		if( m_close ) { odbx_lo_close( m_lo ); }
 	}
 
 
 
-	void Lob_Impl::close() throw( std::exception )
+	void Lob_Impl::close()
 	{
 		int err;
 
@@ -66,7 +69,7 @@ namespace OpenDBX
 
 
 
-	ssize_t Lob_Impl::read( void* buffer, size_t buflen ) throw( std::exception )
+	ssize_t Lob_Impl::read( void* buffer, size_t buflen )
 	{
 		ssize_t err;
 
@@ -80,7 +83,7 @@ namespace OpenDBX
 
 
 
-	ssize_t Lob_Impl::write( void* buffer, size_t buflen ) throw( std::exception )
+	ssize_t Lob_Impl::write( void* buffer, size_t buflen )
 	{
 		ssize_t err;
 
@@ -102,15 +105,32 @@ namespace OpenDBX
 
 
 
-	Result_Impl::Result_Impl( odbx_t* handle ) throw( std::exception )
+	static inline size_t _hash( const string& name )
+	{
+		size_t hash = 2166136261U;   // FNV-1a
+
+		for( size_t i = 0; i < name.size(); i++ )
+		{
+			hash = ( hash ^ (unsigned char) name[i] ) * 16777619U;
+		}
+
+		return hash;
+	}
+
+
+
+	Result_Impl::Result_Impl( odbx_t* handle )
 	{
 		m_handle = handle;
 		m_result = NULL;
+		m_batch = NULL;
+		m_done = false;
+		m_cols = 0;
 	}
 
 
 
-	Result_Impl::~Result_Impl() throw()
+	Result_Impl::~Result_Impl() noexcept
 	{
 		try
 		{
@@ -121,15 +141,29 @@ namespace OpenDBX
 
 
 
-	void Result_Impl::finish() throw( std::exception )
+	/*
+	 *  The error of a canceled statement is only skipped once, so backends
+	 *  returning it again can't loop forever
+	 */
+
+	void Result_Impl::finish()
 	{
-		odbxres res;
+		bool canceled = false;
+		odbxres res = ODBX_RES_TIMEOUT;
 
 		do
 		{
-			if( ( res = this->getResult( NULL, 0 ) ) == ODBX_RES_TIMEOUT )
+			try
+			{
+				if( ( res = this->getResult( NULL, 0 ) ) == ODBX_RES_TIMEOUT )
+				{
+					throw Exception( string( odbx_error( m_handle, ODBX_ERR_RESULT ) ), ODBX_ERR_RESULT, odbx_error_type( m_handle, ODBX_ERR_RESULT ) );
+				}
+			}
+			catch( Exception& e )
 			{
-				throw Exception( string( odbx_error( m_handle, ODBX_ERR_RESULT ) ), ODBX_ERR_RESULT, odbx_error_type( m_handle, ODBX_ERR_RESULT ) );
+				if( e.getCode() != -ODBX_ERR_CANCELED || canceled ) { throw; }
+				canceled = true;
 			}
 		}
 		while ( res != ODBX_RES_DONE );
@@ -137,10 +171,20 @@ namespace OpenDBX
 
 
 
-	odbxres Result_Impl::getResult( struct timeval* timeout, unsigned long chunk ) throw( std::exception )
+	odbxres Result_Impl::getResult( struct timeval* timeout, unsigned long chunk )
 	{
 		int err;
 
+		if( m_batch != NULL )
+		{
+			odbx_result_finish( m_batch );
+			m_batch = NULL;
+		}
+
+		m_cols = 0;
+		m_names.clear();
+		m_slots.clear();
+
 		if( m_result != NULL )
 		{
 			if( ( err = odbx_result_finish( m_result ) ) != ODBX_ERR_SUCCESS )
@@ -155,14 +199,15 @@ namespace OpenDBX
 			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
 		}
 
-		m_pos.clear();
+		if( err == ODBX_RES_ROWS ) { this->_columns(); }
+		m_done = false;
 
 		return (odbxres) err;
 	}
 
 
 
-	odbxrow Result_Impl::getRow() throw( std::exception )
+	odbxrow Result_Impl::getRow()
 	{
 		int err;
 
@@ -171,103 +216,228 @@ namespace OpenDBX
 			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
 		}
 
+		m_cols = err == ODBX_ROW_NEXT ? m_names.size() : 0;
+
 		return (odbxrow) err;
 	}
 
 
 
-	uint64_t Result_Impl::rowsAffected() throw( std::exception )
+	/*
+	 *  The rows are detached from the result set in one block. Fetching again
+	 *  after the last row isn't safe for all backends, so this is remembered.
+	 */
+
+	unsigned long Result_Impl::getRows( unsigned long rows, vector<const char*>& values, vector<unsigned long>& lengths )
+	{
+		int err;
+		unsigned long i, cols, count = 0;
+
+		values.clear();
+		lengths.clear();
+
+		if( m_batch != NULL )
+		{
+			odbx_result_finish( m_batch );
+			m_batch = NULL;
+		}
+
+		if( m_done || rows == 0 ) { return 0; }
+
+		if( ( err = odbx_result_detach( m_result, &m_batch, rows ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
+		}
+
+		if( err == ODBX_ROW_DONE ) { m_done = true; }
+
+		cols = odbx_column_count( m_batch );
+		values.reserve( rows * cols );
+		lengths.reserve( rows * cols );
+
+		while( odbx_row_fetch( m_batch ) == ODBX_ROW_NEXT )
+		{
+			for( i = 0; i < cols; i++ )
+			{
+				values.push_back( odbx_field_value( m_batch, i ) );
+				lengths.push_back( odbx_field_length( m_batch, i ) );
+			}
+			count++;
+		}
+
+		return count;
+	}
+
+
+
+	/*
+	 *  The remaining rows of the current result set are copied at once and
+	 *  the result set can't be used for fetching rows afterwards
+	 */
+
+	odbx_result_t* Result_Impl::detach()
+	{
+		int err;
+		odbx_result_t* detached;
+
+		if( m_result == NULL ) { this->_invalid(); }
+
+		if( ( err = odbx_result_detach( m_result, &detached, 0 ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
+		}
+
+		m_done = true;
+		m_cols = 0;
+
+		return detached;
+	}
+
+
+
+	uint64_t Result_Impl::rowsAffected()
 	{
 		return odbx_rows_affected( m_result );
 	}
 
 
 
-	unsigned long Result_Impl::columnCount() throw( std::exception )
+	unsigned long Result_Impl::columnCount()
 	{
-		return odbx_column_count( m_result );
+		return m_names.size();
 	}
 
 
 
-	unsigned long Result_Impl::columnPos( const string& name ) throw( std::exception )
+	/*
+	 *  Column names are looked up via a hash table with linear probing which
+	 *  is at most half full. Like before, the last of several columns with
+	 *  the same name wins.
+	 */
+
+	unsigned long Result_Impl::columnPos( const string& name )
 	{
-		map<const string, unsigned long>::const_iterator it;
+		size_t i, mask;
 
-		if( !m_pos.empty() )
-		{
-			if( ( it = m_pos.find( name ) ) != m_pos.end() ) { return it->second; }
+		if( m_slots.empty() ) { this->_invalid(); }
 
-			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
-		}
+		mask = m_slots.size() - 1;
 
-		for( unsigned long i = 0; i < odbx_column_count( m_result ); i++ )
+		for( i = _hash( name ) & mask; m_slots[i] != 0; i = ( i + 1 ) & mask )
 		{
-			m_pos[this->columnName( i )] = i;
+			if( m_names[m_slots[i] - 1] == name ) { return m_slots[i] - 1; }
 		}
 
-		if( ( it = m_pos.find( name ) ) != m_pos.end() ) { return it->second; }
+		this->_invalid();
+		return 0;
+	}
 
-		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+
+
+	const string& Result_Impl::columnName( unsigned long pos )
+	{
+		if( pos >= m_names.size() ) { this->_invalid(); }
+
+		return m_names[pos];
 	}
 
 
 
-	const string Result_Impl::columnName( unsigned long pos ) throw( std::exception )
+	odbxtype Result_Impl::columnType( unsigned long pos )
 	{
-		if( pos < odbx_column_count( m_result ) )
-		{
-			if( odbx_column_name( m_result, pos ) != NULL )
-			{
-				return string( odbx_column_name( m_result, pos ) );
-			}
+		if( pos >= m_names.size() ) { this->_invalid(); }
 
-			return string();
-		}
+		return (odbxtype) odbx_column_type( m_result, pos );
+	}
 
-		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+
+
+	unsigned long Result_Impl::fieldLength( unsigned long pos )
+	{
+		if( pos >= m_cols ) { this->_invalid(); }
+
+		return odbx_field_length( m_result, pos );
 	}
 
 
 
-	odbxtype Result_Impl::columnType( unsigned long pos ) throw( std::exception )
+	const char* Result_Impl::fieldValue( unsigned long pos )
 	{
-		if( pos < odbx_column_count( m_result ) )
-		{
-			return (odbxtype) odbx_column_type( m_result, pos );
-		}
+		if( pos >= m_cols ) { this->_invalid(); }
 
-		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		return odbx_field_value( m_result, pos );
 	}
 
 
 
-	unsigned long Result_Impl::fieldLength( unsigned long pos ) throw( std::exception )
+	const char* Result_Impl::fieldValue( unsigned long pos, unsigned long& length )
 	{
-		if( pos < odbx_column_count( m_result ) )
+		const char* value;
+
+		if( pos >= m_cols ) { this->_invalid(); }
+
+		if( ( value = odbx_field_value( m_result, pos ) ) == NULL )
 		{
-			return odbx_field_length( m_result, pos );
+			length = 0;
+			return NULL;
 		}
 
-		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		length = odbx_field_length( m_result, pos );
+		return value;
+	}
+
+
+
+	Lob_Iface* Result_Impl::getLob( const char* value )
+	{
+		return new Lob_Impl( m_result, value );
 	}
 
 
 
-	const char* Result_Impl::fieldValue( unsigned long pos ) throw( std::exception )
+	/*
+	 *  Column names are read once per result set. They stay available after
+	 *  the last row while the backends may already have released theirs.
+	 *  Types are fetched per row because some backends like SQLite decide
+	 *  them per value.
+	 */
+
+	inline void Result_Impl::_columns()
 	{
-		if( pos < odbx_column_count( m_result ) )
+		size_t i, j, size = 1, mask;
+		unsigned long cols = odbx_column_count( m_result );
+		const char* name;
+
+		m_names.reserve( cols );
+
+		for( i = 0; i < cols; i++ )
 		{
-			return odbx_field_value( m_result, pos );
+			name = odbx_column_name( m_result, i );
+			m_names.push_back( name != NULL ? string( name ) : string() );
 		}
 
-		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		if( cols == 0 ) { return; }
+
+		while( size < cols * 2 ) { size <<= 1; }
+		m_slots.assign( size, 0 );
+		mask = size - 1;
+
+		for( i = 0; i < cols; i++ )
+		{
+			for( j = _hash( m_names[i] ) & mask; m_slots[j] != 0; j = ( j + 1 ) & mask )
+			{
+				if( m_names[m_slots[j] - 1] == m_names[i] ) { break; }
+			}
+
+			m_slots[j] = i + 1;
+		}
 	}
 
 
-	Lob_Iface* Result_Impl::getLob( const char* value ) throw( std::exception )
+
+	inline void Result_Impl::_invalid() const
 	{
-		return new Lob_Impl( m_result, value );
+		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
 	}
 
 
@@ -280,14 +450,14 @@ namespace OpenDBX
 
 
 
-	Stmt_Impl::Stmt_Impl( odbx_t* handle ) throw( std::exception )
+	Stmt_Impl::Stmt_Impl( odbx_t* handle )
 	{
 		m_handle = handle;
 	}
 
 
 
-	odbx_t* Stmt_Impl::_getHandle() const throw()
+	odbx_t* Stmt_Impl::_getHandle() const noexcept
 	{
 		return m_handle;
 	}
@@ -301,83 +471,182 @@ namespace OpenDBX
 
 
 
-	StmtSimple_Impl::StmtSimple_Impl( odbx_t* handle, const string& sql ) throw( std::exception ) : Stmt_Impl( handle )
+	StmtSimple_Impl::StmtSimple_Impl( odbx_t* handle, const string& sql ) : Stmt_Impl( handle )
 	{
+		char quote = 0;
+		bool mysql = handle != NULL && handle->name != NULL && strstr( handle->name, "mysql" ) != NULL;
+
 		m_sql = sql;
-/*		m_buffer = NULL;
+		m_buffer = NULL;
 		m_bufsize = 0;
-		size_t pos = 0;
+		m_bound = 0;
 
-		while( ( pos = m_sql.find( "?", pos ) ) != string::npos )
+		// placeholders within quoted strings, identifiers and comments are no parameters
+		for( size_t i = 0; i < m_sql.size(); i++ )
 		{
-			m_pos.push_back( pos );
-			pos += 1;
+			switch( quote )
+			{
+				case 0:
+					break;
+				case '-':   // line comment
+					if( m_sql[i] == '\n' ) { quote = 0; }
+					continue;
+				case '*':   // block comment
+					if( m_sql[i] == '*' && i + 1 < m_sql.size() && m_sql[i+1] == '/' ) { quote = 0; i++; }
+					continue;
+				default:
+					if( m_sql[i] == '\\' && mysql && quote != '`' ) { i++; }   // MySQL escapes quotes by backslashes
+					else if( m_sql[i] == quote ) { quote = 0; }
+					continue;
+			}
+
+			switch( m_sql[i] )
+			{
+				case '\'':
+				case '"':
+				case '`':
+					quote = m_sql[i];
+					break;
+				case '#':
+					if( mysql ) { quote = '-'; }
+					break;
+				case '-':
+				case '/':
+					if( i + 1 < m_sql.size() && m_sql[i+1] == ( m_sql[i] == '-' ? '-' : '*' ) )
+					{
+						quote = m_sql[++i] == '-' ? '-' : '*';
+					}
+					break;
+				case '?':
+					m_pos.push_back( i );
+					break;
+			}
 		}
 
-		m_binds.resize( m_pos.size() );
-		m_flags.resize( m_pos.size() );
+		m_binds.resize( m_pos.size(), NULL );
+		m_bindsize.resize( m_pos.size(), 0 );
+		m_values.resize( m_pos.size() );
+		m_flags.resize( m_pos.size(), -1 );   // not bound yet
+	}
+
 
-		for( size_t i = 0; i < m_binds.size(); i++ )
-		{
-			m_binds[i] = NULL;
-			m_flags[i] = Stmt::None;
-		}*/
+
+	StmtSimple_Impl::StmtSimple_Impl() : Stmt_Impl( NULL )
+	{
+		m_buffer = NULL;
+		m_bufsize = 0;
+		m_bound = 0;
 	}
 
 
 
-	StmtSimple_Impl::StmtSimple_Impl() throw( std::exception ) : Stmt_Impl( NULL )
+	StmtSimple_Impl::~StmtSimple_Impl() noexcept
 	{
-// 		m_buffer = NULL;
-// 		m_bufsize = 0;
+		if( m_buffer != NULL ) { std::free( m_buffer ); }
 	}
 
 
 
-	StmtSimple_Impl::~StmtSimple_Impl() throw()
+	void StmtSimple_Impl::bind( const void* data, unsigned long size, size_t pos, int flags )
 	{
-// 		if( m_buffer != NULL ) { std::free( m_buffer ); }
+		if( pos >= m_pos.size() )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		}
+
+		if( m_flags[pos] < 0 ) { m_bound++; }
+		if( data == NULL ) { flags |= Stmt::Null; }
+
+		m_binds[pos] = data;
+		m_bindsize[pos] = ( flags & Stmt::Null ) == 0 ? size : 0;
+		m_flags[pos] = flags & ( Stmt::Null | Stmt::Quote );
 	}
 
 
 
-// 	void StmtSimple_Impl::bind( const void* data, unsigned long size, size_t pos, int flags )
-// 	{
-// 		if( pos >= m_pos.size() )
-// 		{
-// 			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
-// 		}
-//
-// 		if( ( flags & Stmt::Null ) == 0 )
-// 		{
-// 			m_binds[pos] = data;
-// 			m_bindsize[pos] = size;
-// 		}
-// 		m_flags[pos] = flags;
-// 	}
+	/*
+	 *  Typed values are converted to their text form and copied, so the
+	 *  caller doesn't need to keep them until execute() is called. Negative
+	 *  numbers are enclosed in parentheses as "-?" would become a comment.
+	 */
+
+	void StmtSimple_Impl::bindParam( size_t pos, int type, const void* data, unsigned long size )
+	{
+		char buffer[32];
+		const char* dp;
+		int64_t num;
+		double real;
+		int len;
 
+		if( pos >= m_pos.size() )
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		}
 
+		switch( type )
+		{
+			case ODBX_PARAM_NULL:
+				this->bind( NULL, 0, pos, Stmt::Null );
+				return;
+			case ODBX_PARAM_INT64:
+				memcpy( &num, data, sizeof( int64_t ) );
+				len = snprintf( buffer, sizeof( buffer ), num < 0 ? "(%lld)" : "%lld", (long long) num );
+				m_values[pos].assign( buffer, len );
+				this->bind( m_values[pos].data(), m_values[pos].size(), pos, Stmt::None );
+				return;
+			case ODBX_PARAM_DOUBLE:
+				memcpy( &real, data, sizeof( double ) );
+				if( !std::isfinite( real ) ) { break; }   // no portable SQL representation
+				len = snprintf( buffer, sizeof( buffer ), real < 0 ? "(%.17g)" : "%.17g", real );
+				if( ( dp = localeconv()->decimal_point ) != NULL && dp[0] != '.' && dp[0] != '\0' && dp[1] == '\0' )
+				{
+					for( int i = 0; i < len; i++ )   // snprintf() uses the decimal point of the current locale
+					{
+						if( buffer[i] == dp[0] ) { buffer[i] = '.'; }
+					}
+				}
+				m_values[pos].assign( buffer, len );
+				this->bind( m_values[pos].data(), m_values[pos].size(), pos, Stmt::None );
+				return;
+			case ODBX_PARAM_TEXT:
+			case ODBX_PARAM_BLOB:
+				m_values[pos].assign( (const char*) data, size );
+				this->bind( m_values[pos].data(), m_values[pos].size(), pos, Stmt::Quote );
+				return;
+		}
 
-// 	size_t StmtSimple_Impl::count()
-// 	{
-// 		return m_pos.size();
-// 	}
+		throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+	}
 
 
 
-	Result_Iface* StmtSimple_Impl::execute() throw( std::exception )
+	size_t StmtSimple_Impl::count()
 	{
-// 		if( m_binds.size() ) { _exec_params(); }
-// 		else { _exec_noparams(); }
+		return m_pos.size();
+	}
+
 
-		this->_exec_noparams();
+
+	/*
+	 *  Statements without bound parameters are sent as they are, so
+	 *  question marks in other statements don't cause an error
+	 */
+
+	Result_Iface* StmtSimple_Impl::execute()
+	{
+		if( m_bound == 0 ) { this->_exec_noparams(); }
+		else if( m_bound == m_pos.size() ) { this->_exec_params(); }
+		else
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
+		}
 
 		return new Result_Impl( this->_getHandle() );
 	}
 
 
 
-	inline void StmtSimple_Impl::_exec_noparams() throw( std::exception )
+	inline void StmtSimple_Impl::_exec_noparams()
 	{
 		int err;
 
@@ -389,58 +658,151 @@ namespace OpenDBX
 
 
 
-// 	inline void StmtSimple_Impl::_exec_params()
-// 	{
-// 		int err;
-// 		unsigned long esclen;
-// 		size_t i, sqlpos = 0, bufpos = 0, lastpos = 0, max = m_sql.size() + 1;
-//
-// 		for( i = 0; i < m_binds.size(); i++ )
-// 		{
-// 			if( m_binds[i] != NULL ) { max += m_bindsize[i] * 2 + 2; }
-// 			else { max += 4; }
-// 		}
-// 		m_buffer = _resize( m_buffer, max );
-//
-// 		for( i = 0; i < m_binds.size(); i++ )
-// 		{
-// 			sqlpos = m_pos[i];
-//
-// 			memcpy( m_buffer + bufpos, m_sql.c_str() + lastpos, sqlpos - lastpos );
-// 			bufpos += sqlpos - lastpos;
-// 			lastpos = sqlpos + 1;
-//
-// 			if( m_binds[i] != NULL )
-// 			{
-// 				if( ( m_flags[i] & Stmt::Quote ) > 0 ) { m_buffer[bufpos++] = '\''; }
-// 				esclen = max - bufpos;
-//
-// 				if( (err = odbx_escape( m_handle, (const char*) m_binds[i], m_bindsize[i], m_buffer + bufpos, &esclen ) ) < 0 )
-// 				{
-// 					throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
-// 				}
-//
-// 				bufpos += esclen;
-// 				if( ( m_flags[i] & Stmt::Quote ) != 0 ) { m_buffer[bufpos++] = '\''; }
-// 			}
-// 			else
-// 			{
-// 				memcpy( m_buffer + bufpos, "NULL", 4 );
-// 				bufpos += 4;
-// 			}
-//
-// 			sqlpos += 1;
-// 		}
-//
-// 		memcpy( m_buffer + bufpos, m_sql.c_str() + lastpos, m_sql.size() - lastpos );
-// 		bufpos += m_sql.size() - lastpos;
-// 		m_buffer[bufpos] = 0;
-//
-// 		if( ( err = odbx_query( m_handle, m_buffer, bufpos ) ) < 0 )
-// 		{
-// 			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
-// 		}
-// 	}
+	/*
+	 *  The statement is assembled in a buffer which is large enough for the
+	 *  escaped values in the worst case (twice the size plus the terminating
+	 *  zero) and which is reused as long as the values don't grow
+	 */
+
+	inline void StmtSimple_Impl::_exec_params()
+	{
+		int err;
+		size_t i, bufpos = 0, lastpos = 0;
+		size_t max = m_sql.size() - m_pos.size() + 1;
+		unsigned long esclen;
+		odbx_t* handle = this->_getHandle();
+
+
+		for( i = 0; i < m_pos.size(); i++ )
+		{
+			if( ( m_flags[i] & Stmt::Null ) != 0 ) { max += 4; }
+			else { max += m_bindsize[i] * 2 + 3; }
+		}
+
+		if( max > m_bufsize )
+		{
+			m_buffer = _resize( m_buffer, max );
+			m_bufsize = max;
+		}
+
+		for( i = 0; i < m_pos.size(); i++ )
+		{
+			memcpy( m_buffer + bufpos, m_sql.data() + lastpos, m_pos[i] - lastpos );
+			bufpos += m_pos[i] - lastpos;
+			lastpos = m_pos[i] + 1;
+
+			if( ( m_flags[i] & Stmt::Null ) != 0 )
+			{
+				memcpy( m_buffer + bufpos, "NULL", 4 );
+				bufpos += 4;
+				continue;
+			}
+
+			if( ( m_flags[i] & Stmt::Quote ) != 0 ) { m_buffer[bufpos++] = '\''; }
+			esclen = m_bufsize - bufpos;
+
+			if( ( err = odbx_escape( handle, (const char*) m_binds[i], m_bindsize[i], m_buffer + bufpos, &esclen ) ) < 0 )
+			{
+				throw Exception( string( odbx_error( handle, err ) ), err, odbx_error_type( handle, err ) );
+			}
+
+			bufpos += esclen;
+			if( ( m_flags[i] & Stmt::Quote ) != 0 ) { m_buffer[bufpos++] = '\''; }
+		}
+
+		memcpy( m_buffer + bufpos, m_sql.data() + lastpos, m_sql.size() - lastpos );
+		bufpos += m_sql.size() - lastpos;
+		m_buffer[bufpos] = 0;
+
+		if( ( err = odbx_query( handle, m_buffer, bufpos ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( handle, err ) ), err, odbx_error_type( handle, err ) );
+		}
+	}
+
+
+
+	inline char* StmtSimple_Impl::_resize( char* buffer, size_t size )
+	{
+		if( ( buffer = (char*) std::realloc( buffer, size ) ) == NULL )
+		{
+			throw Exception( string( odbx_error( this->_getHandle(), -ODBX_ERR_NOMEM ) ), -ODBX_ERR_NOMEM, odbx_error_type( this->_getHandle(), -ODBX_ERR_NOMEM ) );
+		}
+
+		return buffer;
+	}
+
+
+
+
+
+	/*
+	*  OpenDBX StmtPrepared implementation
+	*/
+
+
+
+	StmtPrepared_Impl::StmtPrepared_Impl( odbx_t* handle, const string& sql ) : Stmt_Impl( handle )
+	{
+		int err;
+
+		if( ( err = odbx_stmt_prepare( handle, &m_stmt, sql.data(), sql.size() ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( handle, err ) ), err, odbx_error_type( handle, err ) );
+		}
+	}
+
+
+
+	StmtPrepared_Impl::~StmtPrepared_Impl() noexcept
+	{
+		odbx_stmt_finish( m_stmt );
+	}
+
+
+
+	/*
+	 *  Untyped values are passed as text because their type is unknown
+	 */
+
+	void StmtPrepared_Impl::bind( const void* data, unsigned long size, size_t pos, int flags )
+	{
+		if( data == NULL || ( flags & Stmt::Null ) != 0 ) { this->bindParam( pos, ODBX_PARAM_NULL, NULL, 0 ); }
+		else { this->bindParam( pos, ODBX_PARAM_TEXT, data, size ); }
+	}
+
+
+
+	void StmtPrepared_Impl::bindParam( size_t pos, int type, const void* data, unsigned long size )
+	{
+		int err;
+
+		if( ( err = odbx_stmt_bind( m_stmt, pos, type, data, size ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( this->_getHandle(), err ) ), err, odbx_error_type( this->_getHandle(), err ) );
+		}
+	}
+
+
+
+	size_t StmtPrepared_Impl::count()
+	{
+		return odbx_stmt_count( m_stmt );
+	}
+
+
+
+	Result_Iface* StmtPrepared_Impl::execute()
+	{
+		int err;
+
+		if( ( err = odbx_stmt_execute( m_stmt ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( this->_getHandle(), err ) ), err, odbx_error_type( this->_getHandle(), err ) );
+		}
+
+		return new Result_Impl( this->_getHandle() );
+	}
 
 
 
@@ -452,7 +814,7 @@ namespace OpenDBX
 
 
 
-	Conn_Impl::Conn_Impl( const char* backend, const char* host, const char* port ) throw( std::exception )
+	Conn_Impl::Conn_Impl( const char* backend, const char* host, const char* port )
 	{
 		int err;
 
@@ -464,13 +826,14 @@ namespace OpenDBX
 			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
 		}
 
+		m_trace = NULL;
 		m_unbind = false;
 		m_finish = true;
 	}
 
 
 
-	Conn_Impl::~Conn_Impl() throw()
+	Conn_Impl::~Conn_Impl() noexcept
 	{
 		if( m_unbind ) { odbx_unbind( m_handle ); }
 		if( m_finish ) { odbx_finish( m_handle ); }
@@ -480,7 +843,7 @@ namespace OpenDBX
 
 
 
-	void Conn_Impl::bind( const char* database, const char* who, const char* cred, odbxbind method ) throw( std::exception )
+	void Conn_Impl::bind( const char* database, const char* who, const char* cred, odbxbind method )
 	{
 		int err;
 
@@ -494,7 +857,7 @@ namespace OpenDBX
 
 
 
-	void Conn_Impl::unbind() throw( std::exception )
+	void Conn_Impl::unbind()
 	{
 		int err;
 
@@ -508,7 +871,19 @@ namespace OpenDBX
 
 
 
-	void Conn_Impl::finish() throw( std::exception )
+	void Conn_Impl::cancel()
+	{
+		int err;
+
+		if( ( err = odbx_cancel( m_handle ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
+		}
+	}
+
+
+
+	void Conn_Impl::finish()
 	{
 		int err;
 
@@ -528,7 +903,7 @@ namespace OpenDBX
 
 
 
-	bool Conn_Impl::getCapability( odbxcap cap ) throw( std::exception )
+	bool Conn_Impl::getCapability( odbxcap cap )
 	{
 		int err = odbx_capabilities( m_handle, (unsigned int) cap );
 
@@ -545,7 +920,7 @@ namespace OpenDBX
 
 
 
-	void Conn_Impl::getOption( odbxopt option, void* value ) throw( std::exception )
+	void Conn_Impl::getOption( odbxopt option, void* value )
 	{
 		int err;
 
@@ -557,7 +932,7 @@ namespace OpenDBX
 
 
 
-	void Conn_Impl::setOption( odbxopt option, void* value ) throw( std::exception )
+	void Conn_Impl::setOption( odbxopt option, void* value )
 	{
 		int err;
 
@@ -569,7 +944,7 @@ namespace OpenDBX
 
 
 
-	string& Conn_Impl::escape( const char* from, unsigned long fromlen, string& to ) throw( std::exception )
+	string& Conn_Impl::escape( const char* from, unsigned long fromlen, string& to )
 	{
 		int err;
 		unsigned long size = m_escsize;
@@ -594,12 +969,18 @@ namespace OpenDBX
 
 
 
-	Stmt_Iface* Conn_Impl::create( const string& sql, Stmt::Type type ) throw( std::exception )
+	Stmt_Iface* Conn_Impl::create( const string& sql, Stmt::Type type )
 	{
 		switch( type )
 		{
 			case Stmt::Simple:
 				return new StmtSimple_Impl( m_handle, sql );
+			case Stmt::Prepared:
+				if( odbx_capabilities( m_handle, ODBX_CAP_STMT ) == ODBX_ENABLE )
+				{
+					return new StmtPrepared_Impl( m_handle, sql );
+				}
+				return new StmtSimple_Impl( m_handle, sql );   // no native support
 			default:
 				throw Exception( string( odbx_error( NULL, -ODBX_ERR_PARAM ) ), -ODBX_ERR_PARAM, odbx_error_type( NULL, -ODBX_ERR_PARAM ) );
 		}
@@ -607,7 +988,37 @@ namespace OpenDBX
 
 
 
-	inline char* Conn_Impl::_resize( char* buffer, size_t size ) throw( std::exception )
+	void Conn_Impl::setTraceHooks( const struct odbx_trace_hooks* hooks, void* arg )
+	{
+		int err;
+
+		if( !m_finish )   // handle was already released by finish()
+		{
+			throw Exception( string( odbx_error( NULL, -ODBX_ERR_HANDLE ) ), -ODBX_ERR_HANDLE, odbx_error_type( NULL, -ODBX_ERR_HANDLE ) );
+		}
+
+		if( ( err = odbx_set_trace_hooks( m_handle, hooks, arg ) ) < 0 )
+		{
+			throw Exception( string( odbx_error( m_handle, err ) ), err, odbx_error_type( m_handle, err ) );
+		}
+
+		m_trace = hooks != NULL ? arg : NULL;
+	}
+
+
+
+	/*
+	 *  Hooks which were replaced by another caller are kept
+	 */
+
+	void Conn_Impl::unsetTraceHooks( void* arg )
+	{
+		if( m_trace == arg ) { this->setTraceHooks( NULL, NULL ); }
+	}
+
+
+
+	inline char* Conn_Impl::_resize( char* buffer, size_t size )
 	{
 		if( ( buffer = (char*) std::realloc( buffer, size ) ) == NULL )
 		{
@@ -12,7 +12,6 @@
 #include "lib/opendbx/api"
 #include <vector>
 #include <string>
-#include <map>
 
 
 
@@ -25,7 +24,6 @@ namespace OpenDBX
 {
 	using std::string;
 	using std::vector;
-	using std::map;
 
 
 
@@ -37,13 +35,13 @@ namespace OpenDBX
 
 	public:
 
-		Lob_Impl( odbx_result_t* result, const char* value ) throw( std::exception );
-		~Lob_Impl() throw();
+		Lob_Impl( odbx_result_t* result, const char* value );
+		~Lob_Impl() noexcept;
 
-		void close() throw( std::exception );
+		void close();
 
-		ssize_t read( void* buffer, size_t buflen ) throw( std::exception );
-		ssize_t write( void* buffer, size_t buflen ) throw( std::exception );
+		ssize_t read( void* buffer, size_t buflen );
+		ssize_t write( void* buffer, size_t buflen );
 	};
 
 
@@ -52,29 +50,41 @@ namespace OpenDBX
 	{
 		odbx_t* m_handle;
 		odbx_result_t* m_result;
-		map<const string, unsigned long> m_pos;
+		odbx_result_t* m_batch;   // rows returned by getRows()
+		bool m_done;
+		unsigned long m_cols;   // columns of the current row, zero if there's none
+		vector<string> m_names;   // column names of the current result set
+		vector<unsigned long> m_slots;   // open addressing hash of m_names, position + 1
+
+	protected:
+
+		inline void _columns();
+		inline void _invalid() const;
 
 	public:
 
-		Result_Impl( odbx_t* handle ) throw( std::exception );
-		~Result_Impl() throw();
+		Result_Impl( odbx_t* handle );
+		~Result_Impl() noexcept;
 
-		void finish() throw( std::exception );
+		void finish();
 
-		odbxres getResult( struct timeval* timeout, unsigned long chunk ) throw( std::exception );
+		odbxres getResult( struct timeval* timeout, unsigned long chunk );
 
-		odbxrow getRow() throw( std::exception );
-		uint64_t rowsAffected() throw( std::exception );
+		odbxrow getRow();
+		unsigned long getRows( unsigned long rows, vector<const char*>& values, vector<unsigned long>& lengths );
+		odbx_result_t* detach();
+		uint64_t rowsAffected();
 
-		unsigned long columnCount() throw( std::exception );
-		unsigned long columnPos( const string& name ) throw( std::exception );
-		const string columnName( unsigned long pos ) throw( std::exception );
-		odbxtype columnType( unsigned long pos ) throw( std::exception );
+		unsigned long columnCount();
+		unsigned long columnPos( const string& name );
+		const string& columnName( unsigned long pos );
+		odbxtype columnType( unsigned long pos );
 
-		unsigned long fieldLength( unsigned long pos ) throw( std::exception );
-		const char* fieldValue( unsigned long pos ) throw( std::exception );
+		unsigned long fieldLength( unsigned long pos );
+		const char* fieldValue( unsigned long pos );
+		const char* fieldValue( unsigned long pos, unsigned long& length );
 
-		Lob_Iface* getLob( const char* value ) throw( std::exception );
+		Lob_Iface* getLob( const char* value );
 	};
 
 
@@ -85,11 +95,11 @@ namespace OpenDBX
 
 	protected:
 
-	odbx_t* _getHandle() const throw();
+	odbx_t* _getHandle() const noexcept;
 
 	public:
 
-		Stmt_Impl( odbx_t* handle ) throw( std::exception );
+		Stmt_Impl( odbx_t* handle );
 	};
 
 
@@ -101,24 +111,46 @@ namespace OpenDBX
 		vector<size_t> m_pos;
 		vector<const void*> m_binds;
 		vector<unsigned long> m_bindsize;
+		vector<string> m_values;   // copies of typed values
+		size_t m_bound;
 		size_t m_bufsize;
 		char* m_buffer;
 
 	protected:
 
-// 		inline void _exec_params() throw( std::exception );
-		inline void _exec_noparams() throw( std::exception );
+		inline void _exec_params();
+		inline void _exec_noparams();
+		inline char* _resize( char* buffer, size_t size );
+
+	public:
+
+		StmtSimple_Impl( odbx_t* handle, const string& sql );
+		StmtSimple_Impl();
+		~StmtSimple_Impl() noexcept;
+
+		void bind( const void* data, unsigned long size, size_t pos, int flags );
+		void bindParam( size_t pos, int type, const void* data, unsigned long size );
+		size_t count();
+
+		Result_Iface* execute();
+	};
+
+
+
+	class StmtPrepared_Impl : public Stmt_Impl
+	{
+		odbx_stmt_t* m_stmt;
 
 	public:
 
-		StmtSimple_Impl( odbx_t* handle, const string& sql ) throw( std::exception );
-		StmtSimple_Impl() throw( std::exception );
-		~StmtSimple_Impl() throw();
+		StmtPrepared_Impl( odbx_t* handle, const string& sql );
+		~StmtPrepared_Impl() noexcept;
 
-// 		void bind( const void* data, unsigned long size, size_t pos, int flags );
-// 		size_t count();
+		void bind( const void* data, unsigned long size, size_t pos, int flags );
+		void bindParam( size_t pos, int type, const void* data, unsigned long size );
+		size_t count();
 
-		Result_Iface* execute() throw( std::exception );
+		Result_Iface* execute();
 	};
 
 
@@ -128,29 +160,34 @@ namespace OpenDBX
 		odbx_t* m_handle;
 		char* m_escbuf;
 		unsigned long m_escsize;
+		void* m_trace;   // argument of the trace hooks
 		bool m_unbind, m_finish;
 
 	protected:
 
-		inline char* _resize( char* buffer, size_t size ) throw( std::exception );
+		inline char* _resize( char* buffer, size_t size );
 
 	public:
 
-		Conn_Impl( const char* backend, const char* host, const char* port ) throw( std::exception );
-		~Conn_Impl() throw();
-		void finish() throw( std::exception );
+		Conn_Impl( const char* backend, const char* host, const char* port );
+		~Conn_Impl() noexcept;
+		void finish();
+
+		void bind( const char* database, const char* who, const char* cred, odbxbind method = ODBX_BIND_SIMPLE );
+		void unbind();
+		void cancel();
 
-		void bind( const char* database, const char* who, const char* cred, odbxbind method = ODBX_BIND_SIMPLE ) throw( std::exception );
-		void unbind() throw( std::exception );
+		bool getCapability( odbxcap cap );
 
-		bool getCapability( odbxcap cap ) throw( std::exception );
+		void getOption( odbxopt option, void* value );
+		void setOption( odbxopt option, void* value );
 
-		void getOption( odbxopt option, void* value ) throw( std::exception );
-		void setOption( odbxopt option, void* value ) throw( std::exception );
+		string& escape( const char* from, unsigned long fromlen, string& to );
 
-		string& escape( const char* from, unsigned long fromlen, string& to ) throw( std::exception );
+		Stmt_Iface* create( const string& sql, Stmt::Type type );
 
-		Stmt_Iface* create( const string& sql, Stmt::Type type ) throw( std::exception );
+		void setTraceHooks( const struct odbx_trace_hooks* hooks, void* arg );
+		void unsetTraceHooks( void* arg );
 	};
 
 }   // namespace
@@ -0,0 +1,459 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "opendbx/arrow.h"
+#include "odbxconv.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/*
+ *  Arrow types the ODBX types are mapped to
+ */
+
+enum odbx_akind {
+	ODBX_ARROW_BOOL,
+	ODBX_ARROW_INT16,
+	ODBX_ARROW_INT32,
+	ODBX_ARROW_INT64,
+	ODBX_ARROW_FLOAT,
+	ODBX_ARROW_DOUBLE,
+	ODBX_ARROW_DATE,
+	ODBX_ARROW_TIME,
+	ODBX_ARROW_TIMESTAMP,
+	ODBX_ARROW_TIMESTAMPTZ,
+	ODBX_ARROW_STRING,
+	ODBX_ARROW_BINARY,
+};
+
+static const char* odbx_arrow_format[] = {
+	"b",   // bit packed boolean
+	"s",   // int16
+	"i",   // int32
+	"l",   // int64
+	"f",   // float
+	"g",   // double
+	"tdD",   // days since epoch as int32
+	"ttu",   // microseconds since midnight as int64
+	"tsu:",   // microseconds since epoch as int64
+	"tsu:UTC",
+	"u",   // utf8 string with int32 offsets
+	"z",   // binary with int32 offsets
+};
+
+static const int odbx_arrow_width[] = { 0, 2, 4, 8, 4, 8, 4, 8, 8, 8, 4, 4 };
+
+#define ODBX_ARROW_ALIGN(size) ( ( (size) + 7 ) & ~((size_t) 7) )
+
+
+
+static enum odbx_akind _odbx_arrow_kind( int type )
+{
+	switch( type )
+	{
+		case ODBX_TYPE_BOOLEAN:
+			return ODBX_ARROW_BOOL;
+		case ODBX_TYPE_SMALLINT:
+			return ODBX_ARROW_INT16;
+		case ODBX_TYPE_INTEGER:
+			return ODBX_ARROW_INT32;
+		case ODBX_TYPE_BIGINT:
+			return ODBX_ARROW_INT64;
+		case ODBX_TYPE_REAL:
+			return ODBX_ARROW_FLOAT;
+		case ODBX_TYPE_DOUBLE:
+		case ODBX_TYPE_FLOAT:
+			return ODBX_ARROW_DOUBLE;
+		case ODBX_TYPE_DATE:
+			return ODBX_ARROW_DATE;
+		case ODBX_TYPE_TIME:
+			return ODBX_ARROW_TIME;
+		case ODBX_TYPE_TIMESTAMP:
+			return ODBX_ARROW_TIMESTAMP;
+		case ODBX_TYPE_TIMESTAMPTZ:
+			return ODBX_ARROW_TIMESTAMPTZ;
+		case ODBX_TYPE_TIMETZ:   // Arrow times can't store a time zone
+			return ODBX_ARROW_STRING;
+		case ODBX_TYPE_BLOB:
+			return ODBX_ARROW_BINARY;
+	}
+
+	return ODBX_ARROW_STRING;   // including decimals to avoid losing precision
+}
+
+
+
+
+
+/*
+ *  Creation and release of Arrow arrays and schemas
+ */
+
+static void _odbx_arrow_array_release( struct ArrowArray* array )
+{
+	free( array->private_data );
+	array->release = NULL;
+}
+
+
+
+static void _odbx_arrow_batch_release( struct ArrowArray* array )
+{
+	int64_t i;
+
+	for( i = 0; i < array->n_children; i++ )
+	{
+		if( array->children[i]->release != NULL ) { array->children[i]->release( array->children[i] ); }
+	}
+
+	free( array->private_data );
+	array->release = NULL;
+}
+
+
+
+static void _odbx_arrow_schema_release( struct ArrowSchema* schema )
+{
+	int64_t i;
+
+	for( i = 0; i < schema->n_children; i++ )
+	{
+		if( schema->children[i]->release != NULL ) { schema->children[i]->release( schema->children[i] ); }
+	}
+
+	free( schema->private_data );
+	schema->release = NULL;
+}
+
+
+
+static void _odbx_arrow_field_release( struct ArrowSchema* schema )
+{
+	free( schema->private_data );   // contains the name
+	schema->release = NULL;
+}
+
+
+
+/*
+ *  Copies the values of one column into the buffers of an Arrow array.
+ *  All buffers are allocated as one block referenced by private_data.
+ *  Values which can't be converted to the column type are set to NULL.
+ */
+
+static int _odbx_arrow_column( const struct odbx_mat* mat, unsigned long col, enum odbx_akind kind, struct ArrowArray* array )
+{
+	char* block;
+	unsigned char* valid;
+	char* values;
+	char* data = NULL;
+	uint64_t row, cell;
+	int64_t nulls = 0, num;
+	size_t nullsize, valsize, datasize = 0, size;
+	unsigned long len;
+	const char* value;
+	double dbl;
+	int flag, bit;
+
+
+	nullsize = ( mat->rows + 7 ) >> 3;
+	valsize = kind == ODBX_ARROW_BOOL ? nullsize : odbx_arrow_width[kind] * mat->rows;
+
+	if( kind == ODBX_ARROW_STRING || kind == ODBX_ARROW_BINARY )
+	{
+		valsize += 4;   // one more offset
+
+		for( row = 0, cell = col; row < mat->rows; row++, cell += mat->cols )
+		{
+			datasize += _odbx_mat_length( mat, cell );
+		}
+
+		if( datasize > INT32_MAX ) { return -ODBX_ERR_SIZE; }
+	}
+
+	size = ODBX_ARROW_ALIGN( sizeof( void* ) * 3 ) + ODBX_ARROW_ALIGN( nullsize ) + ODBX_ARROW_ALIGN( valsize ) + datasize;
+
+	if( ( block = (char*) malloc( size ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	valid = (unsigned char*) block + ODBX_ARROW_ALIGN( sizeof( void* ) * 3 );
+	values = (char*) valid + ODBX_ARROW_ALIGN( nullsize );
+
+	memset( valid, 0, nullsize );
+	memset( values, 0, valsize );
+
+	if( kind == ODBX_ARROW_STRING || kind == ODBX_ARROW_BINARY )
+	{
+		data = values + ODBX_ARROW_ALIGN( valsize );
+		datasize = 0;
+	}
+
+	if( kind == ODBX_ARROW_INT16 || kind == ODBX_ARROW_INT32 || kind == ODBX_ARROW_INT64 )
+	{
+		nulls = (int64_t) _odbx_conv_int_column( mat, col, odbx_arrow_width[kind], values, valid );
+	}
+	else
+	{
+		for( row = 0, cell = col; row < mat->rows; row++, cell += mat->cols )
+		{
+			if( _odbx_mat_isnull( mat, cell ) )
+			{
+				if( data != NULL ) { ((int32_t*) values)[row+1] = (int32_t) datasize; }
+				nulls++;
+				continue;
+			}
+
+			value = _odbx_mat_value( mat, cell );
+			len = _odbx_mat_length( mat, cell );
+			flag = 0;
+			num = 0;
+			dbl = 0;
+
+			switch( kind )
+			{
+				case ODBX_ARROW_BOOL:
+					if( ( flag = _odbx_conv_bool( value, len, &bit ) ) == 0 && bit ) { values[row >> 3] |= 1 << ( row & 7 ); }
+					break;
+				case ODBX_ARROW_FLOAT:
+					flag = _odbx_conv_double( value, len, &dbl );
+					((float*) values)[row] = (float) dbl;
+					break;
+				case ODBX_ARROW_DOUBLE:
+					flag = _odbx_conv_double( value, len, &((double*) values)[row] );
+					break;
+				case ODBX_ARROW_DATE:
+					flag = _odbx_conv_date( value, len, &num ) == (int) len ? 0 : -1;
+					((int32_t*) values)[row] = (int32_t) num;
+					break;
+				case ODBX_ARROW_TIME:
+					flag = _odbx_conv_time( value, len, &((int64_t*) values)[row] ) == (int) len ? 0 : -1;
+					break;
+				case ODBX_ARROW_TIMESTAMP:
+					flag = _odbx_conv_timestamp( value, len, 0, &((int64_t*) values)[row] );
+					break;
+				case ODBX_ARROW_TIMESTAMPTZ:
+					flag = _odbx_conv_timestamp( value, len, 1, &((int64_t*) values)[row] );
+					break;
+				default:   // strings and binary data
+					memcpy( data + datasize, value, len );
+					datasize += len;
+					((int32_t*) values)[row+1] = (int32_t) datasize;
+					break;
+			}
+
+			if( flag < 0 )
+			{
+				nulls++;
+				continue;
+			}
+
+			valid[row >> 3] |= 1 << ( row & 7 );
+		}
+	}
+
+	array->length = (int64_t) mat->rows;
+	array->null_count = nulls;
+	array->offset = 0;
+	array->n_buffers = data != NULL ? 3 : 2;
+	array->n_children = 0;
+	array->buffers = (const void**) block;
+	array->buffers[0] = nulls > 0 ? valid : NULL;
+	array->buffers[1] = values;
+	array->buffers[2] = data;
+	array->children = NULL;
+	array->dictionary = NULL;
+	array->release = _odbx_arrow_array_release;
+	array->private_data = block;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int _odbx_arrow_batch( const struct odbx_mat* mat, const enum odbx_akind* kinds, struct ArrowArray* batch )
+{
+	int err;
+	char* block;
+	unsigned long i;
+	struct ArrowArray* child;
+
+
+	if( ( block = (char*) malloc( sizeof( void* ) + ( sizeof( struct ArrowArray* ) + sizeof( struct ArrowArray ) ) * mat->cols ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	batch->length = (int64_t) mat->rows;
+	batch->null_count = 0;
+	batch->offset = 0;
+	batch->n_buffers = 1;
+	batch->n_children = 0;
+	batch->buffers = (const void**) block;
+	batch->buffers[0] = NULL;   // no validity bitmap for rows
+	batch->children = (struct ArrowArray**) ( block + sizeof( void* ) );
+	batch->dictionary = NULL;
+	batch->release = _odbx_arrow_batch_release;
+	batch->private_data = block;
+
+	child = (struct ArrowArray*) ( batch->children + mat->cols );
+
+	for( i = 0; i < mat->cols; i++ )
+	{
+		if( ( err = _odbx_arrow_column( mat, i, kinds[i], child + i ) ) < 0 )
+		{
+			batch->release( batch );
+			return err;
+		}
+
+		batch->children[i] = child + i;
+		batch->n_children++;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static int _odbx_arrow_schema( const struct odbx_mat* mat, const enum odbx_akind* kinds, struct ArrowSchema* schema )
+{
+	unsigned long i;
+	struct ArrowSchema* child;
+	const struct odbx_mat_column* col;
+
+
+	if( ( schema->private_data = malloc( ( sizeof( struct ArrowSchema* ) + sizeof( struct ArrowSchema ) ) * mat->cols + 1 ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	schema->format = "+s";   // struct with one child per column
+	schema->name = "";
+	schema->metadata = NULL;
+	schema->flags = 0;
+	schema->n_children = 0;
+	schema->children = (struct ArrowSchema**) schema->private_data;
+	schema->dictionary = NULL;
+	schema->release = _odbx_arrow_schema_release;
+
+	child = (struct ArrowSchema*) ( schema->children + mat->cols );
+
+	for( i = 0; i < mat->cols; i++ )
+	{
+		col = _odbx_mat_column( mat, i );
+
+		if( ( child[i].private_data = malloc( col->namelen + 1 ) ) == NULL )
+		{
+			schema->release( schema );
+			return -ODBX_ERR_NOMEM;
+		}
+
+		memcpy( child[i].private_data, (const char*) mat + col->name, col->namelen + 1 );
+
+		child[i].format = odbx_arrow_format[kinds[i]];
+		child[i].name = (const char*) child[i].private_data;
+		child[i].metadata = NULL;
+		child[i].flags = ARROW_FLAG_NULLABLE;
+		child[i].n_children = 0;
+		child[i].children = NULL;
+		child[i].dictionary = NULL;
+		child[i].release = _odbx_arrow_field_release;
+
+		schema->children[i] = child + i;
+		schema->n_children++;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+
+
+/*
+ *  ODBX columnar export
+ */
+
+int odbx_result_to_columnar( odbx_result_t* result, unsigned long batchrows,
+	int (*callback)( struct ArrowSchema* schema, struct ArrowArray* batch, void* arg ), void* arg )
+{
+	int err, more;
+	unsigned long i;
+	odbx_result_t* detached;
+	const struct odbx_mat* mat;
+	enum odbx_akind* kinds = NULL;
+	struct ArrowSchema schema;
+	struct ArrowArray batch;
+
+
+	if( callback == NULL ) { return -ODBX_ERR_PARAM; }
+
+	do
+	{
+		if( ( more = odbx_result_detach( result, &detached, batchrows ) ) < 0 )
+		{
+			free( kinds );
+			return more;
+		}
+
+		mat = _odbx_mat_get( detached );
+
+		if( mat->rows == 0 && kinds != NULL )   // no more rows after a full batch
+		{
+			odbx_result_finish( detached );
+			break;
+		}
+
+		if( kinds == NULL )
+		{
+			if( ( kinds = (enum odbx_akind*) malloc( sizeof( enum odbx_akind ) * ( mat->cols + 1 ) ) ) == NULL )
+			{
+				odbx_result_finish( detached );
+				return -ODBX_ERR_NOMEM;
+			}
+
+			for( i = 0; i < mat->cols; i++ )
+			{
+				kinds[i] = _odbx_arrow_kind( _odbx_mat_column( mat, i )->type );
+			}
+		}
+
+		if( ( err = _odbx_arrow_schema( mat, kinds, &schema ) ) < 0 )
+		{
+			odbx_result_finish( detached );
+			free( kinds );
+			return err;
+		}
+
+		if( ( err = _odbx_arrow_batch( mat, kinds, &batch ) ) < 0 )
+		{
+			schema.release( &schema );
+			odbx_result_finish( detached );
+			free( kinds );
+			return err;
+		}
+
+		odbx_result_finish( detached );
+
+		if( ( err = callback( &schema, &batch, arg ) ) < 0 )   // callback is responsible for releasing
+		{
+			free( kinds );
+			return err;
+		}
+	}
+	while( more == ODBX_ROW_NEXT );
+
+	free( kinds );
+
+	return ODBX_ERR_SUCCESS;
+}
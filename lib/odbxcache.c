@@ -0,0 +1,1013 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxcache.h"
+#include "odbxlib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+
+#define ODBX_CACHE_BUCKETS 256
+#define ODBX_CACHE_NESTING 64
+
+
+
+/*
+ *  Cached result sets of one statement
+ */
+
+struct odbx_centry
+{
+	struct odbx_centry* next;   // hash chain
+	struct odbx_centry* newer;   // LRU list
+	struct odbx_centry* older;
+	odbx_cache_t* cache;
+	uint64_t hash;
+	uint64_t expires;
+	size_t size;
+	int refs;
+	int linked;
+	char* key;
+	size_t keylen;
+	char* tags;
+	size_t tagslen;
+	unsigned long count;
+	struct odbx_mat** mats;
+};
+
+struct odbx_cache_t
+{
+	odbx_lock_t lock;
+	int refs;
+	uint64_t ttl;
+	size_t maxmem;
+	size_t used;
+	size_t buckets;
+	unsigned long entries;
+	struct odbx_centry** table;
+	struct odbx_centry* newest;
+	struct odbx_centry* oldest;
+};
+
+
+
+/*
+ *  Statement analysis
+ */
+
+static uint64_t _odbx_cache_hash( const char* key, size_t len )
+{
+	size_t i;
+	uint64_t hash = 0xcbf29ce484222325ULL;   // 64 bit FNV-1a
+
+	for( i = 0; i < len; i++ )
+	{
+		hash ^= (unsigned char) key[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+
+
+static int _odbx_cache_keyword( const char* str, size_t len, const char* keyword )
+{
+	size_t klen = strlen( keyword );
+
+	if( len < klen || strncasecmp( str, keyword, klen ) != 0 ) { return 0; }
+	if( len > klen && ( isalnum( (unsigned char) str[klen] ) || str[klen] == '_' ) ) { return 0; }
+
+	return 1;
+}
+
+
+
+/*
+ *  Removes comments, collapses white space outside of quoted strings and
+ *  identifiers and removes trailing semicolons. Comments which aren't
+ *  comments in all dialects (executable MySQL comments, # and -- without
+ *  a space) are kept including their line break. Sets multi if the query
+ *  contains more than one statement or if backslash escapes or dollar
+ *  quoting make it impossible to tell where strings and statements end.
+ */
+
+static size_t _odbx_cache_normalize( const char* query, unsigned long length, char* to, int* multi )
+{
+	char quote = 0;
+	size_t len = 0;
+	unsigned long i, end;
+	int space = 0, semicolon = 0;
+
+
+	*multi = 0;
+
+
+	for( i = 0; i < length; i = end )
+	{
+		end = i + 1;
+
+		if( quote != 0 )
+		{
+			to[len++] = query[i];
+			if( query[i] == '\\' && ( quote == '\'' || quote == '"' ) ) { *multi = 1; }
+			if( query[i] == quote ) { quote = 0; }
+			continue;
+		}
+
+		switch( query[i] )
+		{
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\n':
+				space = 1;
+				continue;
+			case ';':
+				semicolon = 1;
+				continue;
+			case '\'':
+			case '"':
+			case '`':
+				quote = query[i];
+				break;
+			case '[':
+				quote = ']';
+				break;
+			case '$':
+				*multi = 1;
+				break;
+			case '#':
+				quote = '\n';
+				break;
+			case '-':
+				if( end < length && query[end] == '-' )
+				{
+					if( end + 1 < length && !isspace( (unsigned char) query[end+1] ) )
+					{
+						quote = '\n';
+						break;
+					}
+
+					while( end < length && query[end] != '\n' ) { end++; }
+					space = 1;
+					continue;
+				}
+				break;
+			case '/':
+				if( end < length && query[end] == '*' )
+				{
+					for( end = i + 3; end < length && ( query[end-1] != '*' || query[end] != '/' ); end++ );
+					end = end < length ? end + 1 : length;
+
+					if( i + 2 < length && query[i+2] == '!' ) { break; }
+
+					space = 1;
+					continue;
+				}
+				break;
+		}
+
+		if( semicolon && len > 0 )
+		{
+			to[len++] = ';';
+			*multi = 1;
+		}
+		if( space && len > 0 ) { to[len++] = ' '; }
+		semicolon = space = 0;
+
+		memcpy( to + len, query + i, end - i );
+		len += end - i;
+	}
+
+	return len;
+}
+
+
+
+/*
+ *  Copies the table name at the beginning of str in lower case to the tag
+ *  list without quotes and schema. Used for the name following a FROM,
+ *  JOIN, INTO, UPDATE, USING, TABLE or TRUNCATE keyword and for the names
+ *  following the commas in FROM and UPDATE table lists.
+ */
+
+static size_t _odbx_cache_table( const char* str, size_t len, char* to )
+{
+	size_t i = 0, tlen = 0;
+	char quote = 0;
+
+
+	while( i < len && str[i] == ' ' ) { i++; }
+
+	if( _odbx_cache_keyword( str + i, len - i, "TABLE" ) ) { return 0; }   // TRUNCATE TABLE, tagged by TABLE
+
+	if( _odbx_cache_keyword( str + i, len - i, "ONLY" ) )   // FROM ONLY parent
+	{
+		for( i += 4; i < len && str[i] == ' '; i++ );
+	}
+
+	for( ; i < len; i++ )
+	{
+		if( quote != 0 )
+		{
+			if( str[i] == quote ) { quote = 0; continue; }
+		}
+		else
+		{
+			switch( str[i] )
+			{
+				case '"':
+				case '`':
+					quote = str[i];
+					continue;
+				case '[':
+					quote = ']';
+					continue;
+				case '.':
+					tlen = 0;   // drop schema name
+					continue;
+			}
+
+			if( !isalnum( (unsigned char) str[i] ) && str[i] != '_' && str[i] != '$' ) { break; }
+		}
+
+		to[tlen++] = (char) tolower( (unsigned char) str[i] );
+	}
+
+	if( tlen == 0 ) { return 0; }
+
+	to[tlen++] = '\0';
+	return tlen;
+}
+
+
+
+/*
+ *  Extracts the names of the tables a statement refers to. Returns 1 if
+ *  the statement is a SELECT statement whose results can be cached, 0 for
+ *  all other statements. Each nesting level of parentheses remembers if
+ *  it's within a FROM or UPDATE table list, so every comma separated item
+ *  of the list is tagged. Subqueries are tagged by their own FROM clauses.
+ *  Statements nested too deeply to keep track of the lists aren't cached.
+ */
+
+static int _odbx_cache_analyze( struct odbx_cstate* cs, const char* sql, size_t len )
+{
+	size_t i;
+	char quote = 0;
+	size_t depth = 0;
+	uint64_t list = 0;   // bit n is set within a table list on nesting level n
+	int select = _odbx_cache_keyword( sql, len, "SELECT" );
+	static const char* keywords[] = { "FROM", "JOIN", "INTO", "UPDATE", "USING", "TABLE", "TRUNCATE", NULL };
+	static const char* clauses[] = { "WHERE", "SET", "GROUP", "HAVING", "ORDER", "LIMIT", "WINDOW",
+		"UNION", "EXCEPT", "INTERSECT", "RETURNING", NULL };
+
+
+	cs->tagslen = 0;
+
+	for( i = 0; i < len; i++ )
+	{
+		const char** kw;
+
+		if( quote != 0 )
+		{
+			if( sql[i] == quote ) { quote = 0; }
+			continue;
+		}
+
+		switch( sql[i] )
+		{
+			case '\'':
+			case '"':
+			case '`':
+				quote = sql[i];
+				continue;
+			case '[':
+				quote = ']';
+				continue;
+			case '(':
+				if( ++depth < ODBX_CACHE_NESTING ) { list &= ~( 1ULL << depth ); }
+				else { select = 0; }
+				continue;
+			case ')':
+				if( depth > 0 ) { depth--; }
+				continue;
+			case ',':
+				if( depth < ODBX_CACHE_NESTING && ( list & ( 1ULL << depth ) ) != 0 )
+				{
+					cs->tagslen += _odbx_cache_table( sql + i + 1, len - i - 1, cs->tags + cs->tagslen );
+				}
+				continue;
+		}
+
+		if( i > 0 && ( isalnum( (unsigned char) sql[i-1] ) || sql[i-1] == '_' || sql[i-1] == '.' ) ) { continue; }
+
+		for( kw = keywords; *kw != NULL; kw++ )
+		{
+			if( _odbx_cache_keyword( sql + i, len - i, *kw ) )
+			{
+				if( depth < ODBX_CACHE_NESTING && ( kw == keywords || kw == keywords + 3 ) )   // FROM or UPDATE
+				{
+					list |= 1ULL << depth;
+				}
+
+				i += strlen( *kw );
+				cs->tagslen += _odbx_cache_table( sql + i, len - i, cs->tags + cs->tagslen );
+				break;
+			}
+		}
+
+		for( kw = clauses; *kw != NULL; kw++ )
+		{
+			if( depth < ODBX_CACHE_NESTING && _odbx_cache_keyword( sql + i, len - i, *kw ) )
+			{
+				list &= ~( 1ULL << depth );
+				break;
+			}
+		}
+
+		if( select && _odbx_cache_keyword( sql + i, len - i, "FOR" ) ) { select = 0; }   // SELECT ... FOR UPDATE
+	}
+
+	return select;
+}
+
+
+
+static int _odbx_cache_tagged( const struct odbx_centry* entry, const char* tag )
+{
+	size_t pos = 0;
+
+	while( pos < entry->tagslen )
+	{
+		if( strcmp( entry->tags + pos, tag ) == 0 ) { return 1; }
+		pos += strlen( entry->tags + pos ) + 1;
+	}
+
+	return 0;
+}
+
+
+
+
+
+/*
+ *  Cache entry handling (called with locked cache)
+ */
+
+static void _odbx_cache_free( struct odbx_centry* entry )
+{
+	unsigned long i;
+
+	for( i = 0; i < entry->count; i++ )
+	{
+		free( entry->mats[i] );
+	}
+
+	free( entry );
+}
+
+
+
+static void _odbx_cache_unlink( odbx_cache_t* cache, struct odbx_centry* entry )
+{
+	struct odbx_centry** ptr = &cache->table[entry->hash & ( cache->buckets - 1 )];
+
+	while( *ptr != NULL && *ptr != entry ) { ptr = &(*ptr)->next; }
+	if( *ptr != NULL ) { *ptr = entry->next; }
+
+	if( entry->newer != NULL ) { entry->newer->older = entry->older; }
+	else { cache->newest = entry->older; }
+
+	if( entry->older != NULL ) { entry->older->newer = entry->newer; }
+	else { cache->oldest = entry->newer; }
+
+	cache->used -= entry->size;
+	cache->entries--;
+	entry->linked = 0;
+
+	if( entry->refs == 0 ) { _odbx_cache_free( entry ); }
+}
+
+
+
+static int _odbx_cache_unref( odbx_cache_t* cache )
+{
+	if( --cache->refs > 0 ) { return 0; }
+
+	while( cache->oldest != NULL )
+	{
+		_odbx_cache_unlink( cache, cache->oldest );
+	}
+
+	free( cache->table );
+	return 1;
+}
+
+
+
+static struct odbx_centry* _odbx_cache_lookup( odbx_cache_t* cache, const char* key, size_t keylen, uint64_t hash )
+{
+	struct odbx_centry* entry = cache->table[hash & ( cache->buckets - 1 )];
+
+	while( entry != NULL )
+	{
+		if( entry->hash == hash && entry->keylen == keylen && memcmp( entry->key, key, keylen ) == 0 ) { return entry; }
+		entry = entry->next;
+	}
+
+	return NULL;
+}
+
+
+
+static void _odbx_cache_release( void* arg )
+{
+	struct odbx_centry* entry = (struct odbx_centry*) arg;
+	odbx_cache_t* cache = entry->cache;
+	int done;
+
+	_odbx_lib_lock( &cache->lock );
+
+	if( --entry->refs == 0 && !entry->linked ) { _odbx_cache_free( entry ); }
+	done = _odbx_cache_unref( cache );
+
+	_odbx_lib_unlock( &cache->lock );
+
+	if( done )
+	{
+		_odbx_lib_lock_destroy( &cache->lock );
+		free( cache );
+	}
+}
+
+
+
+static void _odbx_cache_store( struct odbx_cstate* cs )
+{
+	unsigned long i;
+	size_t size, bucket;
+	struct odbx_centry* entry;
+	struct odbx_centry* old;
+	odbx_cache_t* cache = cs->cache;
+
+
+	size = sizeof( struct odbx_centry ) + sizeof( struct odbx_mat* ) * cs->count + cs->keylen + cs->tagslen;
+
+	if( ( entry = (struct odbx_centry*) malloc( size ) ) == NULL ) { return; }
+
+	entry->mats = (struct odbx_mat**) ( entry + 1 );
+	entry->key = (char*) ( entry->mats + cs->count );
+	entry->tags = entry->key + cs->keylen;
+
+	memcpy( entry->mats, cs->mats, sizeof( struct odbx_mat* ) * cs->count );
+	memcpy( entry->key, cs->key, cs->keylen );
+	memcpy( entry->tags, cs->tags, cs->tagslen );
+
+	entry->count = cs->count;
+	entry->keylen = cs->keylen;
+	entry->tagslen = cs->tagslen;
+	entry->hash = cs->hash;
+	entry->cache = cache;
+	entry->refs = 0;
+	entry->linked = 1;
+	entry->newer = NULL;
+
+	for( i = 0; i < cs->count; i++ ) { size += (size_t) cs->mats[i]->size; }
+	entry->size = size;
+	cs->count = 0;   // owned by the entry now
+
+	_odbx_lib_lock( &cache->lock );
+
+	if( size > cache->maxmem )
+	{
+		_odbx_lib_unlock( &cache->lock );
+		_odbx_cache_free( entry );
+		return;
+	}
+
+	entry->expires = cache->ttl != 0 ? _odbx_lib_time() + cache->ttl : 0;
+
+	if( ( old = _odbx_cache_lookup( cache, entry->key, entry->keylen, entry->hash ) ) != NULL )
+	{
+		_odbx_cache_unlink( cache, old );
+	}
+
+	while( cache->used + size > cache->maxmem && cache->oldest != NULL )
+	{
+		_odbx_cache_unlink( cache, cache->oldest );   // least recently used
+	}
+
+	bucket = entry->hash & ( cache->buckets - 1 );
+	entry->next = cache->table[bucket];
+	cache->table[bucket] = entry;
+
+	entry->older = cache->newest;
+	if( cache->newest != NULL ) { cache->newest->newer = entry; }
+	else { cache->oldest = entry; }
+	cache->newest = entry;
+
+	cache->used += size;
+	cache->entries++;
+
+	_odbx_lib_unlock( &cache->lock );
+}
+
+
+
+static void _odbx_cache_reset( struct odbx_cstate* cs )
+{
+	unsigned long i;
+
+	if( cs->current != NULL ) { _odbx_mat_abort( &cs->build ); }
+
+	for( i = 0; i < cs->count; i++ )
+	{
+		free( cs->mats[i] );
+	}
+
+	if( cs->replay != NULL )
+	{
+		_odbx_cache_release( cs->replay );
+		cs->replay = NULL;
+	}
+
+	cs->count = 0;
+	cs->record = 0;
+	cs->current = NULL;
+}
+
+
+
+/*
+ *  Computes key and tags of the statement. Returns 1 if the statement is
+ *  cacheable. The tag list can't be longer than the normalized statement.
+ */
+
+static int _odbx_cache_key( odbx_t* handle, struct odbx_cstate* cs, const char* query, unsigned long length )
+{
+	int multi;
+	size_t nlen, dlen, size;
+
+
+	nlen = handle->name != NULL ? strlen( handle->name ) : 0;
+	dlen = handle->database != NULL ? strlen( handle->database ) : 0;
+	size = nlen + dlen + 2 + length;
+
+	if( size > cs->keysize )
+	{
+		char* key;
+		char* tags;
+
+		if( ( key = (char*) realloc( cs->key, size ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+		cs->key = key;
+
+		if( ( tags = (char*) realloc( cs->tags, size ) ) == NULL ) { return -ODBX_ERR_NOMEM; }
+		cs->tags = tags;
+
+		cs->keysize = size;
+	}
+
+	memcpy( cs->key, handle->name, nlen );
+	cs->key[nlen] = '\0';
+	memcpy( cs->key + nlen + 1, handle->database, dlen );
+	cs->key[nlen+dlen+1] = '\0';
+	cs->prefix = nlen + dlen + 2;
+
+	cs->keylen = _odbx_cache_normalize( query, length, cs->key + cs->prefix, &multi );
+	cs->tagslen = 0;
+
+	if( cs->keylen == 0 ) { return 0; }
+
+	if( _odbx_cache_analyze( cs, cs->key + cs->prefix, cs->keylen ) == 0 || multi ) { return 0; }
+
+	cs->keylen += cs->prefix;
+	cs->hash = _odbx_cache_hash( cs->key, cs->keylen );
+
+	return 1;
+}
+
+
+
+
+
+/*
+ *  Hooks called by the ODBX functions
+ */
+
+int _odbx_cache_query( odbx_t* handle, const char* query, unsigned long length )
+{
+	struct odbx_cstate* cs = handle->cache;
+	odbx_cache_t* cache = cs->cache;
+	struct odbx_centry* entry;
+	size_t pos;
+	int err;
+
+
+	_odbx_cache_reset( cs );
+
+	if( ( err = _odbx_cache_key( handle, cs, query, length ) ) < 0 ) { return err; }
+
+	if( err == 0 )   // no SELECT statement, results may be outdated now
+	{
+		for( pos = 0; pos < cs->tagslen; pos += strlen( cs->tags + pos ) + 1 )
+		{
+			odbx_cache_invalidate_tag( cache, cs->tags + pos );
+		}
+
+		return 0;
+	}
+
+	_odbx_lib_lock( &cache->lock );
+
+	if( ( entry = _odbx_cache_lookup( cache, cs->key, cs->keylen, cs->hash ) ) != NULL )
+	{
+		if( entry->expires == 0 || entry->expires > _odbx_lib_time() )
+		{
+			if( entry->newer != NULL )   // move to the front of the LRU list
+			{
+				entry->newer->older = entry->older;
+				if( entry->older != NULL ) { entry->older->newer = entry->newer; }
+				else { cache->oldest = entry->newer; }
+
+				entry->newer = NULL;
+				entry->older = cache->newest;
+				cache->newest->newer = entry;
+				cache->newest = entry;
+			}
+
+			entry->refs++;
+			cache->refs++;
+
+			cs->replay = entry;
+			cs->next = 0;
+
+			_odbx_lib_unlock( &cache->lock );
+			return 1;
+		}
+
+		_odbx_cache_unlink( cache, entry );   // expired
+	}
+
+	_odbx_lib_unlock( &cache->lock );
+
+	cs->record = 1;
+	return 0;
+}
+
+
+
+/*
+ *  Statements whose result sets aren't cached, only tables changed by them
+ *  are invalidated
+ */
+
+int _odbx_cache_bypass( odbx_t* handle, const char* query, unsigned long length )
+{
+	struct odbx_cstate* cs = handle->cache;
+	size_t pos;
+	int err;
+
+
+	_odbx_cache_reset( cs );
+
+	if( ( err = _odbx_cache_key( handle, cs, query, length ) ) < 0 ) { return err; }
+
+	if( err == 0 )
+	{
+		for( pos = 0; pos < cs->tagslen; pos += strlen( cs->tags + pos ) + 1 )
+		{
+			odbx_cache_invalidate_tag( cs->cache, cs->tags + pos );
+		}
+	}
+
+	return 0;
+}
+
+
+
+int _odbx_cache_result( odbx_t* handle, odbx_result_t** result )
+{
+	int err;
+	struct odbx_cstate* cs = handle->cache;
+	struct odbx_centry* entry = cs->replay;
+
+
+	if( cs->next < entry->count )
+	{
+		_odbx_lib_lock( &entry->cache->lock );
+		entry->refs++;
+		entry->cache->refs++;
+		_odbx_lib_unlock( &entry->cache->lock );
+
+		if( ( err = _odbx_mat_result( result, entry->mats[cs->next], _odbx_cache_release, entry ) ) < 0 )
+		{
+			_odbx_cache_release( entry );
+			return err;
+		}
+
+		cs->next++;
+		return err;
+	}
+
+	_odbx_cache_release( entry );
+	cs->replay = NULL;
+
+	return ODBX_RES_DONE;
+}
+
+
+
+void _odbx_cache_record( odbx_t* handle, odbx_result_t* result, int err )
+{
+	struct odbx_cstate* cs = handle->cache;
+
+	if( cs->current != NULL )   // previous result wasn't finished
+	{
+		_odbx_cache_reset( cs );
+		return;
+	}
+
+	switch( err )
+	{
+		case ODBX_RES_TIMEOUT:
+			return;
+		case ODBX_RES_DONE:
+			if( cs->current == NULL && cs->count > 0 ) { _odbx_cache_store( cs ); }
+			_odbx_cache_reset( cs );
+			return;
+		case ODBX_RES_NOROWS:
+		case ODBX_RES_ROWS:
+			break;
+		default:
+			_odbx_cache_reset( cs );
+			return;
+	}
+
+	if( cs->count == cs->size )
+	{
+		struct odbx_mat** mats;
+
+		if( ( mats = (struct odbx_mat**) realloc( cs->mats, sizeof( struct odbx_mat* ) * ( cs->size + 4 ) ) ) == NULL )
+		{
+			_odbx_cache_reset( cs );
+			return;
+		}
+
+		cs->mats = mats;
+		cs->size += 4;
+	}
+
+	if( _odbx_mat_begin( &cs->build, result, err ) < 0 )
+	{
+		_odbx_cache_reset( cs );
+		return;
+	}
+
+	cs->current = result;
+}
+
+
+
+void _odbx_cache_row( odbx_result_t* result, int err )
+{
+	struct odbx_cstate* cs = result->handle->cache;
+
+	if( cs->current != result || err == ODBX_ROW_DONE ) { return; }
+
+	if( err < 0 || _odbx_mat_row( &cs->build, result ) < 0 )
+	{
+		_odbx_cache_reset( cs );
+	}
+}
+
+
+
+void _odbx_cache_result_finish( odbx_result_t* result )
+{
+	struct odbx_cstate* cs = result->handle->cache;
+
+	int err;
+
+	if( cs->current != result ) { return; }
+
+	while( ( err = result->handle->ops->basic->row_fetch( result ) ) == ODBX_ROW_NEXT )
+	{
+		if( _odbx_mat_row( &cs->build, result ) < 0 )
+		{
+			_odbx_cache_reset( cs );
+			return;
+		}
+	}
+
+	if( err < 0 )
+	{
+		_odbx_cache_reset( cs );
+		return;
+	}
+
+	cs->current = NULL;
+
+	if( _odbx_mat_end( &cs->build, &cs->mats[cs->count] ) < 0 )
+	{
+		_odbx_cache_reset( cs );
+		return;
+	}
+
+	cs->count++;
+}
+
+
+
+void _odbx_cache_detach( odbx_t* handle )
+{
+	struct odbx_cstate* cs = handle->cache;
+	odbx_cache_t* cache = cs->cache;
+	int done;
+
+
+	_odbx_cache_reset( cs );
+
+	free( cs->mats );
+	free( cs->tags );
+	free( cs->key );
+	free( cs );
+
+	handle->cache = NULL;
+
+	_odbx_lib_lock( &cache->lock );
+	done = _odbx_cache_unref( cache );
+	_odbx_lib_unlock( &cache->lock );
+
+	if( done )
+	{
+		_odbx_lib_lock_destroy( &cache->lock );
+		free( cache );
+	}
+}
+
+
+
+
+
+/*
+ *  ODBX result cache operations
+ */
+
+int odbx_cache_init( odbx_cache_t** cache, unsigned long maxmem, unsigned long ttl )
+{
+	if( cache == NULL || maxmem == 0 ) { return -ODBX_ERR_PARAM; }
+
+	if( ( *cache = (odbx_cache_t*) calloc( 1, sizeof( odbx_cache_t ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	if( ( (*cache)->table = (struct odbx_centry**) calloc( ODBX_CACHE_BUCKETS, sizeof( struct odbx_centry* ) ) ) == NULL )
+	{
+		free( *cache );
+		*cache = NULL;
+
+		return -ODBX_ERR_NOMEM;
+	}
+
+	(*cache)->buckets = ODBX_CACHE_BUCKETS;
+	(*cache)->maxmem = maxmem;
+	(*cache)->ttl = (uint64_t) ttl * 1000000000;   // nanoseconds
+	(*cache)->refs = 1;
+
+	_odbx_lib_lock_init( &(*cache)->lock );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_cache_attach( odbx_t* handle, odbx_cache_t* cache )
+{
+	if( handle == NULL || handle->ops == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	if( handle->cache != NULL ) { _odbx_cache_detach( handle ); }
+	if( cache == NULL ) { return ODBX_ERR_SUCCESS; }
+
+	if( ( handle->cache = (struct odbx_cstate*) calloc( 1, sizeof( struct odbx_cstate ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	_odbx_lib_lock( &cache->lock );
+	cache->refs++;
+	_odbx_lib_unlock( &cache->lock );
+
+	handle->cache->cache = cache;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_cache_invalidate( odbx_t* handle, const char* query, unsigned long length )
+{
+	int err;
+	odbx_cache_t* cache;
+	struct odbx_centry* entry;
+	struct odbx_cstate cs;
+
+
+	if( query == NULL ) { return -ODBX_ERR_PARAM; }
+	if( handle == NULL || handle->cache == NULL ) { return -ODBX_ERR_HANDLE; }
+	if( length == 0 ) { length = (unsigned long) strlen( query ); }
+
+	cache = handle->cache->cache;
+	memset( &cs, 0, sizeof( struct odbx_cstate ) );   // don't touch a running recording
+
+	if( ( err = _odbx_cache_key( handle, &cs, query, length ) ) > 0 )
+	{
+		_odbx_lib_lock( &cache->lock );
+
+		if( ( entry = _odbx_cache_lookup( cache, cs.key, cs.keylen, cs.hash ) ) != NULL )
+		{
+			_odbx_cache_unlink( cache, entry );
+		}
+
+		_odbx_lib_unlock( &cache->lock );
+		err = ODBX_ERR_SUCCESS;
+	}
+
+	free( cs.tags );
+	free( cs.key );
+
+	return err;
+}
+
+
+
+int odbx_cache_invalidate_tag( odbx_cache_t* cache, const char* table )
+{
+	size_t i, len;
+	char tag[256];
+	struct odbx_centry* entry;
+	struct odbx_centry* older;
+
+
+	if( table == NULL ) { return -ODBX_ERR_PARAM; }
+	if( cache == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	if( ( len = strlen( table ) ) >= sizeof( tag ) ) { return -ODBX_ERR_SIZE; }
+
+	for( i = 0; i <= len; i++ )
+	{
+		tag[i] = (char) tolower( (unsigned char) table[i] );
+	}
+
+	_odbx_lib_lock( &cache->lock );
+
+	for( entry = cache->newest; entry != NULL; entry = older )
+	{
+		older = entry->older;
+		if( _odbx_cache_tagged( entry, tag ) ) { _odbx_cache_unlink( cache, entry ); }
+	}
+
+	_odbx_lib_unlock( &cache->lock );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_cache_finish( odbx_cache_t* cache )
+{
+	int done;
+
+	if( cache == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	_odbx_lib_lock( &cache->lock );
+
+	while( cache->oldest != NULL )
+	{
+		_odbx_cache_unlink( cache, cache->oldest );
+	}
+
+	done = _odbx_cache_unref( cache );
+
+	_odbx_lib_unlock( &cache->lock );
+
+	if( done )
+	{
+		_odbx_lib_lock_destroy( &cache->lock );
+		free( cache );
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
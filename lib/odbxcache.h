@@ -0,0 +1,67 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+#include "odbxmat.h"
+
+
+
+#ifndef ODBXCACHE_H
+#define ODBXCACHE_H
+
+
+
+/*
+ *  Cache state attached to each connection using a result cache
+ */
+
+struct odbx_cstate
+{
+	odbx_cache_t* cache;
+	char* key;   // backend \0 database \0 normalized statement
+	size_t keylen;
+	size_t keysize;
+	size_t prefix;   // length of backend and database part of the key
+	uint64_t hash;
+	char* tags;   // tables the statement refers to, each terminated by \0
+	size_t tagslen;
+	struct odbx_centry* replay;   // entry whose result sets are replayed
+	unsigned long next;   // next result set to replay
+	int record;   // result sets of the current statement are recorded
+	odbx_result_t* current;   // backend result whose rows are recorded
+	struct odbx_mat_builder build;
+	struct odbx_mat** mats;
+	unsigned long count;
+	unsigned long size;
+};
+
+
+
+/*
+ *  Hooks called by the ODBX functions if a cache is attached
+ */
+
+int _odbx_cache_query( odbx_t* handle, const char* query, unsigned long length );
+
+int _odbx_cache_bypass( odbx_t* handle, const char* query, unsigned long length );
+
+int _odbx_cache_result( odbx_t* handle, odbx_result_t** result );
+
+void _odbx_cache_record( odbx_t* handle, odbx_result_t* result, int err );
+
+void _odbx_cache_row( odbx_result_t* result, int err );
+
+void _odbx_cache_result_finish( odbx_result_t* result );
+
+void _odbx_cache_detach( odbx_t* handle );
+
+
+
+#endif
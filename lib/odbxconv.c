@@ -0,0 +1,638 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxconv.h"
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define ODBX_CONV_SWAR 1
+#endif
+
+
+
+static const double odbx_conv_pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const int64_t odbx_conv_scale[] = {
+	1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+	1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+	100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+	1000000000000000000LL
+};
+
+
+
+
+
+/*
+ *  Parsing eight digits at once (SWAR)
+ *
+ *  The first character is in the lowest byte after loading the string on
+ *  little endian machines. Each step combines neighbouring digits into
+ *  numbers with twice as much digits.
+ */
+
+#ifdef ODBX_CONV_SWAR
+
+static inline uint64_t _odbx_conv_load8( const char* str )
+{
+	uint64_t val;
+
+	memcpy( &val, str, sizeof( uint64_t ) );
+	return val;
+}
+
+
+
+static inline int _odbx_conv_isdigit8( uint64_t val )
+{
+	return ( ( ( val + 0x4646464646464646ULL ) | ( val - 0x3030303030303030ULL ) ) & 0x8080808080808080ULL ) == 0;
+}
+
+
+
+static inline uint32_t _odbx_conv_swar8( uint64_t val )
+{
+	val -= 0x3030303030303030ULL;
+	val = ( val * 10 ) + ( val >> 8 );
+	val = ( ( ( val & 0x000000FF000000FFULL ) * ( 100 + ( 1000000ULL << 32 ) ) ) +
+		( ( ( val >> 16 ) & 0x000000FF000000FFULL ) * ( 1 + ( 10000ULL << 32 ) ) ) ) >> 32;
+
+	return (uint32_t) val;
+}
+
+#endif
+
+
+
+/*
+ *  Parses up to 19 digits without sign into an unsigned integer
+ */
+
+static inline int _odbx_conv_digits( const char* str, unsigned long len, uint64_t* value )
+{
+	uint64_t num = 0;
+	unsigned long i = 0;
+
+	if( len == 0 || len > 19 ) { return -1; }
+
+#ifdef ODBX_CONV_SWAR
+	for( ; i + 8 <= len; i += 8 )
+	{
+		uint64_t val = _odbx_conv_load8( str + i );
+
+		if( !_odbx_conv_isdigit8( val ) ) { return -1; }
+		num = num * 100000000 + _odbx_conv_swar8( val );
+	}
+#endif
+
+	for( ; i < len; i++ )
+	{
+		if( str[i] < '0' || str[i] > '9' ) { return -1; }
+		num = num * 10 + ( str[i] - '0' );
+	}
+
+	*value = num;
+	return 0;
+}
+
+
+
+static inline int _odbx_conv_fixed( const char* str, int count )
+{
+	int i, num = 0;
+
+	for( i = 0; i < count; i++ )
+	{
+		if( str[i] < '0' || str[i] > '9' ) { return -1; }
+		num = num * 10 + ( str[i] - '0' );
+	}
+
+	return num;
+}
+
+
+
+/*
+ *  Days since 1970-01-01 in the proleptic gregorian calendar
+ */
+
+static inline int64_t _odbx_conv_days( int64_t year, int month, int day )
+{
+	int64_t era, yoe, doy;
+
+	year -= month <= 2;
+	era = ( year >= 0 ? year : year - 399 ) / 400;
+	yoe = year - era * 400;
+	doy = ( 153 * ( month + ( month > 2 ? -3 : 9 ) ) + 2 ) / 5 + day - 1;
+
+	return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+
+
+
+
+/*
+ *  Scalar conversion functions
+ */
+
+int _odbx_conv_int( const char* str, unsigned long len, int64_t* value )
+{
+	uint64_t num;
+	int neg = 0;
+
+	if( len > 0 && ( str[0] == '-' || str[0] == '+' ) )
+	{
+		neg = str[0] == '-';
+		str++; len--;
+	}
+
+	if( _odbx_conv_digits( str, len, &num ) < 0 ) { return -1; }
+	if( num > (uint64_t) INT64_MAX + neg ) { return -1; }
+
+	*value = neg ? (int64_t) ( 0 - num ) : (int64_t) num;
+	return 0;
+}
+
+
+
+int _odbx_conv_decimal( const char* str, unsigned long len, unsigned int scale, int64_t* value )
+{
+	uint64_t num = 0, frac = 0;
+	unsigned long i = 0, ilen, flen = 0;
+	int neg = 0, round = 0;
+
+
+	if( scale > 18 ) { return -1; }
+
+	if( len > 0 && ( str[0] == '-' || str[0] == '+' ) )
+	{
+		neg = str[0] == '-';
+		i++;
+	}
+
+	for( ilen = i; ilen < len && str[ilen] != '.'; ilen++ );
+
+	if( ilen > i && _odbx_conv_digits( str + i, ilen - i, &num ) < 0 ) { return -1; }
+
+	if( ilen < len )   // fraction
+	{
+		for( i = ilen + 1; i < len; i++ )
+		{
+			if( str[i] < '0' || str[i] > '9' ) { return -1; }
+
+			if( flen < scale ) { frac = frac * 10 + ( str[i] - '0' ); flen++; }
+			else if( flen == scale && round == 0 ) { round = str[i] >= '5' ? 1 : -1; }
+		}
+
+		if( ilen + 1 == len && ilen == (unsigned long) neg ) { return -1; }   // only "."
+	}
+	else if( ilen == (unsigned long) neg ) { return -1; }   // no digits
+
+	for( ; flen < scale; flen++ ) { frac *= 10; }
+
+	if( num > ( (uint64_t) INT64_MAX - frac - 1 ) / odbx_conv_scale[scale] ) { return -1; }
+
+	num = num * odbx_conv_scale[scale] + frac + ( round > 0 );
+
+	*value = neg ? -(int64_t) num : (int64_t) num;
+	return 0;
+}
+
+
+
+/*
+ *  Numbers with up to 19 significant digits and a small exponent are
+ *  converted exactly by one multiplication or division, all others by
+ *  strtod() independent of the decimal point of the current locale
+ */
+
+int _odbx_conv_double( const char* str, unsigned long len, double* value )
+{
+	char buffer[64];
+	char* copy = buffer;
+	const char* dp;
+	char* end;
+	uint64_t mant = 0;
+	unsigned long i = 0, start;
+	int neg = 0, digits = 0, exp = 0, err = 0;
+
+
+	if( len == 0 ) { return -1; }
+
+	if( str[0] == '-' || str[0] == '+' )
+	{
+		neg = str[0] == '-';
+		i++;
+	}
+
+	start = i;
+
+	for( ; i < len && str[i] >= '0' && str[i] <= '9'; i++, digits++ )
+	{
+		mant = mant * 10 + ( str[i] - '0' );
+	}
+
+	if( i < len && str[i] == '.' )
+	{
+		for( i++; i < len && str[i] >= '0' && str[i] <= '9'; i++, digits++, exp-- )
+		{
+			mant = mant * 10 + ( str[i] - '0' );
+		}
+	}
+
+	if( i < len && ( str[i] == 'e' || str[i] == 'E' ) )
+	{
+		int eneg = 0, e = 0;
+
+		if( ++i < len && ( str[i] == '-' || str[i] == '+' ) ) { eneg = str[i++] == '-'; }
+		if( i == len ) { digits = 0; }
+
+		for( ; i < len && str[i] >= '0' && str[i] <= '9'; i++ )
+		{
+			if( e < 10000 ) { e = e * 10 + ( str[i] - '0' ); }
+		}
+
+		exp += eneg ? -e : e;
+	}
+
+	if( i == len && digits > 0 && digits <= 19 && mant <= ( 1ULL << 53 ) && exp >= -22 && exp <= 22 )
+	{
+		*value = exp < 0 ? (double) mant / odbx_conv_pow10[-exp] : (double) mant * odbx_conv_pow10[exp];
+		if( neg ) { *value = -*value; }
+
+		return 0;
+	}
+
+	// long mantissas, large exponents, inf and nan
+
+	if( i < len )   // strtod() would also accept white space, hex numbers and "nan(...)"
+	{
+		if( i != start || ( ( len - i != 3 || ( strncasecmp( str + i, "inf", 3 ) != 0 && strncasecmp( str + i, "nan", 3 ) != 0 ) ) &&
+			( len - i != 8 || strncasecmp( str + i, "infinity", 8 ) != 0 ) ) )
+		{
+			return -1;
+		}
+	}
+	else if( digits == 0 ) { return -1; }
+
+	if( len >= sizeof( buffer ) && ( copy = (char*) malloc( len + 1 ) ) == NULL ) { return -1; }
+
+	memcpy( copy, str, len );   // values aren't always terminated by \0
+	copy[len] = '\0';
+
+	if( ( dp = localeconv()->decimal_point ) != NULL && dp[0] != '.' && dp[0] != '\0' && dp[1] == '\0' )
+	{
+		for( i = 0; i < len; i++ )   // strtod() expects the decimal point of the current locale
+		{
+			if( copy[i] == '.' ) { copy[i] = dp[0]; }
+			else if( copy[i] == dp[0] ) { copy[i] = '.'; }   // and mustn't accept it instead of '.'
+		}
+	}
+
+	*value = strtod( copy, &end );
+	if( end != copy + len ) { err = -1; }
+
+	if( copy != buffer ) { free( copy ); }
+
+	return err;
+}
+
+
+
+int _odbx_conv_bool( const char* str, unsigned long len, int* value )
+{
+	int i;
+	static const char* words[] = { "f", "t", "false", "true", "n", "y", "no", "yes", "0", "1", "off", "on", NULL };
+
+	for( i = 0; words[i] != NULL; i++ )
+	{
+		if( strlen( words[i] ) == len && strncasecmp( str, words[i], len ) == 0 )
+		{
+			*value = i & 1;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+
+
+int _odbx_conv_date( const char* str, unsigned long len, int64_t* days )
+{
+	int year, month, day;
+
+	if( len < 10 || str[4] != '-' || str[7] != '-' ) { return -1; }
+
+	if( ( year = _odbx_conv_fixed( str, 4 ) ) < 0 ) { return -1; }
+	if( ( month = _odbx_conv_fixed( str + 5, 2 ) ) < 1 || month > 12 ) { return -1; }
+	if( ( day = _odbx_conv_fixed( str + 8, 2 ) ) < 1 || day > 31 ) { return -1; }
+
+	*days = _odbx_conv_days( year, month, day );
+	return 10;
+}
+
+
+
+int _odbx_conv_time( const char* str, unsigned long len, int64_t* usec )
+{
+	int hour, min, sec, i = 8, frac = 0, digits = 0;
+
+	if( len < 8 || str[2] != ':' || str[5] != ':' ) { return -1; }
+
+	if( ( hour = _odbx_conv_fixed( str, 2 ) ) < 0 || hour > 24 ) { return -1; }
+	if( ( min = _odbx_conv_fixed( str + 3, 2 ) ) < 0 || min > 59 ) { return -1; }
+	if( ( sec = _odbx_conv_fixed( str + 6, 2 ) ) < 0 || sec > 60 ) { return -1; }
+
+	if( len > 8 && str[8] == '.' )
+	{
+		for( i = 9; i < (int) len && str[i] >= '0' && str[i] <= '9'; i++ )
+		{
+			if( digits < 6 ) { frac = frac * 10 + ( str[i] - '0' ); digits++; }
+		}
+
+		for( ; digits < 6; digits++ ) { frac *= 10; }
+	}
+
+	*usec = ( ( hour * 60 + min ) * 60 + sec ) * (int64_t) 1000000 + frac;
+	return i;
+}
+
+
+
+/*
+ *  Parses "YYYY-MM-DD[( |T)HH:MM:SS[.ffffff]][Z|(+|-)HH[[:]MM]]"
+ */
+
+int _odbx_conv_timestamp( const char* str, unsigned long len, int utc, int64_t* usec )
+{
+	int i, hour, min = 0;
+	int64_t days, time = 0;
+
+	if( ( i = _odbx_conv_date( str, len, &days ) ) < 0 ) { return -1; }
+
+	if( (unsigned long) i < len && ( str[i] == ' ' || str[i] == 'T' ) )
+	{
+		int n;
+
+		if( ( n = _odbx_conv_time( str + i + 1, len - i - 1, &time ) ) < 0 ) { return -1; }
+		i += n + 1;
+	}
+
+	*usec = days * 86400 * (int64_t) 1000000 + time;
+
+	if( (unsigned long) i == len ) { return 0; }
+	if( str[i] == 'Z' && (unsigned long) i + 1 == len ) { return 0; }
+	if( ( str[i] != '+' && str[i] != '-' ) || len - i < 3 ) { return -1; }
+
+	if( ( hour = _odbx_conv_fixed( str + i + 1, 2 ) ) < 0 ) { return -1; }
+
+	if( len - i > 3 )
+	{
+		int pos = str[i+3] == ':' ? i + 4 : i + 3;
+
+		if( len - pos != 2 || ( min = _odbx_conv_fixed( str + pos, 2 ) ) < 0 ) { return -1; }
+	}
+
+	if( utc )
+	{
+		int64_t offset = ( hour * 60 + min ) * 60 * (int64_t) 1000000;
+		*usec += str[i] == '-' ? offset : -offset;
+	}
+
+	return 0;
+}
+
+
+
+
+
+/*
+ *  Column conversion functions
+ */
+
+#ifdef __SSE2__
+
+static const unsigned char odbx_conv_mask[32] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+
+
+/*
+ *  Parses the len <= 16 digits before end using one 16 byte vector. The
+ *  bytes in front of the digits are replaced by '0', so they must be
+ *  readable but can contain anything.
+ */
+
+static inline int _odbx_conv_digits16( const char* end, unsigned long len, uint64_t* value )
+{
+	const __m128i zero = _mm_set1_epi8( '0' );
+	__m128i keep = _mm_loadu_si128( (const __m128i*) ( odbx_conv_mask + len ) );
+	__m128i vec = _mm_loadu_si128( (const __m128i*) ( end - 16 ) );
+	__m128i lo, hi;
+
+
+	vec = _mm_or_si128( _mm_and_si128( keep, vec ), _mm_andnot_si128( keep, zero ) );
+	vec = _mm_sub_epi8( vec, zero );
+
+	if( _mm_movemask_epi8( _mm_or_si128( _mm_cmpgt_epi8( vec, _mm_set1_epi8( 9 ) ), _mm_cmplt_epi8( vec, _mm_setzero_si128() ) ) ) != 0 )
+	{
+		return -1;
+	}
+
+	lo = _mm_madd_epi16( _mm_unpacklo_epi8( vec, _mm_setzero_si128() ), _mm_set_epi16( 1, 10, 1, 10, 1, 10, 1, 10 ) );
+	hi = _mm_madd_epi16( _mm_unpackhi_epi8( vec, _mm_setzero_si128() ), _mm_set_epi16( 1, 10, 1, 10, 1, 10, 1, 10 ) );
+	vec = _mm_madd_epi16( _mm_packs_epi32( lo, hi ), _mm_set_epi16( 1, 100, 1, 100, 1, 100, 1, 100 ) );
+	vec = _mm_madd_epi16( _mm_packs_epi32( vec, vec ), _mm_set_epi16( 1, 10000, 1, 10000, 1, 10000, 1, 10000 ) );
+
+	*value = (uint64_t) (uint32_t) _mm_cvtsi128_si32( vec ) * 100000000 + (uint32_t) _mm_cvtsi128_si32( _mm_srli_si128( vec, 4 ) );
+	return 0;
+}
+
+#endif
+
+
+
+uint64_t _odbx_conv_int_column( const struct odbx_mat* mat, unsigned long col, int width, void* values, unsigned char* valid )
+{
+	int neg;
+	uint64_t row, cell, num, nulls = 0;
+	int64_t max = width == 2 ? INT16_MAX : ( width == 4 ? INT32_MAX : INT64_MAX );
+	unsigned long len;
+	const char* str;
+
+
+	for( row = 0, cell = col; row < mat->rows; row++, cell += mat->cols )
+	{
+		if( _odbx_mat_isnull( mat, cell ) ) { nulls++; continue; }
+
+		str = _odbx_mat_value( mat, cell );
+		len = _odbx_mat_length( mat, cell );
+		neg = 0;
+
+		if( len > 0 && ( str[0] == '-' || str[0] == '+' ) )
+		{
+			neg = str[0] == '-';
+			str++; len--;
+		}
+
+#ifdef __SSE2__
+		// values start behind the header of the arena, so 16 bytes in front of their end are readable
+		if( len > 0 && len <= 16 )
+		{
+			if( _odbx_conv_digits16( str + len, len, &num ) < 0 ) { nulls++; continue; }
+		}
+		else
+#endif
+		if( _odbx_conv_digits( str, len, &num ) < 0 ) { nulls++; continue; }
+
+		if( num > (uint64_t) max + neg ) { nulls++; continue; }
+
+		switch( width )
+		{
+			case 2:
+				((int16_t*) values)[row] = (int16_t) ( neg ? 0 - num : num );
+				break;
+			case 4:
+				((int32_t*) values)[row] = (int32_t) ( neg ? 0 - num : num );
+				break;
+			default:
+				((int64_t*) values)[row] = (int64_t) ( neg ? 0 - num : num );
+		}
+
+		valid[row >> 3] |= 1 << ( row & 7 );
+	}
+
+	return nulls;
+}
+
+
+
+
+
+/*
+ *  ODBX typed field access
+ */
+
+static inline const char* _odbx_conv_field( odbx_result_t* result, unsigned long pos, unsigned long* len )
+{
+	const char* value;
+
+	if( ( value = odbx_field_value( result, pos ) ) == NULL ) { return NULL; }
+
+	*len = odbx_field_length( result, pos );
+	return value;
+}
+
+
+
+int odbx_field_int64( odbx_result_t* result, unsigned long pos, int64_t* value )
+{
+	unsigned long len;
+	const char* str;
+
+	if( value == NULL || ( str = _odbx_conv_field( result, pos, &len ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_int( str, len, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_field_decimal( odbx_result_t* result, unsigned long pos, unsigned int scale, int64_t* value )
+{
+	unsigned long len;
+	const char* str;
+
+	if( value == NULL || ( str = _odbx_conv_field( result, pos, &len ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_decimal( str, len, scale, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_field_double( odbx_result_t* result, unsigned long pos, double* value )
+{
+	unsigned long len;
+	const char* str;
+
+	if( value == NULL || ( str = _odbx_conv_field( result, pos, &len ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_double( str, len, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_field_bool( odbx_result_t* result, unsigned long pos, int* value )
+{
+	unsigned long len;
+	const char* str;
+
+	if( value == NULL || ( str = _odbx_conv_field( result, pos, &len ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_bool( str, len, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_field_timestamp( odbx_result_t* result, unsigned long pos, int64_t* value )
+{
+	unsigned long len;
+	const char* str;
+
+	if( value == NULL || ( str = _odbx_conv_field( result, pos, &len ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_timestamp( str, len, 1, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+
+
+/*
+ *  ODBX conversion of strings with explicit length, e.g. by the C++ API
+ */
+
+int odbx_conv_int64( const char* str, unsigned long length, int64_t* value )
+{
+	if( str == NULL || value == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_int( str, length, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_conv_double( const char* str, unsigned long length, double* value )
+{
+	if( str == NULL || value == NULL ) { return -ODBX_ERR_PARAM; }
+	if( _odbx_conv_double( str, length, value ) < 0 ) { return -ODBX_ERR_PARAM; }
+
+	return ODBX_ERR_SUCCESS;
+}
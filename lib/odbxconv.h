@@ -0,0 +1,56 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxmat.h"
+
+
+
+#ifndef ODBXCONV_H
+#define ODBXCONV_H
+
+
+
+/*
+ *  Conversion of the textual representation of values returned by the
+ *  backends. All functions return a value less than zero if the string
+ *  doesn't contain a valid value of the requested type.
+ */
+
+int _odbx_conv_int( const char* str, unsigned long len, int64_t* value );
+
+int _odbx_conv_decimal( const char* str, unsigned long len, unsigned int scale, int64_t* value );
+
+int _odbx_conv_double( const char* str, unsigned long len, double* value );
+
+int _odbx_conv_bool( const char* str, unsigned long len, int* value );
+
+/* Days since 1970-01-01, returns the number of parsed characters */
+int _odbx_conv_date( const char* str, unsigned long len, int64_t* days );
+
+/* Microseconds since midnight, returns the number of parsed characters */
+int _odbx_conv_time( const char* str, unsigned long len, int64_t* usec );
+
+/* Microseconds since 1970-01-01, converted to UTC if utc is set */
+int _odbx_conv_timestamp( const char* str, unsigned long len, int utc, int64_t* usec );
+
+
+
+/*
+ *  Conversion of all values in one column of a materialized result set.
+ *  Writes integers of width bytes and sets the bits in the validity bitmap
+ *  of values which aren't NULL and could be converted. Returns the number
+ *  of NULL values.
+ */
+
+uint64_t _odbx_conv_int_column( const struct odbx_mat* mat, unsigned long col, int width, void* values, unsigned char* valid );
+
+
+
+#endif
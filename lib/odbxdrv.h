@@ -43,12 +43,41 @@
  *  Commonly used handle and result structures
  */
 
+struct odbx_hstats
+{
+	struct odbx_stats total;
+	struct odbx_stats flushed;   // part of total already added to the process wide counters
+	uint64_t query;   // time the last statement was sent
+	uint64_t result;   // time the current result set was returned
+	uint64_t rows;   // value of total.rows when the current result set was returned
+	int first;   // no result set of the current statement returned yet
+	int bound;
+};
+
+struct odbx_htimer
+{
+	uint64_t timeout;   // maximum duration of statements in nanoseconds, zero if disabled
+	uint64_t deadline;   // this and the following members are protected by the watchdog lock
+	struct odbx_t* next;
+	int queued;
+	int firing;   // watchdog is canceling the statement
+	int armed;   // only used by the thread using the handle
+	char canceled;   // set by odbx_cancel() from any thread
+};
+
 struct odbx_t
 {
 	struct odbx_ops* ops;
 	void* backend;
 	void* generic;
 	void* aux;
+	char* name;   // backend name given to odbx_init()
+	char* database;   // database name given to odbx_bind()
+	struct odbx_cstate* cache;   // result cache state, only used by the library
+	struct odbx_hstats stats;   // only used by the library
+	struct odbx_htimer timer;   // statement deadline, only used by the library
+	struct odbx_htrace* trace;   // trace hooks, only used by the library
+	struct odbx_rstate* rec;   // recording state, only used by the library
 };
 
 struct odbx_result_t
@@ -64,6 +93,16 @@ struct odbx_lo_t
 	void* generic;
 };
 
+struct odbx_stmt_t
+{
+	struct odbx_t* handle;
+	void* generic;
+	void* aux;
+	char* query;   // statement for statistics, traces and recordings, only used by the library
+	unsigned long length;
+	unsigned long count;   // number of parameters, set by the backend
+};
+
 
 
 /*
@@ -91,6 +130,7 @@ struct odbx_basic_ops
 	int (*column_type) ( odbx_result_t* result, unsigned long pos );
 	unsigned long (*field_length) ( odbx_result_t* result, unsigned long pos );
 	const char* (*field_value) ( odbx_result_t* result, unsigned long pos );
+	int (*cancel) ( odbx_t* handle );   // must be safe to call by another thread
 };
 
 
@@ -105,10 +145,28 @@ struct odbx_lo_ops
 
 
 
+/*
+ *  Prepared statements use question marks as placeholders. The results of
+ *  executed statements are returned by the result operation of the basic
+ *  operations and they must be finished before the statement is executed
+ *  again or finished.
+ */
+
+struct odbx_stmt_ops
+{
+	int (*prepare) ( odbx_stmt_t* stmt, const char* query, unsigned long length );
+	int (*bind) ( odbx_stmt_t* stmt, unsigned long pos, int type, const void* value, unsigned long length );
+	int (*execute) ( odbx_stmt_t* stmt );
+	int (*finish) ( odbx_stmt_t* stmt );
+};
+
+
+
 struct odbx_ops
 {
 	struct odbx_basic_ops* basic;
 	struct odbx_lo_ops* lo;
+	struct odbx_stmt_ops* stmt;
 };
 
 
@@ -9,8 +9,18 @@
 
 
 #include "odbxlib.h"
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#if defined( WIN32 ) && defined( HAVE_WINDOWS_H )
+#include <windows.h>
+#endif
 
 
 
@@ -26,6 +36,9 @@ extern struct odbx_ops mssql_odbx_ops;
 #if defined( HAVE_LIBMYSQLCLIENT_R ) || defined( HAVE_LIBMYSQLCLIENT ) || defined( HAVE_LIBMYSQL )
 extern struct odbx_ops mysql_odbx_ops;
 #endif
+#if defined( HAVE_BACKEND_NULL )
+extern struct odbx_ops null_odbx_ops;
+#endif
 #if defined( HAVE_LIBODBC )
 extern struct odbx_ops odbc_odbx_ops;
 #endif
@@ -35,6 +48,9 @@ extern struct odbx_ops oracle_odbx_ops;
 #if defined( HAVE_LIBPQ )
 extern struct odbx_ops pgsql_odbx_ops;
 #endif
+#if defined( HAVE_BACKEND_REPLAY )
+extern struct odbx_ops replay_odbx_ops;
+#endif
 #if defined( HAVE_LIBSQLITE )
 extern struct odbx_ops sqlite_odbx_ops;
 #endif
@@ -80,6 +96,12 @@ struct odbx_backend_syms odbx_lib_ops[] = {
 #endif
 #if defined( HAVE_LIBSQLITE )
 	{ "sqlite", &sqlite_odbx_ops },
+#endif
+#if defined( HAVE_BACKEND_NULL )
+	{ "null", &null_odbx_ops },
+#endif
+#if defined( HAVE_BACKEND_REPLAY )
+	{ "replay", &replay_odbx_ops },
 #endif
 	{ NULL, NULL }
 };
@@ -258,3 +280,45 @@ int _odbx_lib_close( struct odbx_t* handle )
 #else
 #error "Building shared libraries requires capabilities to load libraries dynamically"
 #endif
+
+
+
+/*
+ *  Platform independent helper functions
+ */
+
+char* _odbx_lib_strdup( const char* str )
+{
+	char* copy;
+	size_t len = strlen( str ) + 1;
+
+	if( ( copy = (char*) malloc( len ) ) != NULL )
+	{
+		memcpy( copy, str, len );
+	}
+
+	return copy;
+}
+
+
+
+uint64_t _odbx_lib_time( void )
+{
+#if defined( HAVE_CLOCK_GETTIME ) && defined( CLOCK_MONOTONIC )
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#elif defined( WIN32 )
+	LARGE_INTEGER freq, count;
+
+	QueryPerformanceFrequency( &freq );
+	QueryPerformanceCounter( &count );
+	return (uint64_t) ( count.QuadPart / freq.QuadPart ) * 1000000000 + (uint64_t) ( count.QuadPart % freq.QuadPart ) * 1000000000 / freq.QuadPart;
+#else
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+	return (uint64_t) tv.tv_sec * 1000000000 + (uint64_t) tv.tv_usec * 1000;
+#endif
+}
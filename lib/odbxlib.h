@@ -43,4 +43,66 @@ int _odbx_lib_open( struct odbx_t* handle, const char* backend );
 int _odbx_lib_close( struct odbx_t* handle );
 
 
+/* Copy of a zero terminated string, strdup() isn't part of C99 */
+char* _odbx_lib_strdup( const char* str );
+
+
+/* Monotonic time in nanoseconds */
+uint64_t _odbx_lib_time( void );
+
+
+/* Mutex for critical sections shared between threads, spin lock without POSIX threads */
+#ifdef HAVE_PTHREAD_H
+
+#include <pthread.h>
+
+typedef pthread_mutex_t odbx_lock_t;
+
+static inline void _odbx_lib_lock_init( odbx_lock_t* lock )
+{
+	pthread_mutex_init( lock, NULL );
+}
+
+static inline void _odbx_lib_lock_destroy( odbx_lock_t* lock )
+{
+	pthread_mutex_destroy( lock );
+}
+
+static inline void _odbx_lib_lock( odbx_lock_t* lock )
+{
+	pthread_mutex_lock( lock );
+}
+
+static inline void _odbx_lib_unlock( odbx_lock_t* lock )
+{
+	pthread_mutex_unlock( lock );
+}
+
+#else
+
+typedef char odbx_lock_t;
+
+static inline void _odbx_lib_lock_init( odbx_lock_t* lock )
+{
+	*lock = 0;
+}
+
+static inline void _odbx_lib_lock_destroy( odbx_lock_t* lock )
+{
+	(void) lock;
+}
+
+static inline void _odbx_lib_lock( odbx_lock_t* lock )
+{
+	while( __atomic_test_and_set( lock, __ATOMIC_ACQUIRE ) );
+}
+
+static inline void _odbx_lib_unlock( odbx_lock_t* lock )
+{
+	__atomic_clear( lock, __ATOMIC_RELEASE );
+}
+
+#endif
+
+
 #endif
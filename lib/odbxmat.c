@@ -0,0 +1,616 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxmat.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+
+
+/*
+ *  Result object and pseudo handle for materialized result sets
+ */
+
+struct odbx_mres
+{
+	struct odbx_result_t result;   // must be the first member
+	struct odbx_t handle;
+	const struct odbx_mat* mat;
+	uint64_t row;   // number of fetched rows
+	uint64_t cell;   // first cell of the current row
+	void (*release)( void* arg );
+	void* arg;
+};
+
+
+
+/*
+ *  File opened by odbx_result_open()
+ */
+
+struct odbx_mfile
+{
+	void* data;
+	size_t size;
+	int mapped;
+};
+
+
+
+static int _odbx_mat_result_finish( odbx_result_t* result );
+
+static int _odbx_mat_row_fetch( odbx_result_t* result );
+
+static uint64_t _odbx_mat_rows_affected( odbx_result_t* result );
+
+static void _odbx_mat_unmap( void* arg );
+
+static unsigned long _odbx_mat_column_count( odbx_result_t* result );
+
+static const char* _odbx_mat_column_name( odbx_result_t* result, unsigned long pos );
+
+static int _odbx_mat_column_type( odbx_result_t* result, unsigned long pos );
+
+static unsigned long _odbx_mat_field_length( odbx_result_t* result, unsigned long pos );
+
+static const char* _odbx_mat_field_value( odbx_result_t* result, unsigned long pos );
+
+
+
+static struct odbx_basic_ops odbx_mat_basic_ops = {
+	.init = NULL,
+	.bind = NULL,
+	.unbind = NULL,
+	.finish = NULL,
+	.get_option = NULL,
+	.set_option = NULL,
+	.error = NULL,
+	.error_type = NULL,
+	.escape = NULL,
+	.query = NULL,
+	.result = NULL,
+	.result_finish = _odbx_mat_result_finish,
+	.rows_affected = _odbx_mat_rows_affected,
+	.row_fetch = _odbx_mat_row_fetch,
+	.column_count = _odbx_mat_column_count,
+	.column_name = _odbx_mat_column_name,
+	.column_type = _odbx_mat_column_type,
+	.field_length = _odbx_mat_field_length,
+	.field_value = _odbx_mat_field_value,
+};
+
+static struct odbx_ops odbx_mat_ops = {
+	.basic = &odbx_mat_basic_ops,
+	.lo = NULL,
+	.stmt = NULL,
+};
+
+
+
+
+
+/*
+ *  Builder for materialized result sets
+ */
+
+int _odbx_mat_begin( struct odbx_mat_builder* build, odbx_result_t* result, int status )
+{
+	unsigned long i;
+	size_t len, size = 0;
+	const char* name;
+	char* names;
+	struct odbx_basic_ops* basic = result->handle->ops->basic;
+
+
+	memset( build, 0, sizeof( struct odbx_mat_builder ) );
+
+	build->status = status;
+	build->affected = basic->rows_affected != NULL ? basic->rows_affected( result ) : 0;
+
+	if( status != ODBX_RES_ROWS ) { return ODBX_ERR_SUCCESS; }
+
+	build->cols = basic->column_count( result );
+
+	if( ( build->offsets = (uint64_t*) malloc( sizeof( uint64_t ) * ( build->cols + 1 ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+	build->offsize = build->cols + 1;
+	build->offsets[0] = 0;
+
+	if( build->cols == 0 ) { return ODBX_ERR_SUCCESS; }
+
+	if( ( build->columns = (struct odbx_mat_column*) malloc( sizeof( struct odbx_mat_column ) * build->cols ) ) == NULL )
+	{
+		_odbx_mat_abort( build );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	for( i = 0; i < build->cols; i++ )
+	{
+		if( ( name = basic->column_name( result, i ) ) == NULL ) { name = ""; }
+		len = strlen( name );
+
+		if( build->namelen + len + 1 > size )
+		{
+			size = ( build->namelen + len + 1 ) * 2;
+
+			if( ( names = (char*) realloc( build->names, size ) ) == NULL )
+			{
+				_odbx_mat_abort( build );
+				return -ODBX_ERR_NOMEM;
+			}
+			build->names = names;
+		}
+
+		memcpy( build->names + build->namelen, name, len + 1 );
+
+		build->columns[i].name = build->namelen;
+		build->columns[i].namelen = (uint32_t) len;
+		build->columns[i].type = basic->column_type( result, i );
+		build->namelen += len + 1;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int _odbx_mat_row( struct odbx_mat_builder* build, odbx_result_t* result )
+{
+	unsigned long i, len;
+	const char* value;
+	char* data;
+	uint64_t* offsets;
+	unsigned char* nulls;
+	uint64_t cell = build->rows * build->cols;
+	size_t size, nullsize = ( cell + build->cols + 7 ) >> 3;
+	struct odbx_basic_ops* basic = result->handle->ops->basic;
+
+
+	if( cell + build->cols + 1 > build->offsize )
+	{
+		size = build->offsize * 2;
+		if( size < cell + build->cols + 1 ) { size = cell + build->cols + 1; }
+
+		if( ( offsets = (uint64_t*) realloc( build->offsets, sizeof( uint64_t ) * size ) ) == NULL )
+		{
+			return -ODBX_ERR_NOMEM;
+		}
+		build->offsets = offsets;
+		build->offsize = size;
+	}
+
+	if( nullsize > build->nullsize )
+	{
+		size = build->nullsize * 2;
+		if( size < nullsize ) { size = nullsize; }
+
+		if( ( nulls = (unsigned char*) realloc( build->nulls, size ) ) == NULL )
+		{
+			return -ODBX_ERR_NOMEM;
+		}
+		build->nulls = nulls;
+
+		memset( build->nulls + build->nullsize, 0, size - build->nullsize );
+		build->nullsize = size;
+	}
+
+	for( i = 0; i < build->cols; i++, cell++ )
+	{
+		if( ( value = basic->field_value( result, i ) ) == NULL )
+		{
+			build->nulls[cell >> 3] |= 1 << ( cell & 7 );
+			build->offsets[cell+1] = build->datalen;
+			continue;
+		}
+
+		len = basic->field_length != NULL ? basic->field_length( result, i ) : (unsigned long) strlen( value );
+
+		if( build->datalen + len + 1 > build->datasize )
+		{
+			size = build->datasize * 2;
+			if( size < build->datalen + len + 1 ) { size = build->datalen + len + 1 + 256; }
+
+			if( ( data = (char*) realloc( build->data, size ) ) == NULL )
+			{
+				return -ODBX_ERR_NOMEM;
+			}
+			build->data = data;
+			build->datasize = size;
+		}
+
+		memcpy( build->data + build->datalen, value, len );
+		build->data[build->datalen + len] = '\0';
+		build->datalen += len + 1;
+		build->offsets[cell+1] = build->datalen;
+	}
+
+	build->rows++;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int _odbx_mat_end( struct odbx_mat_builder* build, struct odbx_mat** mat )
+{
+	unsigned long i;
+	uint64_t cells = build->rows * build->cols;
+	size_t colpos, namepos, offpos, nullpos, datapos, size;
+
+
+	colpos = ODBX_MAT_ALIGN( sizeof( struct odbx_mat ) );
+	namepos = colpos + sizeof( struct odbx_mat_column ) * build->cols;
+	offpos = ODBX_MAT_ALIGN( namepos + build->namelen );
+	nullpos = offpos + sizeof( uint64_t ) * ( cells + 1 );
+	datapos = ODBX_MAT_ALIGN( nullpos + ( ( cells + 7 ) >> 3 ) );
+	size = datapos + build->datalen;
+
+	if( ( *mat = (struct odbx_mat*) malloc( size ) ) == NULL )
+	{
+		_odbx_mat_abort( build );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	memset( *mat, 0, datapos );
+
+	(*mat)->magic = ODBX_MAT_MAGIC;
+	(*mat)->version = ODBX_MAT_VERSION;
+	(*mat)->status = (uint16_t) build->status;
+	(*mat)->size = size;
+	(*mat)->affected = build->affected;
+	(*mat)->rows = build->rows;
+	(*mat)->cols = build->cols;
+	(*mat)->columns = colpos;
+	(*mat)->offsets = offpos;
+	(*mat)->nulls = nullpos;
+	(*mat)->data = datapos;
+
+	for( i = 0; i < build->cols; i++ )
+	{
+		build->columns[i].name += namepos;
+	}
+
+	if( build->cols > 0 ) { memcpy( (char*) *mat + colpos, build->columns, sizeof( struct odbx_mat_column ) * build->cols ); }
+	if( build->namelen > 0 ) { memcpy( (char*) *mat + namepos, build->names, build->namelen ); }
+	if( build->offsets != NULL ) { memcpy( (char*) *mat + offpos, build->offsets, sizeof( uint64_t ) * ( cells + 1 ) ); }
+	if( cells > 0 ) { memcpy( (char*) *mat + nullpos, build->nulls, ( cells + 7 ) >> 3 ); }
+	if( build->datalen > 0 ) { memcpy( (char*) *mat + datapos, build->data, build->datalen ); }
+
+	_odbx_mat_abort( build );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+void _odbx_mat_abort( struct odbx_mat_builder* build )
+{
+	free( build->columns );
+	free( build->names );
+	free( build->offsets );
+	free( build->nulls );
+	free( build->data );
+
+	memset( build, 0, sizeof( struct odbx_mat_builder ) );
+}
+
+
+
+
+
+/*
+ *  Result objects for materialized result sets
+ *
+ *  Each result object has its own pseudo handle so the ODBX functions
+ *  dispatch to the operations below instead to the backend of the
+ *  connection the rows were fetched from.
+ */
+
+int _odbx_mat_result( odbx_result_t** result, const struct odbx_mat* mat, void (*release)( void* arg ), void* arg )
+{
+	struct odbx_mres* mres;
+
+	if( ( mres = (struct odbx_mres*) calloc( 1, sizeof( struct odbx_mres ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	mres->handle.ops = &odbx_mat_ops;
+	mres->result.handle = &mres->handle;
+	mres->result.generic = (void*) mat;
+	mres->mat = mat;
+	mres->release = release;
+	mres->arg = arg;
+
+	*result = &mres->result;
+
+	return mat->status;
+}
+
+
+
+static int _odbx_mat_result_finish( odbx_result_t* result )
+{
+	struct odbx_mres* mres = (struct odbx_mres*) result;
+
+	if( mres->release != NULL ) { mres->release( mres->arg ); }
+	free( mres );
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+static void _odbx_mat_unmap( void* arg )
+{
+	struct odbx_mfile* mfile = (struct odbx_mfile*) arg;
+
+#ifdef HAVE_SYS_MMAN_H
+	if( mfile->mapped ) { munmap( mfile->data, mfile->size ); }
+	else
+#endif
+	free( mfile->data );
+
+	free( mfile );
+}
+
+
+
+static int _odbx_mat_row_fetch( odbx_result_t* result )
+{
+	struct odbx_mres* mres = (struct odbx_mres*) result;
+
+	if( mres->row < mres->mat->rows )
+	{
+		mres->cell = mres->row * mres->mat->cols;
+		mres->row++;
+
+		return ODBX_ROW_NEXT;
+	}
+
+	return ODBX_ROW_DONE;
+}
+
+
+
+static uint64_t _odbx_mat_rows_affected( odbx_result_t* result )
+{
+	return ((struct odbx_mres*) result)->mat->affected;
+}
+
+
+
+static unsigned long _odbx_mat_column_count( odbx_result_t* result )
+{
+	return (unsigned long) ((struct odbx_mres*) result)->mat->cols;
+}
+
+
+
+static const char* _odbx_mat_column_name( odbx_result_t* result, unsigned long pos )
+{
+	const struct odbx_mat* mat = ((struct odbx_mres*) result)->mat;
+
+	if( pos < mat->cols )
+	{
+		return (const char*) mat + _odbx_mat_column( mat, pos )->name;
+	}
+
+	return NULL;
+}
+
+
+
+static int _odbx_mat_column_type( odbx_result_t* result, unsigned long pos )
+{
+	const struct odbx_mat* mat = ((struct odbx_mres*) result)->mat;
+
+	if( pos < mat->cols )
+	{
+		return _odbx_mat_column( mat, pos )->type;
+	}
+
+	return -ODBX_ERR_PARAM;
+}
+
+
+
+static unsigned long _odbx_mat_field_length( odbx_result_t* result, unsigned long pos )
+{
+	struct odbx_mres* mres = (struct odbx_mres*) result;
+
+	if( mres->row > 0 && mres->row <= mres->mat->rows && pos < mres->mat->cols )
+	{
+		return _odbx_mat_length( mres->mat, mres->cell + pos );
+	}
+
+	return 0;
+}
+
+
+
+static const char* _odbx_mat_field_value( odbx_result_t* result, unsigned long pos )
+{
+	struct odbx_mres* mres = (struct odbx_mres*) result;
+
+	if( mres->row > 0 && mres->row <= mres->mat->rows && pos < mres->mat->cols && !_odbx_mat_isnull( mres->mat, mres->cell + pos ) )
+	{
+		return _odbx_mat_value( mres->mat, mres->cell + pos );
+	}
+
+	return NULL;
+}
+
+
+
+
+const struct odbx_mat* _odbx_mat_get( odbx_result_t* result )
+{
+	if( result->handle == NULL || result->handle->ops != &odbx_mat_ops ) { return NULL; }
+
+	return ((struct odbx_mres*) result)->mat;
+}
+
+
+
+
+
+/*
+ *  ODBX result materialization
+ */
+
+int odbx_result_detach( odbx_result_t* result, odbx_result_t** detached, unsigned long maxrows )
+{
+	int err;
+	unsigned long rows = 0;
+	struct odbx_mat* mat;
+	struct odbx_mat_builder build;
+
+
+	if( detached == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( result == NULL || result->handle == NULL || result->handle->ops == NULL || result->handle->ops->basic == NULL ||
+		result->handle->ops->basic->row_fetch == NULL || result->handle->ops->basic->column_count == NULL )
+	{
+		return -ODBX_ERR_HANDLE;
+	}
+
+	err = result->handle->ops->basic->column_count( result ) > 0 ? ODBX_RES_ROWS : ODBX_RES_NOROWS;
+
+	if( ( err = _odbx_mat_begin( &build, result, err ) ) < 0 ) { return err; }
+
+	while( maxrows == 0 || rows < maxrows )
+	{
+		if( ( err = odbx_row_fetch( result ) ) != ODBX_ROW_NEXT ) { break; }
+
+		if( ( err = _odbx_mat_row( &build, result ) ) < 0 ) { break; }
+		rows++;
+	}
+
+	if( err < 0 )
+	{
+		_odbx_mat_abort( &build );
+		return err;
+	}
+
+	if( ( err = _odbx_mat_end( &build, &mat ) ) < 0 ) { return err; }
+
+	if( ( err = _odbx_mat_result( detached, mat, free, mat ) ) < 0 )
+	{
+		free( mat );
+		return err;
+	}
+
+	return maxrows != 0 && rows == maxrows ? ODBX_ROW_NEXT : ODBX_ROW_DONE;
+}
+
+
+
+int odbx_result_serialize( odbx_result_t* result, const void** buffer, size_t* size )
+{
+	const struct odbx_mat* mat;
+
+	if( buffer == NULL || size == NULL ) { return -ODBX_ERR_PARAM; }
+	if( result == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	if( ( mat = _odbx_mat_get( result ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+
+	*buffer = (const void*) mat;
+	*size = (size_t) mat->size;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  The buffer may come from a file or another process, so all offsets are
+ *  checked before it's used
+ */
+
+int odbx_result_deserialize( odbx_result_t** result, const void* buffer, size_t size )
+{
+	int err;
+	const struct odbx_mat* mat = (const struct odbx_mat*) buffer;
+
+
+	if( result == NULL || buffer == NULL || ( (uintptr_t) buffer & 7 ) != 0 ) { return -ODBX_ERR_PARAM; }
+
+	if( ( err = _odbx_mat_check( mat, size ) ) < 0 ) { return err; }
+
+	return _odbx_mat_result( result, mat, NULL, NULL );
+}
+
+
+
+/*
+ *  Maps the file into memory or reads it if this isn't possible. Memory
+ *  returned by mmap() and malloc() is always aligned to eight bytes.
+ */
+
+int odbx_result_open( odbx_result_t** result, const char* path )
+{
+	int err = ODBX_ERR_SUCCESS;
+	long len;
+	FILE* file;
+	struct odbx_mfile* mfile;
+
+
+	if( result == NULL || path == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( ( file = fopen( path, "rb" ) ) == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( fseek( file, 0, SEEK_END ) != 0 || ( len = ftell( file ) ) <= 0 || fseek( file, 0, SEEK_SET ) != 0 )
+	{
+		fclose( file );
+		return -ODBX_ERR_SIZE;
+	}
+
+	if( ( mfile = (struct odbx_mfile*) calloc( 1, sizeof( struct odbx_mfile ) ) ) == NULL )
+	{
+		fclose( file );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	mfile->size = (size_t) len;
+
+#ifdef HAVE_SYS_MMAN_H
+	if( ( mfile->data = mmap( NULL, mfile->size, PROT_READ, MAP_PRIVATE, fileno( file ), 0 ) ) != MAP_FAILED )
+	{
+		mfile->mapped = 1;
+	}
+	else { mfile->data = NULL; }
+#endif
+
+	if( !mfile->mapped )
+	{
+		if( ( mfile->data = malloc( mfile->size ) ) == NULL ) { err = -ODBX_ERR_NOMEM; }
+		else if( fread( mfile->data, mfile->size, 1, file ) != 1 ) { err = -ODBX_ERR_SIZE; }
+	}
+
+	fclose( file );
+
+	if( err < 0 || ( err = _odbx_mat_check( (const struct odbx_mat*) mfile->data, mfile->size ) ) < 0 ||
+		( err = _odbx_mat_result( result, (const struct odbx_mat*) mfile->data, _odbx_mat_unmap, mfile ) ) < 0 )
+	{
+		_odbx_mat_unmap( mfile );
+		return err;
+	}
+
+	return err;
+}
@@ -0,0 +1,183 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+#include <stddef.h>
+
+
+
+#ifndef ODBXMAT_H
+#define ODBXMAT_H
+
+
+
+/*
+ *  Materialized result sets
+ *
+ *  All rows of a result set are copied into a single memory block which
+ *  doesn't contain any pointers, only offsets relative to its beginning:
+ *
+ *  struct odbx_mat | columns | column names | value offsets | NULL bitmap | values
+ *
+ *  Each value is terminated by \0 and value i (row * cols + col) starts at
+ *  data + offsets[i]. NULL values don't occupy any bytes in the value area.
+ */
+
+#define ODBX_MAT_MAGIC 0x5842444f   // "ODBX" in little endian byte order
+#define ODBX_MAT_VERSION 1
+#define ODBX_MAT_ALIGN(size) ( ( (size) + 7 ) & ~((size_t) 7) )
+
+
+struct odbx_mat_column
+{
+	uint64_t name;   // offset of the zero terminated name
+	uint32_t namelen;
+	int32_t type;
+};
+
+struct odbx_mat
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t status;   // ODBX_RES_NOROWS or ODBX_RES_ROWS
+	uint64_t size;   // size of the whole block in bytes
+	uint64_t affected;
+	uint64_t rows;
+	uint64_t cols;
+	uint64_t columns;   // offset of column array
+	uint64_t offsets;   // offset of value offsets (rows * cols + 1 entries)
+	uint64_t nulls;   // offset of NULL bitmap (rows * cols bits)
+	uint64_t data;   // offset of the values
+};
+
+
+
+/*
+ *  Read access to materialized result sets
+ */
+
+static inline const struct odbx_mat_column* _odbx_mat_column( const struct odbx_mat* mat, unsigned long pos )
+{
+	return (const struct odbx_mat_column*) ( (const char*) mat + mat->columns ) + pos;
+}
+
+static inline int _odbx_mat_isnull( const struct odbx_mat* mat, uint64_t cell )
+{
+	return ( ( (const unsigned char*) mat + mat->nulls )[cell >> 3] >> ( cell & 7 ) ) & 1;
+}
+
+static inline const char* _odbx_mat_value( const struct odbx_mat* mat, uint64_t cell )
+{
+	return (const char*) mat + mat->data + ( (const uint64_t*) ( (const char*) mat + mat->offsets ) )[cell];
+}
+
+static inline unsigned long _odbx_mat_length( const struct odbx_mat* mat, uint64_t cell )
+{
+	const uint64_t* off = (const uint64_t*) ( (const char*) mat + mat->offsets );
+
+	if( off[cell+1] == off[cell] ) { return 0; }   // NULL value
+	return (unsigned long) ( off[cell+1] - off[cell] - 1 );
+}
+
+
+
+/*
+ *  Checks all offsets of a materialized result set which may come from a
+ *  file or another process. The block must be aligned to 8 bytes.
+ */
+
+static inline int _odbx_mat_check( const struct odbx_mat* mat, size_t size )
+{
+	uint64_t i, cells;
+	const uint64_t* off;
+
+
+	if( size < sizeof( struct odbx_mat ) || mat->magic != ODBX_MAT_MAGIC || mat->version != ODBX_MAT_VERSION ) { return -ODBX_ERR_PARAM; }
+	if( mat->status != ODBX_RES_ROWS && mat->status != ODBX_RES_NOROWS ) { return -ODBX_ERR_PARAM; }
+
+	cells = mat->rows * mat->cols;
+
+	if( mat->size > size || ( mat->cols != 0 && cells / mat->cols != mat->rows ) ||
+		mat->columns > mat->size || mat->cols > ( mat->size - mat->columns ) / sizeof( struct odbx_mat_column ) ||
+		mat->offsets > mat->size || ( mat->offsets & 7 ) != 0 || cells >= ( mat->size - mat->offsets ) / sizeof( uint64_t ) ||
+		mat->nulls > mat->size || ( cells + 7 ) >> 3 > mat->size - mat->nulls || mat->data > mat->size )
+	{
+		return -ODBX_ERR_SIZE;
+	}
+
+	for( i = 0; i < mat->cols; i++ )
+	{
+		const struct odbx_mat_column* col = _odbx_mat_column( mat, i );
+
+		if( col->name >= mat->size || col->namelen >= mat->size - col->name || ((const char*) mat)[col->name + col->namelen] != '\0' )
+		{
+			return -ODBX_ERR_SIZE;
+		}
+	}
+
+	off = (const uint64_t*) ( (const char*) mat + mat->offsets );
+
+	if( off[0] != 0 || off[cells] > mat->size - mat->data ) { return -ODBX_ERR_SIZE; }
+
+	for( i = 0; i < cells; i++ )
+	{
+		if( off[i+1] < off[i] || ( off[i+1] == off[i] ) != _odbx_mat_isnull( mat, i ) ) { return -ODBX_ERR_SIZE; }
+		if( off[i+1] > off[i] && ((const char*) mat)[mat->data + off[i+1] - 1] != '\0' ) { return -ODBX_ERR_SIZE; }
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Creating materialized result sets from the rows of a backend result
+ */
+
+struct odbx_mat_builder
+{
+	int status;
+	uint64_t affected;
+	uint64_t rows;
+	unsigned long cols;
+	struct odbx_mat_column* columns;
+	char* names;
+	size_t namelen;
+	uint64_t* offsets;
+	size_t offsize;
+	unsigned char* nulls;
+	size_t nullsize;
+	char* data;
+	size_t datalen;
+	size_t datasize;
+};
+
+
+int _odbx_mat_begin( struct odbx_mat_builder* build, odbx_result_t* result, int status );
+
+int _odbx_mat_row( struct odbx_mat_builder* build, odbx_result_t* result );
+
+int _odbx_mat_end( struct odbx_mat_builder* build, struct odbx_mat** mat );
+
+void _odbx_mat_abort( struct odbx_mat_builder* build );
+
+
+
+/*
+ *  Result objects serving rows from materialized result sets
+ */
+
+int _odbx_mat_result( odbx_result_t** result, const struct odbx_mat* mat, void (*release)( void* arg ), void* arg );
+
+const struct odbx_mat* _odbx_mat_get( odbx_result_t* result );
+
+
+
+#endif
@@ -0,0 +1,557 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxlib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+
+
+#define ODBX_MUX_EVENTS 64
+#define ODBX_MUX_POLL 10000000   // nanoseconds between polling connections without socket
+
+
+
+/*
+ *  Query waiting for a connection or being executed
+ */
+
+struct odbx_mquery
+{
+	struct odbx_mquery* next;
+	char* query;
+	unsigned long length;
+	uint64_t deadline;   // zero for no deadline
+	odbx_mux_callback callback;
+	void* arg;
+};
+
+struct odbx_mconn
+{
+	odbx_t* handle;
+	struct odbx_mquery* query;   // NULL if idle or the results are discarded
+	int fd;   // socket or -1 if the connection is polled
+	int busy;   // results must be retrieved before the next query can be sent
+	int ready;   // results may be available without waiting
+	int lost;   // connection failed and isn't used any more
+};
+
+struct odbx_mux_t
+{
+	int epoll;
+	struct odbx_mconn* conns;
+	unsigned long count;
+	unsigned long size;
+	unsigned long next;   // connection served first in the next round
+	unsigned long running;   // queries sent to a connection
+	unsigned long waiting;   // queries in the queue
+	struct odbx_mquery* head;
+	struct odbx_mquery* tail;
+};
+
+
+
+/*
+ *  Connection handling
+ */
+
+static void _odbx_mux_watch( odbx_mux_t* mux, unsigned long i, int add )
+{
+#ifdef HAVE_SYS_EPOLL_H
+	struct epoll_event event;
+	struct odbx_mconn* conn = &mux->conns[i];
+
+	if( conn->fd == -1 ) { return; }
+
+	event.events = EPOLLIN;
+	event.data.u64 = i;
+
+	if( add && epoll_ctl( mux->epoll, EPOLL_CTL_ADD, conn->fd, &event ) == -1 )
+	{
+		conn->fd = -1;   // poll it instead
+	}
+
+	if( !add ) { epoll_ctl( mux->epoll, EPOLL_CTL_DEL, conn->fd, &event ); }
+#endif
+}
+
+
+
+/*
+ *  The connection stays busy until all results were retrieved, but the
+ *  query is completed and the remaining results are discarded
+ */
+
+static struct odbx_mquery* _odbx_mux_detach( odbx_mux_t* mux, unsigned long i )
+{
+	struct odbx_mquery* query = mux->conns[i].query;
+
+	if( query != NULL )
+	{
+		mux->conns[i].query = NULL;
+		mux->running--;
+	}
+
+	return query;
+}
+
+
+
+static void _odbx_mux_idle( odbx_mux_t* mux, unsigned long i )
+{
+	_odbx_mux_watch( mux, i, 0 );
+
+	mux->conns[i].busy = 0;
+	mux->conns[i].ready = 0;
+}
+
+
+
+static void _odbx_mux_complete( odbx_t* handle, struct odbx_mquery* query, int status )
+{
+	if( query != NULL )
+	{
+		query->callback( handle, NULL, status, query->arg );
+
+		free( query->query );
+		free( query );
+	}
+}
+
+
+
+static void _odbx_mux_send( odbx_mux_t* mux, unsigned long i, struct odbx_mquery* query )
+{
+	int err;
+	struct odbx_mconn* conn = &mux->conns[i];
+
+	if( ( err = odbx_query( conn->handle, query->query, query->length ) ) < 0 )
+	{
+		if( odbx_error_type( conn->handle, err ) < 0 ) { conn->lost = 1; }
+
+		_odbx_mux_complete( conn->handle, query, err );
+		return;
+	}
+
+	conn->query = query;
+	conn->busy = 1;
+	conn->ready = 0;
+	mux->running++;
+
+	_odbx_mux_watch( mux, i, 1 );
+}
+
+
+
+/*
+ *  Retrieves at most one result without waiting, so a connection returning
+ *  many result sets can't delay the others
+ */
+
+static void _odbx_mux_step( odbx_mux_t* mux, unsigned long i )
+{
+	int err;
+	odbx_result_t* result;
+	struct odbx_mquery* query;
+	struct timeval tv = { 0, 0 };
+	odbx_t* handle = mux->conns[i].handle;
+
+
+	switch( ( err = odbx_result( handle, &result, &tv, 0 ) ) )
+	{
+		case ODBX_RES_TIMEOUT:
+
+			mux->conns[i].ready = 0;
+			return;
+
+		case ODBX_RES_ROWS:
+		case ODBX_RES_NOROWS:
+
+			mux->conns[i].ready = 1;   // more results may be buffered already
+			query = mux->conns[i].query;
+
+			if( query != NULL ) { query->callback( handle, result, err, query->arg ); }
+			odbx_result_finish( result );
+			return;
+
+		case ODBX_RES_DONE:
+
+			query = _odbx_mux_detach( mux, i );
+			_odbx_mux_idle( mux, i );
+			_odbx_mux_complete( handle, query, ODBX_RES_DONE );
+			return;
+	}
+
+	/*
+	 *  Other results of a failed query may be pending, so they are
+	 *  drained before the connection is used again
+	 */
+
+	if( odbx_error_type( handle, err ) < 0 )
+	{
+		mux->conns[i].lost = 1;
+		_odbx_mux_idle( mux, i );
+	}
+	else
+	{
+		mux->conns[i].ready = 1;
+	}
+
+	_odbx_mux_complete( handle, _odbx_mux_detach( mux, i ), err );
+}
+
+
+
+/*
+ *  Scheduling
+ */
+
+static void _odbx_mux_expire( odbx_mux_t* mux, uint64_t now )
+{
+	unsigned long i;
+	struct odbx_mquery *query, *prev = NULL, *expired = NULL;
+
+
+	for( query = mux->head; query != NULL; )
+	{
+		if( query->deadline == 0 || query->deadline > now )
+		{
+			prev = query;
+			query = query->next;
+			continue;
+		}
+
+		if( prev != NULL ) { prev->next = query->next; }
+		else { mux->head = query->next; }
+		if( mux->tail == query ) { mux->tail = prev; }
+
+		mux->waiting--;
+
+		query->next = expired;
+		expired = query;
+		query = prev != NULL ? prev->next : mux->head;
+	}
+
+	while( ( query = expired ) != NULL )
+	{
+		expired = query->next;
+		_odbx_mux_complete( NULL, query, ODBX_RES_TIMEOUT );
+	}
+
+	for( i = 0; i < mux->count; i++ )
+	{
+		if( mux->conns[i].query != NULL && mux->conns[i].query->deadline != 0 && mux->conns[i].query->deadline <= now )
+		{
+			odbx_cancel( mux->conns[i].handle );   // stops the server from producing results nobody waits for
+			_odbx_mux_complete( mux->conns[i].handle, _odbx_mux_detach( mux, i ), ODBX_RES_TIMEOUT );
+		}
+	}
+}
+
+
+
+/*
+ *  Waiting queries are sent in the order they were added to the idle
+ *  connections, starting with the one after the connection served first
+ *  last time so the load is spread evenly
+ */
+
+static void _odbx_mux_dispatch( odbx_mux_t* mux )
+{
+	unsigned long i, n, usable = 0;
+	struct odbx_mquery* query;
+
+
+	for( n = 0; n < mux->count && mux->head != NULL; n++ )
+	{
+		i = ( mux->next + n ) % mux->count;
+
+		if( mux->conns[i].lost ) { continue; }
+		usable++;
+
+		if( mux->conns[i].busy ) { continue; }
+
+		query = mux->head;
+		if( ( mux->head = query->next ) == NULL ) { mux->tail = NULL; }
+		mux->waiting--;
+
+		_odbx_mux_send( mux, i, query );
+	}
+
+	if( usable == 0 )   // no connection left
+	{
+		while( ( query = mux->head ) != NULL )
+		{
+			mux->head = query->next;
+			mux->waiting--;
+			_odbx_mux_complete( NULL, query, -ODBX_ERR_HANDLE );
+		}
+
+		mux->tail = NULL;
+	}
+}
+
+
+
+/*
+ *  Returns the time in nanoseconds until something has to be done
+ */
+
+static uint64_t _odbx_mux_wait( odbx_mux_t* mux, uint64_t now, uint64_t end )
+{
+	unsigned long i;
+	uint64_t wait = end;
+	struct odbx_mquery* query;
+
+
+	for( query = mux->head; query != NULL; query = query->next )
+	{
+		if( query->deadline != 0 && query->deadline < wait ) { wait = query->deadline; }
+	}
+
+	for( i = 0; i < mux->count; i++ )
+	{
+		if( !mux->conns[i].busy ) { continue; }
+
+		if( mux->conns[i].ready ) { return 0; }
+		if( mux->conns[i].fd == -1 && now + ODBX_MUX_POLL < wait ) { wait = now + ODBX_MUX_POLL; }
+
+		query = mux->conns[i].query;
+		if( query != NULL && query->deadline != 0 && query->deadline < wait ) { wait = query->deadline; }
+	}
+
+	return wait > now ? wait - now : 0;
+}
+
+
+
+/*
+ *  ODBX multiplexer operations
+ */
+
+int odbx_mux_init( odbx_mux_t** mux )
+{
+	if( mux == NULL ) { return -ODBX_ERR_PARAM; }
+
+#ifdef HAVE_SYS_EPOLL_H
+	if( ( *mux = (odbx_mux_t*) calloc( 1, sizeof( odbx_mux_t ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	if( ( (*mux)->epoll = epoll_create1( EPOLL_CLOEXEC ) ) == -1 )
+	{
+		free( *mux );
+		*mux = NULL;
+
+		return -ODBX_ERR_NOMEM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+#else
+	*mux = NULL;
+	return -ODBX_ERR_NOTSUP;
+#endif
+}
+
+
+
+int odbx_mux_add( odbx_mux_t* mux, odbx_t* handle )
+{
+	int fd;
+	unsigned long i;
+	struct odbx_mconn* conns;
+
+
+	if( mux == NULL || handle == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	for( i = 0; i < mux->count; i++ )
+	{
+		if( mux->conns[i].handle == handle ) { return -ODBX_ERR_PARAM; }
+	}
+
+	if( mux->count == mux->size )
+	{
+		if( ( conns = (struct odbx_mconn*) realloc( mux->conns, ( mux->size + 8 ) * 2 * sizeof( struct odbx_mconn ) ) ) == NULL )
+		{
+			return -ODBX_ERR_NOMEM;
+		}
+
+		mux->conns = conns;
+		mux->size = ( mux->size + 8 ) * 2;
+	}
+
+	if( odbx_get_option( handle, ODBX_OPT_SOCKET, (void*) &fd ) < 0 ) { fd = -1; }
+
+	memset( &mux->conns[mux->count], 0, sizeof( struct odbx_mconn ) );
+	mux->conns[mux->count].handle = handle;
+	mux->conns[mux->count].fd = fd;
+	mux->count++;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_mux_query( odbx_mux_t* mux, const char* query, unsigned long length, struct timeval* timeout, odbx_mux_callback callback, void* arg )
+{
+	struct odbx_mquery* mq;
+
+
+	if( mux == NULL ) { return -ODBX_ERR_HANDLE; }
+	if( query == NULL || callback == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( length == 0 ) { length = strlen( query ); }
+
+	if( ( mq = (struct odbx_mquery*) malloc( sizeof( struct odbx_mquery ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	if( ( mq->query = (char*) malloc( length + 1 ) ) == NULL )
+	{
+		free( mq );
+		return -ODBX_ERR_NOMEM;
+	}
+
+	memcpy( mq->query, query, length );
+	mq->query[length] = 0;
+	mq->length = length;
+	mq->callback = callback;
+	mq->arg = arg;
+	mq->next = NULL;
+	mq->deadline = 0;
+
+	if( timeout != NULL )
+	{
+		mq->deadline = _odbx_lib_time() + (uint64_t) timeout->tv_sec * 1000000000 + (uint64_t) timeout->tv_usec * 1000;
+	}
+
+	if( mux->tail != NULL ) { mux->tail->next = mq; }
+	else { mux->head = mq; }
+
+	mux->tail = mq;
+	mux->waiting++;
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int odbx_mux_run( odbx_mux_t* mux, struct timeval* timeout )
+{
+#ifdef HAVE_SYS_EPOLL_H
+	int n, ms;
+	unsigned long i, k;
+	uint64_t now, wait, end = UINT64_MAX;
+	struct epoll_event events[ODBX_MUX_EVENTS];
+
+
+	if( mux == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	now = _odbx_lib_time();
+
+	if( timeout != NULL )
+	{
+		end = now + (uint64_t) timeout->tv_sec * 1000000000 + (uint64_t) timeout->tv_usec * 1000;
+	}
+
+	while( mux->waiting + mux->running > 0 )
+	{
+		_odbx_mux_expire( mux, now );
+		_odbx_mux_dispatch( mux );
+
+		if( ( wait = _odbx_mux_wait( mux, now, end ) ) > 3600000000000ULL ) { ms = -1; }
+		else { ms = (int) ( ( wait + 999999 ) / 1000000 ); }
+
+		if( mux->waiting + mux->running == 0 ) { break; }
+
+		while( ( n = epoll_wait( mux->epoll, events, ODBX_MUX_EVENTS, ms ) ) == -1 && errno == EINTR );
+
+		if( n == -1 ) { return -ODBX_ERR_RESULT; }
+
+		while( n-- > 0 )
+		{
+			mux->conns[events[n].data.u64].ready = 1;
+		}
+
+		for( k = 0; k < mux->count; k++ )
+		{
+			i = ( mux->next + k ) % mux->count;
+
+			if( mux->conns[i].busy && ( mux->conns[i].ready || mux->conns[i].fd == -1 ) )
+			{
+				_odbx_mux_step( mux, i );
+			}
+		}
+
+		if( mux->count > 0 ) { mux->next = ( mux->next + 1 ) % mux->count; }
+
+		if( ( now = _odbx_lib_time() ) >= end ) { break; }
+	}
+
+	return (int) ( mux->waiting + mux->running );
+#else
+	return -ODBX_ERR_NOTSUP;
+#endif
+}
+
+
+
+/*
+ *  Connections are drained so they can be used for other queries
+ *  afterwards
+ */
+
+int odbx_mux_finish( odbx_mux_t* mux )
+{
+	int err;
+	unsigned long i;
+	odbx_result_t* result;
+	struct odbx_mquery* query;
+
+
+	if( mux == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	while( ( query = mux->head ) != NULL )
+	{
+		mux->head = query->next;
+		_odbx_mux_complete( NULL, query, -ODBX_ERR_CANCELED );
+	}
+
+	for( i = 0; i < mux->count; i++ )
+	{
+		_odbx_mux_complete( mux->conns[i].handle, _odbx_mux_detach( mux, i ), -ODBX_ERR_CANCELED );
+
+		if( mux->conns[i].busy && !mux->conns[i].lost )
+		{
+			while( ( err = odbx_result( mux->conns[i].handle, &result, NULL, 0 ) ) > ODBX_RES_TIMEOUT )
+			{
+				odbx_result_finish( result );
+			}
+		}
+	}
+
+#ifdef HAVE_SYS_EPOLL_H
+	close( mux->epoll );
+#endif
+
+	free( mux->conns );
+	free( mux );
+
+	return ODBX_ERR_SUCCESS;
+}
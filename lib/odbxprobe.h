@@ -0,0 +1,62 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+
+
+
+#ifndef ODBXPROBE_H
+#define ODBXPROBE_H
+
+
+
+/*
+ *  Statically defined tracepoints of the "opendbx" provider
+ *
+ *  They can be used by perf, bpftrace or SystemTap without recompiling
+ *  the library or the application and cost a single NOP instruction each
+ *  if no tool is attached. Without <sys/sdt.h> they are removed entirely.
+ */
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define ODBX_PROBE1( name, a1 ) DTRACE_PROBE1( opendbx, name, a1 )
+#define ODBX_PROBE2( name, a1, a2 ) DTRACE_PROBE2( opendbx, name, a1, a2 )
+#define ODBX_PROBE3( name, a1, a2, a3 ) DTRACE_PROBE3( opendbx, name, a1, a2, a3 )
+#define ODBX_PROBE4( name, a1, a2, a3, a4 ) DTRACE_PROBE4( opendbx, name, a1, a2, a3, a4 )
+
+/* Rows of the current result set, only reported every ODBX_PROBE_BATCH rows and at its end */
+#define ODBX_PROBE_BATCH   256
+
+#define ODBX_PROBE_ROWS( handle, result, err ) \
+	do { \
+		uint64_t rows_ = (handle)->stats.total.rows - (handle)->stats.rows; \
+		if( (err) != ODBX_ROW_NEXT || rows_ % ODBX_PROBE_BATCH == 0 ) \
+		{ \
+			DTRACE_PROBE4( opendbx, row__batch, handle, result, rows_, err ); \
+		} \
+	} while( 0 )
+
+#else
+
+#define ODBX_PROBE1( name, a1 )
+#define ODBX_PROBE2( name, a1, a2 )
+#define ODBX_PROBE3( name, a1, a2, a3 )
+#define ODBX_PROBE4( name, a1, a2, a3, a4 )
+
+#define ODBX_PROBE_ROWS( handle, result, err ) do {} while( 0 )
+
+#endif
+
+
+
+#endif
@@ -0,0 +1,286 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxrec.h"
+#include "odbxcache.h"
+#include "odbxlib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+
+/*
+ *  Writes one record padded to a multiple of 8 bytes. Recording stops
+ *  after the first failure so the file contains only complete records.
+ */
+
+static void _odbx_rec_write( struct odbx_rstate* rs, uint32_t type, int32_t status, uint64_t nsec, const void* data, size_t len )
+{
+	static const char pad[8] = { 0 };
+	struct odbx_rec rec;
+
+
+	if( rs->err ) { return; }
+
+	rec.type = type;
+	rec.status = status;
+	rec.size = ODBX_MAT_ALIGN( sizeof( struct odbx_rec ) + len );
+	rec.time = nsec;
+	rec.fetch = rs->fetch;
+
+	if( fwrite( &rec, sizeof( struct odbx_rec ), 1, rs->file ) != 1 ||
+		( len > 0 && fwrite( data, len, 1, rs->file ) != 1 ) ||
+		( rec.size > sizeof( struct odbx_rec ) + len && fwrite( pad, rec.size - sizeof( struct odbx_rec ) - len, 1, rs->file ) != 1 ) )
+	{
+		rs->err = 1;
+	}
+}
+
+
+
+static void _odbx_rec_reset( struct odbx_rstate* rs )
+{
+	if( rs->current != NULL )
+	{
+		_odbx_mat_abort( &rs->build );
+		rs->current = NULL;
+	}
+
+	rs->fetch = 0;
+}
+
+
+
+
+
+/*
+ *  Hooks called by the ODBX functions
+ */
+
+void _odbx_rec_query( odbx_t* handle, const char* query, unsigned long length )
+{
+	struct odbx_rstate* rs = handle->rec;
+	char* stmt;
+
+
+	_odbx_rec_reset( rs );
+	rs->last = _odbx_lib_time();
+
+	if( ( stmt = (char*) malloc( length + 1 ) ) == NULL )
+	{
+		rs->err = 1;
+		return;
+	}
+
+	memcpy( stmt, query, length );
+	stmt[length] = '\0';
+
+	_odbx_rec_write( rs, ODBX_REC_QUERY, 0, rs->last - rs->start, stmt, length + 1 );
+	free( stmt );
+}
+
+
+
+void _odbx_rec_error( odbx_t* handle, uint32_t type, int err )
+{
+	struct odbx_rstate* rs = handle->rec;
+	const char* msg = odbx_error( handle, err );
+
+
+	_odbx_rec_reset( rs );
+
+	if( msg == NULL ) { msg = ""; }
+	_odbx_rec_write( rs, type, err, _odbx_lib_time() - rs->last, msg, strlen( msg ) + 1 );
+}
+
+
+
+/*
+ *  Result sets replayed from the cache or detached ones are written at
+ *  once, rows of all others are collected while they are fetched.
+ */
+
+void _odbx_rec_result( odbx_t* handle, odbx_result_t* result, int err )
+{
+	struct odbx_rstate* rs = handle->rec;
+	const struct odbx_mat* mat;
+
+
+	switch( err )
+	{
+		case ODBX_RES_TIMEOUT:
+			return;
+		case ODBX_RES_DONE:
+			_odbx_rec_reset( rs );
+			_odbx_rec_write( rs, ODBX_REC_DONE, err, _odbx_lib_time() - rs->last, NULL, 0 );
+			return;
+		case ODBX_RES_NOROWS:
+		case ODBX_RES_ROWS:
+			break;
+		default:
+			_odbx_rec_error( handle, ODBX_REC_ERROR, err );
+			return;
+	}
+
+	_odbx_rec_reset( rs );
+	rs->wait = _odbx_lib_time() - rs->last;
+
+	if( ( mat = _odbx_mat_get( result ) ) != NULL )
+	{
+		_odbx_rec_write( rs, ODBX_REC_RESULT, err, rs->wait, mat, (size_t) mat->size );
+		rs->last = _odbx_lib_time();
+		return;
+	}
+
+	if( _odbx_mat_begin( &rs->build, result, err ) < 0 )
+	{
+		rs->err = 1;
+		return;
+	}
+
+	rs->current = result;
+}
+
+
+
+void _odbx_rec_row( odbx_result_t* result, int err, uint64_t start )
+{
+	struct odbx_rstate* rs = result->handle->rec;
+
+	if( rs->current != result ) { return; }
+
+	rs->fetch += _odbx_lib_time() - start;
+
+	if( err < 0 || ( err == ODBX_ROW_NEXT && _odbx_mat_row( &rs->build, result ) < 0 ) )
+	{
+		_odbx_rec_reset( rs );
+		rs->err = 1;
+	}
+}
+
+
+
+/*
+ *  Remaining rows are fetched here and also passed to the result cache
+ *  because it won't see them otherwise.
+ */
+
+void _odbx_rec_result_finish( odbx_result_t* result )
+{
+	int err;
+	uint64_t start;
+	struct odbx_mat* mat;
+	struct odbx_rstate* rs = result->handle->rec;
+
+
+	if( rs->current != result ) { return; }
+
+	start = _odbx_lib_time();
+
+	while( ( err = result->handle->ops->basic->row_fetch( result ) ) == ODBX_ROW_NEXT )
+	{
+		if( result->handle->cache != NULL ) { _odbx_cache_row( result, err ); }
+
+		if( _odbx_mat_row( &rs->build, result ) < 0 ) { break; }
+	}
+
+	rs->fetch += _odbx_lib_time() - start;
+	rs->current = NULL;
+
+	if( err != ODBX_ROW_DONE )
+	{
+		_odbx_mat_abort( &rs->build );
+		rs->err = 1;
+		return;
+	}
+
+	if( _odbx_mat_end( &rs->build, &mat ) < 0 )
+	{
+		rs->err = 1;
+		return;
+	}
+
+	_odbx_rec_write( rs, ODBX_REC_RESULT, mat->status, rs->wait, mat, (size_t) mat->size );
+	free( mat );
+
+	rs->fetch = 0;
+	rs->last = _odbx_lib_time();
+}
+
+
+
+int _odbx_rec_close( odbx_t* handle )
+{
+	struct odbx_rstate* rs = handle->rec;
+	int err = rs->err;
+
+	_odbx_rec_reset( rs );
+	if( fclose( rs->file ) != 0 ) { err = 1; }
+	free( rs );
+
+	handle->rec = NULL;
+
+	return err ? -ODBX_ERR_SIZE : ODBX_ERR_SUCCESS;
+}
+
+
+
+
+
+/*
+ *  ODBX recording operations
+ */
+
+int odbx_record( odbx_t* handle, const char* path )
+{
+	struct odbx_rec_file header;
+	struct odbx_rstate* rs;
+	int err;
+
+
+	if( handle == NULL || handle->ops == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	if( handle->rec != NULL && ( err = _odbx_rec_close( handle ) ) < 0 )
+	{
+		return err;   // recording is incomplete
+	}
+
+	if( path == NULL ) { return ODBX_ERR_SUCCESS; }
+
+	if( ( rs = (struct odbx_rstate*) calloc( 1, sizeof( struct odbx_rstate ) ) ) == NULL )
+	{
+		return -ODBX_ERR_NOMEM;
+	}
+
+	if( ( rs->file = fopen( path, "wb" ) ) == NULL )
+	{
+		free( rs );
+		return -ODBX_ERR_PARAM;
+	}
+
+	memset( &header, 0, sizeof( struct odbx_rec_file ) );
+	header.magic = ODBX_REC_MAGIC;
+	header.version = ODBX_REC_VERSION;
+	header.start = (uint64_t) time( NULL );
+
+	if( fwrite( &header, sizeof( struct odbx_rec_file ), 1, rs->file ) != 1 )
+	{
+		fclose( rs->file );
+		free( rs );
+		return -ODBX_ERR_SIZE;
+	}
+
+	rs->start = rs->last = _odbx_lib_time();
+	handle->rec = rs;
+
+	return ODBX_ERR_SUCCESS;
+}
@@ -0,0 +1,107 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+#include "odbxmat.h"
+#include <stdio.h>
+
+
+
+#ifndef ODBXREC_H
+#define ODBXREC_H
+
+
+
+/*
+ *  Recorded statements and result sets
+ *
+ *  A recording file starts with struct odbx_rec_file followed by records,
+ *  each starting with struct odbx_rec and padded to a multiple of 8 bytes.
+ *  The file can be mapped into memory and read without copying:
+ *
+ *  ODBX_REC_QUERY    statement, terminated by \0
+ *  ODBX_REC_RESULT   materialized result set (struct odbx_mat)
+ *  ODBX_REC_DONE     no more result sets of the statement
+ *  ODBX_REC_ERROR    error returned by odbx_result(), code in status and
+ *                    message terminated by \0
+ *  ODBX_REC_FAILED   error returned by odbx_query(), same as above
+ *
+ *  The time of a query record is the offset to the start of the recording.
+ *  For all other records it's the time the backend needed to return the
+ *  result set after sending the statement or finishing the previous result
+ *  set. All times are in nanoseconds.
+ */
+
+#define ODBX_REC_MAGIC 0x5242444f   // "ODBR" in little endian byte order
+#define ODBX_REC_VERSION 1
+
+#define ODBX_REC_QUERY 1
+#define ODBX_REC_RESULT 2
+#define ODBX_REC_DONE 3
+#define ODBX_REC_ERROR 4
+#define ODBX_REC_FAILED 5
+
+
+struct odbx_rec_file
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+	uint64_t start;   // start of the recording in seconds since the epoch
+};
+
+struct odbx_rec
+{
+	uint32_t type;
+	int32_t status;   // return value of odbx_result() or error code
+	uint64_t size;   // size of the record including this header
+	uint64_t time;
+	uint64_t fetch;   // time spent in fetching the rows of a result set
+};
+
+
+
+/*
+ *  Recording state attached to each connection
+ */
+
+struct odbx_rstate
+{
+	FILE* file;
+	uint64_t start;   // start of the recording
+	uint64_t last;   // statement sent or previous result set finished
+	uint64_t wait;   // time until the current result set was returned
+	uint64_t fetch;
+	odbx_result_t* current;   // backend result whose rows are recorded
+	struct odbx_mat_builder build;
+	int err;   // writing failed
+};
+
+
+
+/*
+ *  Hooks called by the ODBX functions if recording is enabled
+ */
+
+void _odbx_rec_query( odbx_t* handle, const char* query, unsigned long length );
+
+void _odbx_rec_error( odbx_t* handle, uint32_t type, int err );
+
+void _odbx_rec_result( odbx_t* handle, odbx_result_t* result, int err );
+
+void _odbx_rec_row( odbx_result_t* result, int err, uint64_t start );
+
+void _odbx_rec_result_finish( odbx_result_t* result );
+
+int _odbx_rec_close( odbx_t* handle );
+
+
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxstats.h"
+#include <string.h>
+
+
+
+/*
+ *  Counters of all result sets finished and all connections closed. The
+ *  structure consists of uint64_t values only and is updated as array.
+ */
+
+static struct odbx_stats odbx_stats_global;
+
+#define ODBX_STATS_COUNTERS ( sizeof( struct odbx_stats ) / sizeof( uint64_t ) )
+
+
+
+void _odbx_stats_flush( struct odbx_hstats* hs )
+{
+	size_t i;
+	uint64_t* total = (uint64_t*) &hs->total;
+	uint64_t* flushed = (uint64_t*) &hs->flushed;
+	uint64_t* global = (uint64_t*) &odbx_stats_global;
+
+
+	for( i = 0; i < ODBX_STATS_COUNTERS; i++ )
+	{
+		if( total[i] != flushed[i] )
+		{
+			__atomic_fetch_add( global + i, total[i] - flushed[i], __ATOMIC_RELAXED );
+			flushed[i] = total[i];
+		}
+	}
+}
+
+
+
+
+
+/*
+ *  ODBX statistics
+ */
+
+int odbx_stats( odbx_t* handle, struct odbx_stats* stats )
+{
+	size_t i;
+	uint64_t* global = (uint64_t*) &odbx_stats_global;
+
+
+	if( stats == NULL ) { return -ODBX_ERR_PARAM; }
+
+	if( handle != NULL )
+	{
+		if( handle->ops == NULL ) { return -ODBX_ERR_HANDLE; }
+
+		memcpy( stats, &handle->stats.total, sizeof( struct odbx_stats ) );
+		return ODBX_ERR_SUCCESS;
+	}
+
+	for( i = 0; i < ODBX_STATS_COUNTERS; i++ )
+	{
+		((uint64_t*) stats)[i] = __atomic_load_n( global + i, __ATOMIC_RELAXED );
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
@@ -0,0 +1,35 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+
+
+
+#ifndef ODBXSTATS_H
+#define ODBXSTATS_H
+
+
+
+/* Counts latency in bucket i if it's less than 2^i microseconds */
+static inline void _odbx_stats_latency( uint64_t* histogram, uint64_t nsec )
+{
+	uint64_t usec = nsec / 1000;
+	int bucket = usec != 0 ? 64 - __builtin_clzll( usec ) : 0;
+
+	histogram[bucket < ODBX_STATS_BUCKETS ? bucket : ODBX_STATS_BUCKETS - 1]++;
+}
+
+
+/* Adds the counters of a handle to the process wide counters */
+void _odbx_stats_flush( struct odbx_hstats* hs );
+
+
+
+#endif
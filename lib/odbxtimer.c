@@ -0,0 +1,211 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxlib.h"
+#include "odbxtimer.h"
+
+#if defined( HAVE_PTHREAD_H ) && defined( HAVE_CLOCK_GETTIME )
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#ifdef CLOCK_MONOTONIC
+#define ODBX_WATCHDOG 1
+#endif
+#endif
+
+
+
+#ifdef ODBX_WATCHDOG
+
+/*
+ *  Armed handles are kept in an unsorted list, because there's at most one
+ *  entry per connection and the watchdog only scans it after a deadline
+ *  passed or an earlier one was added. The watchdog waits on a condition
+ *  using the same monotonic clock as _odbx_lib_time().
+ */
+
+static pthread_once_t odbx_timer_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t odbx_timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t odbx_timer_done = PTHREAD_COND_INITIALIZER;   // signaled after a statement was canceled
+static pthread_cond_t odbx_timer_wake;   // signaled after an earlier deadline was added
+static odbx_t* odbx_timer_list = NULL;
+static uint64_t odbx_timer_next = 0;   // deadline the watchdog waits for, zero while it's busy
+static int odbx_timer_started = 0;
+
+
+
+static void* _odbx_timer_run( void* arg )
+{
+	odbx_t* handle;
+	odbx_t** prev;
+	uint64_t now, next;
+	struct timespec ts;
+
+
+	pthread_mutex_lock( &odbx_timer_mutex );
+
+	while( 1 )
+	{
+		next = UINT64_MAX;
+		now = _odbx_lib_time();
+
+		for( prev = &odbx_timer_list; ( handle = *prev ) != NULL; prev = &handle->timer.next )
+		{
+			if( handle->timer.deadline <= now )
+			{
+				*prev = handle->timer.next;
+				handle->timer.queued = 0;
+				handle->timer.firing = 1;
+				break;
+			}
+
+			if( handle->timer.deadline < next ) { next = handle->timer.deadline; }
+		}
+
+		if( handle != NULL )   // disarming the handle waits until the backend returned
+		{
+			pthread_mutex_unlock( &odbx_timer_mutex );
+			odbx_cancel( handle );
+			pthread_mutex_lock( &odbx_timer_mutex );
+
+			handle->timer.firing = 0;
+			pthread_cond_broadcast( &odbx_timer_done );
+			continue;
+		}
+
+		odbx_timer_next = next;
+
+		if( next == UINT64_MAX )
+		{
+			pthread_cond_wait( &odbx_timer_wake, &odbx_timer_mutex );
+		}
+		else
+		{
+			ts.tv_sec = (time_t) ( next / 1000000000 );
+			ts.tv_nsec = (long) ( next % 1000000000 );
+
+			pthread_cond_timedwait( &odbx_timer_wake, &odbx_timer_mutex, &ts );
+		}
+
+		odbx_timer_next = 0;
+	}
+
+	return arg;
+}
+
+
+
+/*
+ *  Signals are blocked in the watchdog thread, so they are still delivered
+ *  to the threads of the application
+ */
+
+static void _odbx_timer_start( void )
+{
+	pthread_t thread;
+	pthread_attr_t attr;
+	pthread_condattr_t cattr;
+	sigset_t all, orig;
+
+
+	if( pthread_condattr_init( &cattr ) != 0 ) { return; }
+
+	if( pthread_condattr_setclock( &cattr, CLOCK_MONOTONIC ) == 0 && pthread_cond_init( &odbx_timer_wake, &cattr ) == 0 )
+	{
+		if( pthread_attr_init( &attr ) == 0 )
+		{
+			pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+
+			sigfillset( &all );
+			pthread_sigmask( SIG_SETMASK, &all, &orig );
+
+			if( pthread_create( &thread, &attr, _odbx_timer_run, NULL ) == 0 ) { odbx_timer_started = 1; }
+
+			pthread_sigmask( SIG_SETMASK, &orig, NULL );
+			pthread_attr_destroy( &attr );
+		}
+
+		if( !odbx_timer_started ) { pthread_cond_destroy( &odbx_timer_wake ); }
+	}
+
+	pthread_condattr_destroy( &cattr );
+}
+
+#endif
+
+
+
+
+
+/*
+ *  ODBX statement deadlines
+ */
+
+int _odbx_timer_init( void )
+{
+#ifdef ODBX_WATCHDOG
+	if( pthread_once( &odbx_timer_once, _odbx_timer_start ) == 0 && odbx_timer_started )
+	{
+		return ODBX_ERR_SUCCESS;
+	}
+#endif
+
+	return -ODBX_ERR_NOTSUP;
+}
+
+
+
+void _odbx_timer_arm( odbx_t* handle )
+{
+#ifdef ODBX_WATCHDOG
+	pthread_mutex_lock( &odbx_timer_mutex );
+
+	handle->timer.deadline = _odbx_lib_time() + handle->timer.timeout;
+
+	if( !handle->timer.queued )
+	{
+		handle->timer.next = odbx_timer_list;
+		handle->timer.queued = 1;
+		odbx_timer_list = handle;
+	}
+
+	if( handle->timer.deadline < odbx_timer_next ) { pthread_cond_signal( &odbx_timer_wake ); }
+
+	pthread_mutex_unlock( &odbx_timer_mutex );
+
+	handle->timer.armed = 1;
+#endif
+}
+
+
+
+void _odbx_timer_disarm( odbx_t* handle )
+{
+#ifdef ODBX_WATCHDOG
+	odbx_t** prev;
+
+	pthread_mutex_lock( &odbx_timer_mutex );
+
+	if( handle->timer.queued )
+	{
+		for( prev = &odbx_timer_list; *prev != handle; prev = &(*prev)->timer.next );
+
+		*prev = handle->timer.next;
+		handle->timer.queued = 0;
+	}
+
+	while( handle->timer.firing ) { pthread_cond_wait( &odbx_timer_done, &odbx_timer_mutex ); }
+
+	pthread_mutex_unlock( &odbx_timer_mutex );
+#endif
+
+	handle->timer.armed = 0;
+}
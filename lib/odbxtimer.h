@@ -0,0 +1,49 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+
+
+
+#ifndef ODBXTIMER_H
+#define ODBXTIMER_H
+
+
+
+/*
+ *  Statements of handles with the ODBX_OPT_QUERY_TIMEOUT option set are
+ *  armed when they are sent and disarmed after all results were returned.
+ *  The watchdog thread calls odbx_cancel() for the ones still running at
+ *  their deadline.
+ */
+
+/* Starts the watchdog thread once, fails if threads aren't available */
+int _odbx_timer_init( void );
+
+void _odbx_timer_arm( odbx_t* handle );
+
+/* Waits until the watchdog isn't canceling the statement any more */
+void _odbx_timer_disarm( odbx_t* handle );
+
+
+/* Errors of canceled statements are reported as ODBX_ERR_CANCELED unless the connection was lost */
+static inline int _odbx_timer_error( odbx_t* handle, int err )
+{
+	if( err < 0 && __atomic_load_n( &handle->timer.canceled, __ATOMIC_ACQUIRE ) && odbx_error_type( handle, err ) >= 0 )
+	{
+		return -ODBX_ERR_CANCELED;
+	}
+
+	return err;
+}
+
+
+
+#endif
@@ -0,0 +1,287 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "opendbx/api.h"
+#include "odbxtrace.h"
+#include "odbxlib.h"
+#include "odbxmat.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+#define ODBX_TRACE_IDENT( c ) ( isalnum( (unsigned char) (c) ) || (c) == '_' || (c) == '$' )
+
+
+
+/*
+ *  Fingerprint of a statement
+ *
+ *  FNV-1a hash of the statement in lower case with string and number
+ *  literals replaced by "?", comments removed and white space only kept
+ *  between words. Statements only differing in their values get the same
+ *  fingerprint.
+ */
+
+static inline uint64_t _odbx_trace_hash( uint64_t hash, char c )
+{
+	return ( hash ^ (unsigned char) c ) * 0x100000001b3ULL;
+}
+
+
+
+uint64_t _odbx_trace_fingerprint( const char* query, unsigned long length )
+{
+	char c, prev = 0;
+	int space = 0;
+	unsigned long i = 0, j;
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+
+	while( i < length )
+	{
+		c = query[i];
+
+		if( isspace( (unsigned char) c ) )
+		{
+			space = 1; i++;
+			continue;
+		}
+
+		if( c == '-' && i + 1 < length && query[i+1] == '-' )
+		{
+			while( i < length && query[i] != '\n' ) { i++; }
+			space = 1;
+			continue;
+		}
+
+		if( c == '/' && i + 1 < length && query[i+1] == '*' )
+		{
+			for( i += 2; i + 1 < length && !( query[i] == '*' && query[i+1] == '/' ); i++ );
+			space = 1; i += 2;
+			continue;
+		}
+
+		if( c == ';' )
+		{
+			for( j = i + 1; j < length && ( isspace( (unsigned char) query[j] ) || query[j] == ';' ); j++ );
+			if( j == length ) { break; }   // trailing semicolons
+		}
+
+		if( space && ODBX_TRACE_IDENT( prev ) && ODBX_TRACE_IDENT( c ) )
+		{
+			hash = _odbx_trace_hash( hash, ' ' );
+			prev = ' ';
+		}
+		space = 0;
+
+		if( c == '\'' )
+		{
+			for( i++; i < length; i++ )
+			{
+				if( query[i] == '\\' ) { i++; continue; }
+				if( query[i] == '\'' )
+				{
+					if( i + 1 < length && query[i+1] == '\'' ) { i++; continue; }
+					break;
+				}
+			}
+
+			c = '?'; i++;
+		}
+		else if( isdigit( (unsigned char) c ) && !ODBX_TRACE_IDENT( prev ) )
+		{
+			while( i < length && ( ODBX_TRACE_IDENT( query[i] ) || query[i] == '.' ) ) { i++; }
+			c = '?';
+		}
+		else if( c == '"' || c == '`' )   // quoted identifiers are case sensitive
+		{
+			hash = _odbx_trace_hash( hash, c );
+			for( i++; i < length && query[i] != c; i++ ) { hash = _odbx_trace_hash( hash, query[i] ); }
+			i++;
+		}
+		else
+		{
+			c = (char) tolower( (unsigned char) c ); i++;
+		}
+
+		hash = _odbx_trace_hash( hash, c );
+		prev = c;
+	}
+
+	return hash;
+}
+
+
+
+
+
+/*
+ *  Trace events
+ */
+
+void _odbx_trace_query( odbx_t* handle, const char* query, unsigned long length )
+{
+	struct odbx_htrace* trace = handle->trace;
+
+
+	trace->span.time = handle->stats.query;
+	trace->span.start = handle->stats.query;
+	trace->span.first = 0;
+	trace->span.fingerprint = _odbx_trace_fingerprint( query, length );
+	trace->span.status = ODBX_ERR_SUCCESS;
+	trace->span.rows = 0;
+	trace->span.bytes = 0;
+
+	if( trace->hooks.query != NULL )
+	{
+		trace->span.query = query;
+		trace->span.length = length;
+
+		trace->hooks.query( handle, &trace->span, trace->arg );
+	}
+
+	trace->span.query = NULL;
+	trace->span.length = 0;
+}
+
+
+
+void _odbx_trace_result( odbx_t* handle, odbx_result_t* result, int err )
+{
+	const struct odbx_mat* mat;
+	struct odbx_htrace* trace = handle->trace;
+
+
+	if( err < 0 )
+	{
+		_odbx_trace_error( handle, err );
+		return;
+	}
+
+	if( err <= ODBX_RES_TIMEOUT ) { return; }
+
+	trace->span.time = handle->stats.result;
+	trace->span.status = err;
+	trace->span.rows = 0;
+	trace->span.bytes = 0;
+	trace->rows = handle->stats.total.rows;
+	trace->bytes = handle->stats.total.bytes;
+
+	if( trace->span.first == 0 ) { trace->span.first = trace->span.time; }
+	if( trace->hooks.result != NULL ) { trace->hooks.result( handle, &trace->span, trace->arg ); }
+
+	// result sets replayed from a cache don't use this handle any more
+	if( result != NULL && ( mat = _odbx_mat_get( result ) ) != NULL && trace->hooks.finish != NULL )
+	{
+		trace->span.rows = mat->rows;
+		trace->span.status = ODBX_ERR_SUCCESS;
+
+		trace->hooks.finish( handle, &trace->span, trace->arg );
+	}
+}
+
+
+
+void _odbx_trace_row( odbx_result_t* result, int err )
+{
+	odbx_t* handle = result->handle;
+	struct odbx_htrace* trace = handle->trace;
+
+
+	if( err < 0 )
+	{
+		_odbx_trace_error( handle, err );
+		return;
+	}
+
+	if( err == ODBX_ROW_NEXT && trace->hooks.rows != NULL && trace->hooks.batch != 0 &&
+		( handle->stats.total.rows - trace->rows ) % trace->hooks.batch == 0 )
+	{
+		trace->span.time = _odbx_lib_time();
+		trace->span.status = err;
+		trace->span.rows = handle->stats.total.rows - trace->rows;
+		trace->span.bytes = handle->stats.total.bytes - trace->bytes;
+
+		trace->hooks.rows( handle, &trace->span, trace->arg );
+	}
+}
+
+
+
+void _odbx_trace_finish( odbx_t* handle, int err )
+{
+	struct odbx_htrace* trace = handle->trace;
+
+
+	if( trace->hooks.finish != NULL )
+	{
+		trace->span.time = _odbx_lib_time();
+		trace->span.status = err;
+		trace->span.rows = handle->stats.total.rows - trace->rows;
+		trace->span.bytes = handle->stats.total.bytes - trace->bytes;
+
+		trace->hooks.finish( handle, &trace->span, trace->arg );
+	}
+}
+
+
+
+void _odbx_trace_error( odbx_t* handle, int err )
+{
+	struct odbx_htrace* trace = handle->trace;
+
+
+	if( trace->hooks.error != NULL )
+	{
+		trace->span.time = _odbx_lib_time();
+		trace->span.status = err;
+
+		trace->hooks.error( handle, &trace->span, trace->arg );
+	}
+}
+
+
+
+
+
+/*
+ *  ODBX trace hooks
+ */
+
+int odbx_set_trace_hooks( odbx_t* handle, const struct odbx_trace_hooks* hooks, void* arg )
+{
+	if( handle == NULL || handle->ops == NULL ) { return -ODBX_ERR_HANDLE; }
+
+	if( hooks == NULL )
+	{
+		free( handle->trace );
+		handle->trace = NULL;
+
+		return ODBX_ERR_SUCCESS;
+	}
+
+	if( handle->trace == NULL )
+	{
+		if( ( handle->trace = (struct odbx_htrace*) calloc( 1, sizeof( struct odbx_htrace ) ) ) == NULL )
+		{
+			return -ODBX_ERR_NOMEM;
+		}
+	}
+
+	memcpy( &handle->trace->hooks, hooks, sizeof( struct odbx_trace_hooks ) );
+	handle->trace->arg = arg;
+	handle->trace->span.backend = handle->name;
+	handle->trace->rows = handle->stats.total.rows;
+	handle->trace->bytes = handle->stats.total.bytes;
+
+	return ODBX_ERR_SUCCESS;
+}
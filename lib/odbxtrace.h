@@ -0,0 +1,50 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky and others
+ *
+ *  Distributed under the terms of the GNU Library General Public Licence
+ * version 2 or (at your option) any later version.
+ */
+
+
+
+#include "odbxdrv.h"
+
+
+
+#ifndef ODBXTRACE_H
+#define ODBXTRACE_H
+
+
+
+struct odbx_htrace
+{
+	struct odbx_trace_hooks hooks;
+	void* arg;
+	struct odbx_trace span;   // state of the current statement
+	uint64_t rows;   // row counter of the handle when the result set was returned
+	uint64_t bytes;   // byte counter of the handle when the result set was returned
+};
+
+
+
+/*
+ *  Trace events called by the ODBX functions if trace hooks are set for
+ *  the handle. Their costs are only paid by connections being traced.
+ */
+
+void _odbx_trace_query( odbx_t* handle, const char* query, unsigned long length );
+
+void _odbx_trace_result( odbx_t* handle, odbx_result_t* result, int err );
+
+void _odbx_trace_row( odbx_result_t* result, int err );
+
+void _odbx_trace_finish( odbx_t* handle, int err );
+
+void _odbx_trace_error( odbx_t* handle, int err );
+
+uint64_t _odbx_trace_fingerprint( const char* query, unsigned long length );
+
+
+
+#endif
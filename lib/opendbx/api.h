@@ -44,8 +44,10 @@ extern "C" {
 enum odbxcap {
 	ODBX_CAP_BASIC,
 #define ODBX_CAP_BASIC   ODBX_CAP_BASIC
-	ODBX_CAP_LO
+	ODBX_CAP_LO,
 #define ODBX_CAP_LO   ODBX_CAP_LO
+	ODBX_CAP_STMT
+#define ODBX_CAP_STMT   ODBX_CAP_STMT
 };
 
 
@@ -92,11 +94,13 @@ enum odbxerr {
 #define ODBX_ERR_RESULT   ODBX_ERR_RESULT
 	ODBX_ERR_NOTSUP,
 #define ODBX_ERR_NOTSUP   ODBX_ERR_NOTSUP
-	ODBX_ERR_HANDLE
+	ODBX_ERR_HANDLE,
 #define ODBX_ERR_HANDLE   ODBX_ERR_HANDLE
+	ODBX_ERR_CANCELED
+#define ODBX_ERR_CANCELED   ODBX_ERR_CANCELED
 };
 
-#define ODBX_MAX_ERRNO   0x0d
+#define ODBX_MAX_ERRNO   0x0e
 
 
 
@@ -193,6 +197,25 @@ enum odbxtype {
 
 
 
+/*
+ *  Types of values bound to prepared statements
+ */
+
+enum odbxparam {
+	ODBX_PARAM_NULL,
+#define ODBX_PARAM_NULL   ODBX_PARAM_NULL
+	ODBX_PARAM_INT64,
+#define ODBX_PARAM_INT64   ODBX_PARAM_INT64
+	ODBX_PARAM_DOUBLE,
+#define ODBX_PARAM_DOUBLE   ODBX_PARAM_DOUBLE
+	ODBX_PARAM_TEXT,
+#define ODBX_PARAM_TEXT   ODBX_PARAM_TEXT
+	ODBX_PARAM_BLOB
+#define ODBX_PARAM_BLOB   ODBX_PARAM_BLOB
+};
+
+
+
 /*
  *  ODBX options
  *
@@ -209,6 +232,8 @@ enum odbxopt {
 #define ODBX_OPT_THREAD_SAFE   ODBX_OPT_THREAD_SAFE
 	ODBX_OPT_LIB_VERSION = 0x0002,
 #define ODBX_OPT_LIB_VERSION   ODBX_OPT_LIB_VERSION
+	ODBX_OPT_SOCKET = 0x0003,
+#define ODBX_OPT_SOCKET   ODBX_OPT_SOCKET
 
 /* Security related options */
 	ODBX_OPT_TLS = 0x0010,
@@ -223,8 +248,10 @@ enum odbxopt {
 #define ODBX_OPT_COMPRESS   ODBX_OPT_COMPRESS
 	ODBX_OPT_MODE = 0x0023,
 #define ODBX_OPT_MODE   ODBX_OPT_MODE
-	ODBX_OPT_CONNECT_TIMEOUT = 0x0024
+	ODBX_OPT_CONNECT_TIMEOUT = 0x0024,
 #define ODBX_OPT_CONNECT_TIMEOUT   ODBX_OPT_CONNECT_TIMEOUT
+	ODBX_OPT_QUERY_TIMEOUT = 0x0025
+#define ODBX_OPT_QUERY_TIMEOUT   ODBX_OPT_QUERY_TIMEOUT
 };
 
 
@@ -249,6 +276,55 @@ enum odbxtls {
 typedef struct odbx_t odbx_t;
 typedef struct odbx_lo_t odbx_lo_t;
 typedef struct odbx_result_t odbx_result_t;
+typedef struct odbx_stmt_t odbx_stmt_t;
+typedef struct odbx_cache_t odbx_cache_t;
+typedef struct odbx_mux_t odbx_mux_t;
+
+typedef void (*odbx_mux_callback)( odbx_t* handle, odbx_result_t* result, int status, void* arg );
+
+
+
+#define ODBX_STATS_BUCKETS   32
+
+struct odbx_stats
+{
+	uint64_t queries;   // statements sent by odbx_query()
+	uint64_t results;   // result sets returned by odbx_result()
+	uint64_t rows;   // rows fetched by odbx_row_fetch()
+	uint64_t bytes;   // sum of the lengths returned by odbx_field_length()
+	uint64_t lo_read;   // bytes read from large objects
+	uint64_t lo_written;   // bytes written to large objects
+	uint64_t result_wait;   // nanoseconds spent in odbx_result()
+	uint64_t reconnects;   // odbx_bind() calls after the first one
+	uint64_t first_result[ODBX_STATS_BUCKETS];   // latency from query to first result
+	uint64_t drain[ODBX_STATS_BUCKETS];   // latency from result to odbx_result_finish()
+};
+
+
+
+struct odbx_trace
+{
+	uint64_t time;   // monotonic time of the event in nanoseconds
+	uint64_t start;   // time the statement was sent
+	uint64_t first;   // time the first result set was returned, zero if none yet
+	uint64_t fingerprint;   // hash of the statement without literals
+	const char* backend;
+	const char* query;   // statement, only available in the query hook
+	unsigned long length;
+	int status;   // return value of the traced function
+	uint64_t rows;   // rows fetched from the current result set
+	uint64_t bytes;   // bytes fetched from the current result set
+};
+
+struct odbx_trace_hooks
+{
+	void (*query)( odbx_t* handle, const struct odbx_trace* trace, void* arg );
+	void (*result)( odbx_t* handle, const struct odbx_trace* trace, void* arg );
+	void (*rows)( odbx_t* handle, const struct odbx_trace* trace, void* arg );
+	void (*finish)( odbx_t* handle, const struct odbx_trace* trace, void* arg );
+	void (*error)( odbx_t* handle, const struct odbx_trace* trace, void* arg );
+	unsigned long batch;   // rows between calls of the rows hook
+};
 
 
 
@@ -270,6 +346,12 @@ int odbx_get_option( odbx_t* handle, unsigned int option, void* value );
 
 int odbx_set_option( odbx_t* handle, unsigned int option, void* value );
 
+int odbx_stats( odbx_t* handle, struct odbx_stats* stats );
+
+int odbx_set_trace_hooks( odbx_t* handle, const struct odbx_trace_hooks* hooks, void* arg );
+
+int odbx_record( odbx_t* handle, const char* path );
+
 const char* odbx_error( odbx_t* handle, int error );
 
 int odbx_error_type( odbx_t* handle, int error );
@@ -280,6 +362,8 @@ int odbx_query( odbx_t* handle, const char* query, unsigned long length );
 
 int odbx_result( odbx_t* handle, odbx_result_t** result, struct timeval* timeout, unsigned long chunk );
 
+int odbx_cancel( odbx_t* handle );
+
 int odbx_result_finish( odbx_result_t* result );
 
 int odbx_row_fetch( odbx_result_t* result );
@@ -296,6 +380,56 @@ unsigned long odbx_field_length( odbx_result_t* result, unsigned long pos );
 
 const char* odbx_field_value( odbx_result_t* result, unsigned long pos );
 
+int odbx_field_int64( odbx_result_t* result, unsigned long pos, int64_t* value );
+
+int odbx_field_decimal( odbx_result_t* result, unsigned long pos, unsigned int scale, int64_t* value );
+
+int odbx_field_double( odbx_result_t* result, unsigned long pos, double* value );
+
+int odbx_field_bool( odbx_result_t* result, unsigned long pos, int* value );
+
+int odbx_field_timestamp( odbx_result_t* result, unsigned long pos, int64_t* value );
+
+int odbx_conv_int64( const char* str, unsigned long length, int64_t* value );
+
+int odbx_conv_double( const char* str, unsigned long length, double* value );
+
+
+
+/*
+ *  ODBX result materialization
+ */
+
+int odbx_result_detach( odbx_result_t* result, odbx_result_t** detached, unsigned long maxrows );
+
+int odbx_result_serialize( odbx_result_t* result, const void** buffer, size_t* size );
+
+int odbx_result_deserialize( odbx_result_t** result, const void* buffer, size_t size );
+
+int odbx_result_open( odbx_result_t** result, const char* path );
+
+struct ArrowSchema;
+struct ArrowArray;
+
+int odbx_result_to_columnar( odbx_result_t* result, unsigned long batchrows,
+	int (*callback)( struct ArrowSchema* schema, struct ArrowArray* batch, void* arg ), void* arg );
+
+
+
+/*
+ *  ODBX prepared statement operations
+ */
+
+int odbx_stmt_prepare( odbx_t* handle, odbx_stmt_t** stmt, const char* query, unsigned long length );
+
+unsigned long odbx_stmt_count( odbx_stmt_t* stmt );
+
+int odbx_stmt_bind( odbx_stmt_t* stmt, unsigned long pos, int type, const void* value, unsigned long length );
+
+int odbx_stmt_execute( odbx_stmt_t* stmt );
+
+int odbx_stmt_finish( odbx_stmt_t* stmt );
+
 
 
 /*
@@ -314,6 +448,40 @@ int odbx_lo_close( odbx_lo_t* lo );
 
 
 
+/*
+ *  ODBX result cache operations
+ */
+
+int odbx_cache_init( odbx_cache_t** cache, unsigned long maxmem, unsigned long ttl );
+
+int odbx_cache_attach( odbx_t* handle, odbx_cache_t* cache );
+
+int odbx_cache_invalidate( odbx_t* handle, const char* query, unsigned long length );
+
+int odbx_cache_invalidate_tag( odbx_cache_t* cache, const char* table );
+
+int odbx_cache_finish( odbx_cache_t* cache );
+
+
+
+/*
+ *  ODBX multiplexer operations
+ */
+
+int odbx_mux_init( odbx_mux_t** mux );
+
+int odbx_mux_add( odbx_mux_t* mux, odbx_t* handle );
+
+int odbx_mux_query( odbx_mux_t* mux, const char* query, unsigned long length, struct timeval* timeout, odbx_mux_callback callback, void* arg );
+
+int odbx_mux_run( odbx_mux_t* mux, struct timeval* timeout );
+
+int odbx_mux_finish( odbx_mux_t* mux );
+
+
+
+
+
 /*
  *  Depricated defines and functions
  *
@@ -0,0 +1,88 @@
+/*
+ *  OpenDBX - A simple but extensible database abstraction layer
+ *  Copyright (C) 2004-2008 Norbert Sendetzky <norbert@linuxnetworks.de>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307 USA.
+ */
+
+
+#include <opendbx/api.h>
+
+
+
+#ifndef ODBX_ARROW_H
+#define ODBX_ARROW_H
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/*
+ *  Structures of the Apache Arrow C data interface
+ *
+ *  The definitions are part of the stable ABI of Arrow and the guard
+ *  allows including the headers of Arrow and OpenDBX in any order.
+ */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED   1
+#define ARROW_FLAG_NULLABLE   2
+#define ARROW_FLAG_MAP_KEYS_SORTED   4
+
+struct ArrowSchema
+{
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+	void (*release)( struct ArrowSchema* );
+	void* private_data;
+};
+
+struct ArrowArray
+{
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+	void (*release)( struct ArrowArray* );
+	void* private_data;
+};
+
+#endif
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ *  Microbenchmark of the value conversion functions against the libc
+ *
+ *  Usage: odbxconvbench [count]
+ */
+
+
+
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+
+#include "odbxconv.h"
+#include "odbxlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+
+struct values
+{
+	char* data;
+	unsigned long* off;
+	unsigned long count;
+};
+
+
+
+static void generate( struct values* v, unsigned long count, int kind )
+{
+	unsigned long i, len = 0;
+
+	v->data = (char*) malloc( count * 32 );
+	v->off = (unsigned long*) malloc( sizeof( unsigned long ) * ( count + 1 ) );
+	v->count = count;
+
+	for( i = 0; i < count; i++ )
+	{
+		long long r = ( (long long) rand() << 20 ) ^ rand();
+
+		v->off[i] = len;
+
+		switch( kind )
+		{
+			case 0:
+				len += sprintf( v->data + len, "%lld", ( i & 1 ) ? -r : r % 100000 ) + 1;
+				break;
+			case 1:
+				len += sprintf( v->data + len, "%.3f", (double) r / 1000.0 ) + 1;
+				break;
+			case 2:
+				len += sprintf( v->data + len, "20%02lu-%02lu-%02lu %02lu:%02lu:%02lu.%06lu", i % 30, i % 12 + 1, i % 28 + 1,
+					i % 24, i % 60, ( i / 60 ) % 60, (unsigned long) r % 1000000 ) + 1;
+				break;
+		}
+	}
+
+	v->off[count] = len;
+}
+
+
+
+/*
+ *  Builds a materialized result set with one column containing the values
+ */
+
+static struct odbx_mat* materialize( struct values* v )
+{
+	unsigned long i;
+	struct odbx_mat* mat;
+	size_t colpos, offpos, nullpos, datapos;
+
+
+	colpos = ODBX_MAT_ALIGN( sizeof( struct odbx_mat ) );
+	offpos = ODBX_MAT_ALIGN( colpos + sizeof( struct odbx_mat_column ) + 1 );
+	nullpos = offpos + sizeof( uint64_t ) * ( v->count + 1 );
+	datapos = ODBX_MAT_ALIGN( nullpos + ( ( v->count + 7 ) >> 3 ) );
+
+	mat = (struct odbx_mat*) calloc( 1, datapos + v->off[v->count] );
+
+	mat->magic = ODBX_MAT_MAGIC;
+	mat->version = ODBX_MAT_VERSION;
+	mat->status = ODBX_RES_ROWS;
+	mat->size = datapos + v->off[v->count];
+	mat->rows = v->count;
+	mat->cols = 1;
+	mat->columns = colpos;
+	mat->offsets = offpos;
+	mat->nulls = nullpos;
+	mat->data = datapos;
+
+	((struct odbx_mat_column*) ( (char*) mat + colpos ))->name = colpos + sizeof( struct odbx_mat_column );
+
+	for( i = 0; i <= v->count; i++ )
+	{
+		((uint64_t*) ( (char*) mat + offpos ))[i] = v->off[i];
+	}
+
+	memcpy( (char*) mat + datapos, v->data, v->off[v->count] );
+
+	return mat;
+}
+
+
+
+static void report( const char* name, uint64_t start, unsigned long count, double check )
+{
+	printf( "%-24s %8.2f ns/value   (%g)\n", name, (double) ( _odbx_lib_time() - start ) / count, check );
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	unsigned long i, count = 1000000;
+	struct values ints, dbls, stamps;
+	struct odbx_mat* mat;
+	uint64_t start;
+	int64_t sum, num;
+	double dsum, dbl;
+	int64_t* column;
+	unsigned char* valid;
+
+
+	if( argc > 1 ) { count = strtoul( argv[1], NULL, 10 ); }
+	if( count == 0 ) { count = 1; }
+
+	generate( &ints, count, 0 );
+	generate( &dbls, count, 1 );
+	generate( &stamps, count, 2 );
+
+	start = _odbx_lib_time();
+	for( i = 0, sum = 0; i < count; i++ ) { sum += strtoll( ints.data + ints.off[i], NULL, 10 ); }
+	report( "int64 strtoll", start, count, (double) sum );
+
+	start = _odbx_lib_time();
+	for( i = 0, sum = 0; i < count; i++ )
+	{
+		_odbx_conv_int( ints.data + ints.off[i], ints.off[i+1] - ints.off[i] - 1, &num );
+		sum += num;
+	}
+	report( "int64 _odbx_conv_int", start, count, (double) sum );
+
+	mat = materialize( &ints );
+	column = (int64_t*) malloc( sizeof( int64_t ) * count );
+	valid = (unsigned char*) calloc( 1, ( count + 7 ) >> 3 );
+	memset( column, 0, sizeof( int64_t ) * count );   // no page faults while measuring
+
+	start = _odbx_lib_time();
+	_odbx_conv_int_column( mat, 0, sizeof( int64_t ), column, valid );
+	for( i = 0, sum = 0; i < count; i++ ) { sum += column[i]; }
+	report( "int64 column", start, count, (double) sum );
+
+	free( valid );
+	free( column );
+	free( mat );
+
+	start = _odbx_lib_time();
+	for( i = 0, dsum = 0; i < count; i++ ) { dsum += strtod( dbls.data + dbls.off[i], NULL ); }
+	report( "double strtod", start, count, dsum );
+
+	start = _odbx_lib_time();
+	for( i = 0, dsum = 0; i < count; i++ )
+	{
+		_odbx_conv_double( dbls.data + dbls.off[i], dbls.off[i+1] - dbls.off[i] - 1, &dbl );
+		dsum += dbl;
+	}
+	report( "double _odbx_conv_double", start, count, dsum );
+
+	start = _odbx_lib_time();
+	for( i = 0, sum = 0; i < count; i++ )
+	{
+		struct tm tm;
+
+		memset( &tm, 0, sizeof( tm ) );
+		strptime( stamps.data + stamps.off[i], "%Y-%m-%d %H:%M:%S", &tm );
+		sum += (int64_t) timegm( &tm );
+	}
+	report( "timestamp strptime", start, count, (double) sum );
+
+	start = _odbx_lib_time();
+	for( i = 0, sum = 0; i < count; i++ )
+	{
+		_odbx_conv_timestamp( stamps.data + stamps.off[i], stamps.off[i+1] - stamps.off[i] - 1, 0, &num );
+		sum += num / 1000000;
+	}
+	report( "timestamp _odbx_conv", start, count, (double) sum );
+
+	return 0;
+}
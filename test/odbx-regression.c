@@ -12,7 +12,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 #include <odbx.h>
+#include <opendbx/arrow.h>
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -22,12 +24,35 @@
 #include <getopt.h>
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #include "odbx-regression.h"
 
 
 
 int exec( odbx_t* handle[], struct odbxstmt qptr[], int verbose );
 int lob_read( odbx_t* handle, odbx_result_t* result, int pos );
+int fetch( odbx_t* handle, const char* query, char* value, size_t size );
+int cache_test( odbx_t* handle[], int verbose );
+int detach_test( odbx_t* handle[], int verbose );
+int detach_check( odbx_result_t* result, int first, int rows );
+int stmt_test( odbx_t* handle[], int verbose );
+int stmt_fetch( odbx_t* handle, odbx_stmt_t* stmt, odbx_result_t** result, const char* value );
+int mux_test( odbx_t* handle[], int verbose );
+void mux_callback( odbx_t* handle, odbx_result_t* result, int status, void* arg );
+int cancel_test( odbx_t* handle[], int verbose );
+void* cancel_thread( void* arg );
+int conv_same( double a, double b );
+int conv_test( odbx_t* handle[], int verbose );
+int arrow_test( odbx_t* handle[], int verbose );
+int arrow_column( const struct ArrowSchema* field, const struct ArrowArray* array, unsigned long first, int col );
+int arrow_callback( struct ArrowSchema* schema, struct ArrowArray* batch, void* arg );
+void stats_delta( const struct odbx_stats* before, const struct odbx_stats* after, uint64_t delta[8] );
+int stats_test( odbx_t* handle[], int verbose );
+int replay_run( odbx_t* handle, char* out, size_t size );
+int replay_test( odbx_t* handle[], const char* backend, const char* host, int verbose );
 
 
 
@@ -199,9 +224,9 @@ int main( int argc, char* argv[] )
 			unsigned long len = 128;
 			int err;
 
-			if( ( err = odbx_escape( handle[k], value, strlen( value ), escaped, &len ) ) != 0 )
+			if( ( err = odbx_escape( handle[0], value, strlen( value ), escaped, &len ) ) != 0 )
 			{
-				fprintf( stderr, "Error in odbx_escape(): %s\n", odbx_error( handle[k], err ) );
+				fprintf( stderr, "Error in odbx_escape(): %s\n", odbx_error( handle[0], err ) );
 				break;
 			}
 
@@ -229,6 +254,19 @@ int main( int argc, char* argv[] )
 			}
 		}
 
+		if( strstr( backend, "sqlite3" ) != NULL )   // tests of library features using SQLite statements
+		{
+			if( cache_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in cache_test(): Fatal error\n" ); }
+			if( detach_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in detach_test(): Fatal error\n" ); }
+			if( stmt_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in stmt_test(): Fatal error\n" ); }
+			if( mux_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in mux_test(): Fatal error\n" ); }
+			if( cancel_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in cancel_test(): Fatal error\n" ); }
+			if( conv_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in conv_test(): Fatal error\n" ); }
+			if( arrow_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in arrow_test(): Fatal error\n" ); }
+			if( stats_test( handle, verbose ) < 0 ) { fprintf( stdout, "Error in stats_test(): Fatal error\n" ); }
+			if( replay_test( handle, backend, host, verbose ) < 0 ) { fprintf( stdout, "Error in replay_test(): Fatal error\n" ); }
+		}
+
 		for( k = 0; k < 2; k++ )
 		{
 			if( verbose ) { fprintf( stdout, "  odbx_unbind()\n" ); }
@@ -426,3 +464,1265 @@ int lob_read( odbx_t* handle, odbx_result_t* result, int pos )
 
 	return ODBX_ERR_SUCCESS;
 }
+
+
+
+/*
+ *  Executes the query and copies the first value of the first row to
+ *  value. Returns the number of rows or the first error.
+ */
+
+int fetch( odbx_t* handle, const char* query, char* value, size_t size )
+{
+	int err, rows = 0, first = 0;
+	odbx_result_t* result;
+	const char* tmp;
+
+
+	value[0] = '\0';
+
+	if( ( err = odbx_query( handle, query, 0 ) ) < 0 ) { return err; }
+
+	while( ( err = odbx_result( handle, &result, NULL, 0 ) ) != ODBX_RES_DONE )
+	{
+		if( err < 0 )
+		{
+			if( first == 0 ) { first = err; }
+			if( odbx_error_type( handle, err ) < 0 ) { return err; }
+			continue;
+		}
+
+		while( ( err = odbx_row_fetch( result ) ) == ODBX_ROW_NEXT )
+		{
+			if( rows++ == 0 && ( tmp = odbx_field_value( result, 0 ) ) != NULL ) { snprintf( value, size, "%s", tmp ); }
+		}
+
+		if( err < 0 && first == 0 ) { first = err; }
+
+		odbx_result_finish( result );
+	}
+
+	return first < 0 ? first : rows;
+}
+
+
+
+int cache_test( odbx_t* handle[], int verbose )
+{
+	int err;
+	char value[32];
+	odbx_cache_t* cache;
+	const char* msg = NULL;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_cache_attach()\n" ); }
+
+	if( ( err = fetch( handle[0], "CREATE TABLE \"odbxcache\" ( \"id\" INTEGER, \"str20\" VARCHAR(20) )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxcache\" VALUES ( 1, 'first' )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "CREATE TABLE \"odbxjoin\" ( \"id\" INTEGER, \"str20\" VARCHAR(20) )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxjoin\" VALUES ( 1, 'first' )", value, sizeof( value ) ) ) < 0 )
+	{
+		fprintf( stderr, "Error in cache_test(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	if( ( err = odbx_cache_init( &cache, 65536, 0 ) ) < 0 || ( err = odbx_cache_attach( handle[0], cache ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_cache_attach(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	fetch( handle[0], "SELECT \"str20\" FROM \"odbxcache\"", value, sizeof( value ) );
+	fetch( handle[1], "UPDATE \"odbxcache\" SET \"str20\" = 'second'", value, sizeof( value ) );
+
+	// Test case:  Changes by other connections aren't visible, comments and white space don't change the key
+	if( fetch( handle[0], "SELECT \"str20\"\n/* comment */  FROM \"odbxcache\" -- comment", value, sizeof( value ) ) != 1 || strcmp( value, "first" ) != 0 )
+	{
+		msg = "Result not returned from cache";
+	}
+
+	// Test case:  Text after line comments isn't part of the statement
+	if( msg == NULL && ( fetch( handle[0], "SELECT 'a' -- x\nFROM \"odbxcache\" WHERE 1 = 0", value, sizeof( value ) ) != 0 ||
+		fetch( handle[0], "SELECT 'a' -- x FROM \"odbxcache\" WHERE 1 = 0", value, sizeof( value ) ) != 1 ) )
+	{
+		msg = "Statements with different comments share the cached result";
+	}
+
+	// Test case:  TRUNCATE without TABLE invalidates the results before the statement is sent (SQLite doesn't know it)
+	if( msg == NULL )
+	{
+		fetch( handle[0], "TRUNCATE \"odbxcache\"", value, sizeof( value ) );
+
+		if( fetch( handle[0], "SELECT \"str20\" FROM \"odbxcache\"", value, sizeof( value ) ) != 1 || strcmp( value, "second" ) != 0 )
+		{
+			msg = "Result not invalidated by TRUNCATE";
+		}
+	}
+
+	// Test case:  Writes by the same connection invalidate the cached results of the table
+	if( msg == NULL )
+	{
+		fetch( handle[0], "UPDATE \"odbxcache\" SET \"str20\" = 'third'", value, sizeof( value ) );
+
+		if( fetch( handle[0], "SELECT \"str20\" FROM \"odbxcache\"", value, sizeof( value ) ) != 1 || strcmp( value, "third" ) != 0 )
+		{
+			msg = "Result not invalidated by UPDATE";
+		}
+	}
+
+	// Test case:  All tables of a comma separated FROM list are tagged, not only the first one
+	if( msg == NULL )
+	{
+		fetch( handle[0], "SELECT \"b\".\"str20\" FROM \"odbxcache\" \"a\", \"odbxjoin\" \"b\" WHERE \"a\".\"id\" = \"b\".\"id\"", value, sizeof( value ) );
+		fetch( handle[0], "UPDATE \"odbxjoin\" SET \"str20\" = 'second'", value, sizeof( value ) );
+
+		if( fetch( handle[0], "SELECT \"b\".\"str20\" FROM \"odbxcache\" \"a\", \"odbxjoin\" \"b\" WHERE \"a\".\"id\" = \"b\".\"id\"", value, sizeof( value ) ) != 1 ||
+			strcmp( value, "second" ) != 0 )
+		{
+			msg = "Result of comma join not invalidated by UPDATE";
+		}
+	}
+
+	odbx_cache_attach( handle[0], NULL );
+	odbx_cache_finish( cache );
+
+	fetch( handle[0], "DROP TABLE \"odbxjoin\"", value, sizeof( value ) );
+	fetch( handle[0], "DROP TABLE \"odbxcache\"", value, sizeof( value ) );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in cache_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+int detach_test( odbx_t* handle[], int verbose )
+{
+	int err;
+	FILE* file;
+	size_t size;
+	char value[32];
+	const void* buffer;
+	const char* msg = NULL;
+	const char* path = "odbxtest.mat";
+	odbx_result_t *result, *first, *second, *copy;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_result_detach()\n" ); }
+
+	if( ( err = fetch( handle[0], "CREATE TABLE \"odbxmat\" ( \"id\" INTEGER, \"str20\" VARCHAR(20) )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxmat\" VALUES ( 1, 'a' )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxmat\" VALUES ( 2, NULL )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxmat\" VALUES ( 3, 'c' )", value, sizeof( value ) ) ) < 0 ||
+		( err = odbx_query( handle[0], "SELECT \"id\", \"str20\" FROM \"odbxmat\" ORDER BY \"id\"", 0 ) ) < 0 ||
+		( err = odbx_result( handle[0], &result, NULL, 0 ) ) < 0 )
+	{
+		fprintf( stderr, "Error in detach_test(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	// Test case:  Rows are copied in batches of maxrows
+	if( ( err = odbx_result_detach( result, &first, 2 ) ) != ODBX_ROW_NEXT )
+	{
+		fprintf( stderr, "Error in odbx_result_detach(): %s\n", err < 0 ? odbx_error( handle[0], err ) : "All rows copied" );
+		odbx_result_finish( result );
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( ( err = odbx_result_detach( result, &second, 2 ) ) != ODBX_ROW_DONE )
+	{
+		fprintf( stderr, "Error in odbx_result_detach(): %s\n", err < 0 ? odbx_error( handle[0], err ) : "Rows remaining" );
+		odbx_result_finish( first );
+		odbx_result_finish( result );
+		return -ODBX_ERR_PARAM;
+	}
+
+	odbx_result_finish( result );
+	while( odbx_result( handle[0], &result, NULL, 0 ) > 0 ) { odbx_result_finish( result ); }
+
+	// Test case:  Detached rows are still valid after the next statement was sent
+	fetch( handle[0], "DROP TABLE \"odbxmat\"", value, sizeof( value ) );
+
+	if( detach_check( first, 1, 2 ) < 0 || detach_check( second, 3, 1 ) < 0 ) { msg = "Detached result contains wrong values"; }
+
+	// Test case:  Serialized result sets can be restored from memory and from a file
+	if( msg == NULL )
+	{
+		if( odbx_result_serialize( first, &buffer, &size ) != ODBX_ERR_SUCCESS ) { msg = "Serializing result failed"; }
+		else if( odbx_result_deserialize( &copy, buffer, size - 8 ) >= 0 ) { msg = "Truncated buffer was accepted"; }
+		else if( odbx_result_deserialize( &copy, buffer, size ) != ODBX_RES_ROWS ) { msg = "Deserializing result failed"; }
+		else
+		{
+			if( detach_check( copy, 1, 2 ) < 0 ) { msg = "Deserialized result contains wrong values"; }
+			odbx_result_finish( copy );
+		}
+	}
+
+	if( msg == NULL )
+	{
+		if( ( file = fopen( path, "wb" ) ) == NULL || fwrite( buffer, size, 1, file ) != 1 ) { msg = "Writing result failed"; }
+		if( file != NULL ) { fclose( file ); }
+
+		if( msg == NULL && odbx_result_open( &copy, path ) != ODBX_RES_ROWS ) { msg = "Opening result file failed"; }
+		else if( msg == NULL )
+		{
+			if( detach_check( copy, 1, 2 ) < 0 ) { msg = "Result file contains wrong values"; }
+			odbx_result_finish( copy );
+		}
+
+		remove( path );
+	}
+
+	odbx_result_finish( first );
+	odbx_result_finish( second );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in detach_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Rows of the "odbxmat" table contain the id and 'a', NULL or 'c'
+ */
+
+int detach_check( odbx_result_t* result, int first, int rows )
+{
+	int i;
+	char id[8];
+	const char* str[] = { "a", NULL, "c" };
+
+
+	if( odbx_column_count( result ) != 2 || strcmp( odbx_column_name( result, 1 ), "str20" ) != 0 ) { return -ODBX_ERR_PARAM; }
+
+	for( i = first; i < first + rows; i++ )
+	{
+		snprintf( id, sizeof( id ), "%d", i );
+
+		if( odbx_row_fetch( result ) != ODBX_ROW_NEXT || strcmp( odbx_field_value( result, 0 ), id ) != 0 ) { return -ODBX_ERR_PARAM; }
+
+		if( str[i-1] == NULL ? odbx_field_value( result, 1 ) != NULL :
+			odbx_field_value( result, 1 ) == NULL || strcmp( odbx_field_value( result, 1 ), str[i-1] ) != 0 )
+		{
+			return -ODBX_ERR_PARAM;
+		}
+	}
+
+	return odbx_row_fetch( result ) == ODBX_ROW_DONE ? ODBX_ERR_SUCCESS : -ODBX_ERR_PARAM;
+}
+
+
+
+int stmt_test( odbx_t* handle[], int verbose )
+{
+	int err;
+	const char* msg = NULL;
+	odbx_result_t *result, *other;
+	odbx_stmt_t *first, *second;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_stmt_execute()\n" ); }
+
+	if( ( err = odbx_stmt_prepare( handle[0], &first, "SELECT 'first'", 0 ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_stmt_prepare(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	if( ( err = odbx_stmt_prepare( handle[0], &second, "SELECT 'second'", 0 ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_stmt_prepare(): %s\n", odbx_error( handle[0], err ) );
+		odbx_stmt_finish( first );
+		return err;
+	}
+
+	// Test case:  Other statements can't be executed while a result set of a prepared statement is in use
+	if( stmt_fetch( handle[0], first, &result, "first" ) < 0 ) { msg = "Executing first statement failed"; }
+	else
+	{
+		if( odbx_stmt_execute( second ) != -ODBX_ERR_PARAM ) { msg = "Second statement executed while result set is in use"; }
+		odbx_result_finish( result );
+	}
+
+	// Test case:  Both statements are still valid after the result set was finished
+	if( msg == NULL )
+	{
+		if( stmt_fetch( handle[0], second, &other, "second" ) < 0 ) { msg = "Executing second statement failed"; }
+		else { odbx_result_finish( other ); }
+	}
+
+	// Test case:  Finishing a statement whose result set is in use defers finalizing it
+	if( msg == NULL )
+	{
+		if( stmt_fetch( handle[0], first, &result, "first" ) < 0 ) { msg = "Executing first statement again failed"; }
+		else
+		{
+			odbx_stmt_finish( first );
+			first = NULL;
+			odbx_result_finish( result );
+
+			if( stmt_fetch( handle[0], second, &other, "second" ) < 0 ) { msg = "Executing second statement again failed"; }
+			else { odbx_result_finish( other ); }
+		}
+	}
+
+	// Test case:  Doubles are sent with a decimal point, NaN and infinity are rejected
+	if( msg == NULL )
+	{
+		odbx_stmt_t* param;
+		double real = 0.5, nan = NAN, inf = -INFINITY;
+
+		if( odbx_stmt_prepare( handle[0], &param, "SELECT ?", 0 ) < 0 ) { msg = "Preparing statement with placeholder failed"; }
+		else
+		{
+			if( odbx_stmt_bind( param, 0, ODBX_PARAM_DOUBLE, &nan, sizeof( double ) ) != -ODBX_ERR_PARAM ||
+				odbx_stmt_bind( param, 0, ODBX_PARAM_DOUBLE, &inf, sizeof( double ) ) != -ODBX_ERR_PARAM )
+			{
+				msg = "NaN or infinity accepted as value";
+			}
+			else if( odbx_stmt_bind( param, 0, ODBX_PARAM_DOUBLE, &real, sizeof( double ) ) < 0 ||
+				stmt_fetch( handle[0], param, &result, "0.5" ) < 0 )
+			{
+				msg = "Executing statement with bound double failed";
+			}
+			else { odbx_result_finish( result ); }
+
+			odbx_stmt_finish( param );
+		}
+	}
+
+	while( odbx_result( handle[0], &result, NULL, 0 ) > 0 ) { odbx_result_finish( result ); }
+
+	if( first != NULL ) { odbx_stmt_finish( first ); }
+	odbx_stmt_finish( second );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in stmt_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Executes the statement and fetches the first row, which must contain
+ *  the given value. The result set is returned without finishing it
+ */
+
+int stmt_fetch( odbx_t* handle, odbx_stmt_t* stmt, odbx_result_t** result, const char* value )
+{
+	int err;
+
+
+	if( ( err = odbx_stmt_execute( stmt ) ) < 0 ) { return err; }
+	if( ( err = odbx_result( handle, result, NULL, 0 ) ) != ODBX_RES_ROWS ) { return err < 0 ? err : -ODBX_ERR_PARAM; }
+
+	if( odbx_row_fetch( *result ) != ODBX_ROW_NEXT || odbx_field_value( *result, 0 ) == NULL ||
+		strcmp( odbx_field_value( *result, 0 ), value ) != 0 )
+	{
+		odbx_result_finish( *result );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Result of a query executed by the multiplexer
+ */
+
+struct muxcheck
+{
+	odbx_t* handle;
+	char value[8];
+	int status;
+};
+
+
+
+int mux_test( odbx_t* handle[], int verbose )
+{
+	int i, err;
+	odbx_mux_t* mux = NULL;
+	const char* msg = NULL;
+	struct timeval tv = { 0, 0 };
+	struct muxcheck check[6];
+	const char* queries[] = { "SELECT 1", "SELECT 2", "SELECT 3", "SELECT 4", "SELECT * FROM \"odbxmissing\"", "SELECT 6" };
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_mux_run()\n" ); }
+
+	if( ( err = odbx_mux_init( &mux ) ) < 0 || ( err = odbx_mux_add( mux, handle[0] ) ) < 0 || ( err = odbx_mux_add( mux, handle[1] ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_mux_add(): %s\n", odbx_error( handle[0], err ) );
+		if( mux != NULL ) { odbx_mux_finish( mux ); }
+		return err;
+	}
+
+	memset( check, 0, sizeof( check ) );
+
+	for( i = 0; i < 6; i++ )
+	{
+		// the last query expires before it can be sent
+		if( ( err = odbx_mux_query( mux, queries[i], 0, i == 5 ? &tv : NULL, mux_callback, &check[i] ) ) < 0 )
+		{
+			fprintf( stderr, "Error in odbx_mux_query(): %s\n", odbx_error( handle[0], err ) );
+			odbx_mux_finish( mux );
+			return err;
+		}
+	}
+
+	if( ( err = odbx_mux_run( mux, NULL ) ) != 0 ) { msg = "Queries remaining after odbx_mux_run()"; }
+
+	// Test case:  Queries are executed in turns by all connections and return their values
+	for( i = 0; i < 4 && msg == NULL; i++ )
+	{
+		if( check[i].status != ODBX_RES_DONE || check[i].handle == NULL || check[i].value[0] != '1' + i || check[i].value[1] != 0 )
+		{
+			msg = "Query returned wrong result";
+		}
+	}
+
+	if( msg == NULL && check[0].handle == check[1].handle ) { msg = "Queries weren't dispatched to all connections"; }
+
+	// Test case:  Failing queries report their error and don't affect the others
+	if( msg == NULL && ( check[4].status >= 0 || check[4].handle == NULL ) ) { msg = "Error of failed query not reported"; }
+
+	// Test case:  Queries whose deadline passed in the queue are never sent
+	if( msg == NULL && ( check[5].status != ODBX_RES_TIMEOUT || check[5].handle != NULL ) ) { msg = "Expired query not reported"; }
+
+	odbx_mux_finish( mux );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in mux_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+void mux_callback( odbx_t* handle, odbx_result_t* result, int status, void* arg )
+{
+	struct muxcheck* check = (struct muxcheck*) arg;
+
+	check->handle = handle;
+	check->status = status;
+
+	if( result != NULL && status == ODBX_RES_ROWS && odbx_row_fetch( result ) == ODBX_ROW_NEXT && odbx_field_value( result, 0 ) != NULL )
+	{
+		snprintf( check->value, sizeof( check->value ), "%s", odbx_field_value( result, 0 ) );
+	}
+}
+
+
+
+/*
+ *  State shared with the thread calling odbx_cancel()
+ */
+
+struct cancelarg
+{
+	odbx_t* handle;
+	int done;
+};
+
+
+
+int cancel_test( odbx_t* handle[], int verbose )
+{
+	int err;
+	char value[32];
+	unsigned int timeout = 200;
+	const char* msg = NULL;
+	const char* query = "WITH RECURSIVE \"c\"( \"x\" ) AS ( SELECT 1 UNION ALL SELECT \"x\" + 1 FROM \"c\" WHERE \"x\" < 100000000 ) SELECT count(*) FROM \"c\"";
+#ifdef HAVE_PTHREAD_H
+	pthread_t thread;
+	struct cancelarg arg = { handle[0], 0 };
+#endif
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_cancel()\n" ); }
+
+	if( ( err = odbx_set_option( handle[0], ODBX_OPT_QUERY_TIMEOUT, (void*) &timeout ) ) < 0 )
+	{
+		fprintf( stderr, "Error in odbx_set_option(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	// Test case:  Statements running longer than the query timeout are interrupted
+	if( fetch( handle[0], query, value, sizeof( value ) ) != -ODBX_ERR_CANCELED ) { msg = "Statement not canceled after query timeout"; }
+
+	timeout = 0;
+	odbx_set_option( handle[0], ODBX_OPT_QUERY_TIMEOUT, (void*) &timeout );
+
+	// Test case:  The connection can be used again after a statement was canceled
+	if( msg == NULL && ( fetch( handle[0], "SELECT 'ok'", value, sizeof( value ) ) != 1 || strcmp( value, "ok" ) != 0 ) )
+	{
+		msg = "Connection not usable after statement was canceled";
+	}
+
+#ifdef HAVE_PTHREAD_H
+	// Test case:  Running statements are interrupted by odbx_cancel() of another thread
+	if( msg == NULL )
+	{
+		if( pthread_create( &thread, NULL, cancel_thread, &arg ) != 0 ) { msg = "Starting thread failed"; }
+		else
+		{
+			if( fetch( handle[0], query, value, sizeof( value ) ) != -ODBX_ERR_CANCELED ) { msg = "Statement not canceled by odbx_cancel()"; }
+
+			__atomic_store_n( &arg.done, 1, __ATOMIC_RELEASE );
+			pthread_join( thread, NULL );
+		}
+	}
+#endif
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in cancel_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Cancels repeatedly, as the first call may happen before the statement
+ *  was sent
+ */
+
+void* cancel_thread( void* arg )
+{
+	struct cancelarg* ca = (struct cancelarg*) arg;
+
+	while( __atomic_load_n( &ca->done, __ATOMIC_ACQUIRE ) == 0 )
+	{
+		usleep( 50000 );
+		odbx_cancel( ca->handle );
+	}
+
+	return NULL;
+}
+
+
+
+/*
+ *  Input of the conversion functions and the expected result, the value
+ *  is only compared if the input is valid
+ */
+
+struct convcheck
+{
+	const char* str;
+	int valid;
+	int64_t value;
+};
+
+static const struct convcheck conv_int[] = {
+	{ "0", 1, 0 },
+	{ "-0", 1, 0 },
+	{ "+0", 1, 0 },
+	{ "+42", 1, 42 },
+	{ "-42", 1, -42 },
+	{ "0000000000000000042", 1, 42 },
+	{ "9223372036854775807", 1, INT64_MAX },
+	{ "+9223372036854775807", 1, INT64_MAX },
+	{ "-9223372036854775808", 1, INT64_MIN },
+	{ "9223372036854775808", 0, 0 },
+	{ "-9223372036854775809", 0, 0 },
+	{ "18446744073709551616", 0, 0 },
+	{ "99999999999999999999", 0, 0 },
+	{ "", 0, 0 },
+	{ "-", 0, 0 },
+	{ "+", 0, 0 },
+	{ "--1", 0, 0 },
+	{ "+-1", 0, 0 },
+	{ " 1", 0, 0 },
+	{ "\t1", 0, 0 },
+	{ "1 ", 0, 0 },
+	{ "1\n", 0, 0 },
+	{ "1.0", 0, 0 },
+	{ "1e3", 0, 0 },
+	{ "0x10", 0, 0 },
+	{ "12345678a", 0, 0 },
+	{ "1234567812345678 ", 0, 0 },
+	{ NULL, 0, 0 }
+};
+
+static const struct convcheck conv_double[] = {   // values are compared to the result of strtod()
+	{ "0", 1, 0 },
+	{ "-0", 1, 0 },
+	{ "+1", 1, 0 },
+	{ "1.5", 1, 0 },
+	{ "-.5", 1, 0 },
+	{ "5.", 1, 0 },
+	{ "1e10", 1, 0 },
+	{ "1E-5", 1, 0 },
+	{ "-1.25e+2", 1, 0 },
+	{ "0.1", 1, 0 },
+	{ "0.30000000000000004", 1, 0 },
+	{ "123456789012345678", 1, 0 },
+	{ "9007199254740993", 1, 0 },
+	{ "1e22", 1, 0 },
+	{ "1e23", 1, 0 },
+	{ "1e-22", 1, 0 },
+	{ "1e-23", 1, 0 },
+	{ "1.7976931348623157e308", 1, 0 },
+	{ "2.2250738585072014e-308", 1, 0 },
+	{ "4.9e-324", 1, 0 },
+	{ "1e-400", 1, 0 },
+	{ "1e400", 1, 0 },
+	{ "1e100000", 1, 0 },
+	{ "12345678901234567890123456789012", 1, 0 },
+	{ "0.000000000000000000000000000001", 1, 0 },
+	{ "inf", 1, 0 },
+	{ "-Infinity", 1, 0 },
+	{ "NaN", 1, 0 },
+	{ "+nan", 1, 0 },
+	{ "", 0, 0 },
+	{ "+", 0, 0 },
+	{ "-", 0, 0 },
+	{ ".", 0, 0 },
+	{ "-.", 0, 0 },
+	{ "e5", 0, 0 },
+	{ "1e", 0, 0 },
+	{ "1e+", 0, 0 },
+	{ "1.2.3", 0, 0 },
+	{ "1,5", 0, 0 },
+	{ " 1", 0, 0 },
+	{ "\t1", 0, 0 },
+	{ "1 ", 0, 0 },
+	{ "0x10", 0, 0 },
+	{ "--1", 0, 0 },
+	{ "1e5x", 0, 0 },
+	{ "nan(1)", 0, 0 },
+	{ "infx", 0, 0 },
+	{ "in", 0, 0 },
+	{ "1inf", 0, 0 },
+	{ NULL, 0, 0 }
+};
+
+static const struct convcheck conv_timestamp[] = {
+	{ "1970-01-01", 1, 0 },
+	{ "1970-01-01 00:00:01", 1, 1000000 },
+	{ "1969-12-31 23:59:59.999999", 1, -1 },
+	{ "1900-03-01", 1, -2203891200000000LL },
+	{ "2038-01-19 03:14:08", 1, 2147483648000000LL },
+	{ "2000-02-29 12:00:00", 1, 951825600000000LL },
+	{ "2000-02-29T12:00:00Z", 1, 951825600000000LL },
+	{ "2000-02-29 12:00:00.5+02:00", 1, 951818400500000LL },
+	{ "2000-02-29 12:00:00-0130", 1, 951831000000000LL },
+	{ "2000-02-29 12:00:00.1234567+05", 1, 951807600123456LL },
+	{ "", 0, 0 },
+	{ "2000-13-01", 0, 0 },
+	{ "2000-02-29 24:60:00", 0, 0 },
+	{ "2000-02-29 12:00", 0, 0 },
+	{ "2000-02-29 12:00:00 ", 0, 0 },
+	{ "2000-02-29 12:00:00+5", 0, 0 },
+	{ "2000-02-29 12:00:00+05:3", 0, 0 },
+	{ "20000-01-01", 0, 0 },
+	{ NULL, 0, 0 }
+};
+
+
+
+/*
+ *  Compares doubles including the sign of zero and NaN
+ */
+
+int conv_same( double a, double b )
+{
+	if( isnan( a ) || isnan( b ) ) { return isnan( a ) && isnan( b ); }
+
+	return a == b && signbit( a ) == signbit( b );
+}
+
+
+
+int conv_test( odbx_t* handle[], int verbose )
+{
+	int i, n, err;
+	size_t len;
+	double real;
+	int64_t num;
+	uint64_t val;
+	char str[40], query[1024];
+	odbx_result_t* result;
+	const char* input = NULL;
+	const char* msg = NULL;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_conv_int64()\n" ); }
+
+	// Test case:  Limits, signs, white space and invalid characters
+	for( i = 0; msg == NULL && conv_int[i].str != NULL; i++ )
+	{
+		err = odbx_conv_int64( conv_int[i].str, strlen( conv_int[i].str ), &num );
+
+		if( err != ( conv_int[i].valid ? ODBX_ERR_SUCCESS : -ODBX_ERR_PARAM ) || ( conv_int[i].valid && num != conv_int[i].value ) )
+		{
+			msg = "Wrong result of odbx_conv_int64()";
+			input = conv_int[i].str;
+		}
+	}
+
+	// Test case:  Numbers of 1 to 32 digits crossing the boundaries of the eight byte blocks with and without sign
+	for( n = 1; msg == NULL && n <= 32; n++ )
+	{
+		str[0] = '-';
+		val = 0;
+
+		for( i = 1; i <= n; i++ )
+		{
+			str[i] = (char) ( '1' + ( i - 1 ) % 9 );
+			val = val * 10 + ( str[i] - '0' );   // only compared for up to 19 digits
+		}
+
+		if( odbx_conv_int64( str + 1, n, &num ) != ( n <= 19 ? ODBX_ERR_SUCCESS : -ODBX_ERR_PARAM ) || ( n <= 19 && num != (int64_t) val ) ||
+			odbx_conv_int64( str, n + 1, &num ) != ( n <= 19 ? ODBX_ERR_SUCCESS : -ODBX_ERR_PARAM ) || ( n <= 19 && num != -(int64_t) val ) )
+		{
+			msg = "Wrong result of odbx_conv_int64() for long number";
+		}
+
+		// Test case:  Characters next to the digits are rejected at every position
+		for( i = 1; msg == NULL && i <= n && n <= 19; i++ )
+		{
+			char c = str[i];
+
+			str[i] = ( i & 1 ) ? '/' : ':';
+			if( odbx_conv_int64( str + 1, n, &num ) != -ODBX_ERR_PARAM ) { msg = "Invalid character accepted by odbx_conv_int64()"; }
+			str[i] = c;
+		}
+
+		if( msg != NULL ) { str[n+1] = '\0'; input = str; }
+	}
+
+	if( verbose ) { fprintf( stdout, "  odbx_conv_double()\n" ); }
+
+	// Test case:  Exponents, values requiring strtod(), infinity, NaN and invalid input
+	for( i = 0; msg == NULL && conv_double[i].str != NULL; i++ )
+	{
+		err = odbx_conv_double( conv_double[i].str, strlen( conv_double[i].str ), &real );
+
+		if( err != ( conv_double[i].valid ? ODBX_ERR_SUCCESS : -ODBX_ERR_PARAM ) ||
+			( conv_double[i].valid && !conv_same( real, strtod( conv_double[i].str, NULL ) ) ) )
+		{
+			msg = "Wrong result of odbx_conv_double()";
+			input = conv_double[i].str;
+		}
+	}
+
+	// Test case:  Numbers of 1 to 32 characters with and without decimal point
+	for( n = 1; msg == NULL && n <= 32; n++ )
+	{
+		for( i = 0; i < n; i++ ) { str[i] = (char) ( '1' + i % 9 ); }
+		str[n] = '\0';
+
+		if( odbx_conv_double( str, n, &real ) != ODBX_ERR_SUCCESS || !conv_same( real, strtod( str, NULL ) ) )
+		{
+			msg = "Wrong result of odbx_conv_double() for long number";
+			input = str;
+		}
+
+		str[n/2] = '.';
+
+		if( msg == NULL && n > 1 && ( odbx_conv_double( str, n, &real ) != ODBX_ERR_SUCCESS || !conv_same( real, strtod( str, NULL ) ) ) )
+		{
+			msg = "Wrong result of odbx_conv_double() for long number";
+			input = str;
+		}
+	}
+
+	if( verbose ) { fprintf( stdout, "  odbx_field_timestamp()\n" ); }
+
+	// Test case:  Dates and timestamps with fractions and time zones returned by the backend
+	if( msg == NULL )
+	{
+		len = (size_t) snprintf( query, sizeof( query ), "SELECT" );
+
+		for( i = 0; conv_timestamp[i].str != NULL && len < sizeof( query ); i++ )
+		{
+			len += (size_t) snprintf( query + len, sizeof( query ) - len, "%s '%s'", i > 0 ? "," : "", conv_timestamp[i].str );
+		}
+
+		if( odbx_query( handle[0], query, 0 ) < 0 || odbx_result( handle[0], &result, NULL, 0 ) != ODBX_RES_ROWS ) { msg = "Selecting timestamps failed"; }
+		else
+		{
+			if( odbx_row_fetch( result ) != ODBX_ROW_NEXT ) { msg = "Selecting timestamps failed"; }
+
+			for( i = 0; msg == NULL && conv_timestamp[i].str != NULL; i++ )
+			{
+				err = odbx_field_timestamp( result, i, &num );
+
+				if( err != ( conv_timestamp[i].valid ? ODBX_ERR_SUCCESS : -ODBX_ERR_PARAM ) || ( conv_timestamp[i].valid && num != conv_timestamp[i].value ) )
+				{
+					msg = "Wrong result of odbx_field_timestamp()";
+					input = conv_timestamp[i].str;
+				}
+			}
+
+			odbx_result_finish( result );
+		}
+
+		while( odbx_result( handle[0], &result, NULL, 0 ) > 0 ) { odbx_result_finish( result ); }
+	}
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in conv_test(): %s for \"%s\"\n", msg, input != NULL ? input : "" );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Rows of the "odbxarrow" table and the state of the columnar export
+ */
+
+struct arrowrow
+{
+	int isnull;   // bit n is set if column n is NULL
+	int64_t num;
+	double real;
+	const char* str;
+	const char* ts;
+};
+
+static const struct arrowrow arrow_rows[] = {
+	{ 0, 1, 0.5, "a", "2000-02-29 12:00:00" },
+	{ 15, 0, 0, NULL, NULL },
+	{ 0, -1234567890123456LL, -2.25, "bc", "1970-01-01 00:00:00" },
+	{ 8, INT64_MAX, 1e300, "it's", NULL },
+	{ 0, INT64_MIN, 0, "last", "1969-12-31 23:59:59.999999" },
+};
+
+#define ARROWROWS 5
+
+struct arrowcheck
+{
+	int batches;
+	unsigned long rows;
+	const char* msg;
+};
+
+
+
+int arrow_test( odbx_t* handle[], int verbose )
+{
+	int err;
+	char value[32];
+	odbx_result_t* result;
+	struct arrowcheck check = { 0, 0, NULL };
+	const char* msg = NULL;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_result_to_columnar()\n" ); }
+
+	if( ( err = fetch( handle[0], "CREATE TABLE \"odbxarrow\" ( \"id\" INTEGER, \"num\" INTEGER, \"real\" DOUBLE, \"str\" VARCHAR(20), \"ts\" TIMESTAMP )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxarrow\" VALUES ( 1, 1, 0.5, 'a', '2000-02-29 12:00:00' )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxarrow\" VALUES ( 2, NULL, NULL, NULL, NULL )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxarrow\" VALUES ( 3, -1234567890123456, -2.25, 'bc', '1970-01-01 00:00:00' )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxarrow\" VALUES ( 4, 9223372036854775807, 1e300, 'it''s', NULL )", value, sizeof( value ) ) ) < 0 ||
+		( err = fetch( handle[0], "INSERT INTO \"odbxarrow\" VALUES ( 5, -9223372036854775807 - 1, 0, 'last', '1969-12-31 23:59:59.999999' )", value, sizeof( value ) ) ) < 0 )
+	{
+		fprintf( stderr, "Error in arrow_test(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	// Test case:  Rows are exported in batches of two with NULL values, strings and numbers of up to 20 characters
+	if( ( err = odbx_query( handle[0], "SELECT \"num\", \"real\", \"str\", \"ts\" FROM \"odbxarrow\" ORDER BY \"id\"", 0 ) ) < 0 ||
+		( err = odbx_result( handle[0], &result, NULL, 0 ) ) != ODBX_RES_ROWS )
+	{
+		msg = "Selecting rows failed";
+	}
+	else
+	{
+		if( ( err = odbx_result_to_columnar( result, 2, arrow_callback, &check ) ) < 0 ) { msg = check.msg != NULL ? check.msg : "Exporting rows failed"; }
+		else if( check.batches != 3 || check.rows != ARROWROWS ) { msg = "Wrong number of batches or rows"; }
+
+		odbx_result_finish( result );
+	}
+
+	while( odbx_result( handle[0], &result, NULL, 0 ) > 0 ) { odbx_result_finish( result ); }
+
+	fetch( handle[0], "DROP TABLE \"odbxarrow\"", value, sizeof( value ) );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in arrow_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Compares one column of a batch with the expected rows. SQLite returns
+ *  timestamps as text, so they are exported as strings.
+ */
+
+int arrow_column( const struct ArrowSchema* field, const struct ArrowArray* array, unsigned long first, int col )
+{
+	int64_t i, nulls = 0;
+	const struct arrowrow* row;
+	const unsigned char* valid = (const unsigned char*) array->buffers[0];
+	const int32_t* offsets = (const int32_t*) array->buffers[1];
+	const char* str;
+
+
+	if( strcmp( field->format, col == 0 ? "l" : ( col == 1 ? "g" : "u" ) ) != 0 ) { return -1; }
+	if( array->n_buffers != ( col < 2 ? 2 : 3 ) || array->offset != 0 ) { return -1; }
+	if( col >= 2 && offsets[0] != 0 ) { return -1; }
+
+	for( i = 0; i < array->length; i++ )
+	{
+		row = arrow_rows + first + i;
+
+		if( row->isnull & ( 1 << col ) )
+		{
+			if( valid == NULL || ( valid[i >> 3] >> ( i & 7 ) ) & 1 ) { return -1; }
+			if( col >= 2 && offsets[i+1] != offsets[i] ) { return -1; }
+
+			nulls++;
+			continue;
+		}
+
+		if( valid != NULL && ( ( valid[i >> 3] >> ( i & 7 ) ) & 1 ) == 0 ) { return -1; }
+
+		switch( col )
+		{
+			case 0:
+				if( ((const int64_t*) array->buffers[1])[i] != row->num ) { return -1; }
+				break;
+			case 1:
+				if( ((const double*) array->buffers[1])[i] != row->real ) { return -1; }
+				break;
+			default:
+				str = col == 2 ? row->str : row->ts;
+				if( offsets[i+1] - offsets[i] != (int32_t) strlen( str ) ||
+					memcmp( (const char*) array->buffers[2] + offsets[i], str, strlen( str ) ) != 0 )
+				{
+					return -1;
+				}
+		}
+	}
+
+	return nulls == array->null_count ? 0 : -1;
+}
+
+
+
+int arrow_callback( struct ArrowSchema* schema, struct ArrowArray* batch, void* arg )
+{
+	int i;
+	struct arrowcheck* check = (struct arrowcheck*) arg;
+	const char* names[] = { "num", "real", "str", "ts" };
+
+
+	if( schema->n_children != 4 || batch->n_children != 4 || strcmp( schema->format, "+s" ) != 0 ||
+		batch->length != ( check->rows + 2 <= ARROWROWS ? 2 : ARROWROWS - check->rows ) )
+	{
+		check->msg = "Wrong schema or batch size";
+	}
+
+	for( i = 0; check->msg == NULL && i < 4; i++ )
+	{
+		if( strcmp( schema->children[i]->name, names[i] ) != 0 || batch->children[i]->length != batch->length ||
+			arrow_column( schema->children[i], batch->children[i], check->rows, i ) < 0 )
+		{
+			check->msg = "Wrong values, offsets or validity bitmap";
+		}
+	}
+
+	check->batches++;
+	check->rows += (unsigned long) batch->length;
+
+	schema->release( schema );
+	batch->release( batch );
+
+	return check->msg != NULL ? -ODBX_ERR_PARAM : ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Difference of the counters in two statistics, histograms are summed up
+ */
+
+void stats_delta( const struct odbx_stats* before, const struct odbx_stats* after, uint64_t delta[8] )
+{
+	int i;
+
+
+	delta[0] = after->queries - before->queries;
+	delta[1] = after->results - before->results;
+	delta[2] = after->rows - before->rows;
+	delta[3] = after->bytes - before->bytes;
+	delta[4] = after->lo_read + after->lo_written - before->lo_read - before->lo_written;
+	delta[5] = after->reconnects - before->reconnects;
+	delta[6] = delta[7] = 0;
+
+	for( i = 0; i < ODBX_STATS_BUCKETS; i++ )
+	{
+		delta[6] += after->first_result[i] - before->first_result[i];
+		delta[7] += after->drain[i] - before->drain[i];
+	}
+}
+
+
+
+int stats_test( odbx_t* handle[], int verbose )
+{
+	int i, err;
+	char value[32];
+	unsigned long pos;
+	odbx_result_t* result;
+	struct odbx_stats before, after, gbefore, gafter;
+	uint64_t delta[8], gdelta[8];
+	// queries, results, rows, bytes, large objects, reconnects, first results, drained results
+	const uint64_t expect[8] = { 3, 3, 3, 9, 0, 0, 3, 3 };
+	const char* queries[] = {
+		"SELECT 1, 'abc' UNION ALL SELECT 22, 'de'",
+		"SELECT 'x'",
+		"CREATE TEMPORARY TABLE \"odbxstats\" ( \"id\" INTEGER )",
+	};
+	const char* msg = NULL;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_stats()\n" ); }
+
+	if( odbx_stats( handle[0], NULL ) != -ODBX_ERR_PARAM )
+	{
+		fprintf( stderr, "Error in stats_test(): %s\n", "Missing statistics buffer accepted" );
+		return -ODBX_ERR_PARAM;
+	}
+
+	if( ( err = odbx_stats( handle[0], &before ) ) < 0 || ( err = odbx_stats( NULL, &gbefore ) ) < 0 )
+	{
+		fprintf( stderr, "Error in stats_test(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	// Test case:  Three statements returning three rows with nine bytes and a result set without rows
+	for( i = 0; i < 3 && msg == NULL; i++ )
+	{
+		if( ( err = odbx_query( handle[0], queries[i], 0 ) ) < 0 )
+		{
+			msg = "Sending query failed";
+			break;
+		}
+
+		while( ( err = odbx_result( handle[0], &result, NULL, 0 ) ) != ODBX_RES_DONE )
+		{
+			if( err < 0 ) { msg = "Getting result failed"; break; }
+
+			while( odbx_row_fetch( result ) == ODBX_ROW_NEXT )
+			{
+				for( pos = 0; pos < odbx_column_count( result ); pos++ ) { odbx_field_length( result, pos ); }
+			}
+
+			odbx_result_finish( result );
+		}
+	}
+
+	if( msg == NULL && ( ( err = odbx_stats( handle[0], &after ) ) < 0 || ( err = odbx_stats( NULL, &gafter ) ) < 0 ) )
+	{
+		msg = "Getting statistics failed";
+	}
+
+	if( msg == NULL )
+	{
+		stats_delta( &before, &after, delta );
+		stats_delta( &gbefore, &gafter, gdelta );
+
+		if( memcmp( delta, expect, sizeof( delta ) ) != 0 ) { msg = "Wrong counters of the connection"; }
+		else if( memcmp( gdelta, expect, sizeof( gdelta ) ) != 0 ) { msg = "Wrong counters of the process"; }
+		else if( after.result_wait < before.result_wait ) { msg = "Wrong time spent waiting for results"; }
+	}
+
+	fetch( handle[0], "DROP TABLE \"odbxstats\"", value, sizeof( value ) );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in stats_test(): %s\n", msg );
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  Runs the statements of the replay test and writes the status codes,
+ *  error messages, column names and types and all values to a transcript
+ */
+
+static const char* replay_stmts[] = {
+	"CREATE TEMPORARY TABLE \"odbxreplay\" ( \"id\" INTEGER, \"str\" VARCHAR(10), \"num\" DOUBLE )",
+	"INSERT INTO \"odbxreplay\" VALUES ( 1, 'one', 0.5 ); INSERT INTO \"odbxreplay\" VALUES ( 2, NULL, NULL )",
+	"SELECT \"id\", \"str\", \"num\" FROM \"odbxreplay\" ORDER BY \"id\"; SELECT COUNT(*) AS \"cnt\" FROM \"odbxreplay\"",
+	"SELECT * FROM \"odbxmissing\"",
+	"SELECT 'after' AS \"last\"",
+	NULL
+};
+
+
+
+int replay_run( odbx_t* handle, char* out, size_t size )
+{
+	int i, err;
+	size_t len = 0;
+	unsigned long pos;
+	odbx_result_t* result;
+
+
+	out[0] = '\0';
+
+	for( i = 0; replay_stmts[i] != NULL; i++ )
+	{
+		if( ( err = odbx_query( handle, replay_stmts[i], 0 ) ) < 0 )
+		{
+			len += snprintf( out + len, size - len, "query %d: %s\n", err, odbx_error( handle, err ) );
+			if( len >= size ) { return -ODBX_ERR_SIZE; }
+			continue;
+		}
+
+		while( ( err = odbx_result( handle, &result, NULL, 0 ) ) != ODBX_RES_DONE )
+		{
+			if( err < 0 )
+			{
+				len += snprintf( out + len, size - len, "result %d (%d): %s\n", err, odbx_error_type( handle, err ), odbx_error( handle, err ) );
+				if( len >= size ) { return -ODBX_ERR_SIZE; }
+				if( odbx_error_type( handle, err ) < 0 ) { return err; }
+				continue;
+			}
+
+			len += snprintf( out + len, size - len, "result %d, %lu columns, %llu affected:", err, odbx_column_count( result ), (unsigned long long) odbx_rows_affected( result ) );
+
+			for( pos = 0; pos < odbx_column_count( result ) && len < size; pos++ )
+			{
+				len += snprintf( out + len, size - len, " %s(%d)", odbx_column_name( result, pos ), odbx_column_type( result, pos ) );
+			}
+
+			while( len < size && ( err = odbx_row_fetch( result ) ) == ODBX_ROW_NEXT )
+			{
+				len += snprintf( out + len, size - len, "\n " );
+
+				for( pos = 0; pos < odbx_column_count( result ) && len < size; pos++ )
+				{
+					if( odbx_field_value( result, pos ) == NULL ) { len += snprintf( out + len, size - len, " NULL" ); }
+					else { len += snprintf( out + len, size - len, " '%s'(%lu)", odbx_field_value( result, pos ), odbx_field_length( result, pos ) ); }
+				}
+			}
+
+			odbx_result_finish( result );
+
+			if( len < size ) { len += snprintf( out + len, size - len, "\n" ); }
+			if( len >= size ) { return -ODBX_ERR_SIZE; }
+		}
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
+
+
+
+/*
+ *  The replay backend is expected next to the SQLite one, e.g. in
+ *  "../backends/replay/" instead of "../backends/sqlite3/". The test is
+ *  skipped if it wasn't built.
+ */
+
+int replay_test( odbx_t* handle[], const char* backend, const char* host, int verbose )
+{
+	int err;
+	size_t i, len;
+	odbx_t* replay;
+	char path[1024], file[1024], recorded[2048], replayed[2048];
+	const char* msg = NULL;
+
+
+	if( verbose ) { fprintf( stdout, "  odbx_record()\n" ); }
+
+	for( i = len = 0; backend[i] != '\0' && len < sizeof( path ) - 7; )
+	{
+		if( strncmp( backend + i, "sqlite3", 7 ) == 0 )
+		{
+			memcpy( path + len, "replay", 6 );
+			len += 6; i += 7;
+		}
+		else { path[len++] = backend[i++]; }
+	}
+	path[len] = '\0';
+
+	snprintf( file, sizeof( file ), "%sodbxreplay.rec", host != NULL ? host : "" );
+
+	// Test case:  Result sets, column names and types, values and errors of a recorded script are replayed unchanged
+	if( ( err = odbx_record( handle[0], file ) ) < 0 )
+	{
+		fprintf( stderr, "Error in replay_test(): %s\n", odbx_error( handle[0], err ) );
+		return err;
+	}
+
+	err = replay_run( handle[0], recorded, sizeof( recorded ) );
+
+	if( odbx_record( handle[0], NULL ) < 0 ) { msg = "Recording is incomplete"; }
+	else if( err < 0 ) { msg = "Running the script on the database failed"; }
+	else if( odbx_init( &replay, path, host, "0" ) < 0 )
+	{
+		fprintf( stderr, "Skipping replay_test(): Backend %s not available\n", path );   // not built
+	}
+	else
+	{
+		if( odbx_bind( replay, "odbxreplay.rec", NULL, NULL, ODBX_BIND_SIMPLE ) < 0 ) { msg = "Loading the recording failed"; }
+		else
+		{
+			if( replay_run( replay, replayed, sizeof( replayed ) ) < 0 ) { msg = "Replaying the script failed"; }
+			else if( strcmp( recorded, replayed ) != 0 ) { msg = "Replayed results differ from the recorded ones"; }
+			else if( strstr( recorded, "result 3, 3 columns" ) == NULL || strstr( recorded, "'after'" ) == NULL ||
+				strstr( recorded, "odbxmissing" ) == NULL )
+			{
+				msg = "Recorded results are incomplete";
+			}
+
+			odbx_unbind( replay );
+		}
+
+		odbx_finish( replay );
+	}
+
+	remove( file );
+
+	if( msg != NULL )
+	{
+		fprintf( stderr, "Error in replay_test(): %s\n", msg );
+		if( verbose ) { fprintf( stderr, "Recorded:\n%s\nReplayed:\n%s\n", recorded, replayed ); }
+		return -ODBX_ERR_PARAM;
+	}
+
+	return ODBX_ERR_SUCCESS;
+}
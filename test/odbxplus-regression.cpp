@@ -12,7 +12,12 @@
 #include <vector>
 #include <iostream>
 #include <cstdlib>
+#include <cmath>
+#include <future>
+#include <chrono>
 #include <opendbx/api>
+#include <opendbx/async>
+#include <opendbx/coroutine>
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -35,11 +40,38 @@ using OpenDBX::Conn;
 using OpenDBX::Stmt;
 using OpenDBX::Result;
 using OpenDBX::Lob;
+using OpenDBX::Rows;
+using OpenDBX::ResultSet;
+using OpenDBX::RowView;
+using OpenDBX::MaterializedResult;
 
 
 
 void exec( vector<Conn>& conn, struct odbxstmt* qptr, int verbose );
 void lob_read( Result& result, int pos );
+void bind_test( Conn& conn, int verbose );
+void prepare_test( Conn& conn, int verbose );
+void trace_test( Conn& conn, int verbose );
+void async_test( const string& backend, const string& host, const string& port, const string& db, const string& user, const string& pass, int verbose );
+void fetch( Result result );
+
+#if defined( __cpp_impl_coroutine ) && __cplusplus >= 202002L
+
+struct CoTask
+{
+	struct promise_type
+	{
+		CoTask get_return_object() noexcept { return CoTask(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept { std::terminate(); }
+	};
+};
+
+CoTask coroutine_query( OpenDBX::AsyncConn& conn, int& count, std::exception_ptr& error );
+
+#endif
 
 
 
@@ -183,6 +215,11 @@ int main( int argc, char* argv[] )
 				exec( conn, queries, verbose );
 			}
 
+			bind_test( conn[0], verbose );
+			prepare_test( conn[0], verbose );
+			trace_test( conn[0], verbose );
+			async_test( backend, host, port, db, user, pass, verbose );
+
 			for( k = 0; k < 2; k++ )
 			{
 				if( verbose ) { cout << "  Conn::unbind()" << endl; }
@@ -217,7 +254,7 @@ int main( int argc, char* argv[] )
 void exec( vector<Conn>& conn, struct odbxstmt* qptr, int verbose )
 {
 	odbxres stat;
-	unsigned long fields, i;
+	unsigned long fields, i, len;
 	struct timeval tv;
 
 
@@ -278,6 +315,12 @@ void exec( vector<Conn>& conn, struct odbxstmt* qptr, int verbose )
 
 							default:
 
+								// Test case:  Value and length at once must match separate calls
+								if( result.fieldValue( i, len ) != result.fieldValue( i ) || ( len != result.fieldLength( i ) && result.fieldValue( i ) != NULL ) )
+								{
+									throw std::runtime_error( string( "fieldValue() with length differs from fieldValue() and fieldLength()" ) );
+								}
+
 								if( result.fieldValue( i ) == NULL ) { cout << "NULL" << endl; }
 								else { cout << "'" << string( result.fieldValue( i ) ) << "'" << endl; }
 						}
@@ -337,3 +380,356 @@ void lob_read( Result& result, int pos )
 
 	lob.close();
 }
+
+
+
+void bind_test( Conn& conn, int verbose )
+{
+	int i;
+	const char* value = "it's";
+
+
+	if( verbose ) { cout << "  Stmt::bind()" << endl; }
+
+	Stmt stmt = conn.create( "SELECT '?', \"?\" FROM \"odbxtest\" WHERE \"str20\" = ? AND \"i32\" = ?" );
+
+	// Test case:  Placeholders in quoted strings and identifiers aren't counted
+	if( stmt.count() != 2 ) {
+		throw std::runtime_error( string( "Stmt::count() doesn't return the number of placeholders" ) );
+	}
+
+	// Test case:  Binding to a non-existing placeholder must fail
+	try {
+		stmt.bind( value, 4, 2 );
+		throw std::runtime_error( string( "No exception thrown using bind() for non-existing placeholder" ) );
+	} catch( OpenDBX::Exception& oe ) {
+		if( oe.getCode() != -ODBX_ERR_PARAM ) { throw oe; }
+	}
+
+	// Test case:  NaN and infinity have no SQL representation and must be rejected
+	try {
+		stmt.bind( 1, std::nan( "" ) );
+		throw std::runtime_error( string( "No exception thrown using bind() for NaN" ) );
+	} catch( OpenDBX::Exception& oe ) {
+		if( oe.getCode() != -ODBX_ERR_PARAM ) { throw oe; }
+	}
+
+	// Test case:  Executing a statement with only some values bound must fail
+	stmt.bind( value, 4, 0 );
+
+	try {
+		stmt.execute();
+		throw std::runtime_error( string( "No exception thrown by execute() for unbound placeholders" ) );
+	} catch( OpenDBX::Exception& oe ) {
+		if( oe.getCode() != -ODBX_ERR_PARAM ) { throw oe; }
+	}
+
+	// Test case:  Placeholders in comments and backtick identifiers aren't counted
+	stmt = conn.create( "SELECT `?` /* don't use ? */ FROM \"odbxtest\" WHERE \"str20\" = ? -- it's ?\n AND \"i32\" = ?" );
+
+	if( stmt.count() != 2 ) {
+		throw std::runtime_error( string( "Stmt::count() counts placeholders in comments" ) );
+	}
+
+	fetch( conn.create( "CREATE TABLE \"odbxbind\" ( \"i32\" INTEGER, \"str20\" VARCHAR(20) )" ).execute() );
+
+	// Test case:  Bound values are escaped and the statement buffer grows for longer values
+	stmt = conn.create( "INSERT INTO \"odbxbind\" /* don't use ? */ VALUES ( ?, ? ) -- it's ?" );
+
+	for( i = 0; i < 2; i++ )
+	{
+		stmt.bind( 0, (int64_t) i );
+		stmt.bind( 1, string( i == 0 ? "it's" : "it's a longer one" ) );
+		fetch( stmt.execute() );
+	}
+
+	stmt = conn.create( "SELECT \"str20\" FROM \"odbxbind\" WHERE \"i32\" = ? -- it's ?" );
+
+	for( i = 0; i < 2; i++ )
+	{
+		stmt.bind( 0, (int64_t) i );
+
+		Result result = stmt.execute();
+
+		if( result.getResult() != ODBX_RES_ROWS || result.getRow() != ODBX_ROW_NEXT || result.fieldValue( 0 ) == NULL ||
+			string( result.fieldValue( 0 ) ) != ( i == 0 ? "it's" : "it's a longer one" ) )
+		{
+			throw std::runtime_error( string( "Simple statement returned wrong value" ) );
+		}
+
+		fetch( result );
+	}
+
+	fetch( conn.create( "DROP TABLE \"odbxbind\"" ).execute() );
+}
+
+
+
+void prepare_test( Conn& conn, int verbose )
+{
+	int i;
+
+
+	if( verbose ) { cout << "  Stmt::Prepared" << endl; }
+
+	fetch( conn.create( "CREATE TABLE \"odbxprep\" ( \"i32\" INTEGER, \"str20\" VARCHAR(20) )" ).execute() );
+
+	Stmt stmt = conn.create( "INSERT INTO \"odbxprep\" VALUES ( ?, ? )", Stmt::Prepared );
+
+	if( stmt.count() != 2 ) {
+		throw std::runtime_error( string( "Stmt::count() doesn't return the number of placeholders" ) );
+	}
+
+	// Test case:  Binding to a non-existing placeholder must fail
+	try {
+		stmt.bindNull( 2 );
+		throw std::runtime_error( string( "No exception thrown using bind() for non-existing placeholder" ) );
+	} catch( OpenDBX::Exception& oe ) {
+		if( oe.getCode() != -ODBX_ERR_PARAM ) { throw oe; }
+	}
+
+	// Test case:  The statement can be executed several times with different values
+	for( i = 0; i < 3; i++ )
+	{
+		stmt.bind( 0, i );
+		if( i == 1 ) { stmt.bindNull( 1 ); }
+		else { stmt.bind( 1, string( "it's" ) ); }
+
+		fetch( stmt.execute() );
+	}
+
+	stmt = conn.create( "SELECT \"str20\" FROM \"odbxprep\" WHERE \"i32\" = ?", Stmt::Prepared );
+
+	for( i = 0; i < 2; i++ )
+	{
+		stmt.bind( 0, (int64_t) i );
+
+		Result result = stmt.execute();
+
+		if( result.getResult() != ODBX_RES_ROWS || result.getRow() != ODBX_ROW_NEXT ||
+			( i == 0 && ( result.fieldValue( 0 ) == NULL || string( result.fieldValue( 0 ) ) != "it's" ) ) ||
+			( i == 1 && result.fieldValue( 0 ) != NULL ) )
+		{
+			throw std::runtime_error( string( "Prepared statement returned wrong value" ) );
+		}
+
+		fetch( result );
+	}
+
+	// Test case:  Column metadata is available before the first row is fetched, even if there's none
+	{
+		Result result = conn.create( "SELECT \"i32\", \"str20\" FROM \"odbxprep\" WHERE 1 = 0" ).execute();
+
+		if( result.getResult() != ODBX_RES_ROWS || result.columnCount() != 2 || result.columnName( 1 ) != "str20" ) {
+			throw std::runtime_error( string( "Result::columnName() failed before first row" ) );
+		}
+
+		result.columnType( 0 );
+		result.columnType( 1 );
+		fetch( result );
+	}
+
+	if( verbose ) { cout << "  Result::rows()" << endl; }
+
+	// Test case:  Rows are decoded into the requested types
+	i = 0;
+	Rows<int, string> rows = conn.create( "SELECT \"i32\", \"str20\" FROM \"odbxprep\" ORDER BY \"i32\"" ).execute().rows<int, string>();
+
+	for( Rows<int, string>::iterator it = rows.begin(); it != rows.end(); ++it, i++ )
+	{
+		if( std::get<0>( *it ) != i || std::get<1>( *it ) != ( i == 1 ? "" : "it's" ) ) {
+			throw std::runtime_error( string( "Result::rows() returned wrong value" ) );
+		}
+	}
+
+	if( i != 3 ) {
+		throw std::runtime_error( string( "Result::rows() returned wrong number of rows" ) );
+	}
+
+	// Test case:  Text columns can't be decoded as numbers
+	try {
+		conn.create( "SELECT \"str20\", \"i32\" FROM \"odbxprep\"" ).execute().rows<int, string>().begin();
+		throw std::runtime_error( string( "No exception thrown by Result::rows() for wrong column type" ) );
+	} catch( OpenDBX::Exception& oe ) {
+		if( oe.getCode() != -ODBX_ERR_PARAM ) { throw oe; }
+	}
+
+	if( verbose ) { cout << "  Result::sets()" << endl; }
+
+	// Test case:  Rows are returned across several batches
+	i = 0;
+	Result result = conn.create( "SELECT \"i32\", \"str20\" FROM \"odbxprep\" ORDER BY \"i32\"" ).execute();
+
+	for( ResultSet& set : result.sets( 2 ) )
+	{
+		for( const RowView& row : set )
+		{
+			if( row.size() != 2 || row.get<int>( 0 ) != i || row.isNull( 1 ) != ( i == 1 ) ) {
+				throw std::runtime_error( string( "Result::sets() returned wrong value" ) );
+			}
+			i++;
+		}
+	}
+
+	if( i != 3 ) {
+		throw std::runtime_error( string( "Result::sets() returned wrong number of rows" ) );
+	}
+
+	if( verbose ) { cout << "  Result::materialize()" << endl; }
+
+	// Test case:  Copied rows are independent of the connection
+	MaterializedResult copy = conn.create( "SELECT \"i32\", \"str20\" FROM \"odbxprep\" ORDER BY \"i32\"" ).execute().materialize();
+
+	if( copy.size() != 1 || copy[0].rowCount() != 3 || copy[0].columnCount() != 2 ||
+		copy[0].row( 2 ).get<int>( 0 ) != 2 || !copy[0].row( 1 ).isNull( 1 ) )
+	{
+		throw std::runtime_error( string( "Result::materialize() returned wrong values" ) );
+	}
+
+#if defined( __cpp_impl_coroutine ) && __cplusplus >= 202002L
+	if( verbose ) { cout << "  AsyncConn::query()" << endl; }
+
+	// Test case:  Rows are returned to a coroutine resumed by the reactor
+	{
+		i = 0;
+		std::exception_ptr error;
+		OpenDBX::EpollReactor reactor;
+		OpenDBX::AsyncConn async( conn, reactor );
+
+		coroutine_query( async, i, error );
+		reactor.run();
+
+		if( error ) { std::rethrow_exception( error ); }
+
+		if( i != 3 ) {
+			throw std::runtime_error( string( "AsyncConn::query() returned wrong number of rows" ) );
+		}
+	}
+#endif
+
+	fetch( conn.create( "DROP TABLE \"odbxprep\"" ).execute() );
+}
+
+
+
+class CountTrace : public Conn::Trace
+{
+public:
+
+	int queries;
+
+	CountTrace( Conn& conn ) : Conn::Trace( conn ), queries( 0 ) {}
+
+	void query( const struct odbx_trace& ) noexcept { queries++; }
+};
+
+
+
+void trace_test( Conn& conn, int verbose )
+{
+	if( verbose ) { cout << "  Conn::Trace" << endl; }
+
+	CountTrace* first = new CountTrace( conn );
+	CountTrace second( conn );
+
+	// Test case:  Destroying a replaced trace object keeps the hooks of the current one
+	delete first;
+	fetch( conn.create( "CREATE TABLE \"odbxtrace\" ( \"i32\" INTEGER )" ).execute() );
+	fetch( conn.create( "DROP TABLE \"odbxtrace\"" ).execute() );
+
+	if( second.queries != 2 ) {
+		throw std::runtime_error( string( "Conn::Trace hooks removed by replaced trace object" ) );
+	}
+}
+
+
+
+void async_test( const string& backend, const string& host, const string& port, const string& db, const string& user, const string& pass, int verbose )
+{
+	if( verbose ) { cout << "  AsyncExecutor::Token::cancel()" << endl; }
+
+	std::promise<void> release;
+	std::shared_future<void> blocked = release.get_future().share();
+	OpenDBX::AsyncExecutor::Token token;
+
+	OpenDBX::AsyncExecutor executor( [=]() {
+		Conn conn( backend, host, port );
+		conn.bind( db, user, pass );
+		return conn;
+	}, 1, 2 );
+
+	// The callback keeps the only worker busy until it's released
+	executor.submit( "CREATE TABLE \"odbxasync\" ( \"i32\" INTEGER )", [blocked]( MaterializedResult&, std::exception_ptr ) { blocked.wait(); } );
+	std::future<MaterializedResult> waiting = executor.submit( "DROP TABLE \"odbxasync\"", OpenDBX::AsyncExecutor::NoAffinity, token );
+
+	// Test case:  Canceling answers waiting statements without waiting for a worker
+	token.cancel();
+	bool ready = waiting.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+	release.set_value();
+
+	if( !ready ) {
+		throw std::runtime_error( string( "AsyncExecutor::Token::cancel() didn't answer waiting statement" ) );
+	}
+
+	// Test case:  Statements submitted with a canceled token aren't executed
+	std::future<MaterializedResult> futures[] = {
+		std::move( waiting ),
+		executor.submit( "DROP TABLE \"odbxasync\"", OpenDBX::AsyncExecutor::NoAffinity, token )
+	};
+
+	for( int i = 0; i < 2; i++ )
+	{
+		try {
+			futures[i].get();
+			throw std::runtime_error( string( "Canceled statement was executed" ) );
+		} catch( OpenDBX::Exception& oe ) {
+			if( oe.getCode() != -ODBX_ERR_CANCELED ) { throw oe; }
+		}
+	}
+
+	executor.submit( "DROP TABLE \"odbxasync\"" ).get();
+}
+
+
+
+void fetch( Result result )
+{
+	while( result.getResult() != ODBX_RES_DONE )
+	{
+		while( result.getRow() != ODBX_ROW_DONE );
+	}
+}
+
+
+
+#if defined( __cpp_impl_coroutine ) && __cplusplus >= 202002L
+
+CoTask coroutine_query( OpenDBX::AsyncConn& conn, int& count, std::exception_ptr& error )
+{
+	try
+	{
+		unsigned long i, rows;
+		OpenDBX::AsyncResult result = co_await conn.query( "SELECT \"i32\", \"str20\" FROM \"odbxprep\" ORDER BY \"i32\"" );
+
+		while( result.status() != ODBX_RES_DONE )
+		{
+			while( ( rows = co_await result.nextBatch( 2 ) ) > 0 )
+			{
+				for( i = 0; i < rows; i++, count++ )
+				{
+					if( result.row( i ).get<int>( 0 ) != count || result.row( i ).isNull( 1 ) != ( count == 1 ) ) {
+						throw std::runtime_error( string( "AsyncResult::nextBatch() returned wrong value" ) );
+					}
+				}
+			}
+
+			co_await result.nextResult();
+		}
+	}
+	catch( ... )
+	{
+		error = std::current_exception();
+	}
+}
+
+#endif
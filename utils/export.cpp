@@ -0,0 +1,416 @@
+#include "export.hpp"
+#include <cstring>
+#include <unistd.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+#ifdef ENABLE_NLS
+#  ifdef HAVE_LIBINTL_H
+#    include <libintl.h>
+#  endif
+#else
+#  define gettext(string) string
+#endif
+
+
+
+using namespace OpenDBX;
+
+
+
+#define EXPORT_NULL 0xffffffff
+#define EXPORT_HEADER 0xfffffffe
+
+
+
+Export::Export( const string& format, const string& filename, bool compress, size_t bufsize ) : m_bufsize( bufsize ), m_file( stdout ), m_gz( NULL ),
+	m_names( true ), m_rows( 0 ), m_bytes( 0 )
+{
+	if( format == "csv" ) { m_format = Csv; }
+	else if( format == "tsv" ) { m_format = Tsv; }
+	else if( format == "jsonl" ) { m_format = Jsonl; }
+	else if( format == "binary" ) { m_format = Binary; }
+	else { throw ExportException( string( gettext( "Unknown export format: " ) ) + format ); }
+
+	if( !filename.empty() && filename != "-" && ( m_file = fopen( filename.c_str(), "wb" ) ) == NULL )
+	{
+		throw ExportException( string( gettext( "Unable to open file: " ) ) + filename );
+	}
+
+	if( compress )
+	{
+#ifdef HAVE_LIBZ
+		int fd = dup( fileno( m_file ) );
+
+		if( fd < 0 || ( m_gz = (void*) gzdopen( fd, "wb" ) ) == NULL )
+		{
+			if( fd >= 0 ) { ::close( fd ); }
+			if( m_file != stdout ) { fclose( m_file ); }
+			throw ExportException( gettext( "Unable to initialize compression" ) );
+		}
+#else
+		if( m_file != stdout ) { fclose( m_file ); }
+		throw ExportException( gettext( "Compression isn't supported, zlib wasn't available at compile time" ) );
+#endif
+	}
+
+	m_buffer.reserve( m_bufsize + 4096 );
+}
+
+
+
+Export::~Export()
+{
+	try
+	{
+		this->close();
+	}
+	catch( ExportException& e ) {}
+}
+
+
+
+void Export::close()
+{
+	if( m_file == NULL ) { return; }
+
+	this->flush();
+
+#ifdef HAVE_LIBZ
+	if( m_gz != NULL && gzclose( (gzFile) m_gz ) != Z_OK )
+	{
+		m_gz = NULL;
+		throw ExportException( gettext( "Writing compressed output failed" ) );
+	}
+	m_gz = NULL;
+#endif
+
+	FILE* file = m_file;
+	m_file = NULL;
+
+	if( ( file == stdout ? fflush( file ) : fclose( file ) ) != 0 )
+	{
+		throw ExportException( gettext( "Writing output failed" ) );
+	}
+}
+
+
+
+/*
+ *  Disables the line with the column names of CSV output, e.g. if several
+ *  files are concatenated
+ */
+
+void Export::columnNames( bool enable )
+{
+	m_names = enable;
+}
+
+
+
+void Export::flush()
+{
+	if( m_buffer.empty() ) { return; }
+
+	m_bytes += m_buffer.size();
+
+#ifdef HAVE_LIBZ
+	if( m_gz != NULL )
+	{
+		if( gzwrite( (gzFile) m_gz, m_buffer.data(), (unsigned) m_buffer.size() ) != (int) m_buffer.size() )
+		{
+			throw ExportException( gettext( "Writing compressed output failed" ) );
+		}
+
+		m_buffer.clear();
+		return;
+	}
+#endif
+
+	if( fwrite( m_buffer.data(), m_buffer.size(), 1, m_file ) != 1 )
+	{
+		throw ExportException( gettext( "Writing output failed" ) );
+	}
+
+	m_buffer.clear();
+}
+
+
+
+/*
+ *  Values are only quoted if necessary. Empty strings are quoted to
+ *  distinguish them from NULL values.
+ */
+
+void Export::csv( const char* value, unsigned long length )
+{
+	unsigned long i, pos;
+
+	if( value == NULL ) { return; }
+
+	for( i = 0; i < length; i++ )
+	{
+		if( value[i] == '"' || value[i] == ',' || value[i] == '\n' || value[i] == '\r' ) { break; }
+	}
+
+	if( i == length && length > 0 )
+	{
+		m_buffer.append( value, length );
+		return;
+	}
+
+	m_buffer += '"';
+
+	for( pos = 0, i = 0; i < length; i++ )
+	{
+		if( value[i] == '"' )
+		{
+			m_buffer.append( value + pos, i - pos + 1 );
+			m_buffer += '"';
+			pos = i + 1;
+		}
+	}
+
+	m_buffer.append( value + pos, length - pos );
+	m_buffer += '"';
+}
+
+
+
+void Export::tsv( const char* value, unsigned long length )
+{
+	char c;
+	unsigned long i, pos;
+
+	if( value == NULL )
+	{
+		m_buffer.append( "\\N", 2 );
+		return;
+	}
+
+	for( pos = 0, i = 0; i < length; i++ )
+	{
+		switch( value[i] )
+		{
+			case '\\': c = '\\'; break;
+			case '\t': c = 't'; break;
+			case '\n': c = 'n'; break;
+			case '\r': c = 'r'; break;
+			default: continue;
+		}
+
+		m_buffer.append( value + pos, i - pos );
+		m_buffer += '\\';
+		m_buffer += c;
+		pos = i + 1;
+	}
+
+	m_buffer.append( value + pos, length - pos );
+}
+
+
+
+void Export::json( const char* value, unsigned long length )
+{
+	char hex[8];
+	unsigned long i, pos;
+
+	if( value == NULL )
+	{
+		m_buffer.append( "null", 4 );
+		return;
+	}
+
+	m_buffer += '"';
+
+	for( pos = 0, i = 0; i < length; i++ )
+	{
+		if( value[i] != '"' && value[i] != '\\' && (unsigned char) value[i] >= 0x20 ) { continue; }
+
+		m_buffer.append( value + pos, i - pos );
+		pos = i + 1;
+
+		switch( value[i] )
+		{
+			case '"': m_buffer.append( "\\\"", 2 ); break;
+			case '\\': m_buffer.append( "\\\\", 2 ); break;
+			case '\n': m_buffer.append( "\\n", 2 ); break;
+			case '\r': m_buffer.append( "\\r", 2 ); break;
+			case '\t': m_buffer.append( "\\t", 2 ); break;
+			default:
+				snprintf( hex, sizeof( hex ), "\\u%04x", (unsigned int) (unsigned char) value[i] );
+				m_buffer.append( hex, 6 );
+		}
+	}
+
+	m_buffer.append( value + pos, length - pos );
+	m_buffer += '"';
+}
+
+
+
+void Export::put32( uint32_t value )
+{
+	char le[4];
+
+	le[0] = (char) ( value & 0xff );
+	le[1] = (char) ( ( value >> 8 ) & 0xff );
+	le[2] = (char) ( ( value >> 16 ) & 0xff );
+	le[3] = (char) ( ( value >> 24 ) & 0xff );
+
+	m_buffer.append( le, 4 );
+}
+
+
+
+void Export::binary( const char* value, unsigned long length )
+{
+	if( value == NULL )
+	{
+		put32( EXPORT_NULL );
+		return;
+	}
+
+	put32( (uint32_t) length );
+	m_buffer.append( value, length );
+}
+
+
+
+/*
+ *  The JSON keys are escaped only once per result set
+ */
+
+void Export::header( Result& result, unsigned long cols )
+{
+	string name;
+
+	m_keys.clear();
+
+	switch( m_format )
+	{
+		case Csv:
+			if( !m_names ) { break; }
+
+			for( unsigned long i = 0; i < cols; i++ )
+			{
+				name = result.columnName( i );
+
+				if( i > 0 ) { m_buffer += ','; }
+				csv( name.data(), name.size() );
+			}
+			m_buffer += '\n';
+			break;
+		case Jsonl:
+			for( unsigned long i = 0; i < cols; i++ )
+			{
+				name = result.columnName( i );
+
+				m_buffer.clear();   // empty after flush()
+				m_buffer += i > 0 ? ',' : '{';
+				json( name.data(), name.size() );
+				m_buffer += ':';
+				m_keys.push_back( m_buffer );
+			}
+			m_buffer.clear();
+			break;
+		case Binary:
+			put32( EXPORT_HEADER );
+			put32( (uint32_t) cols );
+
+			for( unsigned long i = 0; i < cols; i++ )
+			{
+				name = result.columnName( i );
+				binary( name.data(), name.size() );
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+
+
+/*
+ *  Writes all result sets of the statement. The rows are fetched in blocks
+ *  of chunk rows, which is also passed to the backend as hint how many rows
+ *  it should retrieve from the server at once.
+ */
+
+uint64_t Export::write( Result& result, unsigned long chunk )
+{
+	odbxres stat;
+	uint64_t total = 0;
+	unsigned long r, i, rows, cols;
+
+
+	if( chunk == 0 ) { chunk = 1; }
+
+	while( ( stat = result.getResult( NULL, chunk ) ) != ODBX_RES_DONE )
+	{
+		if( stat != ODBX_RES_ROWS ) { continue; }
+
+		cols = result.columnCount();
+
+		this->flush();
+		this->header( result, cols );
+
+		while( ( rows = result.getRows( chunk, m_values, m_lengths ) ) > 0 )
+		{
+			const char** value = &m_values[0];
+			const unsigned long* length = &m_lengths[0];
+
+			for( r = 0; r < rows; r++ )
+			{
+				switch( m_format )
+				{
+					case Csv:
+						for( i = 0; i < cols; i++ )
+						{
+							if( i > 0 ) { m_buffer += ','; }
+							csv( *value++, *length++ );
+						}
+						m_buffer += '\n';
+						break;
+					case Tsv:
+						for( i = 0; i < cols; i++ )
+						{
+							if( i > 0 ) { m_buffer += '\t'; }
+							tsv( *value++, *length++ );
+						}
+						m_buffer += '\n';
+						break;
+					case Jsonl:
+						for( i = 0; i < cols; i++ )
+						{
+							m_buffer += m_keys[i];
+							json( *value++, *length++ );
+						}
+						m_buffer.append( cols > 0 ? "}\n" : "{}\n" );
+						break;
+					case Binary:
+						for( i = 0; i < cols; i++ )
+						{
+							binary( *value++, *length++ );
+						}
+						break;
+				}
+
+				if( m_buffer.size() >= m_bufsize ) { this->flush(); }
+			}
+
+			total += rows;
+			m_rows += rows;
+
+			this->progress( m_rows, m_bytes + m_buffer.size() );
+		}
+	}
+
+	return total;
+}
@@ -0,0 +1,86 @@
+#include <opendbx/api>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdio>
+#include <stdint.h>
+
+
+using std::string;
+using std::vector;
+
+
+
+#ifndef EXPORT_HPP
+#define EXPORT_HPP
+
+
+
+class ExportException : public std::runtime_error
+{
+public:
+	explicit ExportException( const string& str ) : std::runtime_error( str ) {}
+};
+
+
+
+/*
+ *  Writes result sets in a machine readable format
+ *
+ *  csv     comma separated values quoted according to RFC 4180, first line
+ *          contains the column names, NULL values are empty fields
+ *  tsv     tab separated values in the text format of PostgreSQL COPY,
+ *          special characters are escaped by backslashes, NULL is \N
+ *  jsonl   one JSON object per row with the column names as keys
+ *  binary  column count and names as header of each result set, then the
+ *          fields of all rows, each as 32 bit little endian length
+ *          followed by the data (length 0xffffffff for NULL values)
+ *
+ *  Output is collected in a large buffer and written in blocks, optionally
+ *  compressed by gzip. Derived classes can override progress() which is
+ *  called after each block of rows.
+ */
+
+class Export
+{
+public:
+
+	enum exportfmt { Csv, Tsv, Jsonl, Binary };
+
+protected:
+
+	exportfmt m_format;
+	string m_buffer;
+	size_t m_bufsize;
+	FILE* m_file;
+	void* m_gz;
+	bool m_names;
+	uint64_t m_rows;
+	uint64_t m_bytes;
+	vector<string> m_keys;
+	vector<const char*> m_values;
+	vector<unsigned long> m_lengths;
+
+	void flush();
+	void put32( uint32_t value );
+	void header( OpenDBX::Result& result, unsigned long cols );
+	void csv( const char* value, unsigned long length );
+	void tsv( const char* value, unsigned long length );
+	void json( const char* value, unsigned long length );
+	void binary( const char* value, unsigned long length );
+
+	virtual void progress( uint64_t rows, uint64_t bytes ) {}
+
+public:
+
+	Export( const string& format, const string& filename, bool compress, size_t bufsize = 1048576 );
+	virtual ~Export();
+
+	void columnNames( bool enable );
+	uint64_t write( OpenDBX::Result& result, unsigned long chunk );
+	void close();
+};
+
+
+
+#endif
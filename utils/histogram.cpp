@@ -0,0 +1,128 @@
+#include "histogram.hpp"
+
+
+
+#define HIST_SUBBITS 7
+#define HIST_HALF ( 1 << ( HIST_SUBBITS - 1 ) )
+#define HIST_BUCKETS ( ( 64 - HIST_SUBBITS + 2 ) * HIST_HALF )
+
+
+
+Histogram::Histogram() : m_counts( HIST_BUCKETS, 0 ), m_count( 0 ), m_sum( 0 ), m_min( 0 ), m_max( 0 ) {}
+
+
+
+size_t Histogram::index( uint64_t value )
+{
+	if( value < ( 1 << HIST_SUBBITS ) ) { return (size_t) value; }
+
+	int shift = 64 - __builtin_clzll( value ) - HIST_SUBBITS;   // value >> shift is in [HALF, 2*HALF)
+
+	return (size_t) shift * HIST_HALF + (size_t) ( value >> shift );
+}
+
+
+
+uint64_t Histogram::lower( size_t index )
+{
+	if( index < ( 1 << HIST_SUBBITS ) ) { return (uint64_t) index; }
+
+	size_t shift = index / HIST_HALF - 1;
+
+	return (uint64_t) ( index - shift * HIST_HALF ) << shift;
+}
+
+
+
+void Histogram::record( uint64_t value )
+{
+	m_counts[index( value )]++;
+
+	if( m_count == 0 || value < m_min ) { m_min = value; }
+	if( value > m_max ) { m_max = value; }
+
+	m_sum += value;
+	m_count++;
+}
+
+
+
+void Histogram::merge( const Histogram& hist )
+{
+	if( hist.m_count == 0 ) { return; }
+
+	for( size_t i = 0; i < m_counts.size(); i++ )
+	{
+		m_counts[i] += hist.m_counts[i];
+	}
+
+	if( m_count == 0 || hist.m_min < m_min ) { m_min = hist.m_min; }
+	if( hist.m_max > m_max ) { m_max = hist.m_max; }
+
+	m_sum += hist.m_sum;
+	m_count += hist.m_count;
+}
+
+
+
+uint64_t Histogram::count() const
+{
+	return m_count;
+}
+
+
+
+uint64_t Histogram::min() const
+{
+	return m_min;
+}
+
+
+
+uint64_t Histogram::max() const
+{
+	return m_max;
+}
+
+
+
+double Histogram::mean() const
+{
+	if( m_count == 0 ) { return 0.0; }
+
+	return (double) m_sum / m_count;
+}
+
+
+
+/*
+ *  Returns the middle of the bucket containing the percentile, but not
+ *  more than the largest recorded value
+ */
+
+uint64_t Histogram::percentile( double pct ) const
+{
+	uint64_t rank, seen = 0;
+
+
+	if( m_count == 0 ) { return 0; }
+
+	rank = (uint64_t) ( pct / 100.0 * m_count + 0.5 );
+	if( rank == 0 ) { rank = 1; }
+	if( rank > m_count ) { rank = m_count; }
+
+	for( size_t i = 0; i < m_counts.size(); i++ )
+	{
+		if( ( seen += m_counts[i] ) >= rank )
+		{
+			uint64_t value = ( lower( i ) + lower( i + 1 ) ) / 2;
+
+			if( value < m_min ) { return m_min; }
+			if( value > m_max ) { return m_max; }
+
+			return value;
+		}
+	}
+
+	return m_max;
+}
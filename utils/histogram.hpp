@@ -0,0 +1,52 @@
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+
+using std::vector;
+
+
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+
+
+/*
+ *  Latency histogram with logarithmic buckets of linear sub-buckets
+ *
+ *  Values below 128 are counted exactly, larger ones in 64 sub-buckets per
+ *  power of two, so percentiles are accurate to less than 1% for any value
+ *  while recording a value costs only a few instructions.
+ */
+
+class Histogram
+{
+protected:
+
+	vector<uint64_t> m_counts;
+	uint64_t m_count;
+	uint64_t m_sum;
+	uint64_t m_min;
+	uint64_t m_max;
+
+	static size_t index( uint64_t value );
+	static uint64_t lower( size_t index );
+
+public:
+
+	Histogram();
+
+	void record( uint64_t value );
+	void merge( const Histogram& hist );
+
+	uint64_t count() const;
+	uint64_t min() const;
+	uint64_t max() const;
+	double mean() const;
+	uint64_t percentile( double pct ) const;
+};
+
+
+
+#endif
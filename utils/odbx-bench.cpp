@@ -0,0 +1,301 @@
+#include "argmap.hpp"
+#include "odbx-bench.hpp"
+#include "parallel.hpp"
+#include <opendbx/api>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+#include <clocale>
+#include <ctime>
+#include <cerrno>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ENABLE_NLS
+#  ifdef HAVE_LIBINTL_H
+#    include <libintl.h>
+#  endif
+#else
+#  define gettext(string) string
+#endif
+
+
+
+using namespace OpenDBX;
+
+using std::string;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+
+string help( ArgMap& A, const string& progname )
+{
+	return "\nOpenDBX load generator, version " + string( PACKAGE_VERSION ) + "\n\n" + progname + " [options]\n\n" + A.help() + "\n";
+}
+
+
+
+void wait( uint64_t until )
+{
+	uint64_t time;
+	struct timespec ts;
+
+	if( ( time = now() ) >= until ) { return; }
+
+	ts.tv_sec = (time_t) ( ( until - time ) / 1000000000 );
+	ts.tv_nsec = (long) ( ( until - time ) % 1000000000 );
+
+	while( nanosleep( &ts, &ts ) != 0 && errno == EINTR );
+}
+
+
+
+/*
+ *  Executes statements until the end of the run. In open-loop mode, the
+ *  latency is measured from the time the statement should have been sent,
+ *  so a slow server also increases the latency of the following ones.
+ */
+
+void* run( void* arg )
+{
+	size_t t;
+	string sql;
+	bool failed;
+	uint64_t start, done, seq = 0;
+	struct worker* w = (struct worker*) arg;
+	uint64_t random = 0x9e3779b97f4a7c15ULL * ( w->id + 1 );
+
+
+	while( ( start = now() ) < w->end )
+	{
+		if( w->interval > 0 )
+		{
+			start = w->first + (uint64_t) ( w->interval * seq );
+			if( start >= w->end ) { break; }
+			wait( start );
+		}
+
+		t = w->workload->choose( Workload::next( random ) );
+		w->workload->expand( t, sql, random, seq++, w->id );
+		failed = false;
+
+		if( w->lock != NULL ) { pthread_mutex_lock( w->lock ); }
+
+		try
+		{
+			Result result = w->conn->create( sql ).execute();
+
+			while( result.getResult() != ODBX_RES_DONE )
+			{
+				while( result.getRow() != ODBX_ROW_DONE );
+			}
+		}
+		catch( OpenDBX::Exception& oe )
+		{
+			if( oe.getType() < 0 ) { w->fatal = oe.what(); }
+			failed = true;
+		}
+		catch( std::exception& e )
+		{
+			failed = true;
+		}
+
+		if( w->lock != NULL ) { pthread_mutex_unlock( w->lock ); }
+
+		done = now();
+
+		if( !w->fatal.empty() ) { break; }
+		if( start < w->begin ) { continue; }   // warmup
+
+		if( failed ) { w->errors[t]++; }
+		else { w->hist[t].record( done - start ); }
+	}
+
+	return NULL;
+}
+
+
+
+void report( const string& name, const Histogram& hist, uint64_t errors, double duration )
+{
+	printf( "%-16s %10llu %8llu %10.1f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", name.c_str(),
+		(unsigned long long) hist.count(), (unsigned long long) errors, hist.count() / duration,
+		hist.mean() / 1e6, hist.percentile( 50.0 ) / 1e6, hist.percentile( 90.0 ) / 1e6,
+		hist.percentile( 99.0 ) / 1e6, hist.percentile( 99.9 ) / 1e6, hist.max() / 1e6 );
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	int err = 0;
+	vector<Conn*> conns;
+	vector<pthread_mutex_t> locks;
+	vector<struct worker> workers;
+
+
+	try
+	{
+		ArgMap A;
+		string config;
+
+#ifdef ENABLE_NLS
+		setlocale( LC_ALL, "" );
+		textdomain( "opendbx-utils" );
+		bindtextdomain( "opendbx-utils", LOCALEDIR );
+#endif
+
+		if( !A.checkArgv( argc, argv, "--config", config ) ) {
+			if( !A.checkArgv( argc, argv, "-c", config ) ) { config = ""; }
+		}
+
+		A.set( "help", "?", string( gettext( "print this help" ) ), false );
+		A.set( "backend", "b", string( gettext( "name of the backend or path to the backend library" ) ) ) = "mysql";
+		A.set( "config", "c", string( gettext( "read configuration from file" ) ) ) = config;
+		A.set( "database", "d", string( gettext( "database name or database file name" ) ) );
+		A.set( "workload", "f", string( gettext( "file containing the weighted SQL templates" ) ) );
+		A.set( "host", "h", string( gettext( "host name, IP address or path to the database server" ) ) ) = "localhost";
+		A.set( "connections", "n", string( gettext( "number of connections shared by the threads (default: one per thread)" ) ) ) = "0";
+		A.set( "port", "p", string( gettext( "port name or number of the database server" ) ) );
+		A.set( "rate", "r", string( gettext( "statements per second of all threads, 0 for maximum throughput" ) ) ) = "0";
+		A.set( "duration", "s", string( gettext( "seconds to measure after the warmup" ) ) ) = "10";
+		A.set( "threads", "t", string( gettext( "number of threads sending statements" ) ) ) = "1";
+		A.set( "username", "u", string( gettext( "user name for authentication" ) ) );
+		A.set( "warmup", "W", string( gettext( "seconds to run before measuring" ) ) ) = "2";
+		string& password = A.set( "password", "w", string( gettext( "with prompt asking for the passphrase" ) ), false );
+
+		if( A.asString( "config" ) != "" ) {
+			A.parseFile( A.asString( "config" ) );
+		}
+		A.parseArgv( argc, argv );
+
+		if( A.mustDo( "help" ) || A.asString( "workload" ) == "" ) {
+			std::cout << help( A, string( argv[0] ) );
+			return 0;
+		}
+
+		if( A.mustDo( "password" ) ) {
+			std::cout << gettext( "Password: " );
+			std::cin >> password;
+		}
+
+		long threads = A.asLong( "threads" );
+		long connections = A.asLong( "connections" );
+		double rate = A.asDouble( "rate" );
+		double duration = A.asDouble( "duration" );
+		double warmup = A.asDouble( "warmup" );
+
+		if( threads < 1 || connections < 0 || rate < 0 || duration <= 0 || warmup < 0 ) {
+			throw std::runtime_error( gettext( "Invalid number of threads, connections, rate or duration" ) );
+		}
+
+		if( connections == 0 || connections > threads ) { connections = threads; }
+
+		Workload workload( A.asString( "workload" ) );
+
+		for( long i = 0; i < connections; i++ )
+		{
+			conns.push_back( new Conn( A.asString( "backend" ), A.asString( "host" ), A.asString( "port" ) ) );
+			conns.back()->bind( A.asString( "database" ), A.asString( "username" ), A.asString( "password" ) );
+		}
+
+		if( connections < threads )
+		{
+			locks.resize( connections );
+			for( long i = 0; i < connections; i++ ) { pthread_mutex_init( &locks[i], NULL ); }
+		}
+
+		uint64_t start = now();
+
+		workers.resize( threads );
+
+		for( long i = 0; i < threads; i++ )
+		{
+			struct worker& w = workers[i];
+
+			w.id = (unsigned long) i;
+			w.conn = conns[i % connections];
+			w.lock = locks.empty() ? NULL : &locks[i % connections];
+			w.workload = &workload;
+			w.begin = start + (uint64_t) ( warmup * 1e9 );
+			w.end = w.begin + (uint64_t) ( duration * 1e9 );
+			w.interval = rate > 0 ? 1e9 * threads / rate : 0.0;
+			w.first = start + (uint64_t) ( w.interval * i / threads );   // spread threads evenly
+			w.hist.resize( workload.size() );
+			w.errors.resize( workload.size(), 0 );
+		}
+
+		for( long i = 0; i < threads; i++ )
+		{
+			if( pthread_create( &workers[i].thread, NULL, run, (void*) &workers[i] ) != 0 )
+			{
+				for( long j = 0; j < i; j++ ) { workers[j].end = 0; pthread_join( workers[j].thread, NULL ); }
+				throw std::runtime_error( gettext( "Starting thread failed" ) );
+			}
+		}
+
+		for( long i = 0; i < threads; i++ )
+		{
+			pthread_join( workers[i].thread, NULL );
+
+			if( !workers[i].fatal.empty() )
+			{
+				cerr << gettext( "Error: " ) << workers[i].fatal << endl;
+				err = 1;
+			}
+		}
+
+		Histogram all;
+		uint64_t errors = 0;
+
+		printf( "%-16s %10s %8s %10s %9s %9s %9s %9s %9s %9s\n", "template", "count", "errors", "rate/s",
+			"mean/ms", "p50/ms", "p90/ms", "p99/ms", "p99.9/ms", "max/ms" );
+
+		for( size_t t = 0; t < workload.size(); t++ )
+		{
+			Histogram hist;
+			uint64_t errs = 0;
+
+			for( long i = 0; i < threads; i++ )
+			{
+				hist.merge( workers[i].hist[t] );
+				errs += workers[i].errors[t];
+			}
+
+			report( workload.name( t ), hist, errs, duration );
+
+			all.merge( hist );
+			errors += errs;
+		}
+
+		report( "all", all, errors, duration );
+	}
+	catch( std::runtime_error &e )
+	{
+		cerr << gettext( "Error: " ) << e.what() << endl;
+		err = 1;
+	}
+	catch( ... )
+	{
+		cerr << gettext( "Error: Caught unknown exception" ) << endl;
+		err = 1;
+	}
+
+	for( size_t i = 0; i < locks.size(); i++ ) { pthread_mutex_destroy( &locks[i] ); }
+
+	for( size_t i = 0; i < conns.size(); i++ )
+	{
+		try { conns[i]->finish(); }
+		catch( std::exception& e ) {}
+
+		delete conns[i];
+	}
+
+	return err;
+}
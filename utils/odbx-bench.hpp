@@ -0,0 +1,34 @@
+#include "histogram.hpp"
+#include "workload.hpp"
+#include <opendbx/api>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+
+using std::string;
+using std::vector;
+
+
+#ifndef ODBX_BENCH_HPP
+#define ODBX_BENCH_HPP
+
+
+struct worker
+{
+	unsigned long id;
+	pthread_t thread;
+	OpenDBX::Conn* conn;
+	pthread_mutex_t* lock;   // only if the connection is shared by several threads
+	const Workload* workload;
+	uint64_t first;   // time the first statement is sent in open-loop mode
+	uint64_t begin;   // start of the measurement after warmup
+	uint64_t end;
+	double interval;   // nanoseconds between statements in open-loop mode, zero in closed-loop mode
+	vector<Histogram> hist;
+	vector<uint64_t> errors;
+	string fatal;
+};
+
+
+#endif
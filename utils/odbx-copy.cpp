@@ -0,0 +1,708 @@
+#include "argmap.hpp"
+#include "odbx-copy.hpp"
+#include "parallel.hpp"
+#include <opendbx/api>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <clocale>
+#include <ctime>
+#include <unistd.h>
+#include <sys/time.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ENABLE_NLS
+#  ifdef HAVE_LIBINTL_H
+#    include <libintl.h>
+#  endif
+#else
+#  define gettext(string) string
+#endif
+
+
+
+using namespace OpenDBX;
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+
+string help( ArgMap& A, const string& progname )
+{
+	return "\nOpenDBX table copy, version " + string( PACKAGE_VERSION ) + "\n\n" + progname + " [options]\n\n" + A.help() + "\n";
+}
+
+
+
+BatchQueue::BatchQueue( size_t max ) : m_max( max ), m_closed( false )
+{
+	pthread_mutex_init( &m_lock, NULL );
+	pthread_cond_init( &m_notempty, NULL );
+	pthread_cond_init( &m_notfull, NULL );
+}
+
+
+
+BatchQueue::~BatchQueue()
+{
+	for( size_t i = 0; i < m_queue.size(); i++ ) { delete m_queue[i]; }
+
+	pthread_cond_destroy( &m_notfull );
+	pthread_cond_destroy( &m_notempty );
+	pthread_mutex_destroy( &m_lock );
+}
+
+
+
+bool BatchQueue::push( struct batch* b )
+{
+	pthread_mutex_lock( &m_lock );
+
+	while( !m_closed && m_queue.size() >= m_max ) {
+		pthread_cond_wait( &m_notfull, &m_lock );
+	}
+
+	bool closed = m_closed;
+	if( !closed )
+	{
+		m_queue.push_back( b );
+		pthread_cond_signal( &m_notempty );
+	}
+
+	pthread_mutex_unlock( &m_lock );
+
+	return !closed;
+}
+
+
+
+struct batch* BatchQueue::pop()
+{
+	struct batch* b = NULL;
+
+	pthread_mutex_lock( &m_lock );
+
+	while( !m_closed && m_queue.empty() ) {
+		pthread_cond_wait( &m_notempty, &m_lock );
+	}
+
+	if( !m_queue.empty() )
+	{
+		b = m_queue.front();
+		m_queue.pop_front();
+		pthread_cond_signal( &m_notfull );
+	}
+
+	pthread_mutex_unlock( &m_lock );
+
+	return b;
+}
+
+
+
+void BatchQueue::close()
+{
+	pthread_mutex_lock( &m_lock );
+	m_closed = true;
+	pthread_cond_broadcast( &m_notempty );
+	pthread_cond_broadcast( &m_notfull );
+	pthread_mutex_unlock( &m_lock );
+}
+
+
+
+void fail( struct job* j, const string& error )
+{
+	pthread_mutex_lock( &j->lock );
+	if( !j->failed ) { j->error = error; }
+	j->failed = true;
+	pthread_mutex_unlock( &j->lock );
+
+	j->queue->close();
+}
+
+
+
+/*
+ *  Column types of the destination table if it's created by odbx-copy
+ */
+
+string sqltype( odbxtype type )
+{
+	switch( type )
+	{
+		case ODBX_TYPE_BOOLEAN:
+			return "BOOLEAN";
+		case ODBX_TYPE_SMALLINT:
+			return "SMALLINT";
+		case ODBX_TYPE_INTEGER:
+			return "INTEGER";
+		case ODBX_TYPE_BIGINT:
+			return "BIGINT";
+		case ODBX_TYPE_DECIMAL:
+			return "NUMERIC";
+		case ODBX_TYPE_REAL:
+			return "REAL";
+		case ODBX_TYPE_DOUBLE:
+		case ODBX_TYPE_FLOAT:
+			return "DOUBLE PRECISION";
+		case ODBX_TYPE_TIME:
+			return "TIME";
+		case ODBX_TYPE_TIMETZ:
+			return "TIME WITH TIME ZONE";
+		case ODBX_TYPE_TIMESTAMP:
+			return "TIMESTAMP";
+		case ODBX_TYPE_TIMESTAMPTZ:
+			return "TIMESTAMP WITH TIME ZONE";
+		case ODBX_TYPE_DATE:
+			return "DATE";
+		case ODBX_TYPE_INTERVAL:
+			return "INTERVAL";
+		case ODBX_TYPE_BLOB:
+			return "BLOB";
+		default:
+			return "TEXT";
+	}
+}
+
+
+
+bool numeric( odbxtype type, const char* value, unsigned long len )
+{
+	switch( type )
+	{
+		case ODBX_TYPE_SMALLINT:
+		case ODBX_TYPE_INTEGER:
+		case ODBX_TYPE_BIGINT:
+		case ODBX_TYPE_DECIMAL:
+		case ODBX_TYPE_REAL:
+		case ODBX_TYPE_DOUBLE:
+		case ODBX_TYPE_FLOAT:
+			break;
+		default:
+			return false;
+	}
+
+	if( len == 0 ) { return false; }
+
+	for( unsigned long i = 0; i < len; i++ ) {
+		if( strchr( "0123456789+-.eE", value[i] ) == NULL || value[i] == '\0' ) { return false; }
+	}
+
+	return true;
+}
+
+
+
+/*
+ *  Reads the rows of the source in chunks and passes them to the writer
+ */
+
+void* reader( void* arg )
+{
+	struct job* j = (struct job*) arg;
+	const struct copysettings* conf = j->conf;
+
+
+	try
+	{
+		Conn conn( conf->from.backend, conf->from.host, conf->from.port );
+		conn.bind( conf->from.database, conf->from.username, conf->from.password );
+
+		{
+			unsigned long n, cols;
+			vector<const char*> values;
+			vector<unsigned long> lengths;
+			bool open = true;
+
+			Result result = conn.create( j->query ).execute();
+
+			while( open && result.getResult() != ODBX_RES_DONE )
+			{
+				if( ( cols = result.columnCount() ) != conf->names.size() ) {
+					throw std::runtime_error( gettext( "Number of columns changed" ) );
+				}
+
+				while( open && ( n = result.getRows( conf->rows, values, lengths ) ) > 0 )
+				{
+					struct batch* b = new struct batch;
+					unsigned long size = 0;
+
+					for( unsigned long i = 0; i < n * cols; i++ ) {
+						if( values[i] != NULL ) { size += lengths[i]; }
+					}
+
+					b->rows = n;
+					b->cols = cols;
+					b->data.reserve( size );
+					b->offset.resize( n * cols );
+					b->length.resize( n * cols );
+
+					for( unsigned long i = 0; i < n * cols; i++ )
+					{
+						b->offset[i] = b->data.size();
+						b->length[i] = COPY_NULL;
+
+						if( values[i] != NULL )
+						{
+							b->data.append( values[i], lengths[i] );
+							b->length[i] = lengths[i];
+						}
+					}
+
+					if( !( open = j->queue->push( b ) ) ) { delete b; }   // writer failed
+				}
+			}
+		}
+
+		conn.finish();
+	}
+	catch( std::exception& e )
+	{
+		fail( j, e.what() );
+	}
+
+	j->queue->close();
+
+	return NULL;
+}
+
+
+
+/*
+ *  Parallel writers may have to wait for locks held by the others, e.g. in
+ *  SQLite databases
+ */
+
+void execute( Conn& conn, const string& sql )
+{
+	odbxres res;
+	struct timeval tv = { 60, 0 };
+	Result result = conn.create( sql ).execute();
+
+	while( ( res = result.getResult( &tv ) ) != ODBX_RES_DONE )
+	{
+		if( res == ODBX_RES_ROWS ) {
+			while( result.getRow() != ODBX_ROW_DONE );
+		}
+
+		tv.tv_sec = 60;
+		tv.tv_usec = 0;
+	}
+}
+
+
+
+/*
+ *  Writes the rows using multi-row INSERT statements
+ */
+
+void* writer( void* arg )
+{
+	struct job* j = (struct job*) arg;
+	const struct copysettings* conf = j->conf;
+	struct batch* b = NULL;
+
+
+	try
+	{
+		Conn conn( conf->to.backend, conf->to.host, conf->to.port );
+		conn.bind( conf->to.database, conf->to.username, conf->to.password );
+
+		string sql, value, prefix = "INSERT INTO " + conf->into + " (";
+		unsigned long pending = 0;
+		uint64_t rows = 0;
+
+		for( size_t i = 0; i < conf->names.size(); i++ )
+		{
+			if( i > 0 ) { prefix += ", "; }
+			prefix += conf->names[i];
+		}
+		prefix += ") VALUES ";
+
+		while( ( b = j->queue->pop() ) != NULL )
+		{
+			sql = prefix;
+
+			for( unsigned long r = 0; r < b->rows; r++ )
+			{
+				sql += r > 0 ? ",(" : "(";
+
+				for( unsigned long c = 0; c < b->cols; c++ )
+				{
+					unsigned long i = r * b->cols + c;
+					const char* val = b->data.data() + b->offset[i];
+
+					if( c > 0 ) { sql += ','; }
+
+					if( b->length[i] == COPY_NULL ) { sql += "NULL"; }
+					else if( conf->types[c] == ODBX_TYPE_BOOLEAN )
+					{
+						sql += b->length[i] > 0 && val[0] != '\0' && strchr( "tTyY1", val[0] ) != NULL ? "'1'" : "'0'";
+					}
+					else if( numeric( conf->types[c], val, b->length[i] ) ) { sql.append( val, b->length[i] ); }
+					else
+					{
+						sql += '\'';
+						sql += conn.escape( val, b->length[i], value );
+						sql += '\'';
+					}
+				}
+
+				sql += ')';
+			}
+
+			if( conf->trans > 0 && pending == 0 ) { execute( conn, "BEGIN" ); }
+
+			execute( conn, sql );
+			pending += b->rows;
+			rows += b->rows;
+			delete b;
+			b = NULL;
+
+			if( conf->trans > 0 && pending >= conf->trans )
+			{
+				execute( conn, "COMMIT" );
+				pending = 0;
+			}
+
+			pthread_mutex_lock( &j->lock );
+			j->rows = rows;
+			bool failed = j->failed;
+			pthread_mutex_unlock( &j->lock );
+
+			if( failed ) { break; }   // reader failed
+		}
+
+		if( pending > 0 )
+		{
+			pthread_mutex_lock( &j->lock );
+			bool failed = j->failed;
+			pthread_mutex_unlock( &j->lock );
+
+			execute( conn, failed ? "ROLLBACK" : "COMMIT" );
+		}
+
+		conn.finish();
+	}
+	catch( std::exception& e )
+	{
+		fail( j, e.what() );
+		delete b;
+	}
+
+	j->queue->close();
+	while( ( b = j->queue->pop() ) != NULL ) { delete b; }
+
+	pthread_mutex_lock( &j->lock );
+	j->end = now();
+	pthread_mutex_unlock( &j->lock );
+
+	return NULL;
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	int err = 0;
+	vector<struct job> jobs;
+	vector<BatchQueue*> queues;
+	unsigned long started = 0;
+
+
+	try
+	{
+		ArgMap A;
+		string config;
+
+#ifdef ENABLE_NLS
+		setlocale( LC_ALL, "" );
+		textdomain( "opendbx-utils" );
+		bindtextdomain( "opendbx-utils", LOCALEDIR );
+#endif
+
+		if( !A.checkArgv( argc, argv, "--config", config ) ) {
+			if( !A.checkArgv( argc, argv, "-c", config ) ) { config = ""; }
+		}
+
+		A.set( "help", "?", string( gettext( "print this help" ) ), false );
+		A.set( "backend", "b", string( gettext( "name of the source backend or path to the backend library" ) ) ) = "mysql";
+		A.set( "to-backend", "B", string( gettext( "name of the destination backend, same as source if empty" ) ) );
+		A.set( "config", "c", string( gettext( "read configuration from file" ) ) ) = config;
+		A.set( "create", "C", string( gettext( "create destination table" ) ), false );
+		A.set( "database", "d", string( gettext( "source database name or database file name" ) ) );
+		A.set( "to-database", "D", string( gettext( "destination database name or database file name" ) ) );
+		A.set( "host", "h", string( gettext( "host name, IP address or path to the source database server" ) ) ) = "localhost";
+		A.set( "to-host", "H", string( gettext( "host name, IP address or path to the destination database server" ) ) );
+		A.set( "into", "i", string( gettext( "destination table, same as source table if empty" ) ) );
+		A.set( "jobs", "j", string( gettext( "number of key ranges copied in parallel" ) ) ) = "1";
+		A.set( "key", "k", string( gettext( "integer primary key column used for splitting the table" ) ) );
+		A.set( "queue", "l", string( gettext( "chunks buffered between reading and writing" ) ) ) = "4";
+		A.set( "split", "m", string( gettext( "split by key ranges or modulo of the key" ) ) ) = "range";
+		A.set( "port", "p", string( gettext( "port name or number of the source database server" ) ) );
+		A.set( "to-port", "P", string( gettext( "port name or number of the destination database server" ) ) );
+		A.set( "quiet", "q", string( gettext( "don't show progress" ) ), false );
+		A.set( "rows", "r", string( gettext( "rows per chunk and INSERT statement" ) ) ) = "500";
+		A.set( "columns", "s", string( gettext( "columns to copy" ) ) ) = "*";
+		A.set( "statement", "S", string( gettext( "query whose result is copied instead of a table" ) ) );
+		A.set( "table", "t", string( gettext( "table to copy" ) ) );
+		A.set( "transaction", "T", string( gettext( "rows per transaction, 0 for autocommit" ) ) ) = "10000";
+		A.set( "username", "u", string( gettext( "user name for the source database" ) ) );
+		A.set( "to-username", "U", string( gettext( "user name for the destination database" ) ) );
+		string& password = A.set( "password", "w", string( gettext( "with prompt asking for the source passphrase" ) ), false );
+		string& topassword = A.set( "to-password", "W", string( gettext( "with prompt asking for the destination passphrase" ) ), false );
+		A.set( "where", "x", string( gettext( "condition rows must match" ) ) );
+
+		if( A.asString( "config" ) != "" ) {
+			A.parseFile( A.asString( "config" ) );
+		}
+		A.parseArgv( argc, argv );
+
+		string table = A.asString( "table" );
+		string stmt = A.asString( "statement" );
+		string into = A.asString( "into" ) != "" ? A.asString( "into" ) : table;
+
+		if( A.mustDo( "help" ) || ( table == "" ) == ( stmt == "" ) || into == "" ) {
+			std::cout << help( A, string( argv[0] ) );
+			return 0;
+		}
+
+		if( A.mustDo( "password" ) ) {
+			std::cerr << gettext( "Password: " );
+			std::cin >> password;
+		}
+
+		if( A.mustDo( "to-password" ) ) {
+			std::cerr << gettext( "Destination password: " );
+			std::cin >> topassword;
+		}
+
+		long njobs = A.asLong( "jobs" );
+
+		if( njobs < 1 || A.asLong( "rows" ) < 1 || A.asLong( "queue" ) < 1 || A.asLong( "transaction" ) < 0 ) {
+			throw std::runtime_error( gettext( "Invalid number of jobs, rows, queued chunks or rows per transaction" ) );
+		}
+
+		if( njobs > 1 && ( table == "" || A.asString( "key" ) == "" ) ) {
+			throw std::runtime_error( gettext( "Parallel copies require a table and a key" ) );
+		}
+
+		struct copysettings conf;
+		conf.from.backend = A.asString( "backend" );
+		conf.from.host = A.asString( "host" );
+		conf.from.port = A.asString( "port" );
+		conf.from.database = A.asString( "database" );
+		conf.from.username = A.asString( "username" );
+		conf.from.password = A.asString( "password" );
+		conf.to.backend = A.asString( "to-backend" ) != "" ? A.asString( "to-backend" ) : conf.from.backend;
+		conf.to.host = A.asString( "to-host" ) != "" ? A.asString( "to-host" ) : conf.from.host;
+		conf.to.port = A.asString( "to-port" );
+		conf.to.database = A.asString( "to-database" ) != "" ? A.asString( "to-database" ) : conf.from.database;
+		conf.to.username = A.asString( "to-username" );
+		conf.to.password = A.asString( "to-password" );
+		conf.into = into;
+		conf.rows = (unsigned long) A.asLong( "rows" );
+		conf.trans = (unsigned long) A.asLong( "transaction" );
+		conf.queue = (size_t) A.asLong( "queue" );
+
+		string where = A.asString( "where" );
+		string select = stmt;
+		vector<string> preds( 1, "1 = 1" );
+
+		if( table != "" ) {
+			select = "SELECT " + A.asString( "columns" ) + " FROM " + table;
+		}
+
+		/*
+		 *  The column names and types are taken from a query that returns no
+		 *  rows. Splitting the table is done on the source too.
+		 */
+
+		{
+			Conn conn( conf.from.backend, conf.from.host, conf.from.port );
+			conn.bind( conf.from.database, conf.from.username, conf.from.password );
+
+			{
+				string probe = table != "" ? select + " WHERE 1 = 0" : "SELECT * FROM (" + stmt + ") odbxcopy WHERE 1 = 0";
+				Result result = conn.create( probe ).execute();
+
+				while( result.getResult() != ODBX_RES_DONE )
+				{
+					for( unsigned long i = 0; i < result.columnCount(); i++ )
+					{
+						conf.names.push_back( result.columnName( i ) );
+						conf.types.push_back( result.columnType( i ) );
+					}
+					while( result.getRow() != ODBX_ROW_DONE );
+				}
+			}
+
+			if( table != "" && A.asString( "key" ) != "" ) {
+				preds = splitTable( conn, conf.from.backend, table, A.asString( "key" ), where, A.asString( "split" ), (unsigned long) njobs );
+			}
+
+			conn.finish();
+		}
+
+		if( conf.names.empty() ) {
+			throw std::runtime_error( gettext( "Query returns no columns" ) );
+		}
+
+		if( A.mustDo( "create" ) )
+		{
+			string sql = "CREATE TABLE " + into + " (";
+
+			for( size_t i = 0; i < conf.names.size(); i++ )
+			{
+				if( i > 0 ) { sql += ", "; }
+				sql += conf.names[i] + " " + sqltype( conf.types[i] );
+			}
+			sql += ")";
+
+			Conn conn( conf.to.backend, conf.to.host, conf.to.port );
+			conn.bind( conf.to.database, conf.to.username, conf.to.password );
+			execute( conn, sql );
+			conn.finish();
+		}
+
+		njobs = (long) preds.size();
+		jobs.resize( njobs );
+
+		for( long i = 0; i < njobs; i++ )
+		{
+			struct job& j = jobs[i];
+			std::ostringstream sql;
+
+			sql << select;
+			if( table != "" && ( !where.empty() || njobs > 1 ) )
+			{
+				sql << " WHERE ";
+				if( !where.empty() ) { sql << "(" << where << ")"; }
+				if( !where.empty() && njobs > 1 ) { sql << " AND "; }
+				if( njobs > 1 ) { sql << preds[i]; }
+			}
+
+			queues.push_back( new BatchQueue( conf.queue ) );
+
+			j.id = (unsigned long) i;
+			j.conf = &conf;
+			j.query = sql.str();
+			j.queue = queues.back();
+			j.rows = j.end = 0;
+			j.start = now();
+			j.failed = false;
+
+			pthread_mutex_init( &j.lock, NULL );
+		}
+
+		for( started = 0; started < (unsigned long) njobs; started++ )
+		{
+			if( pthread_create( &jobs[started].writer, NULL, writer, (void*) &jobs[started] ) != 0 ) {
+				throw std::runtime_error( gettext( "Starting thread failed" ) );
+			}
+
+			if( pthread_create( &jobs[started].reader, NULL, reader, (void*) &jobs[started] ) != 0 )
+			{
+				jobs[started].queue->close();
+				pthread_join( jobs[started].writer, NULL );
+				throw std::runtime_error( gettext( "Starting thread failed" ) );
+			}
+		}
+
+		bool progress = !A.mustDo( "quiet" ) && isatty( STDERR_FILENO );
+		uint64_t start = now(), last = start;
+		unsigned long done = 0;
+
+		while( 1 )
+		{
+			uint64_t rows = 0;
+
+			done = 0;
+
+			for( long i = 0; i < njobs; i++ )
+			{
+				pthread_mutex_lock( &jobs[i].lock );
+				rows += jobs[i].rows;
+				if( jobs[i].end != 0 ) { done++; }
+				pthread_mutex_unlock( &jobs[i].lock );
+			}
+
+			if( progress && ( now() - last >= 1000000000 || done == (unsigned long) njobs ) )
+			{
+				double secs = ( now() - start ) / 1e9;
+
+				last = now();
+				fprintf( stderr, gettext( "\r%llu rows, %.0f rows/s, %lu of %ld jobs done " ),
+					(unsigned long long) rows, rows / secs, done, njobs );
+			}
+
+			if( done == (unsigned long) njobs ) { break; }
+
+			struct timespec ts = { 0, 100000000 };
+			nanosleep( &ts, NULL );
+		}
+
+		if( progress ) { fprintf( stderr, "\n" ); }
+
+		for( unsigned long i = 0; i < started; i++ )
+		{
+			pthread_join( jobs[i].reader, NULL );
+			pthread_join( jobs[i].writer, NULL );
+		}
+		started = 0;
+
+		if( !A.mustDo( "quiet" ) ) {
+			fprintf( stderr, "%-6s %12s %9s %12s\n", gettext( "job" ), gettext( "rows" ), gettext( "seconds" ), gettext( "rows/s" ) );
+		}
+
+		for( long i = 0; i < njobs; i++ )
+		{
+			double secs = ( jobs[i].end - jobs[i].start ) / 1e9;
+
+			if( !A.mustDo( "quiet" ) ) {
+				fprintf( stderr, "%-6ld %12llu %9.2f %12.0f\n", i, (unsigned long long) jobs[i].rows,
+					secs, secs > 0 ? jobs[i].rows / secs : 0.0 );
+			}
+
+			if( jobs[i].failed ) {
+				cerr << gettext( "Error: " ) << gettext( "Job " ) << i << ": " << jobs[i].error << endl;
+				err = 1;
+			}
+		}
+	}
+	catch( std::runtime_error &e )
+	{
+		cerr << gettext( "Error: " ) << e.what() << endl;
+		err = 1;
+	}
+	catch( ... )
+	{
+		cerr << gettext( "Error: Caught unknown exception" ) << endl;
+		err = 1;
+	}
+
+	for( unsigned long i = 0; i < started; i++ )
+	{
+		jobs[i].queue->close();
+		pthread_join( jobs[i].reader, NULL );
+		pthread_join( jobs[i].writer, NULL );
+	}
+
+	for( size_t i = 0; i < jobs.size() && i < queues.size(); i++ ) { pthread_mutex_destroy( &jobs[i].lock ); }
+	for( size_t i = 0; i < queues.size(); i++ ) { delete queues[i]; }
+
+	return err;
+}
@@ -0,0 +1,107 @@
+#include <opendbx/api>
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+
+using std::string;
+using std::vector;
+using std::deque;
+
+
+#ifndef ODBX_COPY_HPP
+#define ODBX_COPY_HPP
+
+
+#define COPY_NULL ((unsigned long) -1)
+
+
+struct endpoint
+{
+	string backend;
+	string host;
+	string port;
+	string database;
+	string username;
+	string password;
+};
+
+
+struct copysettings
+{
+	struct endpoint from;
+	struct endpoint to;
+	string into;
+	vector<string> names;
+	vector<odbxtype> types;
+	unsigned long rows;   // rows per INSERT statement
+	unsigned long trans;   // rows per transaction
+	size_t queue;
+};
+
+
+/*
+ *  Rows fetched by the reader, the values of all fields are stored one
+ *  after another in data
+ */
+
+struct batch
+{
+	unsigned long rows;
+	unsigned long cols;
+	string data;
+	vector<unsigned long> offset;
+	vector<unsigned long> length;   // COPY_NULL for NULL values
+};
+
+
+
+/*
+ *  Bounded queue between reader and writer thread
+ *
+ *  After close(), push() fails and pop() returns the remaining batches
+ *  followed by NULL.
+ */
+
+class BatchQueue
+{
+protected:
+
+	deque<struct batch*> m_queue;
+	size_t m_max;
+	bool m_closed;
+	pthread_mutex_t m_lock;
+	pthread_cond_t m_notempty;
+	pthread_cond_t m_notfull;
+
+public:
+
+	BatchQueue( size_t max );
+	~BatchQueue();
+
+	bool push( struct batch* b );
+	struct batch* pop();
+	void close();
+};
+
+
+struct job
+{
+	unsigned long id;
+	pthread_t reader;
+	pthread_t writer;
+	const struct copysettings* conf;
+	string query;
+	BatchQueue* queue;
+	pthread_mutex_t lock;   // protects the members below
+	uint64_t rows;
+	uint64_t start;
+	uint64_t end;
+	bool failed;
+	string error;
+};
+
+
+#endif
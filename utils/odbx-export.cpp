@@ -0,0 +1,375 @@
+#include "argmap.hpp"
+#include "odbx-export.hpp"
+#include "parallel.hpp"
+#include <opendbx/api>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <clocale>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ENABLE_NLS
+#  ifdef HAVE_LIBINTL_H
+#    include <libintl.h>
+#  endif
+#else
+#  define gettext(string) string
+#endif
+
+
+
+using namespace OpenDBX;
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+
+string help( ArgMap& A, const string& progname )
+{
+	return "\nOpenDBX parallel export, version " + string( PACKAGE_VERSION ) + "\n\n" + progname + " [options]\n\n" + A.help() + "\n";
+}
+
+
+
+void ShardExport::progress( uint64_t rows, uint64_t bytes )
+{
+	pthread_mutex_lock( &m_shard->lock );
+	m_shard->rows = rows;
+	m_shard->bytes = bytes;
+	pthread_mutex_unlock( &m_shard->lock );
+}
+
+
+
+/*
+ *  Each shard uses its own connection and writes to its own file
+ */
+
+void* run( void* arg )
+{
+	struct shard* s = (struct shard*) arg;
+	const struct settings* conf = s->conf;
+	string error;
+
+
+	try
+	{
+		Conn conn( conf->backend, conf->host, conf->port );
+		conn.bind( conf->database, conf->username, conf->password );
+
+		{
+			ShardExport exp( s, s->file );
+			exp.columnNames( s->names );
+
+			Result result = conn.create( s->sql ).execute();
+			exp.write( result, conf->chunk );
+			result.finish();
+			exp.close();
+		}
+
+		conn.finish();
+	}
+	catch( std::exception& e )
+	{
+		error = e.what();
+	}
+
+	pthread_mutex_lock( &s->lock );
+	s->error = error;
+	s->end = now();
+	s->done = true;
+	pthread_mutex_unlock( &s->lock );
+
+	return NULL;
+}
+
+
+
+void copyfile( const string& filename, FILE* out )
+{
+	size_t len;
+	vector<char> buffer( 1048576 );
+	FILE* in;
+
+	if( ( in = fopen( filename.c_str(), "rb" ) ) == NULL )
+	{
+		throw std::runtime_error( string( gettext( "Unable to open file: " ) ) + filename );
+	}
+
+	while( ( len = fread( &buffer[0], 1, buffer.size(), in ) ) > 0 )
+	{
+		if( fwrite( &buffer[0], len, 1, out ) != 1 )
+		{
+			fclose( in );
+			throw std::runtime_error( gettext( "Writing output failed" ) );
+		}
+	}
+
+	fclose( in );
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	int err = 0;
+	FILE* out = NULL;
+	vector<struct shard> shards;
+	vector<string> tmpfiles;
+	unsigned long started = 0;
+
+
+	try
+	{
+		ArgMap A;
+		string config;
+
+#ifdef ENABLE_NLS
+		setlocale( LC_ALL, "" );
+		textdomain( "opendbx-utils" );
+		bindtextdomain( "opendbx-utils", LOCALEDIR );
+#endif
+
+		if( !A.checkArgv( argc, argv, "--config", config ) ) {
+			if( !A.checkArgv( argc, argv, "-c", config ) ) { config = ""; }
+		}
+
+		A.set( "help", "?", string( gettext( "print this help" ) ), false );
+		A.set( "backend", "b", string( gettext( "name of the backend or path to the backend library" ) ) ) = "mysql";
+		A.set( "config", "c", string( gettext( "read configuration from file" ) ) ) = config;
+		A.set( "database", "d", string( gettext( "database name or database file name" ) ) );
+		A.set( "export", "e", string( gettext( "export format, i.e. csv, tsv, jsonl or binary" ) ) ) = "csv";
+		A.set( "host", "h", string( gettext( "host name, IP address or path to the database server" ) ) ) = "localhost";
+		A.set( "jobs", "j", string( gettext( "number of shards exported in parallel" ) ) ) = "4";
+		A.set( "key", "k", string( gettext( "integer primary key column used for splitting the table" ) ) );
+		A.set( "split", "m", string( gettext( "split by key ranges or modulo of the key" ) ) ) = "range";
+		A.set( "chunk", "n", string( gettext( "rows fetched at once" ) ) ) = "1000";
+		A.set( "output", "o", string( gettext( "output file, %d is replaced by the shard number" ) ) );
+		A.set( "port", "p", string( gettext( "port name or number of the database server" ) ) );
+		A.set( "quiet", "q", string( gettext( "don't show progress" ) ), false );
+		A.set( "columns", "s", string( gettext( "columns to export" ) ) ) = "*";
+		A.set( "order", "S", string( gettext( "sort rows of each shard by key" ) ), false );
+		A.set( "table", "t", string( gettext( "table to export" ) ) );
+		A.set( "username", "u", string( gettext( "user name for authentication" ) ) );
+		A.set( "where", "W", string( gettext( "condition rows must match" ) ) );
+		string& password = A.set( "password", "w", string( gettext( "with prompt asking for the passphrase" ) ), false );
+		A.set( "compress", "z", string( gettext( "compress output using gzip" ) ), false );
+
+		if( A.asString( "config" ) != "" ) {
+			A.parseFile( A.asString( "config" ) );
+		}
+		A.parseArgv( argc, argv );
+
+		if( A.mustDo( "help" ) || A.asString( "table" ) == "" || A.asString( "key" ) == "" ) {
+			std::cout << help( A, string( argv[0] ) );
+			return 0;
+		}
+
+		if( A.mustDo( "password" ) ) {
+			std::cerr << gettext( "Password: " );
+			std::cin >> password;
+		}
+
+		long jobs = A.asLong( "jobs" );
+
+		if( jobs < 1 || A.asLong( "chunk" ) < 1 ) {
+			throw std::runtime_error( gettext( "Invalid number of jobs or rows per chunk" ) );
+		}
+
+		struct settings conf;
+		conf.backend = A.asString( "backend" );
+		conf.host = A.asString( "host" );
+		conf.port = A.asString( "port" );
+		conf.database = A.asString( "database" );
+		conf.username = A.asString( "username" );
+		conf.password = A.asString( "password" );
+		conf.format = A.asString( "export" );
+		conf.chunk = (unsigned long) A.asLong( "chunk" );
+		conf.compress = A.mustDo( "compress" );
+
+		string output = A.asString( "output" );
+		string where = A.asString( "where" );
+		size_t pattern = output.find( "%d" );
+		bool merge = ( pattern == string::npos );
+
+		Export check( conf.format, "/dev/null", conf.compress );   // fail early on invalid format
+		check.close();
+
+		vector<string> preds;
+
+		{
+			Conn conn( conf.backend, conf.host, conf.port );
+			conn.bind( conf.database, conf.username, conf.password );
+
+			preds = splitTable( conn, conf.backend, A.asString( "table" ), A.asString( "key" ), where, A.asString( "split" ), (unsigned long) jobs );
+		}
+
+		if( merge )
+		{
+			const char* tmpdir = getenv( "TMPDIR" );
+			string tmpl = string( tmpdir != NULL ? tmpdir : "/tmp" ) + "/odbx-export.XXXXXX";
+
+			for( long i = 0; i < jobs; i++ )
+			{
+				vector<char> name( tmpl.begin(), tmpl.end() );
+				name.push_back( '\0' );
+
+				int fd = mkstemp( &name[0] );
+				if( fd < 0 ) { throw std::runtime_error( gettext( "Unable to create temporary file" ) ); }
+				::close( fd );
+
+				tmpfiles.push_back( string( &name[0] ) );
+			}
+
+			if( output.empty() || output == "-" ) { out = stdout; }
+			else if( ( out = fopen( output.c_str(), "wb" ) ) == NULL ) {
+				throw std::runtime_error( string( gettext( "Unable to open file: " ) ) + output );
+			}
+		}
+
+		shards.resize( jobs );
+
+		for( long i = 0; i < jobs; i++ )
+		{
+			struct shard& s = shards[i];
+			std::ostringstream sql, num;
+
+			sql << "SELECT " << A.asString( "columns" ) << " FROM " << A.asString( "table" ) << " WHERE ";
+			if( !where.empty() ) { sql << "(" << where << ") AND "; }
+			sql << preds[i];
+			if( A.mustDo( "order" ) ) { sql << " ORDER BY " << A.asString( "key" ); }
+
+			num << i;
+
+			s.id = (unsigned long) i;
+			s.conf = &conf;
+			s.sql = sql.str();
+			s.file = merge ? tmpfiles[i] : string( output ).replace( pattern, 2, num.str() );
+			s.names = !merge || i == 0;   // only once in merged CSV output
+			s.rows = s.bytes = s.end = 0;
+			s.start = now();
+			s.done = false;
+
+			pthread_mutex_init( &s.lock, NULL );
+		}
+
+		for( started = 0; started < (unsigned long) jobs; started++ )
+		{
+			if( pthread_create( &shards[started].thread, NULL, run, (void*) &shards[started] ) != 0 ) {
+				throw std::runtime_error( gettext( "Starting thread failed" ) );
+			}
+		}
+
+		/*
+		 *  Completed shards are appended in order while the others are still
+		 *  running. Compressed files can be concatenated as gzip allows
+		 *  several members in one file.
+		 */
+
+		bool progress = !A.mustDo( "quiet" ) && isatty( STDERR_FILENO );
+		uint64_t start = now(), last = start;
+		unsigned long merged = 0, done = 0;
+
+		while( 1 )
+		{
+			uint64_t rows = 0, bytes = 0;
+
+			done = 0;
+
+			for( long i = 0; i < jobs; i++ )
+			{
+				pthread_mutex_lock( &shards[i].lock );
+				rows += shards[i].rows;
+				bytes += shards[i].bytes;
+				if( shards[i].done ) { done++; }
+				if( shards[i].done && !shards[i].error.empty() ) { err = 1; }
+				pthread_mutex_unlock( &shards[i].lock );
+			}
+
+			while( merge && err == 0 && merged < (unsigned long) jobs )
+			{
+				pthread_mutex_lock( &shards[merged].lock );
+				bool finished = shards[merged].done;
+				pthread_mutex_unlock( &shards[merged].lock );
+
+				if( !finished ) { break; }
+
+				copyfile( tmpfiles[merged], out );
+				unlink( tmpfiles[merged].c_str() );
+				merged++;
+			}
+
+			if( progress && ( now() - last >= 1000000000 || done == (unsigned long) jobs ) )
+			{
+				double secs = ( now() - start ) / 1e9;
+
+				last = now();
+				fprintf( stderr, gettext( "\r%llu rows, %.0f rows/s, %.1f MB/s, %lu of %ld shards done " ),
+					(unsigned long long) rows, rows / secs, bytes / secs / 1048576, done, jobs );
+			}
+
+			if( done == (unsigned long) jobs ) { break; }
+
+			struct timespec ts = { 0, 100000000 };
+			nanosleep( &ts, NULL );
+		}
+
+		if( progress ) { fprintf( stderr, "\n" ); }
+
+		for( unsigned long i = 0; i < started; i++ ) { pthread_join( shards[i].thread, NULL ); }
+		started = 0;
+
+		if( out != NULL && ( out == stdout ? fflush( out ) : fclose( out ) ) != 0 ) {
+			out = NULL;
+			throw std::runtime_error( gettext( "Writing output failed" ) );
+		}
+		out = NULL;
+
+		fprintf( stderr, "%-6s %12s %14s %9s %12s\n", gettext( "shard" ), gettext( "rows" ), gettext( "bytes" ), gettext( "seconds" ), gettext( "rows/s" ) );
+
+		for( long i = 0; i < jobs; i++ )
+		{
+			double secs = ( shards[i].end - shards[i].start ) / 1e9;
+
+			fprintf( stderr, "%-6ld %12llu %14llu %9.2f %12.0f\n", i, (unsigned long long) shards[i].rows,
+				(unsigned long long) shards[i].bytes, secs, secs > 0 ? shards[i].rows / secs : 0.0 );
+
+			if( !shards[i].error.empty() ) {
+				cerr << gettext( "Error: " ) << gettext( "Shard " ) << i << ": " << shards[i].error << endl;
+			}
+		}
+	}
+	catch( std::runtime_error &e )
+	{
+		cerr << gettext( "Error: " ) << e.what() << endl;
+		err = 1;
+	}
+	catch( ... )
+	{
+		cerr << gettext( "Error: Caught unknown exception" ) << endl;
+		err = 1;
+	}
+
+	for( unsigned long i = 0; i < started; i++ ) { pthread_join( shards[i].thread, NULL ); }
+	for( size_t i = 0; i < shards.size(); i++ ) { pthread_mutex_destroy( &shards[i].lock ); }
+	for( size_t i = 0; i < tmpfiles.size(); i++ ) { unlink( tmpfiles[i].c_str() ); }
+
+	if( out != NULL && out != stdout ) { fclose( out ); }
+
+	return err;
+}
@@ -0,0 +1,66 @@
+#include "export.hpp"
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+
+
+using std::string;
+
+
+#ifndef ODBX_EXPORT_HPP
+#define ODBX_EXPORT_HPP
+
+
+struct settings
+{
+	string backend;
+	string host;
+	string port;
+	string database;
+	string username;
+	string password;
+	string format;
+	unsigned long chunk;
+	bool compress;
+};
+
+
+struct shard
+{
+	unsigned long id;
+	pthread_t thread;
+	const struct settings* conf;
+	string sql;
+	string file;
+	bool names;   // write the column names
+	pthread_mutex_t lock;   // protects the members below
+	uint64_t rows;
+	uint64_t bytes;
+	uint64_t start;
+	uint64_t end;
+	bool done;
+	string error;
+};
+
+
+
+/*
+ *  Updates the statistics of the shard while writing
+ */
+
+class ShardExport : public Export
+{
+protected:
+
+	struct shard* m_shard;
+
+	void progress( uint64_t rows, uint64_t bytes );
+
+public:
+
+	ShardExport( struct shard* s, const string& filename ) :
+		Export( s->conf->format, filename, s->conf->compress ), m_shard( s ) {}
+};
+
+
+#endif
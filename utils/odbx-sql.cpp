@@ -2,6 +2,8 @@
 #include "commands.hpp"
 #include "completion.hpp"
 #include "odbx-sql.hpp"
+#include "export.hpp"
+#include "script.hpp"
 #include <opendbx/api>
 #include <stdexcept>
 #include <iostream>
@@ -9,7 +11,9 @@
 #include <string>
 #include <cstddef>
 #include <cstdlib>
+#include <cstdio>
 #include <clocale>
+#include <vector>
 #include <readline/readline.h>
 #include <readline/history.h>
 
@@ -17,6 +21,10 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
 #ifdef ENABLE_NLS
 #  ifdef HAVE_LIBINTL_H
 #    include <libintl.h>
@@ -30,6 +38,7 @@
 using namespace OpenDBX;
 
 using std::string;
+using std::vector;
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -66,54 +75,74 @@ char* complete( const char* text, int state )
 
 void output( Result& result, struct format* fparam )
 {
-	odbxres stat;
 	unsigned long fields;
 
-	while( ( stat = result.getResult( NULL, 25 ) ) != ODBX_RES_DONE )
+	for( ResultSet& set : result.sets( 64, 25 ) )
 	{
-		switch( stat )
-		{
-			case ODBX_RES_TIMEOUT:
-			case ODBX_RES_NOROWS:
-				continue;
-			default:
-				break;
-		}
+		if( set.status() != ODBX_RES_ROWS ) { continue; }
 
-		fields = result.columnCount();
+		fields = set.columnCount();
 
 		if( fparam->header == true && fields > 0 )
 		{
-			cout << result.columnName( 0 );
+			cout << set.columnName( 0 );
 
 			for( unsigned long i = 1; i < fields; i++ )
 			{
-				cout << fparam->separator << result.columnName( i );
+				cout << fparam->separator << set.columnName( i );
 			}
 			cout << endl << "---" << endl;
 		}
 
-		while( result.getRow() != ODBX_ROW_DONE )
+		for( const RowView& row : set )
 		{
-			if( fields > 0 )
+			for( unsigned long i = 0; i < fields; i++ )
 			{
-				if( result.fieldValue( 0 ) == NULL ) { cout << "NULL"; }
-				else { cout << fparam->delimiter << result.fieldValue( 0 ) << fparam->delimiter; }
+				if( i > 0 ) { cout << fparam->separator; }
 
-				for( unsigned long i = 1; i < fields; i++ )
-				{
-					if( result.fieldValue( i ) == NULL ) { cout << fparam->separator << "NULL"; }
-					else { cout << fparam->separator << fparam->delimiter << result.fieldValue( i ) << fparam->delimiter; }
-				}
+				if( row.isNull( i ) ) { cout << "NULL"; }
+				else { cout << fparam->delimiter << row.value( i ) << fparam->delimiter; }
 			}
-			cout << endl;
+			cout << '\n';
 		}
+
+		cout.flush();
+	}
+}
+
+
+
+/*
+ *  Reads input without echoing it if it's not from a terminal
+ */
+
+char* readinput( const char* prompt, bool iactive )
+{
+	char* line = NULL;
+	size_t size = 0;
+	ssize_t len;
+
+	if( iactive ) { return readline( prompt ); }
+
+	if( ( len = getline( &line, &size, stdin ) ) < 0 )
+	{
+		::free( line );
+		return NULL;
 	}
+
+	while( len > 0 && ( line[len-1] == '\n' || line[len-1] == '\r' ) ) { line[--len] = '\0'; }
+
+	return line;
 }
 
 
 
-void loopstmts( Conn& conn, struct format* fparam, bool iactive )
+/*
+ *  Returns true at the end of the input and false if the connection has
+ *  to be reestablished
+ */
+
+bool loopstmts( Conn& conn, struct format* fparam, bool iactive, Export* exp )
 {
 	char* line;
 	size_t len;
@@ -131,18 +160,26 @@ void loopstmts( Conn& conn, struct format* fparam, bool iactive )
 		using_history();
 	}
 
-	while( ( line = readline( fprompt ) ) != NULL )
+	while( ( line = readinput( fprompt, iactive ) ) != NULL )
 	{
 		len = strlen( line );
 		if( len == 0 ) { free( line ); continue;}
-		if( line[0] == '.' ) { cmd.exec( string( line ), fparam ); continue; }
+		if( line[0] == '.' )
+		{
+			string command( line );
+			::free( line );
+
+			if( exp == NULL ) { cmd.exec( command, fparam ); }
+			else if( command == ".quit" ) { return true; }   // keep exported output clean
+			continue;
+		}
 
 		sql = string( line, len );
 		::free( line );
 
 		if( sql[len-1] != ';' )
 		{
-			while( ( line = readline( cprompt ) ) != NULL )
+			while( ( line = readinput( cprompt, iactive ) ) != NULL )
 			{
 				len = strlen( line );
 				sql += "\n" + string( line, len );
@@ -160,16 +197,119 @@ void loopstmts( Conn& conn, struct format* fparam, bool iactive )
 			Stmt stmt = conn.create( sql );
 			Result result = stmt.execute();
 
-			output( result, fparam );
+			if( exp != NULL ) { exp->write( result, fparam->chunk ); }
+			else { output( result, fparam ); }
 
 			result.finish();
 		}
 		catch( OpenDBX::Exception& oe )
 		{
 			cerr << gettext( "Warning: " ) << oe.what() << endl;
-			if( oe.getType() < 0 ) { return; }
+			if( oe.getType() < 0 ) { return false; }
+		}
+	}
+
+	return true;
+}
+
+
+
+/*
+ *  Returns false if the statement failed and rethrows fatal errors
+ */
+
+bool execute( Conn& conn, const string& sql, struct format* fparam, Export* exp )
+{
+	try
+	{
+		Stmt stmt = conn.create( sql );
+		Result result = stmt.execute();
+
+		if( exp != NULL ) { exp->write( result, fparam->chunk ); }
+		else { output( result, fparam ); }
+
+		result.finish();
+	}
+	catch( OpenDBX::Exception& oe )
+	{
+		cerr << gettext( "Warning: " ) << oe.what() << endl;
+		if( oe.getType() < 0 ) { throw; }
+		return false;
+	}
+
+	return true;
+}
+
+
+
+/*
+ *  Executes the statements of a script grouped into transactions of trans
+ *  statements. If batch is greater than one, the backend must support
+ *  multiple statements per query and that many are sent at once.
+ *  Backslashes escape quotes in strings if backslash is true.
+ */
+
+int runscript( Conn& conn, const string& filename, bool backslash, unsigned long trans, unsigned long batch, struct format* fparam, Export* exp )
+{
+	string sql, query;
+	vector<string> stmts;
+	Script script( filename, backslash );
+	unsigned long intrans = 0;
+	uint64_t count = 0, errors = 0;
+	struct timeval start, end;
+	bool more = true;
+
+
+	gettimeofday( &start, NULL );
+
+	while( more )
+	{
+		stmts.clear();
+
+		while( stmts.size() < batch && ( more = script.next( sql ) ) )
+		{
+			if( trans > 0 && intrans == 0 ) { stmts.push_back( "BEGIN" ); }
+
+			stmts.push_back( sql );
+			count++;
+
+			if( trans > 0 && ++intrans == trans )
+			{
+				stmts.push_back( "COMMIT" );
+				intrans = 0;
+			}
+		}
+
+		if( !more && intrans > 0 ) { stmts.push_back( "COMMIT" ); }
+
+		if( batch > 1 && !stmts.empty() )
+		{
+			query = stmts[0];
+
+			for( size_t i = 1; i < stmts.size(); i++ )
+			{
+				query += "\n;\n";   // statements may end with a line comment
+				query += stmts[i];
+			}
+
+			if( !execute( conn, query, fparam, exp ) ) { errors++; }
+			continue;
+		}
+
+		for( size_t i = 0; i < stmts.size(); i++ )
+		{
+			if( !execute( conn, stmts[i], fparam, exp ) ) { errors++; }
 		}
 	}
+
+	gettimeofday( &end, NULL );
+
+	double secs = ( end.tv_sec - start.tv_sec ) + ( end.tv_usec - start.tv_usec ) / 1e6;
+
+	fprintf( stderr, gettext( "%llu statements in %.2f seconds, %.0f statements/s, %llu failed\n" ),
+		(unsigned long long) count, secs, secs > 0 ? count / secs : 0.0, (unsigned long long) errors );
+
+	return errors > 0 ? 1 : 0;
 }
 
 
@@ -193,16 +333,23 @@ int main( int argc, char* argv[] )
 
 		A.set( "help", "?", string( gettext( "print this help" ) ), false );
 		A.set( "backend", "b", string( gettext( "name of the backend or path to the backend library" ) ) ) = "mysql";
+		A.set( "batch", "B", string( gettext( "statements sent at once in script mode if supported" ) ) ) = "100";
 		A.set( "config", "c", string( gettext( "read configuration from file" ) ) ) = config;
 		A.set( "database", "d", string( gettext( "database name or database file name" ) ) );
 		A.set( "delimiter", "f", string( gettext( "start/end field delimiter in output" ) ) ) = "\"";
+		A.set( "export", "e", string( gettext( "export results as csv, tsv, jsonl or binary" ) ) );
+		A.set( "file", "F", string( gettext( "execute statements from script file, - for stdin" ) ) );
 		A.set( "host", "h", string( gettext( "host name, IP address or path to the database server" ) ) ) = "localhost";
 		A.set( "interactive", "i", string( gettext( "interactive mode" ) ), false );
 		A.set( "keywordfile", "k", string( gettext( "SQL keyword file for command completion" ) ) ) = KEYWORDFILE;
+		A.set( "chunk", "n", string( gettext( "rows fetched at once in export mode" ) ) ) = "1000";
+		A.set( "output", "o", string( gettext( "write exported results to file instead of stdout" ) ) );
 		A.set( "port", "p", string( gettext( "port name or number of the database server" ) ) );
 		A.set( "separator", "s", string( gettext( "separator between fields in output" ) ) ) = "|";
+		A.set( "transaction", "T", string( gettext( "statements per transaction in script mode, 0 for autocommit" ) ) ) = "0";
 		A.set( "username", "u", string( gettext( "user name for authentication" ) ) );
 		string& password = A.set( "password", "w", string( gettext( "with prompt asking for the passphrase" ) ), false );
+		A.set( "compress", "z", string( gettext( "compress exported results using gzip" ) ), false );
 
 		if( A.asString( "config" ) != "" ) {
 			A.parseFile( A.asString( "config" ) );
@@ -223,19 +370,81 @@ int main( int argc, char* argv[] )
 		fparam.delimiter = A.asString( "delimiter" );
 		fparam.separator = A.asString( "separator" );
 		fparam.header = true;
+		fparam.chunk = (unsigned long) A.asLong( "chunk" );
+
+		Export* exp = NULL;
+
+		if( A.mustDo( "interactive" ) && A.asString( "file" ) != "" ) {
+			throw std::runtime_error( gettext( "Script mode can't be used interactively" ) );
+		}
+
+		if( A.asString( "export" ) != "" )
+		{
+			if( A.mustDo( "interactive" ) ) {
+				throw std::runtime_error( gettext( "Export mode can't be used interactively" ) );
+			}
+
+			exp = new Export( A.asString( "export" ), A.asString( "output" ), A.mustDo( "compress" ) );
+		}
 
 		g_comp = new Completion( A.asString( "keywordfile" ) );
 		rl_completion_entry_function = &complete;
 
 		Conn conn( A.asString( "backend" ), A.asString( "host" ), A.asString( "port" ) );
 
+		if( A.asString( "file" ) != "" )
+		{
+			long batch = A.asLong( "batch" );
+			long trans = A.asLong( "transaction" );
+			int multi = ODBX_DISABLE;
+
+			if( batch < 1 || trans < 0 ) {
+				throw std::runtime_error( gettext( "Invalid number of statements per batch or transaction" ) );
+			}
+
+			if( batch > 1 )
+			{
+				try
+				{
+					conn.getOption( ODBX_OPT_MULTI_STATEMENTS, (void*) &multi );
+					if( multi == ODBX_ENABLE ) { conn.setOption( ODBX_OPT_MULTI_STATEMENTS, (void*) &multi ); }
+				}
+				catch( OpenDBX::Exception& oe ) { multi = ODBX_DISABLE; }
+
+				if( multi != ODBX_ENABLE ) { batch = 1; }
+			}
+
+			conn.bind( A.asString( "database" ), A.asString( "username" ), A.asString( "password" ) );
+
+			int err = runscript( conn, A.asString( "file" ), A.asString( "backend" ).find( "mysql" ) != string::npos, (unsigned long) trans, (unsigned long) batch, &fparam, exp );
+
+			conn.unbind();
+
+			if( exp != NULL )
+			{
+				exp->close();
+				delete exp;
+			}
+
+			delete g_comp;
+			return err;
+		}
+
 		while( 1 )
 		{
 			conn.bind( A.asString( "database" ), A.asString( "username" ), A.asString( "password" ) );
 
-			loopstmts( conn, &fparam, A.mustDo( "interactive" ) );
+			bool end = loopstmts( conn, &fparam, A.mustDo( "interactive" ), exp );
 
 			conn.unbind();
+
+			if( end ) { break; }
+		}
+
+		if( exp != NULL )
+		{
+			exp->close();
+			delete exp;
 		}
 
 		delete g_comp;
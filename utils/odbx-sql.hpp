@@ -13,6 +13,7 @@ struct format
 	string delimiter;
 	string separator;
 	bool header;
+	unsigned long chunk;
 };
 
 
@@ -0,0 +1,114 @@
+#include "parallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cstdlib>
+#include <ctime>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#ifdef ENABLE_NLS
+#  ifdef HAVE_LIBINTL_H
+#    include <libintl.h>
+#  endif
+#else
+#  define gettext(string) string
+#endif
+
+
+
+using namespace OpenDBX;
+
+
+
+uint64_t now()
+{
+#ifdef HAVE_CLOCK_GETTIME
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#else
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+	return (uint64_t) tv.tv_sec * 1000000000 + (uint64_t) tv.tv_usec * 1000;
+#endif
+}
+
+
+
+/*
+ *  Key ranges are open at both ends so rows added in the meantime aren't
+ *  lost, the modulo split works for any integer key. Oracle and Firebird
+ *  only know MOD() while SQLite and Sybase only know the % operator.
+ */
+
+vector<string> splitTable( Conn& conn, const string& backend, const string& table, const string& key, const string& where, const string& method, unsigned long jobs )
+{
+	vector<string> preds;
+	std::ostringstream sql;
+
+
+	if( method == "modulo" )
+	{
+		for( unsigned long i = 0; i < jobs; i++ )
+		{
+			std::ostringstream pred;
+			if( backend.find( "oracle" ) != string::npos || backend.find( "firebird" ) != string::npos ) {
+				pred << "ABS(MOD(" << key << ", " << jobs << ")) = " << i;
+			} else {
+				pred << "ABS(" << key << " % " << jobs << ") = " << i;
+			}
+			preds.push_back( pred.str() );
+		}
+
+		return preds;
+	}
+
+	if( method != "range" ) {
+		throw std::runtime_error( string( gettext( "Unknown split method: " ) ) + method );
+	}
+
+	long long min = 0, max = 0;
+
+	sql << "SELECT MIN(" << key << "), MAX(" << key << ") FROM " << table;
+	if( !where.empty() ) { sql << " WHERE " << where; }
+
+	Result result = conn.create( sql.str() ).execute();
+
+	while( result.getResult() != ODBX_RES_DONE )
+	{
+		while( result.getRow() != ODBX_ROW_DONE )
+		{
+			if( result.columnCount() < 2 || result.fieldValue( 0 ) == NULL || result.fieldValue( 1 ) == NULL ) { continue; }
+
+			min = strtoll( result.fieldValue( 0 ), NULL, 10 );
+			max = strtoll( result.fieldValue( 1 ), NULL, 10 );
+		}
+	}
+
+	// the width of the whole range doesn't fit into long long and bounds are clamped to max
+	unsigned long long range = (unsigned long long) max - (unsigned long long) min;
+	unsigned long long width = jobs > 1 ? range / jobs + 1 : 0;
+
+	for( unsigned long i = 0; i < jobs; i++ )
+	{
+		std::ostringstream pred;
+
+		if( i > 0 ) { pred << key << " >= " << (long long) ( (unsigned long long) min + std::min( width * i, range ) ); }
+		if( i > 0 && i < jobs - 1 ) { pred << " AND "; }
+		if( i < jobs - 1 ) { pred << key << " < " << (long long) ( (unsigned long long) min + std::min( width * ( i + 1 ), range ) ); }
+		if( jobs == 1 ) { pred << "1 = 1"; }
+
+		preds.push_back( pred.str() );
+	}
+
+	return preds;
+}
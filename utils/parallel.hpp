@@ -0,0 +1,28 @@
+#include <opendbx/api>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+using std::string;
+using std::vector;
+
+
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+
+
+/*
+ *  Helpers shared by the utilities using several threads
+ */
+
+uint64_t now();
+
+vector<string> splitTable( OpenDBX::Conn& conn, const string& backend, const string& table, const string& key,
+	const string& where, const string& method, unsigned long jobs );
+
+
+
+#endif
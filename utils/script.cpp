@@ -0,0 +1,170 @@
+#include "script.hpp"
+#include <cctype>
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef ENABLE_NLS
+#  ifdef HAVE_LIBINTL_H
+#    include <libintl.h>
+#  endif
+#else
+#  define gettext(string) string
+#endif
+
+
+
+Script::Script( const string& filename, bool backslash, size_t bufsize ) : m_file( stdin ), m_buffer( bufsize ), m_pos( 0 ), m_len( 0 ),
+	m_state( Normal ), m_prev( 0 ), m_content( false ), m_pending( false ), m_backslash( backslash ), m_escaped( false ), m_matched( 0 )
+{
+	if( filename != "-" && ( m_file = fopen( filename.c_str(), "rb" ) ) == NULL )
+	{
+		throw ScriptException( string( gettext( "Unable to open file: " ) ) + filename );
+	}
+}
+
+
+
+Script::~Script()
+{
+	if( m_file != stdin ) { fclose( m_file ); }
+}
+
+
+
+bool Script::fill()
+{
+	m_pos = 0;
+	m_len = fread( &m_buffer[0], 1, m_buffer.size(), m_file );
+
+	if( m_len == 0 && ferror( m_file ) )
+	{
+		throw ScriptException( gettext( "Reading script failed" ) );
+	}
+
+	return m_len > 0;
+}
+
+
+
+/*
+ *  Returns the collected statement without surrounding white space if it
+ *  contains more than comments
+ */
+
+bool Script::finish( string& sql )
+{
+	bool content = m_content || m_pending;
+	size_t start = 0, end = m_stmt.size();
+
+	while( start < end && isspace( (unsigned char) m_stmt[start] ) ) { start++; }
+	while( end > start && isspace( (unsigned char) m_stmt[end-1] ) ) { end--; }
+
+	if( content ) { sql.assign( m_stmt, start, end - start ); }
+
+	m_stmt.clear();
+	m_content = m_pending = false;
+	m_prev = 0;
+
+	return content;
+}
+
+
+
+bool Script::next( string& sql )
+{
+	char c;
+	size_t start;
+
+
+	while( 1 )
+	{
+		if( m_pos >= m_len && !fill() )
+		{
+			m_state = Normal;
+			if( finish( sql ) ) { return true; }   // last statement without semicolon
+			return false;
+		}
+
+		for( start = m_pos; m_pos < m_len; m_pos++ )
+		{
+			c = m_buffer[m_pos];
+
+			switch( m_state )
+			{
+				case Normal:
+					if( c == ';' )
+					{
+						m_stmt.append( &m_buffer[start], m_pos - start );
+						m_pos++;
+
+						if( finish( sql ) ) { return true; }
+
+						start = m_pos;
+						continue;
+					}
+
+					if( m_pending && ( ( m_prev == '-' && c == '-' ) || ( m_prev == '/' && c == '*' ) ) )
+					{
+						m_state = c == '-' ? LineComment : BlockComment;
+						m_pending = false;
+						c = 0;
+						break;
+					}
+
+					if( m_pending ) { m_content = true; m_pending = false; }
+
+					switch( c )
+					{
+						case '\'': m_state = Single; break;
+						case '"': m_state = Double; break;
+						case '`': m_state = Backtick; break;
+						case '$': m_state = DollarTag; m_tag = "$"; break;
+						case '-': case '/': m_pending = true; m_prev = c; continue;
+					}
+
+					if( !isspace( (unsigned char) c ) ) { m_content = true; }
+					break;
+
+				case Single:
+				case Double:
+					if( m_escaped ) { m_escaped = false; }
+					else if( c == '\\' && m_backslash ) { m_escaped = true; }
+					else if( c == ( m_state == Single ? '\'' : '"' ) ) { m_state = Normal; }
+					break;
+				case Backtick:
+					if( c == '`' ) { m_state = Normal; }
+					break;
+
+				case LineComment:
+					if( c == '\n' ) { m_state = Normal; }
+					break;
+				case BlockComment:
+					if( m_prev == '*' && c == '/' ) { m_state = Normal; c = 0; }
+					break;
+
+				case DollarTag:
+					if( c == '$' )
+					{
+						m_tag += c;
+						m_matched = 0;
+						m_state = Dollar;
+					}
+					else if( isalnum( (unsigned char) c ) || c == '_' ) { m_tag += c; }
+					else { m_state = Normal; m_pos--; continue; }   // positional parameter like $1
+					break;
+				case Dollar:
+					if( c == m_tag[m_matched] ) { m_matched++; }
+					else { m_matched = ( c == '$' ? 1 : 0 ); }
+
+					if( m_matched == m_tag.size() ) { m_state = Normal; }
+					break;
+			}
+
+			m_prev = c;
+		}
+
+		m_stmt.append( &m_buffer[start], m_pos - start );
+	}
+}
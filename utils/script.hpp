@@ -0,0 +1,70 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdio>
+
+
+using std::string;
+using std::vector;
+
+
+
+#ifndef SCRIPT_HPP
+#define SCRIPT_HPP
+
+
+
+class ScriptException : public std::runtime_error
+{
+public:
+	explicit ScriptException( const string& str ) : std::runtime_error( str ) {}
+};
+
+
+
+/*
+ *  Splits SQL scripts into statements
+ *
+ *  The input is read in large blocks and statements are separated by
+ *  semicolons outside of string literals ('...'), quoted identifiers
+ *  ("..." and `...`), dollar quoted strings ($tag$...$tag$) and comments
+ *  (-- and C style). Quotes inside literals must be doubled unless
+ *  backslash is set, which treats backslashes in '...' and "..." as
+ *  escape characters like MySQL does. Statements consisting only of
+ *  comments and white space are skipped.
+ */
+
+class Script
+{
+protected:
+
+	enum scriptstate { Normal, Single, Double, Backtick, LineComment, BlockComment, DollarTag, Dollar };
+
+	FILE* m_file;
+	vector<char> m_buffer;
+	size_t m_pos;
+	size_t m_len;
+	scriptstate m_state;
+	char m_prev;
+	bool m_content;
+	bool m_pending;   // possible start of a comment
+	bool m_backslash;
+	bool m_escaped;   // previous character was a backslash in a string
+	string m_tag;
+	size_t m_matched;
+	string m_stmt;
+
+	bool fill();
+	bool finish( string& sql );
+
+public:
+
+	Script( const string& filename, bool backslash = false, size_t bufsize = 1048576 );
+	~Script();
+
+	bool next( string& sql );
+};
+
+
+
+#endif
@@ -0,0 +1,177 @@
+#include "workload.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+
+
+
+Workload::Workload( const string& filename )
+{
+	string line, name, sql;
+	unsigned long weight, lineno = 0;
+	std::ifstream file( filename.c_str() );
+
+
+	if( !file ) {
+		throw WorkloadException( "Workload: Can't open file " + filename );
+	}
+
+	while( getline( file, line ) )
+	{
+		lineno++;
+
+		if( line.find_first_not_of( " \t\r" ) == string::npos || line[line.find_first_not_of( " \t" )] == '#' ) { continue; }
+
+		std::istringstream iss( line );
+
+		if( !( iss >> name >> weight ) || !getline( iss, sql ) || sql.find_first_not_of( " \t\r" ) == string::npos )
+		{
+			std::ostringstream msg;
+			msg << "Workload: Invalid template in line " << lineno << " of " << filename;
+			throw WorkloadException( msg.str() );
+		}
+
+		sql.erase( 0, sql.find_first_not_of( " \t" ) );
+		sql.erase( sql.find_last_not_of( " \t\r;" ) + 1 );
+
+		if( weight > 0 ) { this->parse( name, weight, sql ); }
+	}
+
+	file.close();
+
+	if( m_tmpl.empty() ) {
+		throw WorkloadException( "Workload: No templates in file " + filename );
+	}
+}
+
+
+
+void Workload::parse( const string& name, unsigned long weight, const string& sql )
+{
+	string::size_type end, pos = 0, start;
+	struct tmpl t;
+	struct part p;
+
+
+	t.name = name;
+	t.weight = weight;
+
+	while( ( start = sql.find( '{', pos ) ) != string::npos && ( end = sql.find( '}', start ) ) != string::npos )
+	{
+		string ph = sql.substr( start + 1, end - start - 1 );
+
+		p.min = p.max = 0;
+
+		if( ph == "seq" ) { p.type = Seq; }
+		else if( ph == "thread" ) { p.type = Thread; }
+		else if( ph.compare( 0, 4, "int:" ) == 0 && sscanf( ph.c_str() + 4, "%lld:%lld", (long long*) &p.min, (long long*) &p.max ) == 2 && p.min <= p.max ) { p.type = Int; }
+		else if( ph.compare( 0, 4, "str:" ) == 0 && sscanf( ph.c_str() + 4, "%lld", (long long*) &p.max ) == 1 && p.max >= 0 ) { p.type = Str; }
+		else
+		{
+			throw WorkloadException( "Workload: Invalid placeholder {" + ph + "} in template " + name );
+		}
+
+		if( start > pos )
+		{
+			struct part text;
+
+			text.type = Text;
+			text.text = sql.substr( pos, start - pos );
+			t.parts.push_back( text );
+		}
+
+		t.parts.push_back( p );
+		pos = end + 1;
+	}
+
+	if( pos < sql.size() )
+	{
+		p.type = Text;
+		p.text = sql.substr( pos );
+		t.parts.push_back( p );
+	}
+
+	m_tmpl.push_back( t );
+	m_cumulative.push_back( ( m_cumulative.empty() ? 0 : m_cumulative.back() ) + weight );
+}
+
+
+
+size_t Workload::size() const
+{
+	return m_tmpl.size();
+}
+
+
+
+const string& Workload::name( size_t pos ) const
+{
+	return m_tmpl[pos].name;
+}
+
+
+
+/*
+ *  Picks a template according to the weights
+ */
+
+size_t Workload::choose( uint64_t random ) const
+{
+	unsigned long r = (unsigned long) ( random % m_cumulative.back() );
+
+	return std::upper_bound( m_cumulative.begin(), m_cumulative.end(), r ) - m_cumulative.begin();
+}
+
+
+
+void Workload::expand( size_t pos, string& sql, uint64_t& random, uint64_t seq, unsigned long thread ) const
+{
+	static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	const vector<struct part>& parts = m_tmpl[pos].parts;
+	char num[32];
+
+
+	sql.clear();
+
+	for( size_t i = 0; i < parts.size(); i++ )
+	{
+		switch( parts[i].type )
+		{
+			case Text:
+				sql += parts[i].text;
+				break;
+			case Int:
+				snprintf( num, sizeof( num ), "%lld", (long long) ( parts[i].min + (int64_t) ( next( random ) % (uint64_t) ( parts[i].max - parts[i].min + 1 ) ) ) );
+				sql += num;
+				break;
+			case Str:
+				for( int64_t j = 0; j < parts[i].max; j++ ) { sql += chars[next( random ) % ( sizeof( chars ) - 1 )]; }
+				break;
+			case Seq:
+				snprintf( num, sizeof( num ), "%llu", (unsigned long long) seq );
+				sql += num;
+				break;
+			case Thread:
+				snprintf( num, sizeof( num ), "%lu", thread );
+				sql += num;
+				break;
+		}
+	}
+}
+
+
+
+/*
+ *  xorshift64* pseudo random numbers, each thread uses its own state
+ */
+
+uint64_t Workload::next( uint64_t& random )
+{
+	random ^= random >> 12;
+	random ^= random << 25;
+	random ^= random >> 27;
+
+	return random * 2685821657736338717ULL;
+}
@@ -0,0 +1,78 @@
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+
+using std::string;
+using std::vector;
+
+
+
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+
+
+class WorkloadException : public std::runtime_error
+{
+public:
+	explicit WorkloadException( const string& str ) : std::runtime_error( str ) {}
+};
+
+
+
+/*
+ *  Weighted SQL templates read from a workload file
+ *
+ *  Each line contains the name of the template, its weight and the SQL
+ *  statement separated by white space. Empty lines and lines starting with
+ *  '#' are ignored. The statement can contain placeholders replaced each
+ *  time it's executed:
+ *
+ *  {int:min:max}   random integer between min and max
+ *  {str:len}       random string of len alphanumeric characters
+ *  {seq}           number of statements executed by the thread so far
+ *  {thread}        number of the thread
+ */
+
+class Workload
+{
+protected:
+
+	enum parttype { Text, Int, Str, Seq, Thread };
+
+	struct part {
+		enum parttype type;
+		string text;
+		int64_t min;
+		int64_t max;
+	};
+
+	struct tmpl {
+		string name;
+		unsigned long weight;
+		vector<struct part> parts;
+	};
+
+	vector<struct tmpl> m_tmpl;
+	vector<unsigned long> m_cumulative;
+
+	void parse( const string& name, unsigned long weight, const string& sql );
+
+public:
+
+	Workload( const string& filename );
+
+	size_t size() const;
+	const string& name( size_t pos ) const;
+
+	size_t choose( uint64_t random ) const;
+	void expand( size_t pos, string& sql, uint64_t& random, uint64_t seq, unsigned long thread ) const;
+
+	static uint64_t next( uint64_t& random );
+};
+
+
+
+#endif